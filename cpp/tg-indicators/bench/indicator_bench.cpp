@@ -0,0 +1,209 @@
+// Micro-benchmarks for tg-indicators kernels. Not part of ctest; run a Release build:
+//
+//   ./build/tg_indicators_bench            # every case
+//   ./build/tg_indicators_bench correlation
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "tg_indicators/bar_history.h"
+#include "tg_indicators/correlation.h"
+#include "tg_indicators/indicators/registry.h"
+#include "tg_indicators/indicators/specialize.h"
+#include "tg_indicators/linear_scan.h"
+#include "tg_indicators/parallel.h"
+
+namespace {
+
+struct BenchCase {
+  const char* name;
+  std::function<void()> run;
+};
+
+// Deterministic pseudo-random returns in roughly [-0.05, 0.05].
+std::vector<std::vector<double>> random_returns(size_t symbols, size_t length, uint64_t seed) {
+  std::vector<std::vector<double>> returns(symbols, std::vector<double>(length));
+  uint64_t state = seed;
+  for (auto& column : returns) {
+    for (double& value : column) {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      value = (static_cast<double>(state >> 11) / static_cast<double>(1ULL << 53) - 0.5) * 0.1;
+    }
+  }
+  return returns;
+}
+
+template <typename Fn>
+double time_ms(Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void bench_correlation() {
+  const size_t symbols = 500;
+  const size_t length = 5 * 250;
+  const auto returns = random_returns(symbols, length, 7);
+  tg_indicators::RollingCorrelationOptions options;
+  options.window = 60;
+  // Emitting every bar would hold ~2.4 GB of matrices; keep one per 20 bars. The
+  // running cross-products are still updated on every bar.
+  options.step = 20;
+  size_t matrices = 0;
+  const double ms = time_ms(
+      [&] { matrices = tg_indicators::rolling_correlation(returns, options).end_index.size(); });
+  std::printf("correlation  %zux%zu window=%zu bars=%zu: %.1f ms (%zu matrices)\n", symbols,
+              symbols, options.window, length, ms, matrices);
+
+  const auto benchmark = random_returns(1, length, 11).front();
+  const double beta_ms = time_ms([&] { tg_indicators::rolling_beta(returns, benchmark, 60); });
+  std::printf("beta         %zu symbols window=60 bars=%zu: %.1f ms\n", symbols, length, beta_ms);
+}
+
+void bench_scan() {
+  const size_t count = 2'000'000;
+  const auto x = random_returns(1, count, 3).front();
+  std::vector<double> y(count);
+  const double alpha = 2.0 / 13.0;
+  const double sequential_ms = time_ms(
+      [&] { tg_indicators::linear_recurrence(x.data(), y.data(), count, 1.0 - alpha, alpha, 0.0, 1); });
+  const size_t workers = tg_indicators::default_worker_count();
+  const double parallel_ms = time_ms([&] {
+    tg_indicators::linear_recurrence(x.data(), y.data(), count, 1.0 - alpha, alpha, 0.0, workers);
+  });
+  std::printf("ema scan     %zu bars: sequential %.2f ms, %zu workers %.2f ms\n", count,
+              sequential_ms, workers, parallel_ms);
+}
+
+// A deterministic random walk of daily bars around 10.0.
+std::vector<tg_indicators::OHLCV> random_bars(size_t count, uint64_t seed) {
+  const auto steps = random_returns(1, 3 * count, seed).front();
+  std::vector<tg_indicators::OHLCV> bars(count);
+  double close = 10.0;
+  for (size_t i = 0; i < count; ++i) {
+    close *= 1.0 + 0.2 * steps[3 * i];
+    auto& bar = bars[i];
+    bar.ts_millis = 1'700'000'000'000 + static_cast<int64_t>(i) * 86'400'000;
+    bar.open = close;
+    bar.close = close;
+    bar.high = close * (1.0 + std::abs(steps[3 * i + 1]));
+    bar.low = close * (1.0 - std::abs(steps[3 * i + 2]));
+    bar.volume = 100'000 + static_cast<int64_t>(i % 977) * 100;
+  }
+  return bars;
+}
+
+void bench_pack() {
+  const size_t count = 1'000'000;
+  const auto bars = random_bars(count, 5);
+  const tg_indicators::Params defaults;
+  double separate_ms = 0.0;
+  for (const char* name : {"SMA", "EMA", "MACD", "RSI", "BOLL", "ATR", "ADX", "CCI", "KDJ", "WILLR", "OBV"}) {
+    const auto indicator = tg_indicators::create_indicator(name);
+    separate_ms += time_ms([&] { indicator->compute(bars, defaults); });
+  }
+  const auto pack = tg_indicators::create_indicator("PACK");
+  const double pack_ms = time_ms([&] { pack->compute(bars, defaults); });
+  std::printf("pack         %zu bars: 11 indicators separately %.1f ms, fused PACK %.1f ms\n", count,
+              separate_ms, pack_ms);
+}
+
+void bench_specialized() {
+  // Request-sized inputs, where the specialized kernels apply.
+  const size_t count = 5'000;
+  const size_t repeats = 400;
+  const auto bars = random_bars(count, 9);
+  const std::vector<std::pair<const char*, tg_indicators::Params>> hot{
+      {"RSI", {{"period", 6.0}}}, {"RSI", {{"period", 12.0}}}, {"RSI", {{"period", 14.0}}}, {"RSI", {{"period", 24.0}}},
+      {"MACD", {}},               {"BOLL", {}}};
+  for (const auto& [name, params] : hot) {
+    const auto indicator = tg_indicators::create_indicator(name);
+    auto run = [&] {
+      for (size_t r = 0; r < repeats; ++r) {
+        indicator->compute(bars, params);
+      }
+    };
+    tg_indicators::set_specialized_kernels(false);
+    const double generic_ms = time_ms(run);
+    tg_indicators::set_specialized_kernels(true);
+    const double specialized_ms = time_ms(run);
+    const std::string label = params.empty() ? name : std::string(name) + "(" +
+                                                          std::to_string(static_cast<int>(params.begin()->second)) + ")";
+    std::printf("specialized  %-8s %zux%zu bars: generic %.1f ms, specialized %.1f ms (%.2fx)\n",
+                label.c_str(), repeats, count, generic_ms, specialized_ms, generic_ms / specialized_ms);
+  }
+}
+
+// Minute bars quoted like A-shares: 0.01 ticks, 100-share lots, amount to the fen.
+std::vector<tg_indicators::OHLCV> tick_bars(size_t count, uint64_t seed) {
+  uint64_t state = seed;
+  auto next = [&](int64_t span) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<int64_t>((state >> 33) % static_cast<uint64_t>(span));
+  };
+  std::vector<tg_indicators::OHLCV> bars(count);
+  int64_t close = 1523;
+  for (size_t i = 0; i < count; ++i) {
+    const int64_t open = close + (next(7) == 0 ? 1 : 0);
+    close = std::max<int64_t>(1, open + next(7) - 3);
+    const int64_t high = std::max(open, close) + next(5);
+    const int64_t low = std::max<int64_t>(1, std::min(open, close) - next(5));
+    auto& bar = bars[i];
+    bar.ts_millis = 1'700'000'000'000 + static_cast<int64_t>(i) * 60'000;
+    bar.open = static_cast<double>(open) / 100.0;
+    bar.high = static_cast<double>(high) / 100.0;
+    bar.low = static_cast<double>(low) / 100.0;
+    bar.close = static_cast<double>(close) / 100.0;
+    bar.volume = (10 + next(3000)) * 100;
+    bar.amount = static_cast<double>(bar.volume * (low + (high - low) / 2)) / 100.0;
+  }
+  return bars;
+}
+
+void bench_history() {
+  const size_t count = 1'000'000;
+  const std::pair<const char*, std::vector<tg_indicators::OHLCV>> feeds[] = {
+      {"ticks", tick_bars(count, 11)}, {"doubles", random_bars(count, 11)}};
+  const auto sma = tg_indicators::create_indicator("SMA");
+  const auto pack = tg_indicators::create_indicator("PACK");
+  for (const auto& [label, bars] : feeds) {
+    tg_indicators::BarHistory history;
+    const double append_ms = time_ms([&] { history.append(bars); });
+    std::vector<tg_indicators::OHLCV> decoded;
+    history.read(decoded);  // fault the buffer in, as a reused request buffer would be
+    const double decode_ms = time_ms([&] {
+      decoded.clear();
+      history.read(decoded);
+    });
+    const double sma_ms = time_ms([&] { sma->compute(decoded, {}); });
+    const double pack_ms = time_ms([&] { pack->compute(decoded, {}); });
+    const double raw = static_cast<double>(count * sizeof(tg_indicators::OHLCV));
+    std::printf("history      %-7s %zu bars: %.1f bytes/bar (%.1fx), append %.1f ms, decode %.1f ms, "
+                "SMA %.1f ms, PACK %.1f ms\n",
+                label, count, static_cast<double>(history.memory_bytes()) / static_cast<double>(count),
+                raw / static_cast<double>(history.memory_bytes()), append_ms, decode_ms, sma_ms, pack_ms);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::vector<BenchCase> cases{
+      {"correlation", bench_correlation},
+      {"scan", bench_scan},
+      {"pack", bench_pack},
+      {"specialized", bench_specialized},
+      {"history", bench_history},
+  };
+  const std::string filter = argc > 1 ? argv[1] : "";
+  for (const auto& bench : cases) {
+    if (filter.empty() || filter == bench.name) {
+      bench.run();
+    }
+  }
+  return 0;
+}
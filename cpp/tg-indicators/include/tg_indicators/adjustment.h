@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+#include "tg/v1/contracts.pb.h"
+
+namespace tg_indicators {
+
+// Query-time price adjustment over raw bars, mirroring tg-persistence `adjust_bars`:
+// each bar takes the factor of the latest ex_date on or before its trading_date and
+// is scaled by factor / anchor, where the anchor is the latest factor for
+// PRE_ADJUST and the earliest for POST_ADJUST. Bars before the first ex_date are
+// left unscaled. Prices are multiplied by the ratio and volume divided by it.
+//
+// Returns one ratio per bar, or an empty vector when no adjustment applies (mode
+// NONE/UNSPECIFIED or no factors). Throws std::invalid_argument on a zero or
+// malformed factor.
+std::vector<double> adjustment_ratios(
+    const google::protobuf::RepeatedPtrField<tg::v1::Bar>& bars,
+    const google::protobuf::RepeatedPtrField<tg::v1::AdjustmentFactor>& factors,
+    tg::v1::Adjustment adjustment);
+
+// True if every ratio is identical, i.e. the adjustment is a pure rescale.
+bool uniform_ratios(const std::vector<double>& ratios);
+
+}  // namespace tg_indicators
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace tg_indicators {
+
+struct AdmissionOptions {
+  // In-flight computations at or above which low-priority requests are shed;
+  // 0 means 2x the hardware threads.
+  size_t shed_low_priority_above{};
+  // In-flight computations at or above which every request is shed; 0 means 8x.
+  size_t max_in_flight{};
+  // Starting nanoseconds per cost unit (bars x IIndicator::cost_per_bar), refined by
+  // an EWMA of completed requests.
+  double initial_ns_per_unit{40.0};
+};
+
+enum class RequestPriority { kNormal, kLow };
+
+// Front door for compute work: rejects requests whose estimated cost cannot fit in
+// the remaining deadline, and sheds load once too many computations are in flight,
+// low priority first. Keeping excess work out (instead of queueing it behind the
+// gRPC thread pool) is what keeps admitted requests' tail latency bounded.
+class AdmissionController {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Decision { kAdmit, kShed, kDeadlineTooShort };
+
+  // Holds one in-flight slot until destroyed. complete() feeds the observed
+  // duration back into the cost model.
+  class Ticket {
+   public:
+    Ticket() = default;
+    Ticket(Ticket&& other) noexcept { *this = std::move(other); }
+    Ticket& operator=(Ticket&& other) noexcept;
+    ~Ticket() { release(); }
+
+    void complete();
+
+   private:
+    friend class AdmissionController;
+    void release();
+
+    AdmissionController* owner_{};
+    double cost_units_{};
+    Clock::time_point started_{};
+  };
+
+  explicit AdmissionController(AdmissionOptions options = {});
+
+  std::chrono::nanoseconds estimate(double cost_units) const;
+
+  // `deadline` of Clock::time_point::max() means none. On kAdmit `ticket` owns a slot.
+  Decision admit(double cost_units, RequestPriority priority, Clock::time_point deadline,
+                 Ticket* ticket);
+
+  size_t in_flight() const { return in_flight_.load(std::memory_order_relaxed); }
+  double ns_per_unit() const { return ns_per_unit_.load(std::memory_order_relaxed); }
+  uint64_t admitted() const { return admitted_.load(std::memory_order_relaxed); }
+  uint64_t shed() const { return shed_.load(std::memory_order_relaxed); }
+  uint64_t rejected_deadline() const { return rejected_deadline_.load(std::memory_order_relaxed); }
+
+ private:
+  void observe(double cost_units, std::chrono::nanoseconds elapsed);
+
+  size_t shed_low_above_;
+  size_t max_in_flight_;
+  std::atomic<size_t> in_flight_{0};
+  std::atomic<double> ns_per_unit_;
+  std::atomic<uint64_t> admitted_{0};
+  std::atomic<uint64_t> shed_{0};
+  std::atomic<uint64_t> rejected_deadline_{0};
+};
+
+}  // namespace tg_indicators
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace tg_indicators {
+
+// Per-thread arenas for the compute path. Inside an ArenaScope, every kernel's scratch
+// vectors and output series come from the calling thread's monotonic arena: a bump
+// pointer into one retained block, released wholesale when the outermost scope ends.
+// A request that outgrows the block borrows from the heap once and the block is grown
+// to fit, so a steady stream of similar requests allocates nothing from the global
+// heap after the first.
+
+// Where kernels allocate: the thread's arena inside an ArenaScope, the default
+// resource (global heap) outside one.
+std::pmr::memory_resource* arena_resource();
+
+// Activates the calling thread's arena until destroyed. Scopes nest; only the
+// outermost one releases the arena, so nothing allocated inside it may be used after
+// it ends. Threads started inside a scope (parallel_for workers) allocate from the
+// heap unless they open their own.
+class ArenaScope {
+ public:
+  ArenaScope();
+  ~ArenaScope();
+
+  ArenaScope(const ArenaScope&) = delete;
+  ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+// Bytes in the calling thread's retained block (0 before its first scope).
+size_t arena_capacity();
+
+// Largest block an arena retains between requests; bigger requests borrow the excess
+// from the heap each time rather than pinning that much memory per thread.
+inline constexpr size_t kMaxArenaBytes = size_t{64} << 20;
+
+}  // namespace tg_indicators
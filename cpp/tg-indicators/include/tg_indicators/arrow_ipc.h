@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tg_indicators {
+
+// Minimal Arrow IPC file ("Feather v2") writer for bar and indicator panels, written
+// without an Arrow dependency: the flatbuffer metadata is serialized by hand.
+// pyarrow.ipc.open_file, pyarrow.feather and polars.read_ipc(memory_map=True) read the
+// output in place; every buffer is 8-byte aligned and little-endian.
+
+enum class ArrowType {
+  kUtf8,
+  kInt64,
+  kTimestampMillis,  // timestamp[ms, tz=UTC]
+  kFloat64,          // NaN is written as null
+};
+
+struct ArrowField {
+  std::string name;
+  ArrowType type{ArrowType::kFloat64};
+};
+
+// Rows are appended column by column into a pending record batch, and flush() writes
+// that batch to the stream and releases it, so memory is bounded by the batch size
+// the caller chooses rather than the file size.
+class ArrowFileWriter {
+ public:
+  // Writes the file magic and the schema message. `out` must outlive the writer.
+  ArrowFileWriter(std::ostream& out, std::vector<ArrowField> fields);
+
+  ArrowFileWriter(const ArrowFileWriter&) = delete;
+  ArrowFileWriter& operator=(const ArrowFileWriter&) = delete;
+
+  // Appends one value to `column` of the pending batch; the overload must match the
+  // column's type (std::invalid_argument otherwise).
+  void append(size_t column, std::string_view value);
+  void append(size_t column, int64_t value);
+  void append(size_t column, double value);
+
+  // Rows in the pending batch, i.e. values appended to column 0.
+  size_t pending_rows() const;
+
+  // Writes the pending rows as one record batch; no-op when there are none. Throws
+  // std::logic_error when the columns have different lengths.
+  void flush();
+
+  // Flushes, then writes the end-of-stream marker and the footer. Idempotent.
+  void close();
+
+  size_t batches_written() const { return batches_.size(); }
+
+ private:
+  struct Column {
+    ArrowType type{};
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<int32_t> offsets{0};
+    std::string chars;
+    size_t rows{};
+  };
+  struct Block {
+    int64_t offset{};
+    int32_t metadata_length{};
+    int64_t body_length{};
+  };
+
+  Column& column(size_t index, ArrowType type);
+  Block write_message(const std::vector<uint8_t>& metadata, const std::string& body);
+  void write(const void* data, size_t size);
+
+  std::ostream& out_;
+  std::vector<ArrowField> fields_;
+  std::vector<Column> columns_;
+  std::vector<Block> batches_;
+  int64_t position_{};
+  bool closed_{};
+};
+
+}  // namespace tg_indicators
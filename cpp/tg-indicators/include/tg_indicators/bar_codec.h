@@ -1,6 +1,9 @@
 #pragma once
 
+#include <charconv>
+#include <cmath>
 #include <cstdint>
+#include <limits>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -33,17 +36,111 @@ inline double parse_decimal_string(const std::string& value, const char* field)
   }
 }
 
+inline OHLCV decode_bar(const tg::v1::Bar& bar) {
+  return OHLCV{
+      bar.ts_epoch_millis(),
+      parse_decimal_string(bar.open(), "open"),
+      parse_decimal_string(bar.high(), "high"),
+      parse_decimal_string(bar.low(), "low"),
+      parse_decimal_string(bar.close(), "close"),
+      bar.volume(),
+      parse_decimal_string(bar.amount(), "amount"),
+  };
+}
+
+// Shortest decimal that parse_decimal_string reads back as exactly `value`.
+inline std::string format_decimal(double value) {
+  char buffer[32];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  return std::string(buffer, result.ptr);
+}
+
+// Inverse of decode_bar, for requests built from bars that arrived without protobuf.
+inline void encode_bar(const OHLCV& bar, tg::v1::Bar* out) {
+  out->set_ts_epoch_millis(bar.ts_millis);
+  out->set_open(format_decimal(bar.open));
+  out->set_high(format_decimal(bar.high));
+  out->set_low(format_decimal(bar.low));
+  out->set_close(format_decimal(bar.close));
+  out->set_volume(bar.volume);
+  out->set_amount(format_decimal(bar.amount));
+}
+
 inline std::vector<OHLCV> decode_bars(const google::protobuf::RepeatedPtrField<tg::v1::Bar>& bars) {
   std::vector<OHLCV> decoded;
   decoded.reserve(static_cast<size_t>(bars.size()));
   for (const auto& bar : bars) {
+    decoded.push_back(decode_bar(bar));
+  }
+  return decoded;
+}
+
+// decode_bars with a per-bar price multiplier applied in the same pass (see
+// adjustment.h); an empty `ratios` decodes unadjusted.
+inline std::vector<OHLCV> decode_bars(const google::protobuf::RepeatedPtrField<tg::v1::Bar>& bars,
+                                      const std::vector<double>& ratios) {
+  if (ratios.empty()) {
+    return decode_bars(bars);
+  }
+  if (ratios.size() != static_cast<size_t>(bars.size())) {
+    throw std::invalid_argument("adjustment ratio count does not match bar count");
+  }
+  std::vector<OHLCV> decoded;
+  decoded.reserve(ratios.size());
+  for (int i = 0; i < bars.size(); ++i) {
+    const auto& bar = bars[i];
+    const double ratio = ratios[static_cast<size_t>(i)];
+    decoded.push_back(OHLCV{
+        bar.ts_epoch_millis(),
+        parse_decimal_string(bar.open(), "open") * ratio,
+        parse_decimal_string(bar.high(), "high") * ratio,
+        parse_decimal_string(bar.low(), "low") * ratio,
+        parse_decimal_string(bar.close(), "close") * ratio,
+        static_cast<int64_t>(std::llround(static_cast<double>(bar.volume()) / ratio)),
+        parse_decimal_string(bar.amount(), "amount"),
+    });
+  }
+  return decoded;
+}
+
+// Per-bar validity (1 = traded, 0 = halt or data gap), aligned with the bars.
+using BarMask = std::vector<uint8_t>;
+
+// A request's `valid` column as a BarMask; empty when the request has none.
+inline BarMask decode_mask(const google::protobuf::RepeatedField<bool>& valid, int bar_count) {
+  if (!valid.empty() && valid.size() != bar_count) {
+    throw std::invalid_argument("valid mask length does not match bar count");
+  }
+  return BarMask(valid.begin(), valid.end());
+}
+
+// decode_bars for a masked batch. Invalid bars keep their timestamp but are not
+// parsed, so their price fields may be left empty; their prices decode as NaN.
+inline std::vector<OHLCV> decode_bars(const google::protobuf::RepeatedPtrField<tg::v1::Bar>& bars,
+                                      const std::vector<double>& ratios, const BarMask& valid) {
+  if (valid.empty()) {
+    return decode_bars(bars, ratios);
+  }
+  if (!ratios.empty() && ratios.size() != static_cast<size_t>(bars.size())) {
+    throw std::invalid_argument("adjustment ratio count does not match bar count");
+  }
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  std::vector<OHLCV> decoded;
+  decoded.reserve(valid.size());
+  for (int i = 0; i < bars.size(); ++i) {
+    const auto& bar = bars[i];
+    if (!valid[static_cast<size_t>(i)]) {
+      decoded.push_back(OHLCV{bar.ts_epoch_millis(), nan, nan, nan, nan, 0, nan});
+      continue;
+    }
+    const double ratio = ratios.empty() ? 1.0 : ratios[static_cast<size_t>(i)];
     decoded.push_back(OHLCV{
         bar.ts_epoch_millis(),
-        parse_decimal_string(bar.open(), "open"),
-        parse_decimal_string(bar.high(), "high"),
-        parse_decimal_string(bar.low(), "low"),
-        parse_decimal_string(bar.close(), "close"),
-        bar.volume(),
+        parse_decimal_string(bar.open(), "open") * ratio,
+        parse_decimal_string(bar.high(), "high") * ratio,
+        parse_decimal_string(bar.low(), "low") * ratio,
+        parse_decimal_string(bar.close(), "close") * ratio,
+        static_cast<int64_t>(std::llround(static_cast<double>(bar.volume()) / ratio)),
         parse_decimal_string(bar.amount(), "amount"),
     });
   }
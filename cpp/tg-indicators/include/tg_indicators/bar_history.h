@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tg_indicators/bar_codec.h"
+
+namespace tg_indicators {
+
+// One bar feed's history, held in memory at a fraction of sizeof(OHLCV) per bar.
+// Appends go to an uncompressed hot chunk; every kChunkBars bars it is sealed into
+// a compressed columnar chunk:
+//   - timestamps as delta-of-delta, so a regular bar interval costs one bit;
+//   - open/high/low/close as 1e-4 price units (see fixed_point.h) divided by the
+//     chunk's common tick, close against the previous close, open against the
+//     previous close and high/low against the bar's body; a chunk with a price
+//     that is not an exact 1e-4 multiple falls back to Gorilla XOR of the doubles;
+//   - volume as varints of volume / the chunk's common lot;
+//   - amount like a price column, predicted from volume * close or the previous
+//     amount, whichever the chunk compresses better, with the same XOR fallback.
+// Each column is its own bit stream. Decoding is lossless (bit-identical doubles) and
+// fills every column of a chunk in one loop straight into the caller's bar buffer.
+class BarHistory {
+ public:
+  static constexpr size_t kChunkBars = 256;
+
+  // Appends the bars newer than the last stored one, in order; returns how many.
+  size_t append(std::span<const OHLCV> bars);
+
+  size_t size() const { return sealed_bars_ + hot_.size(); }
+  // Timestamp of the newest bar, 0 when empty.
+  int64_t last_ts_millis() const { return last_ts_millis_; }
+
+  // Decodes bars [first, size()) onto the end of `out`.
+  void read(std::vector<OHLCV>& out, size_t first = 0) const;
+
+  // Heap bytes held by the sealed chunks and the hot chunk.
+  size_t memory_bytes() const;
+
+ private:
+  struct Chunk {
+    size_t count{};
+    std::string bits;
+  };
+
+  std::vector<Chunk> sealed_;
+  size_t sealed_bars_{0};
+  std::vector<OHLCV> hot_;
+  int64_t last_ts_millis_{0};
+};
+
+// Compressed bar histories keyed by session (the client's name for a bar feed, as
+// in StreamStore). Each history is locked on its own, so appends to one session do
+// not block reads of another.
+class HistoryStore {
+ public:
+  // Appends the bars newer than the session's newest stored bar; returns how many.
+  size_t append(const std::string& session, std::span<const OHLCV> bars);
+
+  // Decodes the session's last `max_bars` bars (all of them when 0) onto the end of
+  // `out`. Returns false for an unknown session.
+  bool read(const std::string& session, std::vector<OHLCV>& out, size_t max_bars = 0) const;
+
+  // Bars stored for the session, 0 for an unknown one.
+  size_t bar_count(const std::string& session) const;
+
+  size_t size() const;
+  size_t memory_bytes() const;
+
+  // Drops the sessions neither appended to nor read for `max_idle`, skipping any in
+  // use right now. Returns the number dropped.
+  size_t evict_idle(std::chrono::steady_clock::duration max_idle);
+
+ private:
+  struct Entry {
+    mutable std::mutex mutex;
+    BarHistory history;
+    mutable std::chrono::steady_clock::time_point last_used;
+  };
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+  };
+
+  std::shared_ptr<Entry> find(const std::string& session) const;
+
+  std::array<Shard, 64> shards_;
+};
+
+}  // namespace tg_indicators
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "tg_indicators/indicators/indicator_base.h"
+
+namespace tg_indicators {
+
+// Offline recomputation over the tg-persistence Parquet store, bypassing gRPC:
+//
+//   tg-indicators batch --root DIR --period daily --indicator RSI --param period=14
+//                       [--spec MACD:fast=12,slow=26,signal=9]... [--symbols 600519,000001]
+//                       [--start 2020-01-01] [--end 2026-01-01] [--threads N]
+//                       [--format csv|arrow] [--chunk-rows N] [--out results.arrow]
+//
+// Without --symbols every `symbol=*` partition under the period directory is used.
+// Symbols are read and computed in parallel a block at a time and written in symbol
+// then ts order, so memory is bounded by the block and not by the universe. Output is
+// CSV, or an Arrow IPC file (also readable as Feather v2) in record batches of at most
+// --chunk-rows rows; --format defaults to arrow for .arrow/.feather/.ipc outputs.
+enum class BatchFormat { kCsv, kArrow };
+
+struct IndicatorSpec {
+  std::string indicator;
+  Params params;
+};
+
+struct BatchOptions {
+  std::string root;
+  std::string period{"daily"};
+  std::vector<std::string> symbols;
+  int64_t start_millis{};
+  int64_t end_millis{};
+  // Every --indicator (with the --param flags after it) and --spec, in order.
+  std::vector<IndicatorSpec> specs;
+  size_t threads{};
+  BatchFormat format{BatchFormat::kCsv};
+  size_t chunk_rows{65536};
+  std::string out_path;
+};
+
+BatchOptions parse_batch_args(const std::vector<std::string>& args);
+
+// Columns are symbol, ts_epoch_millis, then every output of every spec: bare output
+// names for a single spec, "RSI(period=14).rsi" style names for several. A spec that
+// rejects a symbol (too few bars) leaves its columns empty and is reported on `log`;
+// symbols every spec rejects are skipped.
+void run_batch(const BatchOptions& options, std::ostream& out, std::ostream& log);
+
+// Entry point for `tg-indicators batch ...`; argv[0] is the "batch" word.
+int run_batch_cli(int argc, char** argv);
+
+}  // namespace tg_indicators
@@ -0,0 +1,86 @@
+#pragma once
+
+/* Stable C ABI over the tg-indicators kernels, shipped as libtg_indicators.so.
+ *
+ * Callers pass bar columns by pointer and length and receive results in buffers they
+ * own; nothing allocated by the library crosses the boundary and no C++ exception
+ * escapes. Every function returns a tg_status; on failure tg_last_error() describes
+ * the problem for the calling thread. The functions are thread-safe.
+ *
+ * Compatibility: symbols and struct layouts are append-only. TG_ABI_VERSION is bumped
+ * when a field or function is added, never for behaviour-preserving changes. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define TG_API __attribute__((visibility("default")))
+#else
+#define TG_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TG_ABI_VERSION 1
+
+/* Values match gRPC status codes so they map 1:1 onto the RPC API. */
+typedef enum tg_status {
+  TG_OK = 0,
+  TG_INVALID_ARGUMENT = 3,
+  TG_NOT_FOUND = 5,
+  TG_OUT_OF_RANGE = 11,
+  TG_INTERNAL = 13,
+} tg_status;
+
+/* Column-major bars, `length` rows. `close` is required. A NULL open/high/low column
+ * is read as close, a NULL ts/volume/amount column as zeros, so price-only kernels
+ * such as RSI or EMA need a single column. */
+typedef struct tg_bars {
+  const int64_t* ts_millis;
+  const double* open;
+  const double* high;
+  const double* low;
+  const double* close;
+  const int64_t* volume;
+  const double* amount;
+  size_t length;
+} tg_bars;
+
+typedef struct tg_param {
+  const char* key;
+  double value;
+} tg_param;
+
+/* One requested output series. `values` must hold at least tg_bars.length doubles;
+ * warm-up positions are written as quiet NaN. */
+typedef struct tg_output {
+  const char* name;
+  double* values;
+  size_t capacity;
+} tg_output;
+
+/* TG_ABI_VERSION the library was built with. */
+TG_API uint32_t tg_abi_version(void);
+
+/* Runs `indicator` (case-insensitive, same names as the RPC API) and writes each
+ * requested output. Outputs the indicator produces but the caller did not request are
+ * discarded; requesting a name the indicator does not produce is TG_NOT_FOUND, a
+ * buffer shorter than the bar count is TG_OUT_OF_RANGE. Nothing is written unless
+ * the call succeeds. */
+TG_API tg_status tg_compute(const char* indicator, const tg_bars* bars, const tg_param* params,
+                            size_t param_count, tg_output* outputs, size_t output_count);
+
+/* Writes up to `capacity` output names of `indicator` as pointers to static strings
+ * and stores the total count in *count, so callers can size their requests. */
+TG_API tg_status tg_output_names(const char* indicator, const char** names, size_t capacity,
+                                 size_t* count);
+
+/* Message for the calling thread's most recent failure; "" after a success. Valid until
+ * the next call on the same thread. */
+TG_API const char* tg_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace tg_indicators {
+
+// Thrown from a cancellation point once the installed request has expired or its
+// client has gone away. The service maps it to DEADLINE_EXCEEDED / CANCELLED.
+class ComputeCancelled : public std::runtime_error {
+ public:
+  explicit ComputeCancelled(bool deadline_exceeded)
+      : std::runtime_error(deadline_exceeded ? "deadline exceeded" : "request cancelled"),
+        deadline_exceeded_(deadline_exceeded) {}
+
+  bool deadline_exceeded() const { return deadline_exceeded_; }
+
+ private:
+  bool deadline_exceeded_;
+};
+
+// Deadline plus an optional "client gone" probe (e.g. ServerContext::IsCancelled).
+class CancellationContext {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit CancellationContext(Clock::time_point deadline = Clock::time_point::max(),
+                               std::function<bool()> is_cancelled = {})
+      : deadline_(deadline), is_cancelled_(std::move(is_cancelled)) {}
+
+  Clock::time_point deadline() const { return deadline_; }
+
+  void check() const {
+    if (deadline_ != Clock::time_point::max() && Clock::now() >= deadline_) {
+      throw ComputeCancelled(true);
+    }
+    if (is_cancelled_ && is_cancelled_()) {
+      throw ComputeCancelled(false);
+    }
+  }
+
+ private:
+  Clock::time_point deadline_;
+  std::function<bool()> is_cancelled_;
+};
+
+inline const CancellationContext*& current_cancellation_slot() {
+  thread_local const CancellationContext* current = nullptr;
+  return current;
+}
+
+inline const CancellationContext* current_cancellation() {
+  return current_cancellation_slot();
+}
+
+// Installs `context` for the current thread for the scope's lifetime. parallel_for
+// re-installs the caller's context on its worker threads.
+class CancellationScope {
+ public:
+  explicit CancellationScope(const CancellationContext* context)
+      : previous_(current_cancellation_slot()) {
+    current_cancellation_slot() = context;
+  }
+  ~CancellationScope() { current_cancellation_slot() = previous_; }
+
+  CancellationScope(const CancellationScope&) = delete;
+  CancellationScope& operator=(const CancellationScope&) = delete;
+
+ private:
+  const CancellationContext* previous_;
+};
+
+// Cooperative check for long loops; a no-op outside a request.
+inline void cancellation_point() {
+  if (const CancellationContext* context = current_cancellation()) {
+    context->check();
+  }
+}
+
+// Loop-friendly form: only checks every 4096 iterations.
+inline void cancellation_point(size_t iteration) {
+  if ((iteration & 0xFFF) == 0) {
+    cancellation_point();
+  }
+}
+
+}  // namespace tg_indicators
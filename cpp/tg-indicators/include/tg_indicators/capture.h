@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <google/protobuf/message_lite.h>
+
+namespace tg_indicators {
+
+// Traffic capture for offline replay (see tools/replay.cpp).
+//
+// File format: the 8-byte header "TGCAP02\n", then length-delimited records. Each
+// record is varint32 record_bytes followed by: varint64 offset_micros (arrival time
+// relative to the capture start), varint32 method (CapturedMethod), varint64
+// deadline_micros (time left before the request's deadline on arrival, 0 = none),
+// varint32 label length, label bytes, and the serialized request message for the
+// rest of the record. record_bytes never exceeds kMaxCaptureRecordBytes.
+
+// Well above gRPC's default 4 MiB message limit; larger requests are not captured.
+inline constexpr size_t kMaxCaptureRecordBytes = size_t{64} << 20;
+
+enum class CapturedMethod : uint32_t {
+  kCompute = 1,
+  kBatchCompute = 2,  // one record per streamed request
+  kCrossSection = 3,
+  kRollingCorrelation = 4,
+  kStreamUpdate = 5,
+  kExtractEvents = 6,
+  kScreen = 7,
+};
+
+struct CapturedRequest {
+  int64_t offset_micros{};
+  CapturedMethod method{CapturedMethod::kCompute};
+  int64_t deadline_micros{};  // 0 = no deadline
+  std::string label;  // indicator name, used to group replay statistics
+  std::string payload;
+};
+
+struct CaptureOptions {
+  // Empty disables capture.
+  std::string path;
+  // Fraction of requests recorded, in [0, 1].
+  double sample_rate{1.0};
+  // Records waiting for the writer thread beyond this are dropped rather than
+  // letting capture slow down request handling.
+  size_t max_queued{10'000};
+};
+
+// Samples and records requests. record() only serializes and enqueues on the calling
+// thread; a background thread owns the file.
+class CaptureWriter {
+ public:
+  explicit CaptureWriter(CaptureOptions options);
+  ~CaptureWriter();
+
+  CaptureWriter(const CaptureWriter&) = delete;
+  CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+  // `deadline` is the request's own, recorded as the time left so replay can set it.
+  void record(CapturedMethod method, const std::string& label, const google::protobuf::MessageLite& request,
+              std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+  uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  void run();
+
+  CaptureOptions options_;
+  std::chrono::steady_clock::time_point started_;
+  std::ofstream out_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<std::string> queue_;  // encoded records
+  bool stopping_{false};
+  std::atomic<uint64_t> written_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::thread thread_;
+};
+
+// Streams records back out of a capture file.
+class CaptureReader {
+ public:
+  // Throws std::runtime_error if the file is missing or not a capture.
+  explicit CaptureReader(const std::string& path);
+
+  // False at end of file; throws std::runtime_error on a truncated record or one
+  // whose length exceeds kMaxCaptureRecordBytes or the rest of the file.
+  bool next(CapturedRequest* out);
+
+ private:
+  std::ifstream in_;
+  uint64_t file_bytes_{};
+};
+
+}  // namespace tg_indicators
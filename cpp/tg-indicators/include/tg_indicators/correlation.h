@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace tg_indicators {
+
+// Rolling multi-series statistics over aligned return columns: every column has the
+// same length and index t means the same bar for every symbol. NaN marks a missing
+// return (halt); any window touching one yields NaN for that symbol's pairs.
+
+struct RollingCorrelationOptions {
+  size_t window{60};
+  // Emit a matrix for every `step`-th window end, starting at bar window - 1.
+  size_t step{1};
+  size_t threads{};
+};
+
+struct RollingCorrelation {
+  std::vector<size_t> end_index;  // bar index each emitted window ends at
+  size_t symbol_count{};
+  // Full symmetric matrices, [k * n * n + i * n + j] for end_index[k].
+  std::vector<double> correlation;
+};
+
+// Pearson correlation matrices from running sums and cross-products. The matrix is
+// processed in cache-sized symbol tiles, each tile streaming the whole time axis, and
+// tiles are spread across threads. The sums are recomputed from scratch every
+// `window` bars, which bounds their rounding residue. A variance within that bound
+// counts as zero, so a flat window (e.g. a limit-locked stock) gives NaN, not noise.
+RollingCorrelation rolling_correlation(const std::vector<std::vector<double>>& returns,
+                                       const RollingCorrelationOptions& options);
+
+// Rolling OLS beta of every column against `benchmark` (cov / var), aligned to the
+// input with NaN for the first window - 1 bars and wherever the benchmark is flat.
+std::vector<std::vector<double>> rolling_beta(const std::vector<std::vector<double>>& returns,
+                                              const std::vector<double>& benchmark, size_t window,
+                                              size_t threads = 0);
+
+}  // namespace tg_indicators
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tg_indicators {
+
+// One symbol's indicator output: strictly increasing timestamps with aligned values.
+// Dates the symbol did not trade (halts, not yet listed) are simply absent; NaN
+// values (warm-up) are treated the same way.
+struct SymbolSeries {
+  std::vector<int64_t> ts_millis;
+  std::vector<double> values;
+};
+
+struct CrossSectionOptions {
+  // Winsorization quantiles in [0, 1], linearly interpolated like numpy.quantile.
+  double winsor_lower{0.01};
+  double winsor_upper{0.99};
+  size_t threads{};
+};
+
+// Per-date statistics over the universe. Every column is date-major: the value for
+// date d and symbol s lives at [d * symbol_count + s]. Symbols missing on a date
+// are NaN in every column and excluded from that date's statistics.
+struct CrossSection {
+  std::vector<int64_t> ts_millis;  // sorted union of all symbols' timestamps
+  size_t symbol_count{};
+  std::vector<double> value;
+  std::vector<double> rank;        // 1-based, ties share their average rank
+  std::vector<double> percentile;  // rank / valid count, in (0, 1]
+  std::vector<double> zscore;      // sample std; NaN with < 2 values or zero spread
+  std::vector<double> winsorized;
+};
+
+// Transposes the symbol-major inputs into a date-major panel, then ranks and
+// normalizes each date independently, in parallel over blocks of dates.
+CrossSection compute_cross_section(const std::vector<SymbolSeries>& universe,
+                                   const CrossSectionOptions& options = {});
+
+}  // namespace tg_indicators
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "tg_indicators/indicators/indicator_base.h"
+
+namespace tg_indicators {
+
+enum class PredicateKind {
+  kCrossAbove,  // series moves from <= reference to > reference
+  kCrossBelow,  // series moves from >= reference to < reference
+  kEnterRange,  // series moves from outside [lower, upper] to inside
+  kExitRange,   // series moves from inside [lower, upper] to outside
+  kNewHigh,     // series exceeds every value of the previous `lookback` bars
+  kNewLow,      // series is below every value of the previous `lookback` bars
+};
+
+// An event condition over one series. `series` and `reference` name indicator
+// outputs or bar fields (open, high, low, close, volume); crossings compare against
+// `reference` when set and against the constant `threshold` otherwise.
+struct SeriesPredicate {
+  std::string id;
+  PredicateKind kind{PredicateKind::kCrossAbove};
+  std::string series;
+  std::string reference;
+  double threshold{};
+  double lower{};
+  double upper{};
+  size_t lookback{};
+};
+
+// Bar at which `predicates[predicate]` fired. `reference` is what the value was
+// compared against: the crossed level, the range bound crossed, or the previous
+// extreme for new highs and lows.
+struct IndicatorEvent {
+  size_t predicate{};
+  size_t bar{};
+  double value{};
+  double reference{};
+};
+
+// Names of bar columns predicates may reference besides indicator outputs.
+inline constexpr const char* kBarFields[] = {"open", "high", "low", "close", "volume"};
+
+// Scans the aligned columns in `series` once per predicate and returns the events at
+// bars >= first_bar, ordered by bar and then by predicate. Bars before first_bar are
+// only read as the previous value or lookback window of later bars, so a live caller
+// can send history and get back just the events on its newest bars. A NaN value
+// (warm-up) never fires and never counts as the previous value of a crossing.
+// Throws std::invalid_argument for an unknown series or an invalid range/lookback.
+std::vector<IndicatorEvent> extract_events(std::span<const SeriesPredicate> predicates,
+                                           const SeriesMap& series, size_t first_bar = 0);
+
+}  // namespace tg_indicators
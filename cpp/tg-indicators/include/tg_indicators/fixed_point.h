@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tg/v1/contracts.pb.h"
+
+namespace tg_indicators {
+
+// Prices as int64 counts of 1e-4 yuan. A-share quotes have at most three or four
+// decimals, so the contract's decimal strings convert without loss, and sums,
+// differences and comparisons of prices are exact.
+inline constexpr int64_t kPriceScale = 10'000;
+inline constexpr int kPriceDecimals = 4;
+
+// Parses a plain decimal string ("12.34", "-0.5", "7") into 1e-4 units. Digits past
+// the fourth decimal are rounded half away from zero. Throws std::invalid_argument
+// on anything else (exponents, empty strings, values beyond ~9.2e14).
+inline int64_t parse_fixed_price(std::string_view value, const char* field) {
+  auto fail = [&](const char* why) {
+    return std::invalid_argument(std::string("invalid decimal field ") + field + ": " + why);
+  };
+  size_t i = 0;
+  bool negative = false;
+  if (!value.empty() && (value[0] == '-' || value[0] == '+')) {
+    negative = value[0] == '-';
+    i = 1;
+  }
+  int64_t whole = 0;
+  size_t digits = 0;
+  for (; i < value.size() && value[i] >= '0' && value[i] <= '9'; ++i, ++digits) {
+    if (whole > (INT64_MAX / kPriceScale - 9) / 10) {
+      throw fail("out of range");
+    }
+    whole = whole * 10 + (value[i] - '0');
+  }
+  int64_t fraction = 0;
+  int decimals = 0;
+  bool round_up = false;
+  if (i < value.size() && value[i] == '.') {
+    for (++i; i < value.size() && value[i] >= '0' && value[i] <= '9'; ++i, ++digits) {
+      if (decimals < kPriceDecimals) {
+        fraction = fraction * 10 + (value[i] - '0');
+        ++decimals;
+      } else if (decimals++ == kPriceDecimals) {
+        round_up = value[i] >= '5';
+      }
+    }
+  }
+  if (digits == 0 || i != value.size()) {
+    throw fail("not a plain decimal");
+  }
+  for (int d = std::min(decimals, kPriceDecimals); d < kPriceDecimals; ++d) {
+    fraction *= 10;
+  }
+  const int64_t units = whole * kPriceScale + fraction + (round_up ? 1 : 0);
+  return negative ? -units : units;
+}
+
+inline double fixed_to_double(int64_t units) {
+  return static_cast<double>(units) / static_cast<double>(kPriceScale);
+}
+
+// Column-major bars in fixed-point price units (amount is not used by any kernel
+// and is not decoded).
+struct FixedBars {
+  std::vector<int64_t> ts_millis;
+  std::vector<int64_t> open;
+  std::vector<int64_t> high;
+  std::vector<int64_t> low;
+  std::vector<int64_t> close;
+  std::vector<int64_t> volume;
+
+  size_t size() const { return close.size(); }
+};
+
+inline FixedBars decode_fixed_bars(const google::protobuf::RepeatedPtrField<tg::v1::Bar>& bars) {
+  FixedBars decoded;
+  const size_t n = static_cast<size_t>(bars.size());
+  for (auto* column : {&decoded.ts_millis, &decoded.open, &decoded.high, &decoded.low, &decoded.close,
+                       &decoded.volume}) {
+    column->resize(n);
+  }
+  for (size_t i = 0; i < n; ++i) {
+    const auto& bar = bars[static_cast<int>(i)];
+    decoded.ts_millis[i] = bar.ts_epoch_millis();
+    decoded.open[i] = parse_fixed_price(bar.open(), "open");
+    decoded.high[i] = parse_fixed_price(bar.high(), "high");
+    decoded.low[i] = parse_fixed_price(bar.low(), "low");
+    decoded.close[i] = parse_fixed_price(bar.close(), "close");
+    decoded.volume[i] = bar.volume();
+  }
+  return decoded;
+}
+
+}  // namespace tg_indicators
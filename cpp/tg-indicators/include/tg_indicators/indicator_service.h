@@ -1,15 +1,38 @@
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <grpcpp/grpcpp.h>
 
 #include "tg/v1/contracts.grpc.pb.h"
+#include "tg_indicators/admission.h"
+#include "tg_indicators/bar_history.h"
+#include "tg_indicators/cancellation.h"
+#include "tg_indicators/capture.h"
+#include "tg_indicators/singleflight.h"
+#include "tg_indicators/stream_store.h"
 
 namespace tg_indicators {
 
+struct ServiceOptions {
+  AdmissionOptions admission;
+  // Share one computation between concurrent Compute/BatchCompute requests with
+  // identical content (see Singleflight).
+  bool coalesce_requests{true};
+  // Sampled request capture for tools/replay.cpp; off unless capture.path is set.
+  CaptureOptions capture;
+  // Keep every bar StreamUpdate receives in a compressed per-session history, which
+  // Compute reads when a request names a history_session instead of sending bars.
+  bool keep_history{false};
+};
+
 class IndicatorServiceImpl final : public tg::v1::IndicatorService::Service {
  public:
+  explicit IndicatorServiceImpl(ServiceOptions options = {});
+
   grpc::Status Compute(grpc::ServerContext* context,
                        const tg::v1::IndicatorRequest* request,
                        tg::v1::IndicatorResult* response) override;
@@ -17,6 +40,70 @@ class IndicatorServiceImpl final : public tg::v1::IndicatorService::Service {
   grpc::Status BatchCompute(
       grpc::ServerContext* context,
       grpc::ServerReaderWriter<tg::v1::IndicatorResult, tg::v1::IndicatorRequest>* stream) override;
+
+  grpc::Status CrossSection(grpc::ServerContext* context,
+                            const tg::v1::CrossSectionRequest* request,
+                            tg::v1::CrossSectionResult* response) override;
+
+  grpc::Status RollingCorrelation(grpc::ServerContext* context,
+                                  const tg::v1::RollingCorrelationRequest* request,
+                                  tg::v1::RollingCorrelationResult* response) override;
+
+  // Folds bars newer than the session's watermark into its streaming state.
+  grpc::Status StreamUpdate(grpc::ServerContext* context,
+                            const tg::v1::StreamUpdateRequest* request,
+                            tg::v1::StreamUpdateResult* response) override;
+
+  // Computes the indicator and returns only the bars where the request's predicates
+  // fire (crossings, range entries/exits, new N-bar highs/lows).
+  grpc::Status ExtractEvents(grpc::ServerContext* context,
+                             const tg::v1::EventsRequest* request,
+                             tg::v1::EventsResult* response) override;
+
+  // Returns the symbols whose latest bar satisfies every condition, evaluating cheap
+  // conditions first so failing symbols skip the expensive indicators.
+  grpc::Status Screen(grpc::ServerContext* context,
+                      const tg::v1::ScreenRequest* request,
+                      tg::v1::ScreenResult* response) override;
+
+  // Per indicator and params: minimum bars, bars until the recurrences converge to a
+  // tolerance, output keys, and the state keys Compute accepts as `seed`.
+  grpc::Status Describe(grpc::ServerContext* context,
+                        const tg::v1::DescribeRequest* request,
+                        tg::v1::DescribeResult* response) override;
+
+  // Compute for bars that arrived without gRPC (ShmIndicatorServer), through the same
+  // capture, admission control, cancellation at `deadline` and request arena. The
+  // outputs live in the arena, so `emit` must copy what it needs before returning.
+  grpc::Status compute_bars(const std::string& indicator, const Params& params,
+                            const std::vector<OHLCV>& bars, CancellationContext::Clock::time_point deadline,
+                            const std::function<void(const SeriesMap&)>& emit);
+
+  StreamStore& streams() { return streams_; }
+  HistoryStore& history() { return history_; }
+  const AdmissionController& admission() const { return admission_; }
+  const Singleflight<tg::v1::IndicatorResult>& coalescer() const { return coalescer_; }
+  // nullptr when capture is off.
+  const CaptureWriter* capture() const { return capture_.get(); }
+
+ private:
+  grpc::Status compute_one(grpc::ServerContext* context, const tg::v1::IndicatorRequest& request,
+                           tg::v1::IndicatorResult* response);
+
+  // Admission control plus a cancellation scope (deadline, client disconnect) around fn.
+  template <typename Fn>
+  grpc::Status run_admitted(grpc::ServerContext* context, double cost_units, Fn&& fn);
+  template <typename Fn>
+  grpc::Status run_admitted(CancellationContext::Clock::time_point deadline, RequestPriority priority,
+                            std::function<bool()> is_cancelled, double cost_units, Fn&& fn);
+
+  AdmissionController admission_;
+  bool coalesce_requests_;
+  Singleflight<tg::v1::IndicatorResult> coalescer_;
+  StreamStore streams_;
+  bool keep_history_;
+  HistoryStore history_;
+  std::unique_ptr<CaptureWriter> capture_;
 };
 
 std::unique_ptr<grpc::Server> StartIndicatorServer(const std::string& address,
@@ -4,10 +4,31 @@
 
 namespace tg_indicators {
 
+struct AdxParams {
+  int period{};
+};
+
+inline constexpr ParamSchema kAdxSchema{std::array{period_field<&AdxParams::period>("period", 14)}};
+
 // ADX(n): Wilder +DI/-DI, DX, then Wilder-smoothed ADX trend strength.
 class AdxIndicator final : public IIndicator {
  public:
   SeriesMap compute(const std::vector<OHLCV>& bars, const Params& params) const override;
+  SeriesMap compute_masked(const std::vector<OHLCV>& bars, const BarMask& valid,
+                           const Params& params) const override;
+  SeriesMap compute_fixed(const FixedBars& bars, const Params& params) const override;
+  bool has_fixed_point_kernel() const override { return true; }
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"adx", "plus_di", "minus_di"};
+    return kNames;
+  }
+  std::span<const ParamSpec> param_schema() const override { return kAdxSchema.specs(); }
+  size_t min_bars(const Params& params) const override {
+    return 2 * static_cast<size_t>(kAdxSchema.decode(params).period);
+  }
+  size_t warmup_bars(const Params& params, double tolerance) const override;
+  bool scale_invariant() const override { return true; }
+  double cost_per_bar(const Params&) const override { return 6.0; }
 };
 
 }  // namespace tg_indicators
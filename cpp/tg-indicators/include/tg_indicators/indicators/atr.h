@@ -4,13 +4,45 @@
 
 namespace tg_indicators {
 
+struct AtrParams {
+  int period{};
+};
+
+inline constexpr ParamSchema kAtrSchema{std::array{period_field<&AtrParams::period>("period", 14)}};
+
 // ATR(n): Wilder-smoothed true range using high/low and previous close.
 class AtrIndicator final : public IIndicator {
  public:
   SeriesMap compute(const std::vector<OHLCV>& bars, const Params& params) const override;
+  SeriesMap compute_masked(const std::vector<OHLCV>& bars, const BarMask& valid,
+                           const Params& params) const override;
+  SeriesMap compute_fixed(const FixedBars& bars, const Params& params) const override;
+  bool has_fixed_point_kernel() const override { return true; }
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"atr"};
+    return kNames;
+  }
+  std::span<const ParamSpec> param_schema() const override { return kAtrSchema.specs(); }
+  size_t min_bars(const Params& params) const override {
+    return static_cast<size_t>(kAtrSchema.decode(params).period);
+  }
+  size_t warmup_bars(const Params& params, double tolerance) const override;
+  std::span<const char* const> state_names() const override {
+    static constexpr const char* kState[] = {"atr", "prev_close"};
+    return kState;
+  }
+  SeriesMap compute_seeded(const std::vector<OHLCV>& bars, const Params& params, const Params& seed,
+                           Params* state) const override;
+  double cost_per_bar(const Params&) const override { return 2.0; }
 };
 
-std::vector<double> true_ranges(const std::vector<OHLCV>& bars);
+Series true_ranges(const std::vector<OHLCV>& bars);
+
+// True ranges over the bars at `positions` only, each against the previous listed bar.
+Series true_ranges(const std::vector<OHLCV>& bars, std::span<const uint32_t> positions);
+
+// Exact true ranges in fixed-point price units.
+std::pmr::vector<int64_t> true_ranges(const FixedBars& bars);
 
 }  // namespace tg_indicators
 
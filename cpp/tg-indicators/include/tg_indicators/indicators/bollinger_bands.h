@@ -4,10 +4,28 @@
 
 namespace tg_indicators {
 
+struct BollParams {
+  int period{};
+  double std_dev{};
+};
+
+inline constexpr ParamSchema kBollSchema{std::array{
+    period_field<&BollParams::period>("period", 20),
+    real_field<&BollParams::std_dev>("std_dev", 2.0, true)}};
+
 // Bollinger Bands: mid=SMA(n), population stddev, upper/lower=mid +/- k*stddev.
 class BollingerBandsIndicator final : public IIndicator {
  public:
   SeriesMap compute(const std::vector<OHLCV>& bars, const Params& params) const override;
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"upper", "mid", "lower"};
+    return kNames;
+  }
+  std::span<const ParamSpec> param_schema() const override { return kBollSchema.specs(); }
+  size_t min_bars(const Params& params) const override {
+    return static_cast<size_t>(kBollSchema.decode(params).period);
+  }
+  double cost_per_bar(const Params& params) const override;
 };
 
 }  // namespace tg_indicators
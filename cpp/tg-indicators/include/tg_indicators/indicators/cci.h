@@ -4,10 +4,29 @@
 
 namespace tg_indicators {
 
+struct CciParams {
+  int period{};
+  double constant{};
+};
+
+inline constexpr ParamSchema kCciSchema{std::array{
+    period_field<&CciParams::period>("period", 20),
+    real_field<&CciParams::constant>("constant", 0.015)}};
+
 // CCI(n): (typical_price - SMA(tp)) / (constant * mean_absolute_deviation).
 class CciIndicator final : public IIndicator {
  public:
   SeriesMap compute(const std::vector<OHLCV>& bars, const Params& params) const override;
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"cci"};
+    return kNames;
+  }
+  std::span<const ParamSpec> param_schema() const override { return kCciSchema.specs(); }
+  size_t min_bars(const Params& params) const override {
+    return static_cast<size_t>(kCciSchema.decode(params).period);
+  }
+  bool scale_invariant() const override { return true; }
+  double cost_per_bar(const Params& params) const override;
 };
 
 }  // namespace tg_indicators
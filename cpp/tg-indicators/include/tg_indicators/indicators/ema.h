@@ -4,13 +4,37 @@
 
 namespace tg_indicators {
 
+struct EmaParams {
+  int period{};
+  double smoothing{};
+};
+
+inline constexpr ParamSchema kEmaSchema{std::array{
+    period_field<&EmaParams::period>("period", 12),
+    real_field<&EmaParams::smoothing>("smoothing", 2.0)}};
+
 // EMA(n): exponential moving average of close, seeded by SMA(n), alpha=smoothing/(n+1).
 class EmaIndicator final : public IIndicator {
  public:
   SeriesMap compute(const std::vector<OHLCV>& bars, const Params& params) const override;
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"ema"};
+    return kNames;
+  }
+  std::span<const ParamSpec> param_schema() const override { return kEmaSchema.specs(); }
+  size_t min_bars(const Params& params) const override {
+    return static_cast<size_t>(kEmaSchema.decode(params).period);
+  }
+  size_t warmup_bars(const Params& params, double tolerance) const override;
+  std::span<const char* const> state_names() const override {
+    static constexpr const char* kState[] = {"ema"};
+    return kState;
+  }
+  SeriesMap compute_seeded(const std::vector<OHLCV>& bars, const Params& params, const Params& seed,
+                           Params* state) const override;
 };
 
-std::vector<double> compute_ema(const std::vector<double>& values, int period, double smoothing = 2.0);
+Series compute_ema(std::span<const double> values, int period, double smoothing = 2.0);
 
 }  // namespace tg_indicators
 
@@ -1,35 +1,102 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
+#include <initializer_list>
 #include <limits>
+#include <memory_resource>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "tg_indicators/arena.h"
 #include "tg_indicators/bar_codec.h"
+#include "tg_indicators/cancellation.h"
+#include "tg_indicators/fixed_point.h"
+#include "tg_indicators/indicators/param_schema.h"
 
 namespace tg_indicators {
 
-using Params = std::unordered_map<std::string, double>;
-using SeriesMap = std::unordered_map<std::string, std::vector<double>>;
+// One output or scratch column; kernels allocate them from arena_resource().
+using Series = std::pmr::vector<double>;
 
 inline double nan_value() {
   return std::numeric_limits<double>::quiet_NaN();
 }
 
-inline double param_or(const Params& params, const std::string& key, double fallback) {
-  const auto it = params.find(key);
-  return it == params.end() ? fallback : it->second;
+inline Series make_series(size_t n, double fill = nan_value()) {
+  return Series(n, fill, arena_resource());
 }
 
-inline int period_param(const Params& params, const std::string& key, int fallback) {
-  const double raw = param_or(params, key, static_cast<double>(fallback));
-  const int period = static_cast<int>(raw);
-  if (!std::isfinite(raw) || raw < 1.0 || static_cast<double>(period) != raw) {
-    throw std::invalid_argument("parameter " + key + " must be a positive integer");
+// The outputs of one compute(): a fixed slot per name of the indicator's
+// output_names(), in that order, so kernels fill slots by index and lookups compare a
+// few short names instead of hashing strings. Names are views of static descriptors
+// (output_names(), kBarFields), never owned; slots live in arena_resource().
+class SeriesMap {
+ public:
+  using value_type = std::pair<std::string_view, Series>;
+  using iterator = std::pmr::vector<value_type>::iterator;
+  using const_iterator = std::pmr::vector<value_type>::const_iterator;
+
+  SeriesMap() : slots_(arena_resource()) {}
+
+  // One slot per name, each `n` NaNs.
+  SeriesMap(std::span<const char* const> names, size_t n) : slots_(arena_resource()) {
+    slots_.reserve(names.size());
+    for (const char* name : names) {
+      slots_.emplace_back(std::piecewise_construct, std::forward_as_tuple(name),
+                          std::forward_as_tuple(n, nan_value()));
+    }
+  }
+
+  SeriesMap(std::initializer_list<value_type> slots) : slots_(slots, arena_resource()) {}
+
+  Series& operator[](size_t slot) { return slots_[slot].second; }
+  const Series& operator[](size_t slot) const { return slots_[slot].second; }
+
+  // Appends a slot; `name` must outlive the map.
+  Series& emplace(std::string_view name, Series values) {
+    return slots_.emplace_back(name, std::move(values)).second;
+  }
+
+  iterator find(std::string_view name) {
+    return std::find_if(slots_.begin(), slots_.end(), [&](const auto& slot) { return slot.first == name; });
+  }
+  const_iterator find(std::string_view name) const {
+    return std::find_if(slots_.begin(), slots_.end(), [&](const auto& slot) { return slot.first == name; });
+  }
+  bool contains(std::string_view name) const { return find(name) != end(); }
+
+  Series& at(std::string_view name) {
+    return const_cast<Series&>(std::as_const(*this).at(name));
+  }
+  const Series& at(std::string_view name) const {
+    const auto it = find(name);
+    if (it == end()) {
+      throw std::out_of_range("no output series " + std::string(name));
+    }
+    return it->second;
   }
-  return period;
+
+  size_t size() const { return slots_.size(); }
+  bool empty() const { return slots_.empty(); }
+  iterator begin() { return slots_.begin(); }
+  iterator end() { return slots_.end(); }
+  const_iterator begin() const { return slots_.begin(); }
+  const_iterator end() const { return slots_.end(); }
+
+ private:
+  std::pmr::vector<value_type> slots_;
+};
+
+// cost_per_bar of a kernel that rescans a full `period`-bar window for every output.
+inline double window_scan_cost(int period) {
+  return 2.0 + 2.0 * static_cast<double>(std::max(1, period));
 }
 
 inline void require_bars(size_t actual, size_t required, const std::string& indicator) {
@@ -39,8 +106,17 @@ inline void require_bars(size_t actual, size_t required, const std::string& indi
   }
 }
 
-inline std::vector<double> close_values(const std::vector<OHLCV>& bars) {
-  std::vector<double> values;
+// Value of `key` in a seed for compute_seeded; throws std::invalid_argument if absent.
+inline double seed_value(const Params& seed, const std::string& key) {
+  const auto it = seed.find(key);
+  if (it == seed.end() || !std::isfinite(it->second)) {
+    throw std::invalid_argument("seed is missing finite state " + key);
+  }
+  return it->second;
+}
+
+inline Series close_values(const std::vector<OHLCV>& bars) {
+  Series values(arena_resource());
   values.reserve(bars.size());
   for (const auto& bar : bars) {
     values.push_back(bar.close);
@@ -48,10 +124,108 @@ inline std::vector<double> close_values(const std::vector<OHLCV>& bars) {
   return values;
 }
 
+// Bars a recurrence prev = (1 - alpha) * prev + alpha * x needs before the influence
+// of its starting value has shrunk below `tolerance` (relative), i.e. (1 - alpha)^k.
+inline size_t convergence_bars(double alpha, double tolerance) {
+  if (alpha >= 1.0) {
+    return 0;
+  }
+  return static_cast<size_t>(std::ceil(std::log(tolerance) / std::log1p(-alpha)));
+}
+
+using Positions = std::pmr::vector<uint32_t>;
+
+// Positions of the valid bars in a BarMask.
+inline Positions valid_positions(const BarMask& valid) {
+  Positions positions(arena_resource());
+  positions.reserve(valid.size());
+  for (size_t i = 0; i < valid.size(); ++i) {
+    if (valid[i]) {
+      positions.push_back(static_cast<uint32_t>(i));
+    }
+  }
+  return positions;
+}
+
+// Spreads outputs computed over the valid bars back onto all `count` bars, NaN at
+// the invalid ones.
+inline SeriesMap scatter_valid(const SeriesMap& compact, std::span<const uint32_t> positions,
+                               size_t count) {
+  SeriesMap out;
+  for (const auto& [name, values] : compact) {
+    Series aligned = make_series(count);
+    for (size_t j = 0; j < positions.size(); ++j) {
+      aligned[positions[j]] = values[j];
+    }
+    out.emplace(name, std::move(aligned));
+  }
+  return out;
+}
+
 class IIndicator {
  public:
   virtual ~IIndicator() = default;
   virtual SeriesMap compute(const std::vector<OHLCV>& bars, const Params& params) const = 0;
+
+  // compute() over only the bars where `valid` is set, as if the rest were absent:
+  // windows span the last N valid bars and recurrences step from one valid bar to
+  // the next. Outputs stay aligned with all of `bars`, NaN at invalid positions.
+  // The default gathers the valid bars into a compact copy; kernels over high/low
+  // windows override it to index into `bars` in place.
+  virtual SeriesMap compute_masked(const std::vector<OHLCV>& bars, const BarMask& valid,
+                                   const Params& params) const {
+    const Positions positions = valid_positions(valid);
+    std::vector<OHLCV> compact;
+    compact.reserve(positions.size());
+    for (uint32_t position : positions) {
+      compact.push_back(bars[position]);
+    }
+    return scatter_valid(compute(compact, params), positions, bars.size());
+  }
+
+  // Same outputs computed from fixed-point prices. Only called when
+  // has_fixed_point_kernel() is true, for indicators whose kernels gain from exact
+  // integer sums, differences and comparisons of prices.
+  virtual SeriesMap compute_fixed(const FixedBars&, const Params&) const {
+    throw std::logic_error("indicator has no fixed-point kernel");
+  }
+  virtual bool has_fixed_point_kernel() const { return false; }
+
+  // Names of the series compute() returns, independent of params.
+  virtual std::span<const char* const> output_names() const = 0;
+
+  // The parameters compute() reads, with their defaults and bounds; empty when it
+  // takes none.
+  virtual std::span<const ParamSpec> param_schema() const { return {}; }
+
+  // Shortest history compute() accepts. Throws std::invalid_argument on bad params.
+  virtual size_t min_bars(const Params& params) const = 0;
+
+  // Bars after which the output is within `tolerance` (relative to the starting
+  // error) of what an unbounded history would give. Indicators over a finite window
+  // have converged as soon as they have min_bars.
+  virtual size_t warmup_bars(const Params& params, double) const { return min_bars(params); }
+
+  // Scalars that carry the indicator from one bar to the next; empty when it cannot
+  // be seeded.
+  virtual std::span<const char* const> state_names() const { return {}; }
+
+  // compute() that can start from and report state (keyed by state_names()). With a
+  // non-empty `seed`, holding the state as of the bar before bars[0], no warm-up bars
+  // are needed and every output slot is filled. When `state` is non-null it receives
+  // the state after the last bar, ready to seed the next call.
+  virtual SeriesMap compute_seeded(const std::vector<OHLCV>&, const Params&, const Params&,
+                                   Params*) const {
+    throw std::invalid_argument("indicator does not accept seeded state");
+  }
+
+  // True when outputs are unchanged by multiplying every price by one constant and
+  // volume is unused, so a uniform price adjustment can be skipped.
+  virtual bool scale_invariant() const { return false; }
+
+  // Relative work per input bar (SMA = 1), used by admission control to estimate a
+  // request's cost before running it. Must not throw on bad params.
+  virtual double cost_per_bar(const Params&) const { return 1.0; }
 };
 
 }  // namespace tg_indicators
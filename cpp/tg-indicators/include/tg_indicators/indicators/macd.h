@@ -4,10 +4,35 @@
 
 namespace tg_indicators {
 
+struct MacdParams {
+  int fast{};
+  int slow{};
+  int signal{};
+};
+
+inline constexpr ParamSchema kMacdSchema{std::array{
+    period_field<&MacdParams::fast>("fast", 12),
+    period_field<&MacdParams::slow>("slow", 26),
+    period_field<&MacdParams::signal>("signal", 9)}};
+
 // MACD: dif=EMA(fast)-EMA(slow), dea=EMA(signal of dif), hist=2*(dif-dea).
 class MacdIndicator final : public IIndicator {
  public:
   SeriesMap compute(const std::vector<OHLCV>& bars, const Params& params) const override;
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"dif", "dea", "hist"};
+    return kNames;
+  }
+  std::span<const ParamSpec> param_schema() const override { return kMacdSchema.specs(); }
+  size_t min_bars(const Params& params) const override;
+  size_t warmup_bars(const Params& params, double tolerance) const override;
+  std::span<const char* const> state_names() const override {
+    static constexpr const char* kState[] = {"fast_ema", "slow_ema", "dea"};
+    return kState;
+  }
+  SeriesMap compute_seeded(const std::vector<OHLCV>& bars, const Params& params, const Params& seed,
+                           Params* state) const override;
+  double cost_per_bar(const Params&) const override { return 3.0; }
 };
 
 }  // namespace tg_indicators
@@ -8,6 +8,16 @@ namespace tg_indicators {
 class ObvIndicator final : public IIndicator {
  public:
   SeriesMap compute(const std::vector<OHLCV>& bars, const Params& params) const override;
+  SeriesMap compute_masked(const std::vector<OHLCV>& bars, const BarMask& valid,
+                           const Params& params) const override;
+  SeriesMap compute_fixed(const FixedBars& bars, const Params& params) const override;
+  bool has_fixed_point_kernel() const override { return true; }
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"obv"};
+    return kNames;
+  }
+  // The level depends on where the history starts; only its changes converge.
+  size_t min_bars(const Params&) const override { return 1; }
 };
 
 }  // namespace tg_indicators
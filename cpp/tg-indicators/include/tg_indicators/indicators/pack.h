@@ -0,0 +1,25 @@
+#pragma once
+
+#include "tg_indicators/indicators/indicator_base.h"
+
+namespace tg_indicators {
+
+// PACK: the standard dashboard set (SMA, EMA, MACD, RSI, BOLL, ATR, ADX, CCI, KDJ,
+// WILLR, OBV) at their schema defaults, computed in one pass over the bars. Each
+// output matches the member indicator's series of the same name.
+class PackIndicator final : public IIndicator {
+ public:
+  SeriesMap compute(const std::vector<OHLCV>& bars, const Params& params) const override;
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {
+        "sma", "ema", "dif", "dea", "hist", "rsi", "upper", "mid", "lower", "atr",
+        "adx", "plus_di", "minus_di", "cci", "k", "d", "j", "willr", "obv"};
+    return kNames;
+  }
+  size_t min_bars(const Params& params) const override;
+  size_t warmup_bars(const Params& params, double tolerance) const override;
+  // About the sum of the members' costs; the window rescans dominate.
+  double cost_per_bar(const Params&) const override { return 150.0; }
+};
+
+}  // namespace tg_indicators
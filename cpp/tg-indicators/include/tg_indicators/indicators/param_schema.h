@@ -0,0 +1,153 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace tg_indicators {
+
+// Parameters as they arrive on the wire (IndicatorRequest.params, --param, the C ABI).
+using Params = std::unordered_map<std::string, double>;
+
+// Machine-readable description of one indicator parameter, as returned by Describe.
+struct ParamSpec {
+  const char* name{};
+  double default_value{};
+  double min{};
+  double max{};
+  bool integer{};
+  bool exclusive_min{};  // value must be > min rather than >= min
+};
+
+inline constexpr double kMaxPeriod = 1 << 24;
+
+template <typename Member>
+struct MemberOf;
+template <typename P, typename T>
+struct MemberOf<T P::*> {
+  using Owner = P;
+  using Type = T;
+};
+
+// Stores `value` into the member of P that `Member` points to.
+template <auto Member>
+constexpr void set_member(typename MemberOf<decltype(Member)>::Owner& out, double value) {
+  out.*Member = static_cast<typename MemberOf<decltype(Member)>::Type>(value);
+}
+
+// One schema row: a ParamSpec bound to the member of P it decodes into.
+template <typename P>
+struct ParamField {
+  ParamSpec spec;
+  void (*set)(P&, double){};
+};
+
+// An integer window length in [1, kMaxPeriod].
+template <auto Member>
+constexpr auto period_field(const char* name, int default_value) {
+  using P = typename MemberOf<decltype(Member)>::Owner;
+  return ParamField<P>{{name, static_cast<double>(default_value), 1.0, kMaxPeriod, true, false},
+                       &set_member<Member>};
+}
+
+// A finite real that must be positive, or non-negative when zero is allowed.
+template <auto Member>
+constexpr auto real_field(const char* name, double default_value, bool allow_zero = false) {
+  using P = typename MemberOf<decltype(Member)>::Owner;
+  return ParamField<P>{
+      {name, default_value, 0.0, std::numeric_limits<double>::infinity(), false, !allow_zero},
+      &set_member<Member>};
+}
+
+// Throws std::invalid_argument unless `value` satisfies `spec`.
+inline double checked_param(const ParamSpec& spec, double value) {
+  const std::string name = spec.name;
+  if (value > spec.max) {
+    throw std::invalid_argument("parameter " + name + " must be at most " +
+                                std::to_string(static_cast<long long>(spec.max)));
+  }
+  if (spec.integer) {
+    if (!std::isfinite(value) || value < spec.min || value != std::trunc(value)) {
+      throw std::invalid_argument("parameter " + name + " must be a positive integer");
+    }
+  } else if (!std::isfinite(value) || (spec.exclusive_min ? value <= spec.min : value < spec.min)) {
+    throw std::invalid_argument("parameter " + name +
+                                (spec.exclusive_min ? " must be positive" : " must be non-negative"));
+  }
+  return value;
+}
+
+// True when `value` satisfies `spec`; the non-throwing form of checked_param.
+inline bool valid_param(const ParamSpec& spec, double value) {
+  if (!std::isfinite(value) || value > spec.max) {
+    return false;
+  }
+  if (spec.integer) {
+    return value >= spec.min && value == std::trunc(value);
+  }
+  return spec.exclusive_min ? value > spec.min : value >= spec.min;
+}
+
+// The parameters of one indicator: a typed struct P and the constexpr table that names,
+// defaults and bounds each of its members. The table is the single source for the
+// defaults, for validation, and for what Describe reports, e.g.
+//
+//   struct MacdParams { int fast{}; int slow{}; int signal{}; };
+//   inline constexpr ParamSchema kMacdSchema{std::array{
+//       period_field<&MacdParams::fast>("fast", 12), ...}};
+//
+// Kernels take P, so they can also be specialized on it at compile time.
+template <typename P, size_t N>
+class ParamSchema {
+ public:
+  constexpr explicit ParamSchema(std::array<ParamField<P>, N> fields) : fields_(fields) {
+    for (size_t i = 0; i < N; ++i) {
+      specs_[i] = fields[i].spec;
+      fields[i].set(defaults_, fields[i].spec.default_value);
+    }
+  }
+
+  // Validated parameters; keys not in the schema are ignored. Requests that send no
+  // params (the common case) get the constant defaults without any lookups.
+  P decode(const Params& raw) const {
+    if (raw.empty()) {
+      return defaults_;
+    }
+    P out = defaults_;
+    for (const auto& field : fields_) {
+      const auto it = raw.find(field.spec.name);
+      if (it != raw.end()) {
+        field.set(out, checked_param(field.spec, it->second));
+      }
+    }
+    return out;
+  }
+
+  // Like decode(), but an invalid value falls back to its default instead of throwing,
+  // for estimates (cost_per_bar) that run before a request is validated.
+  P decode_or_default(const Params& raw) const {
+    P out = defaults_;
+    for (const auto& field : fields_) {
+      const auto it = raw.find(field.spec.name);
+      if (it != raw.end() && valid_param(field.spec, it->second)) {
+        field.set(out, it->second);
+      }
+    }
+    return out;
+  }
+
+  constexpr const P& defaults() const { return defaults_; }
+  constexpr std::span<const ParamSpec> specs() const { return specs_; }
+
+ private:
+  std::array<ParamField<P>, N> fields_;
+  std::array<ParamSpec, N> specs_{};
+  P defaults_{};
+};
+
+}  // namespace tg_indicators
@@ -4,10 +4,33 @@
 
 namespace tg_indicators {
 
+struct RsiParams {
+  int period{};
+};
+
+inline constexpr ParamSchema kRsiSchema{std::array{period_field<&RsiParams::period>("period", 14)}};
+
 // RSI(n): Wilder-smoothed relative strength index over close changes.
 class RsiIndicator final : public IIndicator {
  public:
   SeriesMap compute(const std::vector<OHLCV>& bars, const Params& params) const override;
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"rsi"};
+    return kNames;
+  }
+  std::span<const ParamSpec> param_schema() const override { return kRsiSchema.specs(); }
+  size_t min_bars(const Params& params) const override {
+    return static_cast<size_t>(kRsiSchema.decode(params).period) + 1;
+  }
+  size_t warmup_bars(const Params& params, double tolerance) const override;
+  std::span<const char* const> state_names() const override {
+    static constexpr const char* kState[] = {"avg_gain", "avg_loss", "prev_close"};
+    return kState;
+  }
+  SeriesMap compute_seeded(const std::vector<OHLCV>& bars, const Params& params, const Params& seed,
+                           Params* state) const override;
+  bool scale_invariant() const override { return true; }
+  double cost_per_bar(const Params&) const override { return 2.0; }
 };
 
 }  // namespace tg_indicators
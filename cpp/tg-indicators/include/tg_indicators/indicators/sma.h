@@ -4,13 +4,29 @@
 
 namespace tg_indicators {
 
+struct SmaParams {
+  int period{};
+};
+
+inline constexpr ParamSchema kSmaSchema{std::array{period_field<&SmaParams::period>("period", 20)}};
+
 // SMA(n): arithmetic mean of close over the last n bars. Warm-up slots are NaN.
 class SmaIndicator final : public IIndicator {
  public:
   SeriesMap compute(const std::vector<OHLCV>& bars, const Params& params) const override;
+  SeriesMap compute_fixed(const FixedBars& bars, const Params& params) const override;
+  bool has_fixed_point_kernel() const override { return true; }
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"sma"};
+    return kNames;
+  }
+  std::span<const ParamSpec> param_schema() const override { return kSmaSchema.specs(); }
+  size_t min_bars(const Params& params) const override {
+    return static_cast<size_t>(kSmaSchema.decode(params).period);
+  }
 };
 
-std::vector<double> compute_sma(const std::vector<double>& values, int period);
+Series compute_sma(std::span<const double> values, int period);
 
 }  // namespace tg_indicators
 
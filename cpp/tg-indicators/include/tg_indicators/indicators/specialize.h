@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+
+namespace tg_indicators {
+
+// A period fixed at compile time. It converts to int like a runtime period, so one
+// kernel template serves both, and loops over a Const<N> window get a constant trip
+// count the compiler can unroll and fold.
+template <int N>
+using Const = std::integral_constant<int, N>;
+
+// Calls fn(Const<N>{}) for the first N in Ns equal to `period` and returns true, or
+// returns false without calling fn. Kernels use it to route the parameter sets that
+// dominate traffic to instantiations specialized on them.
+template <int... Ns, typename Fn>
+bool with_constant_period(int period, Fn&& fn) {
+  return ((period == Ns && (fn(Const<Ns>{}), true)) || ...);
+}
+
+inline std::atomic<bool>& specialized_kernels_flag() {
+  static std::atomic<bool> enabled{true};
+  return enabled;
+}
+
+// Whether compute() may take a specialized kernel; on by default. Turning it off
+// forces the generic kernels, for benchmarks and equivalence tests.
+inline bool specialized_kernels() {
+  return specialized_kernels_flag().load(std::memory_order_relaxed);
+}
+
+inline void set_specialized_kernels(bool enabled) {
+  specialized_kernels_flag().store(enabled, std::memory_order_relaxed);
+}
+
+}  // namespace tg_indicators
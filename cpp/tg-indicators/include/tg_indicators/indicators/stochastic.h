@@ -4,10 +4,36 @@
 
 namespace tg_indicators {
 
+struct KdjParams {
+  int k_period{};
+  int d_period{};
+  double j_smooth{};
+};
+
+inline constexpr ParamSchema kKdjSchema{std::array{
+    period_field<&KdjParams::k_period>("k_period", 9),
+    period_field<&KdjParams::d_period>("d_period", 3),
+    real_field<&KdjParams::j_smooth>("j_smooth", 3.0)}};
+
 // KDJ: RSV over k_period, K=2/3 prevK+1/3 RSV, D=2/3 prevD+1/3 K, J=3K-2D.
 class StochasticIndicator final : public IIndicator {
  public:
   SeriesMap compute(const std::vector<OHLCV>& bars, const Params& params) const override;
+  SeriesMap compute_masked(const std::vector<OHLCV>& bars, const BarMask& valid,
+                           const Params& params) const override;
+  SeriesMap compute_fixed(const FixedBars& bars, const Params& params) const override;
+  bool has_fixed_point_kernel() const override { return true; }
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"k", "d", "j"};
+    return kNames;
+  }
+  std::span<const ParamSpec> param_schema() const override { return kKdjSchema.specs(); }
+  size_t min_bars(const Params& params) const override {
+    return static_cast<size_t>(kKdjSchema.decode(params).k_period);
+  }
+  size_t warmup_bars(const Params& params, double tolerance) const override;
+  bool scale_invariant() const override { return true; }
+  double cost_per_bar(const Params& params) const override;
 };
 
 }  // namespace tg_indicators
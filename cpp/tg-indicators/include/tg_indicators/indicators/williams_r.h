@@ -4,10 +4,30 @@
 
 namespace tg_indicators {
 
+struct WillrParams {
+  int period{};
+};
+
+inline constexpr ParamSchema kWillrSchema{std::array{period_field<&WillrParams::period>("period", 14)}};
+
 // Williams %R(n): -100 * (highest_high - close) / (highest_high - lowest_low).
 class WilliamsRIndicator final : public IIndicator {
  public:
   SeriesMap compute(const std::vector<OHLCV>& bars, const Params& params) const override;
+  SeriesMap compute_masked(const std::vector<OHLCV>& bars, const BarMask& valid,
+                           const Params& params) const override;
+  SeriesMap compute_fixed(const FixedBars& bars, const Params& params) const override;
+  bool has_fixed_point_kernel() const override { return true; }
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"willr"};
+    return kNames;
+  }
+  std::span<const ParamSpec> param_schema() const override { return kWillrSchema.specs(); }
+  size_t min_bars(const Params& params) const override {
+    return static_cast<size_t>(kWillrSchema.decode(params).period);
+  }
+  bool scale_invariant() const override { return true; }
+  double cost_per_bar(const Params& params) const override;
 };
 
 }  // namespace tg_indicators
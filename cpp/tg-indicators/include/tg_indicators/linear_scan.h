@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+
+namespace tg_indicators {
+
+// Recurrences shorter than this run sequentially; thread start-up would dominate.
+inline constexpr size_t kParallelScanThreshold = size_t{1} << 17;
+
+// Evaluates the first-order linear recurrence y[i] = a * y[i - 1] + b * x[i] for i in
+// [0, count), with y[-1] = seed. EMA, Wilder smoothing and running sums (a = 1) are all
+// of this form.
+//
+// At or above kParallelScanThreshold, with more than one worker, it becomes a blocked
+// parallel scan: each block is solved from a zero carry, the block carries are
+// chained sequentially (an affine map per block), then every block is corrected by
+// y[j] += a^(j + 1) * carry in a vectorizable pass. The result differs from the
+// sequential evaluation only by rounding reassociation, bounded by roughly
+// count * 1e-16 relative to the largest |y| (|a| <= 1).
+void linear_recurrence(const double* x, double* y, size_t count, double a, double b, double seed,
+                       size_t threads = 0);
+
+}  // namespace tg_indicators
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "tg_indicators/cancellation.h"
+
+namespace tg_indicators {
+
+inline size_t default_worker_count() {
+  const unsigned hw = std::thread::hardware_concurrency();
+  return hw == 0 ? 1 : static_cast<size_t>(hw);
+}
+
+// Runs fn(index) for every index in [0, count) on up to `workers` threads. Work is
+// handed out through a shared counter so uneven items balance themselves. The first
+// exception thrown by any item is rethrown on the calling thread after all workers join.
+// Workers inherit the caller's cancellation context and check it before each item.
+template <typename Fn>
+void parallel_for(size_t count, size_t workers, Fn&& fn) {
+  workers = std::max<size_t>(1, std::min(workers, count));
+  if (workers <= 1) {
+    for (size_t i = 0; i < count; ++i) {
+      cancellation_point();
+      fn(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  const CancellationContext* cancellation = current_cancellation();
+  auto worker = [&]() {
+    CancellationScope scope(cancellation);
+    for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+      try {
+        cancellation_point();
+        fn(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+        next.store(count);
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (size_t t = 1; t < workers; ++t) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace tg_indicators
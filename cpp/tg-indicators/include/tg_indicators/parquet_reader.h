@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "tg_indicators/bar_codec.h"
+
+namespace tg_indicators {
+
+// Reader for the bar partitions written by tg-persistence (`parquet_io.rs`):
+// data/bars/<period>/symbol=<symbol>/year=<year>/part.parquet with columns
+// ts_ms:int64, open/high/low/close/amount:decimal(18,4), volume:int64.
+//
+// Only the seven numeric bar columns are decoded; string columns are never touched.
+// Row groups whose ts_ms statistics fall outside [start_millis, end_millis) are
+// skipped without reading their pages. Supported: data page v1/v2, PLAIN and
+// dictionary encodings, UNCOMPRESSED and SNAPPY codecs.
+
+struct ParquetScanStats {
+  size_t row_groups_total{};
+  size_t row_groups_read{};
+  size_t rows_decoded{};
+  size_t bytes_read{};
+};
+
+inline constexpr int64_t kUnboundedStartMillis = std::numeric_limits<int64_t>::min();
+inline constexpr int64_t kUnboundedEndMillis = std::numeric_limits<int64_t>::max();
+
+// Bars with start_millis <= ts < end_millis, in file order. Throws std::runtime_error
+// on I/O or format errors.
+std::vector<OHLCV> read_parquet_bars(const std::string& path,
+                                     int64_t start_millis = kUnboundedStartMillis,
+                                     int64_t end_millis = kUnboundedEndMillis,
+                                     ParquetScanStats* stats = nullptr);
+
+// Mirrors `bar_partition_path` in parquet_io.rs. `period` is the storage name
+// ("daily", "minute1", "minute5").
+std::string bar_partition_path(const std::string& root,
+                               const std::string& period,
+                               const std::string& symbol,
+                               int year);
+
+// Mirrors `query_bars_sync`: reads every yearly partition overlapping the UTC range,
+// skips missing partitions, and returns bars sorted by timestamp.
+std::vector<OHLCV> query_parquet_bars(const std::string& root,
+                                      const std::string& period,
+                                      const std::string& symbol,
+                                      int64_t start_millis,
+                                      int64_t end_millis,
+                                      ParquetScanStats* stats = nullptr);
+
+}  // namespace tg_indicators
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "tg_indicators/bar_codec.h"
+
+namespace tg_indicators {
+
+// A-share session-aware bar aggregation.
+//
+// Intraday bars are assumed to be labelled by their close time in Asia/Shanghai
+// (UTC+8, no DST). Continuous trading runs 09:30-11:30 and 13:00-15:00, i.e. 240
+// trading minutes; MIN15/30/60 buckets are counted in trading minutes so the lunch
+// break never splits or pads a bucket (MIN60 closes at 10:30, 11:30, 14:00, 15:00).
+// Opening call-auction bars (labelled at or before 09:30) fold into the first bucket,
+// bars labelled inside the lunch break fold into the 11:30 bucket, and closing-auction
+// or after-hours bars (after 15:00) fold into the last bucket.
+//
+// Intraday buckets are stamped with the bucket close time; DAILY and WEEKLY
+// (Monday-based) buckets keep the timestamp of their last constituent bar.
+
+// Trading minutes per bar for intraday periods, 0 for DAILY/WEEKLY/unspecified.
+int intraday_period_minutes(tg::v1::BarPeriod period);
+
+// Throws std::invalid_argument unless `target` can be built from `source` bars.
+void validate_resample(tg::v1::BarPeriod source, tg::v1::BarPeriod target);
+
+// Bucket identifier: equal keys mean "same output bar"; keys increase with time.
+int64_t resample_bucket_key(int64_t ts_millis, tg::v1::BarPeriod target);
+
+// Aggregates time-ordered bars into `target` buckets: first open, max high, min low,
+// last close, summed volume and amount.
+std::vector<OHLCV> resample_bars(const std::vector<OHLCV>& bars, tg::v1::BarPeriod target);
+
+// Incremental form of resample_bars for streaming feeds: each push is O(1) and only
+// touches the forming bucket.
+class BarResampler {
+ public:
+  explicit BarResampler(tg::v1::BarPeriod target);
+  // Resumes a resampler saved as its target(), forming_key() and forming().
+  BarResampler(tg::v1::BarPeriod target, int64_t forming_key, std::optional<OHLCV> forming);
+
+  // Folds one finer bar into the forming bucket. Returns the bucket that the bar
+  // closed, if it started a new one.
+  std::optional<OHLCV> push(const OHLCV& bar);
+
+  // Closes and returns the forming bucket if a bar at `ts_millis` would start a new
+  // one, so a feed can commit a bucket as soon as the next has begun to form.
+  std::optional<OHLCV> close_before(int64_t ts_millis);
+
+  tg::v1::BarPeriod target() const { return target_; }
+  int64_t forming_key() const { return forming_key_; }
+  // Current (not yet closed) aggregated bar, reflecting every bar pushed so far.
+  const std::optional<OHLCV>& forming() const { return forming_; }
+
+ private:
+  tg::v1::BarPeriod target_;
+  int64_t forming_key_{};
+  std::optional<OHLCV> forming_;
+};
+
+}  // namespace tg_indicators
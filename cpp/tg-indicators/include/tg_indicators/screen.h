@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tg_indicators/indicators/indicator_base.h"
+
+namespace tg_indicators {
+
+enum class CompareOp { kLess, kLessEqual, kGreater, kGreaterEqual };
+
+// One side of a screen condition, evaluated at a symbol's latest bar:
+// scale * (constant | bar field | indicator output). With average_bars > 0 the
+// series is averaged over the average_bars bars ending at the latest one, e.g.
+// {series "volume", average_bars 5, scale 2} is twice the 5-bar average volume.
+struct ScreenOperand {
+  std::string indicator;  // empty: `series` is a bar field (see kBarFields), or a constant
+  Params params;
+  std::string series;     // empty with no indicator: the operand is `constant`
+  double constant{};
+  double scale{1.0};
+  size_t average_bars{};
+};
+
+struct ScreenCondition {
+  ScreenOperand left;
+  CompareOp op{CompareOp::kLess};
+  ScreenOperand right;
+};
+
+struct ScreenOutcome {
+  bool matched{};
+  // Latest value of every operand (Screen::labels() order); NaN for operands not
+  // evaluated because an earlier condition already failed.
+  std::vector<double> values;
+  size_t indicators_computed{};
+};
+
+// A conjunction of conditions, prepared once and evaluated per symbol. Conditions
+// are evaluated cheapest first (bar fields and constants, then indicators by
+// cost_per_bar), each indicator/params pair is computed at most once per symbol,
+// and evaluation stops at the first failing condition, so expensive indicators
+// only run for symbols that passed the cheap filters.
+class Screen {
+ public:
+  // Throws std::invalid_argument for unknown indicators or bar fields.
+  explicit Screen(const std::vector<ScreenCondition>& conditions);
+
+  // A symbol matches when every condition holds at its last bar. NaN values and
+  // indicators that reject the bars (too short a history) fail the condition.
+  ScreenOutcome evaluate(const std::vector<OHLCV>& bars) const;
+
+  // Per-operand labels such as "close", "avg5(volume)" or "RSI(period=6).rsi".
+  const std::vector<std::string>& labels() const { return labels_; }
+
+  // Work per bar if every condition is evaluated, in IIndicator::cost_per_bar units.
+  double cost_per_bar() const;
+
+ private:
+  static constexpr size_t kNone = static_cast<size_t>(-1);
+
+  // One distinct indicator/params pair.
+  struct Source {
+    std::unique_ptr<IIndicator> indicator;
+    Params params;
+    double cost{};
+    size_t min_bars{};
+  };
+  struct Operand {
+    size_t source{kNone};
+    size_t field{kNone};  // index into kBarFields
+    std::string series;
+    double constant{};
+    double scale{1.0};
+    size_t average_bars{};
+  };
+  struct Condition {
+    size_t left{};
+    size_t right{};
+    CompareOp op{};
+    double cost{};
+  };
+
+  std::vector<Source> sources_;
+  std::vector<Operand> operands_;
+  std::vector<Condition> conditions_;  // cheapest first
+  std::vector<std::string> labels_;
+};
+
+}  // namespace tg_indicators
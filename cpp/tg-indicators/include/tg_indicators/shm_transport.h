@@ -0,0 +1,220 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "tg_indicators/indicators/indicator_base.h"
+
+namespace tg_indicators {
+
+// Same-host transport that bypasses gRPC: a POSIX shared-memory segment
+// (/dev/shm/<name>) holding a fixed ring of request slots. Clients write columnar bars
+// straight into a slot, ring a futex doorbell, and read the result columns back out
+// of the same slot. No serialization, no sockets.
+//
+// Segment layout (little-endian, every offset 8-byte aligned):
+//
+//   offset 0                         ShmSegmentHeader (kShmHeaderBytes)
+//   kShmHeaderBytes + i * slot_bytes ShmSlotHeader (kShmSlotHeaderBytes), then data
+//
+// Slot state machine, driven through ShmSlotHeader::state (a futex word):
+//
+//   FREE --client CAS--> CLAIMED --client fills, stores--> REQUEST
+//   REQUEST --server CAS--> PROCESSING --server CAS--> RESPONSE
+//   RESPONSE --client reads, stores--> FREE
+//
+// A client that gives up (deadline passed, server stopped) takes back an unclaimed
+// request with REQUEST --CAS--> CLAIMED, or hands an in-flight one to the server with
+// PROCESSING --CAS--> ABANDONED; the server frees an abandoned slot when it finishes.
+//
+// After storing REQUEST the client increments ShmSegmentHeader::doorbell and
+// FUTEX_WAKEs it; after storing RESPONSE the server FUTEX_WAKEs the slot's state word.
+// ShmSegmentHeader::serving is 1 while a server is running on the segment.
+// Futexes are process-shared (no FUTEX_PRIVATE_FLAG).
+//
+// Request data area (n = bar_count), columns back to back:
+//   int64 ts_epoch_millis[n], double open[n], high[n], low[n], close[n],
+//   int64 volume[n], double amount[n]
+//
+// Response data area (replaces the request; m = output_count, n = output_length):
+//   char names[m][kShmNameBytes] (NUL-padded), then double values[m][n].
+//   On error, status holds a gRPC status code and the data area holds message_bytes
+//   of UTF-8 error text.
+
+inline constexpr uint32_t kShmMagic = 0x48534754;  // "TGSH"
+inline constexpr uint32_t kShmVersion = 2;
+inline constexpr size_t kShmHeaderBytes = 4096;
+inline constexpr size_t kShmSlotHeaderBytes = 256;
+inline constexpr size_t kShmNameBytes = 16;
+inline constexpr size_t kShmIndicatorBytes = 32;
+inline constexpr size_t kShmMaxParams = 8;
+inline constexpr size_t kShmColumnsPerBar = 7;
+
+enum class ShmSlotState : uint32_t {
+  kFree = 0,
+  kClaimed = 1,
+  kRequest = 2,
+  kProcessing = 3,
+  kResponse = 4,
+  kAbandoned = 5,
+};
+
+struct ShmSegmentHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t reserved;
+  uint64_t slot_bytes;
+  std::atomic<uint32_t> doorbell;
+  std::atomic<uint32_t> next_slot;  // round-robin claim hint
+  std::atomic<uint32_t> serving;
+};
+
+struct ShmParam {
+  char key[kShmNameBytes];
+  double value;
+};
+
+struct ShmSlotHeader {
+  std::atomic<uint32_t> state;
+  int32_t status;
+  uint32_t bar_count;
+  uint32_t param_count;
+  uint32_t output_count;
+  uint32_t output_length;
+  uint32_t message_bytes;
+  uint32_t timeout_millis;  // the call's remaining deadline at submit; 0 = none
+  char indicator[kShmIndicatorBytes];
+  ShmParam params[kShmMaxParams];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+static_assert(sizeof(ShmSegmentHeader) <= kShmHeaderBytes);
+static_assert(sizeof(ShmSlotHeader) <= kShmSlotHeaderBytes);
+
+// Maps a named segment; the creator also sizes, initializes and finally unlinks it.
+class ShmSegment {
+ public:
+  // Fails with EEXIST if the name is taken, unless replace_existing unlinks the old
+  // segment first (e.g. one left behind by a crashed server).
+  static ShmSegment create(const std::string& name, uint32_t slot_count, size_t max_bars_per_slot,
+                           bool replace_existing = false);
+  static ShmSegment open(const std::string& name);
+
+  ShmSegment(ShmSegment&& other) noexcept;
+  ShmSegment& operator=(ShmSegment&& other) noexcept;
+  ~ShmSegment();
+
+  ShmSegmentHeader& header() const { return *static_cast<ShmSegmentHeader*>(base_); }
+  ShmSlotHeader& slot(uint32_t index) const;
+  std::byte* slot_data(uint32_t index) const;
+  size_t max_bars_per_slot() const;
+
+ private:
+  ShmSegment(std::string name, void* base, size_t bytes, bool owner)
+      : name_(std::move(name)), base_(base), bytes_(bytes), owner_(owner) {}
+
+  std::string name_;
+  void* base_{};
+  size_t bytes_{};
+  bool owner_{};
+};
+
+class IndicatorServiceImpl;
+
+// Serves indicator requests from a segment on `workers` threads until stopped, each
+// through the service's Compute pipeline (capture, admission control, deadline, arena).
+class ShmIndicatorServer {
+ public:
+  ShmIndicatorServer(IndicatorServiceImpl& service, const std::string& name, uint32_t slot_count,
+                     size_t max_bars_per_slot, size_t workers = 1, bool replace_existing = false);
+  ~ShmIndicatorServer();
+
+  ShmIndicatorServer(const ShmIndicatorServer&) = delete;
+  ShmIndicatorServer& operator=(const ShmIndicatorServer&) = delete;
+
+  void stop();
+
+ private:
+  void run();
+  void process(uint32_t index);
+
+  IndicatorServiceImpl& service_;
+  ShmSegment segment_;
+  std::atomic<bool> stopping_{false};
+  std::vector<std::thread> threads_;
+};
+
+// Writable bar columns inside a claimed slot.
+struct ShmBarColumns {
+  std::span<int64_t> ts_millis;
+  std::span<double> open;
+  std::span<double> high;
+  std::span<double> low;
+  std::span<double> close;
+  std::span<int64_t> volume;
+  std::span<double> amount;
+};
+
+class ShmIndicatorClient;
+
+// One request/response exchange that owns its slot until destroyed. Fill columns(),
+// submit(), then read series() in place.
+class ShmCall {
+ public:
+  ShmCall(ShmCall&& other) noexcept;
+  ShmCall& operator=(ShmCall&&) = delete;
+  ~ShmCall();
+
+  ShmBarColumns& columns() { return columns_; }
+
+  // Publishes the request and blocks until the server answers, the deadline passes
+  // (DEADLINE_EXCEEDED) or the server stops (UNAVAILABLE); the server also stops
+  // computing at the deadline. Returns the gRPC status code (0 = OK); on error,
+  // error_message() explains.
+  int submit(std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+  std::string error_message() const;
+  std::vector<std::string> series_names() const;
+  // Output column by name, viewing shared memory; empty if absent.
+  std::span<const double> series(std::string_view name) const;
+
+ private:
+  friend class ShmIndicatorClient;
+  ShmCall(const ShmSegment* segment, uint32_t index, size_t bar_count);
+
+  // Ends a submit() that stopped waiting, releasing the slot or handing it to the server.
+  int give_up(int code, std::string message);
+
+  const ShmSegment* segment_;
+  uint32_t index_;
+  ShmBarColumns columns_;
+  // Set when submit() gave up: the slot no longer holds this call's response.
+  int local_status_{0};
+  std::string local_error_;
+  bool abandoned_{false};  // the server frees the slot
+};
+
+class ShmIndicatorClient {
+ public:
+  explicit ShmIndicatorClient(const std::string& name);
+
+  // Claims a slot for `bar_count` bars, spinning briefly then sleeping while all slots
+  // are busy. Throws std::invalid_argument if the request cannot fit in a slot.
+  ShmCall begin(const std::string& indicator, const Params& params, size_t bar_count);
+
+ private:
+  ShmSegment segment_;
+};
+
+}  // namespace tg_indicators
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <grpcpp/grpcpp.h>
+
+#include "tg_indicators/cancellation.h"
+
+namespace tg_indicators {
+
+// Coalesces concurrent identical calls: the first caller for a key (the leader) runs
+// the computation, callers arriving while it is in flight wait and receive a copy of
+// its result. Nothing is cached once the leader finishes, so there is no staleness.
+// If the leader was cancelled or ran out of its own deadline, waiting followers do
+// not inherit that; one of them retries as the new leader.
+template <typename Result>
+class Singleflight {
+ public:
+  // fn(Result*) -> grpc::Status. Followers honour the current CancellationScope's
+  // deadline while waiting.
+  template <typename Fn>
+  grpc::Status run(const std::string& key, Result* out, Fn&& fn) {
+    for (;;) {
+      std::shared_ptr<Call> call;
+      bool leader = false;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto [it, inserted] = calls_.try_emplace(key);
+        if (inserted) {
+          it->second = std::make_shared<Call>();
+        } else {
+          ++it->second->followers;
+        }
+        call = it->second;
+        leader = inserted;
+      }
+
+      if (leader) {
+        executions_.fetch_add(1, std::memory_order_relaxed);
+        grpc::Status status;
+        try {
+          status = fn(out);
+        } catch (...) {
+          finish(key, *call, grpc::Status(grpc::StatusCode::INTERNAL, "computation failed"), nullptr);
+          throw;
+        }
+        finish(key, *call, status, out);
+        return status;
+      }
+
+      std::unique_lock<std::mutex> lock(call->mutex);
+      const CancellationContext* cancellation = current_cancellation();
+      const auto deadline = cancellation == nullptr ? CancellationContext::Clock::time_point::max()
+                                                    : cancellation->deadline();
+      if (deadline == CancellationContext::Clock::time_point::max()) {
+        call->done_cv.wait(lock, [&] { return call->done; });
+      } else if (!call->done_cv.wait_until(lock, deadline, [&] { return call->done; })) {
+        return {grpc::StatusCode::DEADLINE_EXCEEDED, "deadline exceeded waiting for coalesced call"};
+      }
+      const grpc::StatusCode code = call->status.error_code();
+      if (code == grpc::StatusCode::CANCELLED || code == grpc::StatusCode::DEADLINE_EXCEEDED) {
+        continue;
+      }
+      coalesced_.fetch_add(1, std::memory_order_relaxed);
+      if (call->status.ok()) {
+        out->CopyFrom(call->result);
+      }
+      return call->status;
+    }
+  }
+
+  // Calls that ran the computation vs. calls served by another caller's run.
+  uint64_t executions() const { return executions_.load(std::memory_order_relaxed); }
+  uint64_t coalesced() const { return coalesced_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Call {
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    size_t followers{0};  // guarded by Singleflight::mutex_
+    bool done{false};
+    grpc::Status status;
+    Result result;
+  };
+
+  void finish(const std::string& key, Call& call, const grpc::Status& status, const Result* result) {
+    size_t followers = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      calls_.erase(key);
+      followers = call.followers;
+    }
+    {
+      std::lock_guard<std::mutex> lock(call.mutex);
+      call.status = status;
+      if (followers > 0 && result != nullptr && status.ok()) {
+        call.result.CopyFrom(*result);
+      }
+      call.done = true;
+    }
+    call.done_cv.notify_all();
+  }
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<Call>> calls_;
+  std::atomic<uint64_t> executions_{0};
+  std::atomic<uint64_t> coalesced_{0};
+};
+
+}  // namespace tg_indicators
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tg_indicators/resample.h"
+#include "tg_indicators/streaming.h"
+
+namespace tg_indicators {
+
+struct StreamUpdate {
+  // Timestamp of the newest bar folded into the state, 0 before the first bar. Bars
+  // at or before it are ignored, so a client resends only what came after. With a
+  // resample target this is the newest input bar, folded or still in its bucket.
+  int64_t watermark_ts_millis{};
+  uint64_t bar_count{};
+  size_t applied_bars{};
+  std::span<const char* const> names;
+  std::vector<double> latest;
+  // Outputs for the forming bar, previewed against the committed state; empty when no
+  // forming bar was given or it is not newer than the watermark. With a resample
+  // target it previews the forming bucket whenever one is open.
+  std::vector<double> provisional;
+};
+
+// Live streaming indicator states keyed by (session, indicator, params). A session is
+// the client's name for one bar feed, typically the symbol. Params are keyed as the
+// indicator's schema reads them, defaults filled in, so omitting a parameter and
+// passing its default address the same state.
+//
+// With a resample target the session's bars are aggregated into target-period
+// buckets (see BarResampler) and the indicator folds each bucket once it closes;
+// the same session resampled to another period, or not at all, is a separate state.
+//
+// Snapshots go to a single file: the magic "TGST", format version, entry count, then
+// per entry the session, indicator, params, resample target and forming bucket,
+// watermark, latest values and the StreamingIndicator bytes, and finally an FNV-1a
+// checksum of everything before it. Only the current format version loads. The
+// file is written to "<path>.tmp", fsynced and renamed over `path`, so a crash leaves
+// either the previous or the new snapshot.
+class StreamStore {
+ public:
+  // Folds the closed `bars`, then previews `forming` (the still-open bar, revised on
+  // every tick) without folding it; the client sends it again with `bars` once closed.
+  // With `resample_to` set, closed buckets are folded and the forming bucket, with
+  // `forming` merged in, is what gets previewed.
+  StreamUpdate update(const std::string& session, const std::string& indicator, const Params& params,
+                      std::span<const OHLCV> bars, const OHLCV* forming = nullptr,
+                      tg::v1::BarPeriod resample_to = tg::v1::BAR_PERIOD_UNSPECIFIED);
+
+  size_t size() const;
+
+  // Drops the states no update has touched for `max_idle`, skipping any being updated
+  // right now. Returns the number dropped; a dropped session starts over from its
+  // next update.
+  size_t evict_idle(std::chrono::steady_clock::duration max_idle);
+
+  // Serializes every state, locking each only while its bytes are copied so updates
+  // keep flowing during a snapshot; file I/O happens with no lock held. Returns the
+  // number of entries written.
+  size_t snapshot(const std::string& path) const;
+
+  // Loads a snapshot, replacing live entries with the same key. Returns the number of
+  // entries restored; throws std::runtime_error if the file is corrupt.
+  size_t restore(const std::string& path);
+
+ private:
+  struct Entry {
+    std::mutex mutex;
+    std::string session;
+    std::string indicator;
+    std::vector<std::pair<std::string, double>> params;
+    std::unique_ptr<StreamingIndicator> state;
+    std::optional<BarResampler> resampler;
+    int64_t watermark_ts_millis{};
+    std::vector<double> latest;
+    std::chrono::steady_clock::time_point last_used;
+  };
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+  };
+
+  Shard& shard_for(const std::string& key);
+
+  std::array<Shard, 64> shards_;
+};
+
+}  // namespace tg_indicators
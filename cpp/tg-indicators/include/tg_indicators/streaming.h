@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "tg_indicators/indicators/indicator_base.h"
+
+namespace tg_indicators {
+
+// Incremental form of a registry indicator: bars arrive one at a time and each
+// update() yields exactly what IIndicator::compute would produce at that bar's index
+// over the full history (same operation order, so bit-identical). State is O(1) for
+// the recursive indicators (EMA, MACD, RSI, ATR, ADX, OBV) and O(period) for the
+// windowed ones (SMA, BOLL, CCI, KDJ, WILLR), and serializes to a compact byte string
+// for snapshots. The state is the committed checkpoint: preview() evaluates a forming
+// bar against it without changing it.
+class StreamingIndicator {
+ public:
+  virtual ~StreamingIndicator() = default;
+
+  virtual std::span<const char* const> output_names() const = 0;
+
+  // Folds one closed bar and writes the newest value of every output, in
+  // output_names() order, to `out` (NaN while warming up).
+  virtual void update(const OHLCV& bar, std::span<double> out) = 0;
+
+  // Writes what update(bar, out) would, without folding `bar`: the outputs for a
+  // still-forming bar that is revised many times before it closes. Every revision is
+  // evaluated against the same committed state, and update() commits the final bar
+  // once it closes. O(1) per call; a windowed stream pays one O(period) pass on the
+  // first preview after each update(). Bit-identical to update() except BOLL's bands
+  // and CCI, which agree to rounding.
+  virtual void preview(const OHLCV& bar, std::span<double> out) const = 0;
+
+  // Bars folded so far.
+  virtual uint64_t bar_count() const = 0;
+
+  virtual void save(std::string& out) const = 0;
+  // Replaces the state with bytes from save() of an indicator created with the same
+  // name and params. Throws std::runtime_error on malformed or mismatched input.
+  virtual void load(std::string_view bytes) = 0;
+};
+
+// nullptr for unknown indicator names; std::invalid_argument for bad params.
+std::unique_ptr<StreamingIndicator> create_streaming_indicator(const std::string& name,
+                                                               const Params& params);
+
+}  // namespace tg_indicators
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace tg_indicators {
+
+inline constexpr int64_t kMillisPerDay = 86'400'000;
+
+// Proleptic Gregorian calendar helpers (Howard Hinnant's civil-day algorithms).
+inline constexpr int64_t days_from_civil(int64_t year, unsigned month, unsigned day) {
+  year -= month <= 2 ? 1 : 0;
+  const int64_t era = (year >= 0 ? year : year - 399) / 400;
+  const unsigned yoe = static_cast<unsigned>(year - era * 400);
+  const unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+struct CivilDate {
+  int64_t year{};
+  unsigned month{};
+  unsigned day{};
+};
+
+inline constexpr CivilDate civil_from_days(int64_t days) {
+  days += 719468;
+  const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  const unsigned doe = static_cast<unsigned>(days - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp = (5 * doy + 2) / 153;
+  const unsigned day = doy - (153 * mp + 2) / 5 + 1;
+  const unsigned month = mp < 10 ? mp + 3 : mp - 9;
+  return CivilDate{static_cast<int64_t>(yoe) + era * 400 + (month <= 2 ? 1 : 0), month, day};
+}
+
+inline int64_t floor_div(int64_t value, int64_t divisor) {
+  const int64_t q = value / divisor;
+  return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? q - 1 : q;
+}
+
+inline int utc_year_from_millis(int64_t ts_millis) {
+  return static_cast<int>(civil_from_days(floor_div(ts_millis, kMillisPerDay)).year);
+}
+
+// Parses "YYYY-MM-DD" as UTC midnight.
+inline int64_t parse_date_millis(const std::string& value) {
+  if (value.size() != 10 || value[4] != '-' || value[7] != '-') {
+    throw std::invalid_argument("expected YYYY-MM-DD date, got " + value);
+  }
+  for (size_t i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+    if (value[i] < '0' || value[i] > '9') {
+      throw std::invalid_argument("expected YYYY-MM-DD date, got " + value);
+    }
+  }
+  const int64_t year = std::stoi(value.substr(0, 4));
+  const unsigned month = static_cast<unsigned>(std::stoi(value.substr(5, 2)));
+  const unsigned day = static_cast<unsigned>(std::stoi(value.substr(8, 2)));
+  if (month < 1 || month > 12 || day < 1 || day > 31) {
+    throw std::invalid_argument("date out of range: " + value);
+  }
+  return days_from_civil(year, month, day) * kMillisPerDay;
+}
+
+}  // namespace tg_indicators
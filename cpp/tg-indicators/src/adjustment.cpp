@@ -0,0 +1,59 @@
+#include "tg_indicators/adjustment.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "tg_indicators/bar_codec.h"
+
+namespace tg_indicators {
+
+std::vector<double> adjustment_ratios(
+    const google::protobuf::RepeatedPtrField<tg::v1::Bar>& bars,
+    const google::protobuf::RepeatedPtrField<tg::v1::AdjustmentFactor>& factors,
+    tg::v1::Adjustment adjustment) {
+  if ((adjustment != tg::v1::ADJUSTMENT_PRE_ADJUST && adjustment != tg::v1::ADJUSTMENT_POST_ADJUST) ||
+      factors.empty() || bars.empty()) {
+    return {};
+  }
+
+  std::vector<std::pair<std::string, double>> schedule;
+  schedule.reserve(static_cast<size_t>(factors.size()));
+  for (const auto& factor : factors) {
+    const double value = parse_decimal_string(factor.factor(), "factor");
+    if (value == 0.0) {
+      throw std::invalid_argument("zero adjustment factor on " + factor.ex_date());
+    }
+    schedule.emplace_back(factor.ex_date(), value);
+  }
+  std::stable_sort(schedule.begin(), schedule.end(),
+                   [](const auto& a, const auto& b) { return a.first < b.first; });
+  const double anchor = adjustment == tg::v1::ADJUSTMENT_PRE_ADJUST ? schedule.back().second
+                                                                    : schedule.front().second;
+
+  std::vector<double> ratios;
+  ratios.reserve(static_cast<size_t>(bars.size()));
+  const std::string* last_date = nullptr;
+  double ratio = 1.0;
+  for (const auto& bar : bars) {
+    // Intraday bars share a trading_date, so only search when it changes.
+    if (last_date == nullptr || *last_date != bar.trading_date()) {
+      const auto it = std::upper_bound(
+          schedule.begin(), schedule.end(), bar.trading_date(),
+          [](const std::string& date, const auto& entry) { return date < entry.first; });
+      ratio = it == schedule.begin() ? 1.0 : std::prev(it)->second / anchor;
+      last_date = &bar.trading_date();
+    }
+    ratios.push_back(ratio);
+  }
+  return ratios;
+}
+
+bool uniform_ratios(const std::vector<double>& ratios) {
+  return std::adjacent_find(ratios.begin(), ratios.end(), std::not_equal_to<>()) == ratios.end();
+}
+
+}  // namespace tg_indicators
@@ -0,0 +1,86 @@
+#include "tg_indicators/admission.h"
+
+#include <utility>
+
+#include "tg_indicators/parallel.h"
+
+namespace tg_indicators {
+namespace {
+
+// Requests this small are dominated by fixed overhead and would skew the model.
+constexpr double kMinObservedUnits = 4096.0;
+constexpr double kEwmaWeight = 0.1;
+
+}  // namespace
+
+AdmissionController::Ticket& AdmissionController::Ticket::operator=(Ticket&& other) noexcept {
+  if (this != &other) {
+    release();
+    owner_ = std::exchange(other.owner_, nullptr);
+    cost_units_ = other.cost_units_;
+    started_ = other.started_;
+  }
+  return *this;
+}
+
+void AdmissionController::Ticket::complete() {
+  if (owner_ != nullptr) {
+    owner_->observe(cost_units_, Clock::now() - started_);
+  }
+}
+
+void AdmissionController::Ticket::release() {
+  if (owner_ != nullptr) {
+    owner_->in_flight_.fetch_sub(1, std::memory_order_relaxed);
+    owner_ = nullptr;
+  }
+}
+
+AdmissionController::AdmissionController(AdmissionOptions options)
+    : shed_low_above_(options.shed_low_priority_above == 0 ? 2 * default_worker_count()
+                                                           : options.shed_low_priority_above),
+      max_in_flight_(options.max_in_flight == 0 ? 8 * default_worker_count()
+                                                : options.max_in_flight),
+      ns_per_unit_(options.initial_ns_per_unit) {}
+
+std::chrono::nanoseconds AdmissionController::estimate(double cost_units) const {
+  return std::chrono::nanoseconds(static_cast<int64_t>(cost_units * ns_per_unit()));
+}
+
+AdmissionController::Decision AdmissionController::admit(double cost_units,
+                                                         RequestPriority priority,
+                                                         Clock::time_point deadline,
+                                                         Ticket* ticket) {
+  const Clock::time_point now = Clock::now();
+  if (deadline != Clock::time_point::max() && now + estimate(cost_units) > deadline) {
+    rejected_deadline_.fetch_add(1, std::memory_order_relaxed);
+    return Decision::kDeadlineTooShort;
+  }
+  const size_t limit = priority == RequestPriority::kLow ? shed_low_above_ : max_in_flight_;
+  const size_t before = in_flight_.fetch_add(1, std::memory_order_relaxed);
+  if (before >= limit) {
+    in_flight_.fetch_sub(1, std::memory_order_relaxed);
+    shed_.fetch_add(1, std::memory_order_relaxed);
+    return Decision::kShed;
+  }
+  admitted_.fetch_add(1, std::memory_order_relaxed);
+  *ticket = Ticket();
+  ticket->owner_ = this;
+  ticket->cost_units_ = cost_units;
+  ticket->started_ = now;
+  return Decision::kAdmit;
+}
+
+void AdmissionController::observe(double cost_units, std::chrono::nanoseconds elapsed) {
+  if (cost_units < kMinObservedUnits) {
+    return;
+  }
+  const double sample = static_cast<double>(elapsed.count()) / cost_units;
+  double current = ns_per_unit_.load(std::memory_order_relaxed);
+  while (!ns_per_unit_.compare_exchange_weak(current,
+                                             current + kEwmaWeight * (sample - current),
+                                             std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace tg_indicators
@@ -0,0 +1,95 @@
+#include "tg_indicators/arena.h"
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+
+namespace tg_indicators {
+namespace {
+
+constexpr size_t kInitialArenaBytes = size_t{256} << 10;
+
+// Upstream of the monotonic resource: the heap, counting what a request borrowed
+// beyond the retained block so the next release can grow the block to fit.
+class OverflowResource final : public std::pmr::memory_resource {
+ public:
+  size_t borrowed{};
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    borrowed += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+class ThreadArena {
+ public:
+  std::pmr::memory_resource* resource() {
+    return depth_ > 0 ? &*monotonic_ : std::pmr::get_default_resource();
+  }
+
+  void enter() {
+    if (depth_++ == 0 && !monotonic_) {
+      reserve(kInitialArenaBytes);
+    }
+  }
+
+  void leave() {
+    if (--depth_ > 0) {
+      return;
+    }
+    monotonic_->release();
+    const size_t wanted = std::min(capacity_ + overflow_.borrowed, kMaxArenaBytes);
+    overflow_.borrowed = 0;
+    if (wanted > capacity_) {
+      reserve(wanted);
+    }
+  }
+
+  size_t capacity() const { return capacity_; }
+
+ private:
+  void reserve(size_t bytes) {
+    monotonic_.reset();
+    block_.reset(new std::byte[bytes]);
+    capacity_ = bytes;
+    monotonic_.emplace(block_.get(), capacity_, &overflow_);
+  }
+
+  OverflowResource overflow_;
+  std::unique_ptr<std::byte[]> block_;
+  size_t capacity_{};
+  std::optional<std::pmr::monotonic_buffer_resource> monotonic_;
+  int depth_{};
+};
+
+ThreadArena& thread_arena() {
+  thread_local ThreadArena arena;
+  return arena;
+}
+
+}  // namespace
+
+std::pmr::memory_resource* arena_resource() {
+  return thread_arena().resource();
+}
+
+ArenaScope::ArenaScope() {
+  thread_arena().enter();
+}
+
+ArenaScope::~ArenaScope() {
+  thread_arena().leave();
+}
+
+size_t arena_capacity() {
+  return thread_arena().capacity();
+}
+
+}  // namespace tg_indicators
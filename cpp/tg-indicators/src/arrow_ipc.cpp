@@ -0,0 +1,363 @@
+#include "tg_indicators/arrow_ipc.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+namespace tg_indicators {
+namespace {
+
+static_assert(std::endian::native == std::endian::little, "Arrow IPC buffers are written as-is");
+
+// Format constants from Arrow's Schema.fbs / Message.fbs.
+constexpr int16_t kMetadataV5 = 4;
+constexpr uint8_t kHeaderSchema = 1;
+constexpr uint8_t kHeaderRecordBatch = 3;
+constexpr uint8_t kTypeInt = 2;
+constexpr uint8_t kTypeFloatingPoint = 3;
+constexpr uint8_t kTypeUtf8 = 5;
+constexpr uint8_t kTypeTimestamp = 10;
+constexpr int16_t kPrecisionDouble = 2;
+constexpr int16_t kUnitMillisecond = 1;
+constexpr uint32_t kContinuation = 0xFFFFFFFF;
+constexpr char kMagic[] = "ARROW1";
+
+size_t padded8(size_t size) {
+  return (size + 7) & ~size_t{7};
+}
+
+// Back-to-front flatbuffer builder covering what the Arrow metadata needs: tables of
+// scalars and offsets, strings, vectors of offsets and vectors of 8-byte-word structs.
+// Positions are byte offsets from the end of the buffer, which stay valid as data is
+// prepended; children are built before the table that refers to them.
+class FlatBuilder {
+ public:
+  using Ref = uint32_t;
+
+  Ref add_string(std::string_view value) {
+    align(value.size() + 1, 4);
+    const char terminator = 0;
+    prepend(&terminator, 1);
+    prepend(value.data(), value.size());
+    push(static_cast<uint32_t>(value.size()));
+    return size();
+  }
+
+  Ref add_ref_vector(std::span<const Ref> refs) {
+    align(refs.size() * sizeof(Ref), sizeof(Ref));
+    for (size_t i = refs.size(); i-- > 0;) {
+      push_ref(refs[i]);
+    }
+    push(static_cast<uint32_t>(refs.size()));
+    return size();
+  }
+
+  // `words` holds `count` structs laid out as consecutive int64 words.
+  Ref add_struct_vector(std::span<const int64_t> words, size_t count) {
+    align(words.size_bytes(), 8);
+    prepend(words.data(), words.size_bytes());
+    push(static_cast<uint32_t>(count));
+    return size();
+  }
+
+  void start_table() {
+    fields_.clear();
+    table_start_ = size();
+  }
+
+  template <typename T>
+  void add_field(uint16_t id, T value) {
+    push(value);
+    fields_.push_back({id, size()});
+  }
+
+  void add_ref_field(uint16_t id, Ref ref) {
+    push_ref(ref);
+    fields_.push_back({id, size()});
+  }
+
+  Ref end_table() {
+    push(int32_t{0});  // soffset to the vtable, patched below
+    const uint32_t table = size();
+    uint16_t slots = 0;
+    for (const auto& field : fields_) {
+      slots = std::max<uint16_t>(slots, field.id + 1);
+    }
+    std::vector<uint16_t> vtable(2 + slots, 0);
+    vtable[0] = static_cast<uint16_t>(vtable.size() * sizeof(uint16_t));
+    vtable[1] = static_cast<uint16_t>(table - table_start_);
+    for (const auto& field : fields_) {
+      vtable[2 + field.id] = static_cast<uint16_t>(table - field.position);
+    }
+    for (size_t i = vtable.size(); i-- > 0;) {
+      push(vtable[i]);
+    }
+    const int32_t to_vtable = static_cast<int32_t>(size() - table);
+    std::memcpy(data_.data() + (data_.size() - table), &to_vtable, sizeof(to_vtable));
+    return table;
+  }
+
+  std::vector<uint8_t> finish(Ref root) {
+    align(sizeof(Ref), 8);
+    push_ref(root);
+    return std::move(data_);
+  }
+
+ private:
+  struct Field {
+    uint16_t id;
+    uint32_t position;
+  };
+
+  uint32_t size() const { return static_cast<uint32_t>(data_.size()); }
+
+  // Pads so that `bytes` prepended next end on an `alignment` boundary.
+  void align(size_t bytes, size_t alignment) {
+    const size_t pad = (alignment - (data_.size() + bytes) % alignment) % alignment;
+    data_.insert(data_.begin(), pad, 0);
+  }
+
+  void prepend(const void* bytes, size_t count) {
+    const auto* begin = static_cast<const uint8_t*>(bytes);
+    data_.insert(data_.begin(), begin, begin + count);
+  }
+
+  template <typename T>
+  void push(T value) {
+    align(sizeof(T), sizeof(T));
+    prepend(&value, sizeof(T));
+  }
+
+  void push_ref(Ref target) {
+    align(sizeof(Ref), sizeof(Ref));
+    push(static_cast<uint32_t>(size() + sizeof(Ref) - target));
+  }
+
+  std::vector<uint8_t> data_;
+  std::vector<Field> fields_;
+  uint32_t table_start_{};
+};
+
+FlatBuilder::Ref build_schema(FlatBuilder& builder, const std::vector<ArrowField>& fields) {
+  std::vector<FlatBuilder::Ref> refs;
+  for (const auto& field : fields) {
+    const auto name = builder.add_string(field.name);
+    const auto children = builder.add_ref_vector({});
+    const auto timezone = field.type == ArrowType::kTimestampMillis ? builder.add_string("UTC") : 0;
+    uint8_t type_id = kTypeUtf8;
+    builder.start_table();
+    switch (field.type) {
+      case ArrowType::kUtf8:
+        break;
+      case ArrowType::kInt64:
+        type_id = kTypeInt;
+        builder.add_field<int32_t>(0, 64);  // bitWidth
+        builder.add_field<uint8_t>(1, 1);   // is_signed
+        break;
+      case ArrowType::kTimestampMillis:
+        type_id = kTypeTimestamp;
+        builder.add_field<int16_t>(0, kUnitMillisecond);
+        builder.add_ref_field(1, timezone);
+        break;
+      case ArrowType::kFloat64:
+        type_id = kTypeFloatingPoint;
+        builder.add_field<int16_t>(0, kPrecisionDouble);
+        break;
+    }
+    const auto type = builder.end_table();
+    builder.start_table();
+    builder.add_ref_field(0, name);
+    builder.add_field<uint8_t>(1, 1);  // nullable
+    builder.add_field<uint8_t>(2, type_id);
+    builder.add_ref_field(3, type);
+    builder.add_ref_field(5, children);
+    refs.push_back(builder.end_table());
+  }
+  const auto vector = builder.add_ref_vector(refs);
+  builder.start_table();
+  builder.add_field<int16_t>(0, 0);  // little-endian
+  builder.add_ref_field(1, vector);
+  return builder.end_table();
+}
+
+std::vector<uint8_t> build_message(FlatBuilder& builder, uint8_t header_type, FlatBuilder::Ref header,
+                                   int64_t body_length) {
+  builder.start_table();
+  builder.add_field<int16_t>(0, kMetadataV5);
+  builder.add_field<uint8_t>(1, header_type);
+  builder.add_ref_field(2, header);
+  builder.add_field<int64_t>(3, body_length);
+  return builder.finish(builder.end_table());
+}
+
+// Appends `bytes` to the record batch body, padded to 8, and records its Buffer.
+void append_buffer(std::string& body, std::vector<int64_t>& buffers, const void* bytes, size_t size) {
+  buffers.push_back(static_cast<int64_t>(body.size()));
+  buffers.push_back(static_cast<int64_t>(size));
+  if (size > 0) {
+    body.append(static_cast<const char*>(bytes), size);
+  }
+  body.resize(padded8(body.size()), '\0');
+}
+
+}  // namespace
+
+ArrowFileWriter::ArrowFileWriter(std::ostream& out, std::vector<ArrowField> fields)
+    : out_(out), fields_(std::move(fields)) {
+  for (const auto& field : fields_) {
+    columns_.push_back({});
+    columns_.back().type = field.type;
+  }
+  const char magic[8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+  write(magic, sizeof(magic));
+  FlatBuilder builder;
+  const auto schema = build_schema(builder, fields_);
+  write_message(build_message(builder, kHeaderSchema, schema, 0), {});
+}
+
+ArrowFileWriter::Column& ArrowFileWriter::column(size_t index, ArrowType type) {
+  if (index >= columns_.size() || columns_[index].type != type) {
+    throw std::invalid_argument("value does not match Arrow column " + std::to_string(index));
+  }
+  ++columns_[index].rows;
+  return columns_[index];
+}
+
+void ArrowFileWriter::append(size_t index, std::string_view value) {
+  Column& target = column(index, ArrowType::kUtf8);
+  target.chars.append(value);
+  if (target.chars.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+    throw std::length_error("Arrow utf8 column exceeds 2 GiB in one batch");
+  }
+  target.offsets.push_back(static_cast<int32_t>(target.chars.size()));
+}
+
+void ArrowFileWriter::append(size_t index, int64_t value) {
+  const ArrowType type = index < fields_.size() && fields_[index].type == ArrowType::kInt64
+                             ? ArrowType::kInt64
+                             : ArrowType::kTimestampMillis;
+  column(index, type).ints.push_back(value);
+}
+
+void ArrowFileWriter::append(size_t index, double value) {
+  column(index, ArrowType::kFloat64).doubles.push_back(value);
+}
+
+size_t ArrowFileWriter::pending_rows() const {
+  return columns_.empty() ? 0 : columns_.front().rows;
+}
+
+void ArrowFileWriter::flush() {
+  const size_t rows = pending_rows();
+  if (rows == 0 || closed_) {
+    return;
+  }
+  std::string body;
+  std::vector<int64_t> nodes;
+  std::vector<int64_t> buffers;
+  for (Column& column : columns_) {
+    if (column.rows != rows) {
+      throw std::logic_error("Arrow columns have different lengths");
+    }
+    int64_t null_count = 0;
+    if (column.type == ArrowType::kFloat64) {
+      std::vector<uint8_t> validity((rows + 7) / 8, 0);
+      for (size_t i = 0; i < rows; ++i) {
+        if (std::isnan(column.doubles[i])) {
+          ++null_count;
+        } else {
+          validity[i / 8] |= static_cast<uint8_t>(1U << (i % 8));
+        }
+      }
+      append_buffer(body, buffers, validity.data(), null_count == 0 ? 0 : validity.size());
+      append_buffer(body, buffers, column.doubles.data(), rows * sizeof(double));
+    } else if (column.type == ArrowType::kUtf8) {
+      append_buffer(body, buffers, nullptr, 0);
+      append_buffer(body, buffers, column.offsets.data(), column.offsets.size() * sizeof(int32_t));
+      append_buffer(body, buffers, column.chars.data(), column.chars.size());
+    } else {
+      append_buffer(body, buffers, nullptr, 0);
+      append_buffer(body, buffers, column.ints.data(), rows * sizeof(int64_t));
+    }
+    nodes.push_back(static_cast<int64_t>(rows));
+    nodes.push_back(null_count);
+    const ArrowType type = column.type;
+    column = {};
+    column.type = type;
+  }
+
+  FlatBuilder builder;
+  const auto node_vector = builder.add_struct_vector(nodes, nodes.size() / 2);
+  const auto buffer_vector = builder.add_struct_vector(buffers, buffers.size() / 2);
+  builder.start_table();
+  builder.add_field<int64_t>(0, static_cast<int64_t>(rows));
+  builder.add_ref_field(1, node_vector);
+  builder.add_ref_field(2, buffer_vector);
+  const auto batch = builder.end_table();
+  batches_.push_back(write_message(
+      build_message(builder, kHeaderRecordBatch, batch, static_cast<int64_t>(body.size())), body));
+}
+
+void ArrowFileWriter::close() {
+  if (closed_) {
+    return;
+  }
+  flush();
+  closed_ = true;
+  const uint32_t end_of_stream[2] = {kContinuation, 0};
+  write(end_of_stream, sizeof(end_of_stream));
+
+  // Block is {offset: long, metaDataLength: int, <pad>, bodyLength: long}.
+  std::vector<int64_t> blocks;
+  for (const Block& block : batches_) {
+    blocks.push_back(block.offset);
+    blocks.push_back(block.metadata_length);
+    blocks.push_back(block.body_length);
+  }
+  FlatBuilder builder;
+  const auto schema = build_schema(builder, fields_);
+  const auto dictionaries = builder.add_struct_vector({}, 0);
+  const auto record_batches = builder.add_struct_vector(blocks, batches_.size());
+  builder.start_table();
+  builder.add_field<int16_t>(0, kMetadataV5);
+  builder.add_ref_field(1, schema);
+  builder.add_ref_field(2, dictionaries);
+  builder.add_ref_field(3, record_batches);
+  const std::vector<uint8_t> footer = builder.finish(builder.end_table());
+  write(footer.data(), footer.size());
+  const int32_t footer_length = static_cast<int32_t>(footer.size());
+  write(&footer_length, sizeof(footer_length));
+  write(kMagic, 6);
+  out_.flush();
+  if (!out_) {
+    throw std::runtime_error("failed to write Arrow IPC file");
+  }
+}
+
+ArrowFileWriter::Block ArrowFileWriter::write_message(const std::vector<uint8_t>& metadata,
+                                                      const std::string& body) {
+  Block block;
+  block.offset = position_;
+  const size_t padded = padded8(metadata.size());
+  const int32_t length = static_cast<int32_t>(padded);
+  write(&kContinuation, sizeof(kContinuation));
+  write(&length, sizeof(length));
+  write(metadata.data(), metadata.size());
+  const char zeros[8] = {};
+  write(zeros, padded - metadata.size());
+  write(body.data(), body.size());
+  block.metadata_length = static_cast<int32_t>(sizeof(kContinuation) + sizeof(length) + padded);
+  block.body_length = static_cast<int64_t>(body.size());
+  return block;
+}
+
+void ArrowFileWriter::write(const void* data, size_t size) {
+  out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+  position_ += static_cast<int64_t>(size);
+}
+
+}  // namespace tg_indicators
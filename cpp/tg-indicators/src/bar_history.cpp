@@ -0,0 +1,635 @@
+#include "tg_indicators/bar_history.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <string_view>
+
+#include "tg_indicators/fixed_point.h"
+
+namespace tg_indicators {
+namespace {
+
+// Big-endian bit stream into a byte string.
+class BitWriter {
+ public:
+  explicit BitWriter(std::string& out) : out_(out) {}
+
+  // Appends the low `bits` bits of `value`, 1 <= bits <= 64.
+  void put(uint64_t value, int bits) {
+    if (bits > 32) {
+      put(value >> 32, bits - 32);
+      bits = 32;
+    }
+    pending_ = (pending_ << bits) | (value & ((uint64_t{1} << bits) - 1));
+    pending_bits_ += bits;
+    while (pending_bits_ >= 8) {
+      pending_bits_ -= 8;
+      out_.push_back(static_cast<char>(pending_ >> pending_bits_));
+    }
+  }
+
+  void finish() {
+    if (pending_bits_ > 0) {
+      out_.push_back(static_cast<char>(pending_ << (8 - pending_bits_)));
+      pending_bits_ = 0;
+    }
+  }
+
+ private:
+  std::string& out_;
+  uint64_t pending_{0};
+  int pending_bits_{0};
+};
+
+// Zigzagged integers: "0" for zero, else a run of ones naming the payload width.
+constexpr std::array<int, 6> kBucketBits = {0, 6, 13, 20, 32, 64};
+
+// Reads a BitWriter stream with one unaligned 8-byte load per field. Chunks end in
+// kReadPadding zero bytes, so the load never runs past the buffer.
+constexpr size_t kReadPadding = 8;
+
+class BitReader {
+ public:
+  // Reads from byte `offset` of `in`. Readers of one chunk share `in`, so the compiler
+  // keeps a single base pointer and one bit position per stream.
+  BitReader(std::string_view in, size_t offset) : in_(in.data()), pos_(offset * 8) {}
+
+  uint64_t get(int bits) {
+    if (bits > 32) {
+      const uint64_t high = get(bits - 32);
+      return (high << 32) | get(32);
+    }
+    const uint64_t value = window() >> (64 - bits);
+    pos_ += static_cast<size_t>(bits);
+    return value;
+  }
+
+  // A put_bucketed value. The prefix and payload come from one window with no
+  // data-dependent branch, except for the rare 64-bit payload.
+  uint64_t bucketed() {
+    const uint64_t word = window();
+    const int run = std::min(std::countl_one(word), 5);
+    if (run == 5) {
+      pos_ += 5;
+      return get(64);
+    }
+    // kBucketBits[run], from a register rather than a load on the decode chain.
+    const int bits = static_cast<int>((0x20140D0600ULL >> (8 * run)) & 0xff);
+    pos_ += static_cast<size_t>(run + 1 + bits);
+    return ((word << (run + 1)) >> 1) >> (63 - bits);
+  }
+
+  // An LEB128 varint. Up to seven bytes are assembled from one window without
+  // branching on the length.
+  uint64_t varint() {
+    const uint64_t word = window();
+    const uint64_t stops = ~word & 0x8080808080808000ULL;
+    if (stops == 0) {
+      return long_varint();
+    }
+    const int bytes = std::countl_zero(stops) / 8 + 1;
+    uint64_t value = 0;
+    for (int group = 0; group < 7; ++group) {
+      value |= ((word >> (56 - 8 * group)) & 0x7f) << (7 * group);
+    }
+    pos_ += static_cast<size_t>(8 * bytes);
+    return value & ((uint64_t{1} << (7 * bytes)) - 1);
+  }
+
+ private:
+  uint64_t long_varint() {
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7) {
+      const uint64_t byte = get(8);
+      value |= (byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+  }
+
+  // The next 57+ bits, most significant first.
+  uint64_t window() const {
+    uint64_t word;
+    std::memcpy(&word, in_ + (pos_ >> 3), sizeof(word));
+    if constexpr (std::endian::native == std::endian::little) {
+      word = __builtin_bswap64(word);
+    }
+    return word << (pos_ & 7);
+  }
+
+  const char* in_;
+  size_t pos_{0};
+};
+
+uint64_t zigzag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+  return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+
+int bucket_of(uint64_t value) {
+  if (value == 0) {
+    return 0;
+  }
+  int bucket = 1;
+  while (bucket < 5 && value >> kBucketBits[static_cast<size_t>(bucket)] != 0) {
+    ++bucket;
+  }
+  return bucket;
+}
+
+int bucketed_bits(uint64_t value) {
+  const int bucket = bucket_of(value);
+  return std::min(bucket + 1, 5) + kBucketBits[static_cast<size_t>(bucket)];
+}
+
+void put_bucketed(BitWriter& out, uint64_t value) {
+  const int bucket = bucket_of(value);
+  const int prefix = std::min(bucket + 1, 5);
+  out.put(((uint64_t{1} << bucket) - 1) << (prefix - bucket), prefix);
+  if (bucket > 0) {
+    out.put(value, kBucketBits[static_cast<size_t>(bucket)]);
+  }
+}
+
+void put_varint(BitWriter& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.put((value & 0x7f) | 0x80, 8);
+    value >>= 7;
+  }
+  out.put(value, 8);
+}
+
+// Gorilla XOR: "0" repeats the previous value; "10" reuses the previous window of
+// meaningful bits; "11" sends a new window as 6 bits of leading zeros and 6 bits of
+// width - 1, then the bits.
+struct XorState {
+  uint64_t prev{0};
+  int lead{0};
+  int width{0};
+};
+
+void put_xor(BitWriter& out, XorState& state, double value) {
+  const uint64_t bits = std::bit_cast<uint64_t>(value);
+  const uint64_t delta = bits ^ state.prev;
+  state.prev = bits;
+  if (delta == 0) {
+    out.put(0, 1);
+    return;
+  }
+  const int lead = std::countl_zero(delta);
+  const int trail = std::countr_zero(delta);
+  if (state.width > 0 && lead >= state.lead && trail >= 64 - state.lead - state.width) {
+    out.put(0b10, 2);
+    out.put(delta >> (64 - state.lead - state.width), state.width);
+    return;
+  }
+  state.lead = lead;
+  state.width = 64 - lead - trail;
+  out.put(0b11, 2);
+  out.put(static_cast<uint64_t>(lead), 6);
+  out.put(static_cast<uint64_t>(state.width - 1), 6);
+  out.put(delta >> trail, state.width);
+}
+
+double get_xor(BitReader& in, XorState& state) {
+  if (in.get(1) != 0) {
+    if (in.get(1) != 0) {
+      state.lead = static_cast<int>(in.get(6));
+      state.width = static_cast<int>(in.get(6)) + 1;
+    }
+    state.prev ^= in.get(state.width) << (64 - state.lead - state.width);
+  }
+  return std::bit_cast<double>(state.prev);
+}
+
+// `value` in 1e-4 units when it converts back to the identical double. Bounded so
+// that units, their differences and the scaling stay exact.
+bool to_units(double value, int64_t& units) {
+  constexpr double kLimit = static_cast<double>(int64_t{1} << 53) / static_cast<double>(kPriceScale);
+  if (!(std::abs(value) < kLimit)) {
+    return false;
+  }
+  units = std::llround(value * static_cast<double>(kPriceScale));
+  return std::bit_cast<uint64_t>(fixed_to_double(units)) == std::bit_cast<uint64_t>(value);
+}
+
+uint64_t magnitude(int64_t value) {
+  return value < 0 ? ~static_cast<uint64_t>(value) + 1 : static_cast<uint64_t>(value);
+}
+
+// Largest common divisor of `values`, 1 when there is none usable.
+int64_t common_step(std::span<const int64_t> values) {
+  uint64_t step = 0;
+  for (const int64_t value : values) {
+    step = std::gcd(step, magnitude(value));
+  }
+  return step == 0 || step > static_cast<uint64_t>(INT64_MAX) ? 1 : static_cast<int64_t>(step);
+}
+
+int64_t wrapping_sub(int64_t a, int64_t b) {
+  return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+}
+
+int64_t wrapping_add(int64_t a, int64_t b) {
+  return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+
+int64_t wrapping_mul(int64_t a, int64_t b) {
+  return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+}
+
+// Integer column stream of zigzagged multiples of its common step.
+void put_scaled(std::string& stream, std::span<const int64_t> values) {
+  BitWriter out(stream);
+  const int64_t step = common_step(values);
+  out.put(static_cast<uint64_t>(step), 64);
+  for (const int64_t value : values) {
+    put_bucketed(out, zigzag(value / step));
+  }
+  out.finish();
+}
+
+int64_t get_step(BitReader& in) {
+  return static_cast<int64_t>(in.get(64));
+}
+
+uint64_t scaled_bits(std::span<const int64_t> values) {
+  const int64_t step = common_step(values);
+  uint64_t bits = 0;
+  for (const int64_t value : values) {
+    bits += static_cast<uint64_t>(bucketed_bits(zigzag(value / step)));
+  }
+  return bits;
+}
+
+// Price columns of a chunk in units, or false when any price is not exact in units.
+struct PriceUnits {
+  std::vector<int64_t> open;
+  std::vector<int64_t> high;
+  std::vector<int64_t> low;
+  std::vector<int64_t> close;
+};
+
+bool price_units(std::span<const OHLCV> bars, PriceUnits& units) {
+  const size_t n = bars.size();
+  units.open.resize(n);
+  units.high.resize(n);
+  units.low.resize(n);
+  units.close.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    if (!to_units(bars[i].open, units.open[i]) || !to_units(bars[i].high, units.high[i]) ||
+        !to_units(bars[i].low, units.low[i]) || !to_units(bars[i].close, units.close[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A chunk is a flags byte, the byte offset of every column stream after the first,
+// then the streams. Separate streams let decode_chunk fill all columns in one loop
+// whose per-column bit positions advance independently of each other.
+enum Column : size_t { kTs, kClose, kOpen, kHigh, kLow, kVolume, kAmount, kColumns };
+constexpr uint8_t kExactPrices = 1;
+constexpr uint8_t kExactAmount = 2;
+constexpr uint8_t kTurnover = 4;
+constexpr size_t kHeaderBytes = 1 + (kColumns - 1) * sizeof(uint32_t);
+
+void put_xor_column(std::string& stream, std::span<const OHLCV> bars, double OHLCV::*column) {
+  BitWriter out(stream);
+  XorState state;
+  for (const OHLCV& bar : bars) {
+    put_xor(out, state, bar.*column);
+  }
+  out.finish();
+}
+
+std::string encode_chunk(std::span<const OHLCV> bars) {
+  const size_t n = bars.size();
+  std::array<std::string, kColumns> streams;
+  uint8_t flags = 0;
+
+  {
+    BitWriter out(streams[kTs]);
+    out.put(static_cast<uint64_t>(bars[0].ts_millis), 64);
+    int64_t prev_delta = 0;
+    for (size_t i = 1; i < n; ++i) {
+      const int64_t delta = wrapping_sub(bars[i].ts_millis, bars[i - 1].ts_millis);
+      put_bucketed(out, zigzag(wrapping_sub(delta, prev_delta)));
+      prev_delta = delta;
+    }
+    out.finish();
+  }
+
+  // Residuals against the close (and, for high/low, the bar's body), so they share
+  // the chunk's tick as a common step.
+  PriceUnits units;
+  const bool exact_prices = price_units(bars, units);
+  if (exact_prices) {
+    flags |= kExactPrices;
+    std::vector<int64_t> residual(n);
+    for (size_t i = 0; i < n; ++i) {
+      residual[i] = units.close[i] - (i == 0 ? 0 : units.close[i - 1]);
+    }
+    put_scaled(streams[kClose], residual);
+    for (size_t i = 0; i < n; ++i) {
+      residual[i] = units.open[i] - units.close[i == 0 ? 0 : i - 1];
+    }
+    put_scaled(streams[kOpen], residual);
+    for (size_t i = 0; i < n; ++i) {
+      residual[i] = units.high[i] - std::max(units.open[i], units.close[i]);
+    }
+    put_scaled(streams[kHigh], residual);
+    for (size_t i = 0; i < n; ++i) {
+      residual[i] = std::min(units.open[i], units.close[i]) - units.low[i];
+    }
+    put_scaled(streams[kLow], residual);
+  } else {
+    put_xor_column(streams[kClose], bars, &OHLCV::close);
+    put_xor_column(streams[kOpen], bars, &OHLCV::open);
+    put_xor_column(streams[kHigh], bars, &OHLCV::high);
+    put_xor_column(streams[kLow], bars, &OHLCV::low);
+  }
+
+  std::vector<int64_t> volume(n);
+  for (size_t i = 0; i < n; ++i) {
+    volume[i] = bars[i].volume;
+  }
+  {
+    BitWriter out(streams[kVolume]);
+    const int64_t lot = common_step(volume);
+    out.put(static_cast<uint64_t>(lot), 64);
+    for (const int64_t value : volume) {
+      put_varint(out, zigzag(value / lot));
+    }
+    out.finish();
+  }
+
+  std::vector<int64_t> amount(n);
+  bool exact_amount = true;
+  for (size_t i = 0; i < n && exact_amount; ++i) {
+    exact_amount = to_units(bars[i].amount, amount[i]);
+  }
+  if (exact_amount) {
+    flags |= kExactAmount;
+    std::vector<int64_t> from_previous(n);
+    for (size_t i = 0; i < n; ++i) {
+      from_previous[i] = amount[i] - (i == 0 ? 0 : amount[i - 1]);
+    }
+    std::vector<int64_t> from_turnover;
+    if (exact_prices) {
+      from_turnover.resize(n);
+      for (size_t i = 0; i < n; ++i) {
+        from_turnover[i] = wrapping_sub(amount[i], wrapping_mul(volume[i], units.close[i]));
+      }
+    }
+    const bool turnover = exact_prices && scaled_bits(from_turnover) < scaled_bits(from_previous);
+    flags |= turnover ? kTurnover : 0;
+    put_scaled(streams[kAmount], turnover ? from_turnover : from_previous);
+  } else {
+    put_xor_column(streams[kAmount], bars, &OHLCV::amount);
+  }
+
+  std::string bytes(1, static_cast<char>(flags));
+  uint32_t offset = static_cast<uint32_t>(kHeaderBytes + streams[kTs].size());
+  for (size_t column = 1; column < kColumns; ++column) {
+    bytes.append(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    offset += static_cast<uint32_t>(streams[column].size());
+  }
+  for (const std::string& stream : streams) {
+    bytes += stream;
+  }
+  bytes.append(kReadPadding, '\0');
+  return bytes;
+}
+
+void decode_chunk(std::string_view bytes, size_t n, OHLCV* bars) {
+  const auto flags = static_cast<uint8_t>(bytes[0]);
+  auto stream = [&](Column column) {
+    uint32_t offset = kHeaderBytes;
+    if (column != kTs) {
+      std::memcpy(&offset, bytes.data() + 1 + (column - 1) * sizeof(offset), sizeof(offset));
+    }
+    return BitReader(bytes, offset);
+  };
+  BitReader ts = stream(kTs);
+  BitReader close = stream(kClose);
+  BitReader open = stream(kOpen);
+  BitReader high = stream(kHigh);
+  BitReader low = stream(kLow);
+  BitReader volume = stream(kVolume);
+  BitReader amount = stream(kAmount);
+
+  const bool exact_prices = (flags & kExactPrices) != 0;
+  const bool exact_amount = (flags & kExactAmount) != 0;
+  const bool turnover = (flags & kTurnover) != 0;
+  const int64_t close_step = exact_prices ? get_step(close) : 0;
+  const int64_t open_step = exact_prices ? get_step(open) : 0;
+  const int64_t high_step = exact_prices ? get_step(high) : 0;
+  const int64_t low_step = exact_prices ? get_step(low) : 0;
+  const int64_t lot = get_step(volume);
+  const int64_t amount_step = exact_amount ? get_step(amount) : 0;
+  XorState close_xor;
+  XorState open_xor;
+  XorState high_xor;
+  XorState low_xor;
+  XorState amount_xor;
+
+  int64_t ts_millis = static_cast<int64_t>(ts.get(64));
+  int64_t ts_delta = 0;
+  int64_t close_units = 0;
+  int64_t amount_units = 0;
+  for (size_t i = 0; i < n; ++i) {
+    OHLCV& bar = bars[i];
+    if (i > 0) {
+      ts_delta = wrapping_add(ts_delta, unzigzag(ts.bucketed()));
+      ts_millis = wrapping_add(ts_millis, ts_delta);
+    }
+    bar.ts_millis = ts_millis;
+    if (exact_prices) {
+      const int64_t prev_close = close_units;
+      close_units = prev_close + unzigzag(close.bucketed()) * close_step;
+      const int64_t open_units = (i == 0 ? close_units : prev_close) + unzigzag(open.bucketed()) * open_step;
+      const int64_t high_units =
+          std::max(open_units, close_units) + unzigzag(high.bucketed()) * high_step;
+      const int64_t low_units = std::min(open_units, close_units) - unzigzag(low.bucketed()) * low_step;
+      bar.open = fixed_to_double(open_units);
+      bar.high = fixed_to_double(high_units);
+      bar.low = fixed_to_double(low_units);
+      bar.close = fixed_to_double(close_units);
+    } else {
+      bar.close = get_xor(close, close_xor);
+      bar.open = get_xor(open, open_xor);
+      bar.high = get_xor(high, high_xor);
+      bar.low = get_xor(low, low_xor);
+    }
+    bar.volume = unzigzag(volume.varint()) * lot;
+    if (exact_amount) {
+      const int64_t residual = wrapping_mul(unzigzag(amount.bucketed()), amount_step);
+      amount_units =
+          wrapping_add(turnover ? wrapping_mul(bar.volume, close_units) : amount_units, residual);
+      bar.amount = fixed_to_double(amount_units);
+    } else {
+      bar.amount = get_xor(amount, amount_xor);
+    }
+  }
+}
+
+}  // namespace
+
+size_t BarHistory::append(std::span<const OHLCV> bars) {
+  size_t appended = 0;
+  for (const OHLCV& bar : bars) {
+    if (size() > 0 && bar.ts_millis <= last_ts_millis_) {
+      continue;
+    }
+    if (hot_.empty()) {
+      hot_.reserve(kChunkBars);
+    }
+    hot_.push_back(bar);
+    last_ts_millis_ = bar.ts_millis;
+    ++appended;
+    if (hot_.size() == kChunkBars) {
+      Chunk chunk{hot_.size(), encode_chunk(hot_)};
+      chunk.bits.shrink_to_fit();
+      sealed_bars_ += chunk.count;
+      sealed_.push_back(std::move(chunk));
+      hot_.clear();
+    }
+  }
+  return appended;
+}
+
+void BarHistory::read(std::vector<OHLCV>& out, size_t first) const {
+  if (first >= size()) {
+    return;
+  }
+  const size_t base = out.size();
+  out.resize(base + size() - first);
+  OHLCV* next = out.data() + base;
+  size_t start = 0;
+  for (const Chunk& chunk : sealed_) {
+    const size_t end = start + chunk.count;
+    if (end > first) {
+      if (first <= start) {
+        decode_chunk(chunk.bits, chunk.count, next);
+        next += chunk.count;
+      } else {
+        std::vector<OHLCV> partial(chunk.count);
+        decode_chunk(chunk.bits, chunk.count, partial.data());
+        next = std::copy(partial.begin() + static_cast<std::ptrdiff_t>(first - start), partial.end(), next);
+      }
+    }
+    start = end;
+  }
+  const size_t hot_first = first > sealed_bars_ ? first - sealed_bars_ : 0;
+  std::copy(hot_.begin() + static_cast<std::ptrdiff_t>(hot_first), hot_.end(), next);
+}
+
+size_t BarHistory::memory_bytes() const {
+  size_t bytes = sealed_.capacity() * sizeof(Chunk) + hot_.capacity() * sizeof(OHLCV);
+  for (const Chunk& chunk : sealed_) {
+    bytes += chunk.bits.capacity();
+  }
+  return bytes;
+}
+
+size_t HistoryStore::append(const std::string& session, std::span<const OHLCV> bars) {
+  std::shared_ptr<Entry> entry;
+  {
+    Shard& shard = shards_[std::hash<std::string>{}(session) % shards_.size()];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto& slot = shard.entries[session];
+    if (!slot) {
+      slot = std::make_shared<Entry>();
+    }
+    entry = slot;
+  }
+  std::lock_guard<std::mutex> lock(entry->mutex);
+  entry->last_used = std::chrono::steady_clock::now();
+  return entry->history.append(bars);
+}
+
+std::shared_ptr<HistoryStore::Entry> HistoryStore::find(const std::string& session) const {
+  const Shard& shard = shards_[std::hash<std::string>{}(session) % shards_.size()];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  const auto it = shard.entries.find(session);
+  return it == shard.entries.end() ? nullptr : it->second;
+}
+
+bool HistoryStore::read(const std::string& session, std::vector<OHLCV>& out, size_t max_bars) const {
+  const std::shared_ptr<Entry> entry = find(session);
+  if (!entry) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(entry->mutex);
+  entry->last_used = std::chrono::steady_clock::now();
+  const size_t stored = entry->history.size();
+  entry->history.read(out, max_bars == 0 || max_bars >= stored ? 0 : stored - max_bars);
+  return true;
+}
+
+size_t HistoryStore::bar_count(const std::string& session) const {
+  const std::shared_ptr<Entry> entry = find(session);
+  if (!entry) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(entry->mutex);
+  return entry->history.size();
+}
+
+size_t HistoryStore::size() const {
+  size_t total = 0;
+  for (const Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    total += shard.entries.size();
+  }
+  return total;
+}
+
+size_t HistoryStore::memory_bytes() const {
+  size_t total = 0;
+  for (const Shard& shard : shards_) {
+    std::vector<std::shared_ptr<Entry>> entries;
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      for (const auto& [session, entry] : shard.entries) {
+        entries.push_back(entry);
+      }
+    }
+    for (const auto& entry : entries) {
+      std::lock_guard<std::mutex> lock(entry->mutex);
+      total += entry->history.memory_bytes();
+    }
+  }
+  return total;
+}
+
+size_t HistoryStore::evict_idle(std::chrono::steady_clock::duration max_idle) {
+  const auto cutoff = std::chrono::steady_clock::now() - max_idle;
+  size_t evicted = 0;
+  for (Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    std::erase_if(shard.entries, [&](const auto& item) {
+      // Entries are only handed out under the shard lock, so one nobody else holds
+      // now stays unreachable until it is erased.
+      if (item.second.use_count() != 1) {
+        return false;
+      }
+      std::lock_guard<std::mutex> entry_lock(item.second->mutex);
+      const bool idle = item.second->last_used < cutoff;
+      evicted += idle;
+      return idle;
+    });
+  }
+  return evicted;
+}
+
+}  // namespace tg_indicators
@@ -0,0 +1,358 @@
+#include "tg_indicators/batch_cli.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+
+#include "tg_indicators/arrow_ipc.h"
+#include "tg_indicators/indicators/registry.h"
+#include "tg_indicators/parallel.h"
+#include "tg_indicators/parquet_reader.h"
+#include "tg_indicators/time_util.h"
+
+namespace tg_indicators {
+namespace {
+
+constexpr const char* kUsage =
+    "usage: tg-indicators batch --root DIR --indicator NAME [--period daily|minute1|minute5]\n"
+    "                           [--param key=value]... [--spec NAME[:key=value,...]]...\n"
+    "                           [--symbols A,B,...] [--start YYYY-MM-DD] [--end YYYY-MM-DD]\n"
+    "                           [--threads N] [--format csv|arrow] [--chunk-rows N] [--out FILE]\n";
+
+// Symbols in flight per worker: enough to balance uneven partitions, few enough that a
+// block of computed series stays small next to the universe.
+constexpr size_t kSymbolsPerWorker = 4;
+
+std::vector<std::string> split_csv(const std::string& value) {
+  std::vector<std::string> parts;
+  size_t start = 0;
+  while (start <= value.size()) {
+    const size_t comma = value.find(',', start);
+    const size_t end = comma == std::string::npos ? value.size() : comma;
+    if (end > start) {
+      parts.push_back(value.substr(start, end - start));
+    }
+    if (comma == std::string::npos) {
+      break;
+    }
+    start = comma + 1;
+  }
+  return parts;
+}
+
+std::vector<std::string> discover_symbols(const std::string& root, const std::string& period) {
+  const std::filesystem::path dir = std::filesystem::path(root) / "data" / "bars" / period;
+  std::vector<std::string> symbols;
+  if (!std::filesystem::is_directory(dir)) {
+    return symbols;
+  }
+  for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+    const std::string name = entry.path().filename().string();
+    if (entry.is_directory() && name.rfind("symbol=", 0) == 0) {
+      symbols.push_back(name.substr(7));
+    }
+  }
+  std::sort(symbols.begin(), symbols.end());
+  return symbols;
+}
+
+void append_double(std::string& out, double value) {
+  if (std::isnan(value)) {
+    return;
+  }
+  char buffer[32];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+void append_int(std::string& out, int64_t value) {
+  char buffer[24];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+void parse_param(const std::string& raw, const char* flag, Params& params) {
+  const size_t eq = raw.find('=');
+  if (eq == std::string::npos || eq == 0) {
+    throw std::invalid_argument(std::string(flag) + " expects key=value, got " + raw);
+  }
+  params[raw.substr(0, eq)] = parse_decimal_string(raw.substr(eq + 1), flag);
+}
+
+std::string spec_label(const IndicatorSpec& spec) {
+  const std::map<std::string, double> sorted(spec.params.begin(), spec.params.end());
+  std::ostringstream label;
+  label << normalize_indicator_name(spec.indicator) << '(';
+  const char* separator = "";
+  for (const auto& [name, value] : sorted) {
+    label << separator << name << '=' << value;
+    separator = ",";
+  }
+  label << ')';
+  return label.str();
+}
+
+bool has_suffix(const std::string& value, const std::string& suffix) {
+  return value.size() >= suffix.size() &&
+         value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// One output column of the panel.
+struct PanelColumn {
+  size_t spec{};
+  std::string key;
+  std::string name;
+};
+
+struct SymbolOutput {
+  std::vector<int64_t> ts;
+  std::vector<std::vector<double>> columns;  // PanelColumn order; Arrow output only
+  std::string csv;
+  std::vector<std::string> spec_errors;  // per spec; empty when it computed
+  std::string skipped_reason;
+};
+
+}  // namespace
+
+BatchOptions parse_batch_args(const std::vector<std::string>& args) {
+  BatchOptions options;
+  options.start_millis = kUnboundedStartMillis;
+  options.end_millis = kUnboundedEndMillis;
+  IndicatorSpec* param_target = nullptr;
+  bool format_set = false;
+  for (size_t i = 0; i < args.size(); ++i) {
+    const std::string& flag = args[i];
+    auto value = [&]() -> const std::string& {
+      if (i + 1 >= args.size()) {
+        throw std::invalid_argument("missing value for " + flag);
+      }
+      return args[++i];
+    };
+    if (flag == "--root") {
+      options.root = value();
+    } else if (flag == "--period") {
+      options.period = value();
+    } else if (flag == "--symbols") {
+      options.symbols = split_csv(value());
+    } else if (flag == "--start") {
+      options.start_millis = parse_date_millis(value());
+    } else if (flag == "--end") {
+      options.end_millis = parse_date_millis(value());
+    } else if (flag == "--indicator") {
+      options.specs.push_back({value(), {}});
+      param_target = &options.specs.back();
+    } else if (flag == "--param") {
+      if (param_target == nullptr) {
+        throw std::invalid_argument("--param must follow --indicator");
+      }
+      parse_param(value(), "--param", param_target->params);
+    } else if (flag == "--spec") {
+      const std::string& raw = value();
+      const size_t colon = raw.find(':');
+      IndicatorSpec spec{raw.substr(0, colon), {}};
+      if (colon != std::string::npos) {
+        for (const auto& param : split_csv(raw.substr(colon + 1))) {
+          parse_param(param, "--spec", spec.params);
+        }
+      }
+      options.specs.push_back(std::move(spec));
+      param_target = nullptr;
+    } else if (flag == "--threads") {
+      options.threads = static_cast<size_t>(std::stoul(value()));
+    } else if (flag == "--format") {
+      const std::string& format = value();
+      if (format != "csv" && format != "arrow") {
+        throw std::invalid_argument("--format expects csv or arrow, got " + format);
+      }
+      options.format = format == "arrow" ? BatchFormat::kArrow : BatchFormat::kCsv;
+      format_set = true;
+    } else if (flag == "--chunk-rows") {
+      options.chunk_rows = static_cast<size_t>(std::stoul(value()));
+      if (options.chunk_rows == 0) {
+        throw std::invalid_argument("--chunk-rows must be positive");
+      }
+    } else if (flag == "--out") {
+      options.out_path = value();
+    } else {
+      throw std::invalid_argument("unknown flag " + flag);
+    }
+  }
+  if (options.root.empty() || options.specs.empty()) {
+    throw std::invalid_argument("--root and --indicator or --spec are required");
+  }
+  std::vector<std::string> labels;
+  for (const auto& spec : options.specs) {
+    if (!create_indicator(spec.indicator)) {
+      throw std::invalid_argument("unknown indicator: " + spec.indicator);
+    }
+    labels.push_back(spec_label(spec));
+    if (std::count(labels.begin(), labels.end(), labels.back()) > 1) {
+      throw std::invalid_argument("duplicate indicator spec " + labels.back());
+    }
+  }
+  if (!format_set && (has_suffix(options.out_path, ".arrow") || has_suffix(options.out_path, ".feather") ||
+                      has_suffix(options.out_path, ".ipc"))) {
+    options.format = BatchFormat::kArrow;
+  }
+  return options;
+}
+
+void run_batch(const BatchOptions& options, std::ostream& out, std::ostream& log) {
+  const std::vector<std::string> symbols =
+      options.symbols.empty() ? discover_symbols(options.root, options.period) : options.symbols;
+  std::vector<std::unique_ptr<IIndicator>> indicators;
+  std::vector<PanelColumn> panel;
+  for (size_t s = 0; s < options.specs.size(); ++s) {
+    const IndicatorSpec& spec = options.specs[s];
+    indicators.push_back(create_indicator(spec.indicator));
+    if (!indicators.back()) {
+      throw std::invalid_argument("unknown indicator: " + spec.indicator);
+    }
+    const auto names = indicators.back()->output_names();
+    std::vector<std::string> keys(names.begin(), names.end());
+    std::sort(keys.begin(), keys.end());
+    for (const auto& key : keys) {
+      panel.push_back({s, key, options.specs.size() == 1 ? key : spec_label(spec) + "." + key});
+    }
+  }
+  const bool arrow = options.format == BatchFormat::kArrow;
+
+  std::optional<ArrowFileWriter> writer;
+  if (arrow) {
+    std::vector<ArrowField> fields{{"symbol", ArrowType::kUtf8},
+                                   {"ts_epoch_millis", ArrowType::kTimestampMillis}};
+    for (const auto& column : panel) {
+      fields.push_back({column.name, ArrowType::kFloat64});
+    }
+    writer.emplace(out, std::move(fields));
+  } else {
+    out << "symbol,ts_epoch_millis";
+    for (const auto& column : panel) {
+      out << ',' << column.name;
+    }
+    out << '\n';
+  }
+
+  auto compute_symbol = [&](const std::string& symbol, SymbolOutput& result) {
+    const std::vector<OHLCV> bars = query_parquet_bars(options.root, options.period, symbol,
+                                                       options.start_millis, options.end_millis);
+    if (bars.empty()) {
+      result.skipped_reason = "no bars in range";
+      return;
+    }
+    std::vector<SeriesMap> series(indicators.size());
+    result.spec_errors.resize(indicators.size());
+    size_t computed = 0;
+    for (size_t s = 0; s < indicators.size(); ++s) {
+      try {
+        series[s] = indicators[s]->compute(bars, options.specs[s].params);
+        ++computed;
+      } catch (const std::invalid_argument& e) {
+        result.spec_errors[s] = e.what();
+      }
+    }
+    if (computed == 0) {
+      result.skipped_reason = result.spec_errors.front();
+      return;
+    }
+    const Series missing(bars.size(), nan_value());
+    std::vector<const Series*> columns;
+    for (const auto& column : panel) {
+      const auto it = series[column.spec].find(column.key);
+      columns.push_back(it == series[column.spec].end() ? &missing : &it->second);
+    }
+    if (arrow) {
+      result.ts.reserve(bars.size());
+      for (const auto& bar : bars) {
+        result.ts.push_back(bar.ts_millis);
+      }
+      for (const auto* column : columns) {
+        result.columns.emplace_back(column->begin(), column->end());
+      }
+      return;
+    }
+    for (size_t row = 0; row < bars.size(); ++row) {
+      result.csv.append(symbol);
+      result.csv.push_back(',');
+      append_int(result.csv, bars[row].ts_millis);
+      for (const auto* column : columns) {
+        result.csv.push_back(',');
+        append_double(result.csv, (*column)[row]);
+      }
+      result.csv.push_back('\n');
+    }
+  };
+
+  const size_t workers = options.threads == 0 ? default_worker_count() : options.threads;
+  const size_t block = workers * kSymbolsPerWorker;
+  std::vector<SymbolOutput> outputs;
+  for (size_t first = 0; first < symbols.size(); first += block) {
+    const size_t count = std::min(block, symbols.size() - first);
+    outputs.assign(count, {});
+    parallel_for(count, workers, [&](size_t i) { compute_symbol(symbols[first + i], outputs[i]); });
+
+    for (size_t i = 0; i < count; ++i) {
+      const std::string& symbol = symbols[first + i];
+      const SymbolOutput& result = outputs[i];
+      if (!result.skipped_reason.empty()) {
+        log << "skipped " << symbol << ": " << result.skipped_reason << '\n';
+        continue;
+      }
+      for (size_t s = 0; s < result.spec_errors.size(); ++s) {
+        if (!result.spec_errors[s].empty()) {
+          log << "empty " << symbol << ' ' << spec_label(options.specs[s]) << ": "
+              << result.spec_errors[s] << '\n';
+        }
+      }
+      if (!arrow) {
+        out << result.csv;
+        continue;
+      }
+      for (size_t row = 0; row < result.ts.size(); ++row) {
+        writer->append(0, symbol);
+        writer->append(1, result.ts[row]);
+        for (size_t c = 0; c < result.columns.size(); ++c) {
+          writer->append(c + 2, result.columns[c][row]);
+        }
+        if (writer->pending_rows() >= options.chunk_rows) {
+          writer->flush();
+        }
+      }
+    }
+  }
+  if (writer) {
+    writer->close();
+  }
+}
+
+int run_batch_cli(int argc, char** argv) {
+  try {
+    const BatchOptions options = parse_batch_args(std::vector<std::string>(argv + 1, argv + argc));
+    if (options.out_path.empty()) {
+      run_batch(options, std::cout, std::cerr);
+    } else {
+      std::ofstream file(options.out_path, std::ios::binary | std::ios::trunc);
+      if (!file) {
+        std::cerr << "cannot open " << options.out_path << " for writing\n";
+        return 1;
+      }
+      run_batch(options, file, std::cerr);
+    }
+    return 0;
+  } catch (const std::invalid_argument& e) {
+    std::cerr << e.what() << '\n' << kUsage;
+    return 2;
+  } catch (const std::exception& e) {
+    std::cerr << "batch failed: " << e.what() << '\n';
+    return 1;
+  }
+}
+
+}  // namespace tg_indicators
@@ -0,0 +1,126 @@
+#include "tg_indicators/c_api.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tg_indicators/indicators/registry.h"
+
+namespace {
+
+thread_local std::string last_error;
+
+tg_status fail(tg_status status, std::string message) {
+  last_error = std::move(message);
+  return status;
+}
+
+std::vector<tg_indicators::OHLCV> gather_bars(const tg_bars& bars) {
+  std::vector<tg_indicators::OHLCV> out(bars.length);
+  for (size_t i = 0; i < bars.length; ++i) {
+    const double close = bars.close[i];
+    out[i] = tg_indicators::OHLCV{
+        bars.ts_millis != nullptr ? bars.ts_millis[i] : 0,
+        bars.open != nullptr ? bars.open[i] : close,
+        bars.high != nullptr ? bars.high[i] : close,
+        bars.low != nullptr ? bars.low[i] : close,
+        close,
+        bars.volume != nullptr ? bars.volume[i] : 0,
+        bars.amount != nullptr ? bars.amount[i] : 0.0,
+    };
+  }
+  return out;
+}
+
+tg_status compute(const char* indicator_name, const tg_bars* bars, const tg_param* params,
+                  size_t param_count, tg_output* outputs, size_t output_count) {
+  if (indicator_name == nullptr || bars == nullptr || (bars->length > 0 && bars->close == nullptr) ||
+      (param_count > 0 && params == nullptr) || (output_count > 0 && outputs == nullptr)) {
+    return fail(TG_INVALID_ARGUMENT, "null argument");
+  }
+  const auto indicator = tg_indicators::create_indicator(indicator_name);
+  if (!indicator) {
+    return fail(TG_NOT_FOUND, std::string("unknown indicator: ") + indicator_name);
+  }
+  const auto names = indicator->output_names();
+  for (size_t k = 0; k < output_count; ++k) {
+    const tg_output& output = outputs[k];
+    if (output.name == nullptr || output.values == nullptr) {
+      return fail(TG_INVALID_ARGUMENT, "output " + std::to_string(k) + " has a null name or buffer");
+    }
+    if (std::none_of(names.begin(), names.end(),
+                     [&](const char* name) { return std::strcmp(name, output.name) == 0; })) {
+      return fail(TG_NOT_FOUND, std::string(indicator_name) + " has no output " + output.name);
+    }
+    if (output.capacity < bars->length) {
+      return fail(TG_OUT_OF_RANGE, std::string("output ") + output.name + " holds " +
+                                       std::to_string(output.capacity) + " values, need " +
+                                       std::to_string(bars->length));
+    }
+  }
+
+  tg_indicators::Params decoded;
+  for (size_t i = 0; i < param_count; ++i) {
+    if (params[i].key == nullptr) {
+      return fail(TG_INVALID_ARGUMENT, "param " + std::to_string(i) + " has a null key");
+    }
+    decoded[params[i].key] = params[i].value;
+  }
+  const tg_indicators::SeriesMap series = indicator->compute(gather_bars(*bars), decoded);
+  for (size_t k = 0; k < output_count; ++k) {
+    const auto& values = series.at(outputs[k].name);
+    std::copy(values.begin(), values.end(), outputs[k].values);
+  }
+  last_error.clear();
+  return TG_OK;
+}
+
+}  // namespace
+
+extern "C" {
+
+uint32_t tg_abi_version(void) {
+  return TG_ABI_VERSION;
+}
+
+tg_status tg_compute(const char* indicator, const tg_bars* bars, const tg_param* params,
+                     size_t param_count, tg_output* outputs, size_t output_count) {
+  try {
+    return compute(indicator, bars, params, param_count, outputs, output_count);
+  } catch (const std::invalid_argument& e) {
+    return fail(TG_INVALID_ARGUMENT, e.what());
+  } catch (const std::exception& e) {
+    return fail(TG_INTERNAL, e.what());
+  } catch (...) {
+    return fail(TG_INTERNAL, "unknown error");
+  }
+}
+
+tg_status tg_output_names(const char* indicator_name, const char** names, size_t capacity,
+                          size_t* count) {
+  try {
+    if (indicator_name == nullptr || count == nullptr || (capacity > 0 && names == nullptr)) {
+      return fail(TG_INVALID_ARGUMENT, "null argument");
+    }
+    const auto indicator = tg_indicators::create_indicator(indicator_name);
+    if (!indicator) {
+      return fail(TG_NOT_FOUND, std::string("unknown indicator: ") + indicator_name);
+    }
+    const auto outputs = indicator->output_names();
+    std::copy_n(outputs.begin(), std::min(capacity, outputs.size()), names);
+    *count = outputs.size();
+    last_error.clear();
+    return TG_OK;
+  } catch (const std::exception& e) {
+    return fail(TG_INTERNAL, e.what());
+  }
+}
+
+const char* tg_last_error(void) {
+  return last_error.c_str();
+}
+
+}  // extern "C"
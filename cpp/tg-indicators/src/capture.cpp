@@ -0,0 +1,191 @@
+#include "tg_indicators/capture.h"
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+
+namespace tg_indicators {
+namespace {
+
+constexpr std::string_view kCaptureHeader{"TGCAP02\n", 8};
+
+void put_varint(std::string& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+bool get_varint(std::string_view& in, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64 && !in.empty(); shift += 7) {
+    const auto byte = static_cast<unsigned char>(in.front());
+    in.remove_prefix(1);
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool sampled(double rate) {
+  if (rate >= 1.0) {
+    return true;
+  }
+  if (rate <= 0.0) {
+    return false;
+  }
+  thread_local std::minstd_rand engine(
+      static_cast<unsigned>(std::hash<std::thread::id>{}(std::this_thread::get_id())));
+  return std::uniform_real_distribution<double>(0.0, 1.0)(engine) < rate;
+}
+
+}  // namespace
+
+CaptureWriter::CaptureWriter(CaptureOptions options)
+    : options_(std::move(options)),
+      started_(std::chrono::steady_clock::now()),
+      out_(options_.path, std::ios::binary | std::ios::trunc) {
+  if (!out_) {
+    throw std::runtime_error("cannot open capture file " + options_.path);
+  }
+  out_.write(kCaptureHeader.data(), static_cast<std::streamsize>(kCaptureHeader.size()));
+  thread_ = std::thread([this] { run(); });
+}
+
+CaptureWriter::~CaptureWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  ready_.notify_one();
+  thread_.join();
+}
+
+void CaptureWriter::record(CapturedMethod method, const std::string& label,
+                           const google::protobuf::MessageLite& request,
+                           std::chrono::steady_clock::time_point deadline) {
+  if (!sampled(options_.sample_rate)) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  const auto offset = std::chrono::duration_cast<std::chrono::microseconds>(now - started_);
+  // At least 1 µs for a deadline that has already passed, since 0 means none.
+  uint64_t deadline_micros = 0;
+  if (deadline != std::chrono::steady_clock::time_point::max()) {
+    const auto left = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now);
+    deadline_micros = static_cast<uint64_t>(std::max<int64_t>(1, left.count()));
+  }
+  std::string body;
+  put_varint(body, static_cast<uint64_t>(offset.count()));
+  put_varint(body, static_cast<uint32_t>(method));
+  put_varint(body, deadline_micros);
+  put_varint(body, label.size());
+  body += label;
+  request.AppendToString(&body);
+  if (body.size() > kMaxCaptureRecordBytes) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  std::string encoded;
+  encoded.reserve(body.size() + 5);
+  put_varint(encoded, body.size());
+  encoded += body;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.size() >= options_.max_queued) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    queue_.push_back(std::move(encoded));
+  }
+  ready_.notify_one();
+}
+
+void CaptureWriter::run() {
+  std::deque<std::string> batch;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty() && stopping_) {
+        break;
+      }
+      batch.swap(queue_);
+    }
+    for (const auto& encoded : batch) {
+      out_.write(encoded.data(), static_cast<std::streamsize>(encoded.size()));
+    }
+    written_.fetch_add(batch.size(), std::memory_order_relaxed);
+    batch.clear();
+    out_.flush();
+  }
+  out_.flush();
+}
+
+CaptureReader::CaptureReader(const std::string& path) : in_(path, std::ios::binary | std::ios::ate) {
+  if (in_) {
+    file_bytes_ = static_cast<uint64_t>(in_.tellg());
+    in_.seekg(0);
+  }
+  std::string header(kCaptureHeader.size(), '\0');
+  if (!in_ || !in_.read(header.data(), static_cast<std::streamsize>(header.size())) ||
+      header != kCaptureHeader) {
+    throw std::runtime_error(path + " is not a tg-indicators capture file");
+  }
+}
+
+bool CaptureReader::next(CapturedRequest* out) {
+  uint64_t length = 0;
+  for (int shift = 0;; shift += 7) {
+    const int byte = in_.get();
+    if (byte == std::char_traits<char>::eof()) {
+      if (shift == 0) {
+        return false;
+      }
+      throw std::runtime_error("capture record length is truncated");
+    }
+    length |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      break;
+    }
+    if (shift > 28) {
+      throw std::runtime_error("capture record length is malformed");
+    }
+  }
+  // The length is read from the file: bound it before allocating the record.
+  if (length > kMaxCaptureRecordBytes) {
+    throw std::runtime_error("capture record length exceeds the maximum record size");
+  }
+  if (length > file_bytes_ - static_cast<uint64_t>(in_.tellg())) {
+    throw std::runtime_error("capture record is truncated");
+  }
+  std::string body(length, '\0');
+  if (!in_.read(body.data(), static_cast<std::streamsize>(length))) {
+    throw std::runtime_error("capture record is truncated");
+  }
+
+  std::string_view in(body);
+  uint64_t offset = 0;
+  uint64_t method = 0;
+  uint64_t deadline = 0;
+  uint64_t label_bytes = 0;
+  if (!get_varint(in, &offset) || !get_varint(in, &method) || !get_varint(in, &deadline) ||
+      !get_varint(in, &label_bytes) || label_bytes > in.size()) {
+    throw std::runtime_error("capture record header is malformed");
+  }
+  out->offset_micros = static_cast<int64_t>(offset);
+  out->method = static_cast<CapturedMethod>(method);
+  out->deadline_micros = static_cast<int64_t>(deadline);
+  out->label.assign(in.substr(0, label_bytes));
+  in.remove_prefix(label_bytes);
+  out->payload.assign(in);
+  return true;
+}
+
+}  // namespace tg_indicators
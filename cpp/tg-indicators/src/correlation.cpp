@@ -0,0 +1,248 @@
+#include "tg_indicators/correlation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "tg_indicators/cancellation.h"
+#include "tg_indicators/parallel.h"
+
+namespace tg_indicators {
+namespace {
+
+constexpr size_t kTile = 64;
+
+void validate_columns(const std::vector<std::vector<double>>& returns, size_t length, size_t window) {
+  if (window < 2) {
+    throw std::invalid_argument("correlation window must be at least 2");
+  }
+  for (const auto& column : returns) {
+    if (column.size() != length) {
+      throw std::invalid_argument("return columns must all have the same length");
+    }
+  }
+}
+
+// Number of NaNs in column[0, t) for every t, so a window's validity is one subtraction.
+std::vector<size_t> nan_prefix(const std::vector<double>& column) {
+  std::vector<size_t> prefix(column.size() + 1, 0);
+  for (size_t t = 0; t < column.size(); ++t) {
+    prefix[t + 1] = prefix[t] + (std::isnan(column[t]) ? 1 : 0);
+  }
+  return prefix;
+}
+
+// Running sums are rebuilt from scratch every `window` bars, so between rebuilds at
+// most ~2 * window rounding errors, each bounded by eps times the squares that went
+// through the sums (`mass`), can pile up. A variance inside that bound cannot be told
+// from zero, e.g. a limit-locked stock whose window has gone flat.
+bool is_flat(double variance, double w, double mass) {
+  return variance <= 8.0 * w * w * std::numeric_limits<double>::epsilon() * mass;
+}
+
+}  // namespace
+
+RollingCorrelation rolling_correlation(const std::vector<std::vector<double>>& returns,
+                                       const RollingCorrelationOptions& options) {
+  const size_t n = returns.size();
+  const size_t length = n == 0 ? 0 : returns.front().size();
+  const size_t window = options.window;
+  validate_columns(returns, length, window);
+  if (options.step == 0) {
+    throw std::invalid_argument("correlation step must be positive");
+  }
+
+  RollingCorrelation out;
+  out.symbol_count = n;
+  for (size_t t = window - 1; t < length; t += options.step) {
+    out.end_index.push_back(t);
+  }
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  out.correlation.assign(out.end_index.size() * n * n, nan);
+  if (out.end_index.empty()) {
+    return out;
+  }
+
+  // Time-major copy with NaN zeroed, so one bar's returns for a tile are contiguous.
+  std::vector<double> rows(length * n);
+  std::vector<std::vector<size_t>> nans(n);
+  const size_t workers = options.threads == 0 ? default_worker_count() : options.threads;
+  parallel_for(n, workers, [&](size_t s) {
+    nans[s] = nan_prefix(returns[s]);
+    for (size_t t = 0; t < length; ++t) {
+      const double value = returns[s][t];
+      rows[t * n + s] = std::isnan(value) ? 0.0 : value;
+    }
+  });
+
+  const size_t tiles_per_side = (n + kTile - 1) / kTile;
+  std::vector<std::pair<size_t, size_t>> tiles;
+  for (size_t bi = 0; bi < tiles_per_side; ++bi) {
+    for (size_t bj = bi; bj < tiles_per_side; ++bj) {
+      tiles.emplace_back(bi, bj);
+    }
+  }
+
+  const double w = static_cast<double>(window);
+  parallel_for(tiles.size(), workers, [&](size_t tile_index) {
+    const size_t i0 = tiles[tile_index].first * kTile;
+    const size_t j0 = tiles[tile_index].second * kTile;
+    const size_t bi = std::min(kTile, n - i0);
+    const size_t bj = std::min(kTile, n - j0);
+    std::vector<double> cross(bi * bj, 0.0);
+    std::vector<double> sum_i(bi, 0.0), sq_i(bi, 0.0), sum_j(bj, 0.0), sq_j(bj, 0.0);
+    std::vector<double> mass_i(bi, 0.0), mass_j(bj, 0.0);
+
+    size_t next_emit = 0;
+    for (size_t t = 0; t < length; ++t) {
+      cancellation_point(t);
+      if ((t + 1) % window == 0) {
+        // Rebuild the window ending at t from scratch, dropping accumulated rounding.
+        std::fill(cross.begin(), cross.end(), 0.0);
+        std::fill(sum_i.begin(), sum_i.end(), 0.0);
+        std::fill(sq_i.begin(), sq_i.end(), 0.0);
+        std::fill(sum_j.begin(), sum_j.end(), 0.0);
+        std::fill(sq_j.begin(), sq_j.end(), 0.0);
+        for (size_t u = t + 1 - window; u <= t; ++u) {
+          const double* at_i = &rows[u * n + i0];
+          const double* at_j = &rows[u * n + j0];
+          for (size_t jj = 0; jj < bj; ++jj) {
+            sum_j[jj] += at_j[jj];
+            sq_j[jj] += at_j[jj] * at_j[jj];
+          }
+          for (size_t ii = 0; ii < bi; ++ii) {
+            const double xi = at_i[ii];
+            sum_i[ii] += xi;
+            sq_i[ii] += xi * xi;
+            double* row = &cross[ii * bj];
+            for (size_t jj = 0; jj < bj; ++jj) {
+              row[jj] += xi * at_j[jj];
+            }
+          }
+        }
+        mass_i = sq_i;
+        mass_j = sq_j;
+      } else {
+        const double* now_i = &rows[t * n + i0];
+        const double* now_j = &rows[t * n + j0];
+        const bool evict = t >= window;
+        const double* old_i = evict ? &rows[(t - window) * n + i0] : nullptr;
+        const double* old_j = evict ? &rows[(t - window) * n + j0] : nullptr;
+
+        for (size_t jj = 0; jj < bj; ++jj) {
+          const double old = evict ? old_j[jj] : 0.0;
+          sum_j[jj] += now_j[jj] - old;
+          sq_j[jj] += now_j[jj] * now_j[jj] - old * old;
+          mass_j[jj] += now_j[jj] * now_j[jj];
+        }
+        for (size_t ii = 0; ii < bi; ++ii) {
+          const double xi = now_i[ii];
+          const double old = evict ? old_i[ii] : 0.0;
+          sum_i[ii] += xi - old;
+          sq_i[ii] += xi * xi - old * old;
+          mass_i[ii] += xi * xi;
+          double* row = &cross[ii * bj];
+          if (evict) {
+            for (size_t jj = 0; jj < bj; ++jj) {
+              row[jj] += xi * now_j[jj] - old * old_j[jj];
+            }
+          } else {
+            for (size_t jj = 0; jj < bj; ++jj) {
+              row[jj] += xi * now_j[jj];
+            }
+          }
+        }
+      }
+
+      if (next_emit == out.end_index.size() || out.end_index[next_emit] != t) {
+        continue;
+      }
+      double* matrix = &out.correlation[next_emit * n * n];
+      ++next_emit;
+      for (size_t ii = 0; ii < bi; ++ii) {
+        const size_t i = i0 + ii;
+        const bool valid_i = nans[i][t + 1] == nans[i][t + 1 - window];
+        const double var_i = w * sq_i[ii] - sum_i[ii] * sum_i[ii];
+        for (size_t jj = 0; jj < bj; ++jj) {
+          const size_t j = j0 + jj;
+          if (j < i) {
+            continue;
+          }
+          const bool valid_j = nans[j][t + 1] == nans[j][t + 1 - window];
+          const double var_j = w * sq_j[jj] - sum_j[jj] * sum_j[jj];
+          double value = nan;
+          if (valid_i && valid_j && !is_flat(var_i, w, mass_i[ii]) && !is_flat(var_j, w, mass_j[jj])) {
+            value = i == j ? 1.0
+                           : std::clamp((w * cross[ii * bj + jj] - sum_i[ii] * sum_j[jj]) /
+                                            std::sqrt(var_i * var_j),
+                                        -1.0, 1.0);
+          }
+          matrix[i * n + j] = value;
+          matrix[j * n + i] = value;
+        }
+      }
+    }
+  });
+  return out;
+}
+
+std::vector<std::vector<double>> rolling_beta(const std::vector<std::vector<double>>& returns,
+                                              const std::vector<double>& benchmark, size_t window,
+                                              size_t threads) {
+  const size_t length = benchmark.size();
+  validate_columns(returns, length, window);
+  const std::vector<size_t> benchmark_nans = nan_prefix(benchmark);
+  const double w = static_cast<double>(window);
+  std::vector<std::vector<double>> betas(returns.size());
+  parallel_for(returns.size(), threads == 0 ? default_worker_count() : threads, [&](size_t s) {
+    const std::vector<double>& column = returns[s];
+    const std::vector<size_t> column_nans = nan_prefix(column);
+    std::vector<double>& beta = betas[s];
+    beta.assign(length, std::numeric_limits<double>::quiet_NaN());
+    auto value = [](double x) { return std::isnan(x) ? 0.0 : x; };
+    double sum_x = 0.0, sum_m = 0.0, sum_mm = 0.0, sum_xm = 0.0, mass_m = 0.0;
+    for (size_t t = 0; t < length; ++t) {
+      if ((t + 1) % window == 0) {
+        // Rebuilt from scratch every window, as in rolling_correlation.
+        sum_x = sum_m = sum_mm = sum_xm = 0.0;
+        for (size_t u = t + 1 - window; u <= t; ++u) {
+          const double x = value(column[u]);
+          const double m = value(benchmark[u]);
+          sum_x += x;
+          sum_m += m;
+          sum_mm += m * m;
+          sum_xm += x * m;
+        }
+        mass_m = sum_mm;
+      } else {
+        const double x = value(column[t]);
+        const double m = value(benchmark[t]);
+        sum_x += x;
+        sum_m += m;
+        sum_mm += m * m;
+        sum_xm += x * m;
+        mass_m += m * m;
+        if (t >= window) {
+          const double ox = value(column[t - window]);
+          const double om = value(benchmark[t - window]);
+          sum_x -= ox;
+          sum_m -= om;
+          sum_mm -= om * om;
+          sum_xm -= ox * om;
+        }
+      }
+      if (t + 1 < window || column_nans[t + 1] != column_nans[t + 1 - window] ||
+          benchmark_nans[t + 1] != benchmark_nans[t + 1 - window]) {
+        continue;
+      }
+      const double var_m = w * sum_mm - sum_m * sum_m;
+      if (!is_flat(var_m, w, mass_m)) {
+        beta[t] = (w * sum_xm - sum_x * sum_m) / var_m;
+      }
+    }
+  });
+  return betas;
+}
+
+}  // namespace tg_indicators
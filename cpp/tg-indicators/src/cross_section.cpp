@@ -0,0 +1,129 @@
+#include "tg_indicators/cross_section.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "tg_indicators/parallel.h"
+
+namespace tg_indicators {
+namespace {
+
+constexpr size_t kDateBlock = 256;
+
+double quantile_sorted(const std::vector<std::pair<double, size_t>>& sorted, double q) {
+  const double position = q * static_cast<double>(sorted.size() - 1);
+  const size_t lower = static_cast<size_t>(std::floor(position));
+  const size_t upper = std::min(lower + 1, sorted.size() - 1);
+  const double fraction = position - static_cast<double>(lower);
+  return sorted[lower].first + (sorted[upper].first - sorted[lower].first) * fraction;
+}
+
+}  // namespace
+
+CrossSection compute_cross_section(const std::vector<SymbolSeries>& universe,
+                                   const CrossSectionOptions& options) {
+  if (!(options.winsor_lower >= 0.0 && options.winsor_lower <= options.winsor_upper &&
+        options.winsor_upper <= 1.0)) {
+    throw std::invalid_argument("winsorization quantiles must satisfy 0 <= lower <= upper <= 1");
+  }
+  for (const auto& series : universe) {
+    if (series.ts_millis.size() != series.values.size()) {
+      throw std::invalid_argument("cross-section series timestamps and values differ in length");
+    }
+    if (std::adjacent_find(series.ts_millis.begin(), series.ts_millis.end(),
+                           [](int64_t a, int64_t b) { return a >= b; }) != series.ts_millis.end()) {
+      throw std::invalid_argument("cross-section series timestamps must be strictly increasing");
+    }
+  }
+
+  CrossSection out;
+  out.symbol_count = universe.size();
+  for (const auto& series : universe) {
+    out.ts_millis.insert(out.ts_millis.end(), series.ts_millis.begin(), series.ts_millis.end());
+  }
+  std::sort(out.ts_millis.begin(), out.ts_millis.end());
+  out.ts_millis.erase(std::unique(out.ts_millis.begin(), out.ts_millis.end()), out.ts_millis.end());
+
+  const size_t dates = out.ts_millis.size();
+  const size_t symbols = out.symbol_count;
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  out.value.assign(dates * symbols, nan);
+  out.rank.assign(dates * symbols, nan);
+  out.percentile.assign(dates * symbols, nan);
+  out.zscore.assign(dates * symbols, nan);
+  out.winsorized.assign(dates * symbols, nan);
+
+  const size_t blocks = (dates + kDateBlock - 1) / kDateBlock;
+  const size_t workers = options.threads == 0 ? default_worker_count() : options.threads;
+  parallel_for(blocks, workers, [&](size_t block) {
+    const size_t begin = block * kDateBlock;
+    const size_t end = std::min(begin + kDateBlock, dates);
+
+    // Transpose this block's dates: each worker writes one contiguous slab of rows.
+    for (size_t s = 0; s < symbols; ++s) {
+      const auto& ts = universe[s].ts_millis;
+      auto it = std::lower_bound(ts.begin(), ts.end(), out.ts_millis[begin]);
+      size_t d = begin;
+      for (; it != ts.end() && d < end; ++it) {
+        while (d < end && out.ts_millis[d] < *it) {
+          ++d;
+        }
+        if (d == end) {
+          break;
+        }
+        out.value[d * symbols + s] = universe[s].values[static_cast<size_t>(it - ts.begin())];
+      }
+    }
+
+    std::vector<std::pair<double, size_t>> row;
+    row.reserve(symbols);
+    for (size_t d = begin; d < end; ++d) {
+      const size_t base = d * symbols;
+      row.clear();
+      double sum = 0.0;
+      for (size_t s = 0; s < symbols; ++s) {
+        const double value = out.value[base + s];
+        if (!std::isnan(value)) {
+          row.emplace_back(value, s);
+          sum += value;
+        }
+      }
+      if (row.empty()) {
+        continue;
+      }
+      std::sort(row.begin(), row.end());
+
+      const double count = static_cast<double>(row.size());
+      const double mean = sum / count;
+      double sq = 0.0;
+      for (const auto& [value, s] : row) {
+        sq += (value - mean) * (value - mean);
+      }
+      const double stddev = row.size() > 1 ? std::sqrt(sq / (count - 1.0)) : 0.0;
+      const double low = quantile_sorted(row, options.winsor_lower);
+      const double high = quantile_sorted(row, options.winsor_upper);
+
+      for (size_t i = 0; i < row.size();) {
+        size_t j = i + 1;
+        while (j < row.size() && row[j].first == row[i].first) {
+          ++j;
+        }
+        const double average_rank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2.0;
+        for (size_t k = i; k < j; ++k) {
+          const auto [value, s] = row[k];
+          out.rank[base + s] = average_rank;
+          out.percentile[base + s] = average_rank / count;
+          out.zscore[base + s] = stddev > 0.0 ? (value - mean) / stddev : nan;
+          out.winsorized[base + s] = std::clamp(value, low, high);
+        }
+        i = j;
+      }
+    }
+  });
+  return out;
+}
+
+}  // namespace tg_indicators
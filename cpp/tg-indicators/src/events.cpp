@@ -0,0 +1,118 @@
+#include "tg_indicators/events.h"
+
+#include <algorithm>
+#include <deque>
+
+namespace tg_indicators {
+namespace {
+
+const Series& find_column(const SeriesMap& series, const std::string& name,
+                          const std::string& predicate) {
+  const auto it = series.find(name);
+  if (it == series.end()) {
+    throw std::invalid_argument("predicate " + predicate + " references unknown series " + name);
+  }
+  return it->second;
+}
+
+void scan_crossing(const SeriesPredicate& predicate, size_t index, const Series& values,
+                   const Series* reference, size_t first_bar,
+                   std::vector<IndicatorEvent>& out) {
+  const bool above = predicate.kind == PredicateKind::kCrossAbove;
+  auto level = [&](size_t i) { return reference ? (*reference)[i] : predicate.threshold; };
+  for (size_t i = std::max<size_t>(first_bar, 1); i < values.size(); ++i) {
+    cancellation_point(i);
+    const double prev = values[i - 1] - level(i - 1);
+    const double now = values[i] - level(i);
+    // NaN differences fail both comparisons, so warm-up bars never fire.
+    if (above ? (prev <= 0.0 && now > 0.0) : (prev >= 0.0 && now < 0.0)) {
+      out.push_back({index, i, values[i], level(i)});
+    }
+  }
+}
+
+void scan_range(const SeriesPredicate& predicate, size_t index, const Series& values,
+                size_t first_bar, std::vector<IndicatorEvent>& out) {
+  if (!(predicate.lower <= predicate.upper)) {
+    throw std::invalid_argument("predicate " + predicate.id + " needs lower <= upper");
+  }
+  const bool entering = predicate.kind == PredicateKind::kEnterRange;
+  auto inside = [&](double v) { return v >= predicate.lower && v <= predicate.upper; };
+  for (size_t i = std::max<size_t>(first_bar, 1); i < values.size(); ++i) {
+    cancellation_point(i);
+    const double prev = values[i - 1];
+    const double now = values[i];
+    if (std::isnan(prev) || std::isnan(now) || inside(prev) == inside(now) || inside(now) != entering) {
+      continue;
+    }
+    // The bound the series crossed on its way in or out.
+    const double side = entering ? prev : now;
+    out.push_back({index, i, now, side < predicate.lower ? predicate.lower : predicate.upper});
+  }
+}
+
+// Monotonic deque of the previous `lookback` finite values; a NaN restarts the window.
+void scan_extreme(const SeriesPredicate& predicate, size_t index, const Series& values,
+                  size_t first_bar, std::vector<IndicatorEvent>& out) {
+  if (predicate.lookback == 0) {
+    throw std::invalid_argument("predicate " + predicate.id + " needs a positive lookback");
+  }
+  const bool high = predicate.kind == PredicateKind::kNewHigh;
+  auto beats = [&](double a, double b) { return high ? a > b : a < b; };
+  const size_t window = predicate.lookback;
+  std::deque<size_t> extremes;
+  size_t run_start = first_bar > window ? first_bar - window : 0;
+  for (size_t i = run_start; i < values.size(); ++i) {
+    cancellation_point(i);
+    const double now = values[i];
+    if (std::isnan(now)) {
+      extremes.clear();
+      run_start = i + 1;
+      continue;
+    }
+    while (!extremes.empty() && extremes.front() + window < i) {
+      extremes.pop_front();
+    }
+    if (i >= first_bar && i - run_start >= window && beats(now, values[extremes.front()])) {
+      out.push_back({index, i, now, values[extremes.front()]});
+    }
+    while (!extremes.empty() && !beats(values[extremes.back()], now)) {
+      extremes.pop_back();
+    }
+    extremes.push_back(i);
+  }
+}
+
+}  // namespace
+
+std::vector<IndicatorEvent> extract_events(std::span<const SeriesPredicate> predicates,
+                                           const SeriesMap& series, size_t first_bar) {
+  std::vector<IndicatorEvent> events;
+  for (size_t p = 0; p < predicates.size(); ++p) {
+    const SeriesPredicate& predicate = predicates[p];
+    const Series& values = find_column(series, predicate.series, predicate.id);
+    switch (predicate.kind) {
+      case PredicateKind::kCrossAbove:
+      case PredicateKind::kCrossBelow:
+        scan_crossing(predicate, p, values,
+                      predicate.reference.empty()
+                          ? nullptr
+                          : &find_column(series, predicate.reference, predicate.id),
+                      first_bar, events);
+        break;
+      case PredicateKind::kEnterRange:
+      case PredicateKind::kExitRange:
+        scan_range(predicate, p, values, first_bar, events);
+        break;
+      case PredicateKind::kNewHigh:
+      case PredicateKind::kNewLow:
+        scan_extreme(predicate, p, values, first_bar, events);
+        break;
+    }
+  }
+  std::stable_sort(events.begin(), events.end(),
+                   [](const IndicatorEvent& a, const IndicatorEvent& b) { return a.bar < b.bar; });
+  return events;
+}
+
+}  // namespace tg_indicators
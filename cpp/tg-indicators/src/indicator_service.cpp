@@ -1,24 +1,40 @@
 #include "tg_indicators/indicator_service.h"
 
+#include <algorithm>
+#include <chrono>
 #include <csignal>
 #include <exception>
+#include <functional>
 #include <iostream>
+#include <optional>
+#include <span>
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include "tg_indicators/adjustment.h"
+#include "tg_indicators/arena.h"
 #include "tg_indicators/bar_codec.h"
+#include "tg_indicators/cancellation.h"
+#include "tg_indicators/correlation.h"
+#include "tg_indicators/cross_section.h"
+#include "tg_indicators/events.h"
+#include "tg_indicators/fixed_point.h"
 #include "tg_indicators/indicators/registry.h"
+#include "tg_indicators/parallel.h"
+#include "tg_indicators/resample.h"
+#include "tg_indicators/screen.h"
 
 namespace tg_indicators {
 namespace {
 
+// Fills everything but the timestamps, which callers add from whichever bar
+// representation they computed on.
 void fill_result(const tg::v1::IndicatorRequest& request,
-                 const std::vector<OHLCV>& bars,
                  const SeriesMap& series,
                  tg::v1::IndicatorResult* response) {
   response->Clear();
   response->set_indicator(request.indicator());
-  for (const auto& bar : bars) {
-    response->add_ts_epoch_millis(bar.ts_millis);
-  }
   auto* out_series = response->mutable_series();
   for (const auto& [name, values] : series) {
     auto& double_series = (*out_series)[name];
@@ -28,26 +44,564 @@ void fill_result(const tg::v1::IndicatorRequest& request,
   }
 }
 
-grpc::Status compute_request(const tg::v1::IndicatorRequest& request,
+Params decode_params(const google::protobuf::Map<std::string, double>& proto_params) {
+  Params params;
+  params.reserve(static_cast<size_t>(proto_params.size()));
+  for (const auto& [key, value] : proto_params) {
+    params.emplace(key, value);
+  }
+  return params;
+}
+
+// Work per bar for decoding the five decimal strings of a proto Bar, in the same
+// units as IIndicator::cost_per_bar.
+constexpr double kDecodeCostPerBar = 4.0;
+
+// Values one RollingCorrelation response may carry. Dense n x n matrices per window
+// end grow fast; this keeps the reply well under gRPC's default 4 MiB receive limit.
+constexpr size_t kMaxCorrelationValues = (3u << 20) / sizeof(double);
+
+grpc::Status cancelled_status(const ComputeCancelled& e) {
+  return {e.deadline_exceeded() ? grpc::StatusCode::DEADLINE_EXCEEDED : grpc::StatusCode::CANCELLED,
+          e.what()};
+}
+
+RequestPriority request_priority(const grpc::ServerContext* context) {
+  if (context == nullptr) {
+    return RequestPriority::kNormal;
+  }
+  const auto& metadata = context->client_metadata();
+  const auto it = metadata.find("tg-priority");
+  return it != metadata.end() && it->second == "low" ? RequestPriority::kLow
+                                                     : RequestPriority::kNormal;
+}
+
+CancellationContext::Clock::time_point request_deadline(const grpc::ServerContext* context) {
+  if (context == nullptr) {
+    return CancellationContext::Clock::time_point::max();
+  }
+  const auto deadline = context->deadline();
+  if (deadline == std::chrono::system_clock::time_point::max()) {
+    return CancellationContext::Clock::time_point::max();
+  }
+  const auto remaining = deadline - std::chrono::system_clock::now();
+  return CancellationContext::Clock::now() +
+         std::chrono::duration_cast<CancellationContext::Clock::duration>(remaining);
+}
+
+// Identity of a Compute request for coalescing: normalized indicator name plus the
+// deterministic encoding of the request (map entries sorted), so equal content gives
+// equal keys regardless of params insertion order.
+std::string coalescing_key(const tg::v1::IndicatorRequest& request) {
+  std::string key = normalize_indicator_name(request.indicator());
+  key.push_back('\0');
+  google::protobuf::io::StringOutputStream stream(&key);
+  google::protobuf::io::CodedOutputStream coded(&stream);
+  coded.SetSerializationDeterministic(true);
+  request.SerializeToCodedStream(&coded);
+  coded.Trim();
+  return key;
+}
+
+double indicator_request_cost(const tg::v1::IndicatorRequest& request, size_t stored_bars = 0) {
+  const auto indicator = create_indicator(request.indicator());
+  const double per_bar = indicator ? indicator->cost_per_bar(decode_params(request.params())) : 0.0;
+  return static_cast<double>(static_cast<size_t>(request.bars_size()) + stored_bars) *
+         (kDecodeCostPerBar + per_bar);
+}
+
+// An indicator's outputs plus the bar timestamps they align with.
+struct ComputedSeries {
+  std::vector<int64_t> ts_millis;
+  SeriesMap series;
+  Params state;  // filled when the request seeds or asks for state
+};
+
+// Adds the requested kBarFields columns; column(f, i) reads kBarFields[f] of bar i.
+template <typename Column>
+void add_bar_fields(std::span<const std::string> fields, size_t n, Column column, SeriesMap& series) {
+  for (const auto& field : fields) {
+    const auto* known = std::find_if(std::begin(kBarFields), std::end(kBarFields),
+                                     [&](const char* name) { return field == name; });
+    if (known == std::end(kBarFields) || series.contains(field)) {
+      continue;
+    }
+    Series values = make_series(n);
+    for (size_t i = 0; i < n; ++i) {
+      values[i] = column(static_cast<size_t>(known - std::begin(kBarFields)), i);
+    }
+    series.emplace(*known, std::move(values));
+  }
+}
+
+// Adjusts, resamples and computes `request` on the fixed-point path when it asks for
+// it and can use it, else on doubles. Names in `bar_fields` that are bar columns
+// (kBarFields) and not indicator outputs are added to the series; others are ignored.
+// A request naming a history_session computes over that session's stored bars, which
+// only `history` (Compute's store, null elsewhere) can serve.
+ComputedSeries compute_series(const tg::v1::IndicatorRequest& request, const IIndicator& indicator,
+                              const Params& params, std::span<const std::string> bar_fields = {},
+                              const HistoryStore* history = nullptr) {
+  const bool stored = !request.history_session().empty();
+  if (stored && history == nullptr) {
+    throw std::invalid_argument("history_session is only served by Compute and BatchCompute");
+  }
+  if (stored && (request.bars_size() > 0 || request.valid_size() > 0 ||
+                 request.adjustment_factors_size() > 0 ||
+                 request.resample_to() != tg::v1::BAR_PERIOD_UNSPECIFIED)) {
+    throw std::invalid_argument(
+        "history_session cannot be combined with bars, a valid mask, adjustment factors or resampling");
+  }
+  std::vector<double> ratios =
+      adjustment_ratios(request.bars(), request.adjustment_factors(), request.adjustment());
+  if (indicator.scale_invariant() && uniform_ratios(ratios)) {
+    ratios.clear();
+  }
+  ComputedSeries computed;
+  const bool stateful = request.seed_size() > 0 || request.return_state();
+  const BarMask valid = decode_mask(request.valid(), request.bars_size());
+  if (!valid.empty() && (stateful || request.resample_to() != tg::v1::BAR_PERIOD_UNSPECIFIED)) {
+    throw std::invalid_argument("a valid mask cannot be combined with seeded state or resampling");
+  }
+  // Fixed-point prices only hold exact quotes, so adjusted or resampled requests
+  // and indicators without an integer kernel take the double path.
+  if (request.fixed_point() && indicator.has_fixed_point_kernel() && !stateful && valid.empty() &&
+      ratios.empty() && request.resample_to() == tg::v1::BAR_PERIOD_UNSPECIFIED && !stored) {
+    FixedBars bars = decode_fixed_bars(request.bars());
+    computed.series = indicator.compute_fixed(bars, params);
+    add_bar_fields(bar_fields, bars.size(), [&](size_t field, size_t i) {
+      const std::vector<int64_t>* prices[] = {&bars.open, &bars.high, &bars.low, &bars.close};
+      return field < 4 ? fixed_to_double((*prices[field])[i]) : static_cast<double>(bars.volume[i]);
+    }, computed.series);
+    computed.ts_millis = std::move(bars.ts_millis);
+    return computed;
+  }
+  std::vector<OHLCV> bars;
+  if (!stored) {
+    bars = decode_bars(request.bars(), ratios, valid);
+  } else if (!history->read(request.history_session(), bars)) {
+    throw std::invalid_argument("no history for session: " + request.history_session());
+  }
+  if (request.resample_to() != tg::v1::BAR_PERIOD_UNSPECIFIED && !bars.empty()) {
+    validate_resample(request.bars(0).period(), request.resample_to());
+    bars = resample_bars(bars, request.resample_to());
+  }
+  if (!valid.empty()) {
+    computed.series = indicator.compute_masked(bars, valid, params);
+  } else if (stateful) {
+    computed.series = indicator.compute_seeded(bars, params, decode_params(request.seed()),
+                                               request.return_state() ? &computed.state : nullptr);
+  } else {
+    computed.series = indicator.compute(bars, params);
+  }
+  add_bar_fields(bar_fields, bars.size(), [&](size_t field, size_t i) {
+    const OHLCV& bar = bars[i];
+    const double values[] = {bar.open, bar.high, bar.low, bar.close, static_cast<double>(bar.volume)};
+    return values[field];
+  }, computed.series);
+  computed.ts_millis.reserve(bars.size());
+  for (const auto& bar : bars) {
+    computed.ts_millis.push_back(bar.ts_millis);
+  }
+  return computed;
+}
+
+grpc::Status compute_request(const tg::v1::IndicatorRequest& request, const HistoryStore& history,
                              tg::v1::IndicatorResult* response) {
   auto indicator = create_indicator(request.indicator());
   if (!indicator) {
     return {grpc::StatusCode::NOT_FOUND, "unknown indicator: " + request.indicator()};
   }
 
-  Params params;
-  params.reserve(static_cast<size_t>(request.params().size()));
-  for (const auto& [key, value] : request.params()) {
-    params.emplace(key, value);
+  const Params params = decode_params(request.params());
+
+  try {
+    const ComputedSeries computed = compute_series(request, *indicator, params, {}, &history);
+    fill_result(request, computed.series, response);
+    response->mutable_ts_epoch_millis()->Add(computed.ts_millis.begin(), computed.ts_millis.end());
+    response->mutable_state()->insert(computed.state.begin(), computed.state.end());
+    return grpc::Status::OK;
+  } catch (const std::invalid_argument& e) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, e.what()};
+  } catch (const ComputeCancelled& e) {
+    return cancelled_status(e);
+  } catch (const std::exception& e) {
+    return {grpc::StatusCode::INTERNAL, e.what()};
+  }
+}
+
+PredicateKind predicate_kind(tg::v1::PredicateKind kind) {
+  switch (kind) {
+    case tg::v1::PREDICATE_KIND_CROSS_ABOVE:
+      return PredicateKind::kCrossAbove;
+    case tg::v1::PREDICATE_KIND_CROSS_BELOW:
+      return PredicateKind::kCrossBelow;
+    case tg::v1::PREDICATE_KIND_ENTER_RANGE:
+      return PredicateKind::kEnterRange;
+    case tg::v1::PREDICATE_KIND_EXIT_RANGE:
+      return PredicateKind::kExitRange;
+    case tg::v1::PREDICATE_KIND_NEW_HIGH:
+      return PredicateKind::kNewHigh;
+    case tg::v1::PREDICATE_KIND_NEW_LOW:
+      return PredicateKind::kNewLow;
+    default:
+      throw std::invalid_argument("predicate kind is required");
+  }
+}
+
+// Computes the indicator, then reduces its series to the bars where a predicate
+// fires, so only events cross the wire.
+grpc::Status events_request(const tg::v1::EventsRequest& request, tg::v1::EventsResult* response) {
+  const auto& inner = request.request();
+  auto indicator = create_indicator(inner.indicator());
+  if (!indicator) {
+    return {grpc::StatusCode::NOT_FOUND, "unknown indicator: " + inner.indicator()};
+  }
+  try {
+    std::vector<SeriesPredicate> predicates;
+    std::vector<std::string> referenced;
+    for (const auto& proto : request.predicates()) {
+      predicates.push_back({proto.id(), predicate_kind(proto.kind()), proto.series(), proto.reference(),
+                            proto.threshold(), proto.lower(), proto.upper(), proto.lookback()});
+      referenced.push_back(proto.series());
+      referenced.push_back(proto.reference());
+    }
+    const ComputedSeries computed =
+        compute_series(inner, *indicator, decode_params(inner.params()), referenced);
+    const size_t first_bar = static_cast<size_t>(
+        std::upper_bound(computed.ts_millis.begin(), computed.ts_millis.end(),
+                         request.since_ts_epoch_millis()) -
+        computed.ts_millis.begin());
+
+    response->Clear();
+    response->set_indicator(inner.indicator());
+    for (const IndicatorEvent& event : extract_events(predicates, computed.series, first_bar)) {
+      auto* out = response->add_events();
+      out->set_predicate_id(predicates[event.predicate].id);
+      out->set_ts_epoch_millis(computed.ts_millis[event.bar]);
+      out->set_value(event.value);
+      out->set_reference(event.reference);
+    }
+    return grpc::Status::OK;
+  } catch (const std::invalid_argument& e) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, e.what()};
+  } catch (const ComputeCancelled& e) {
+    return cancelled_status(e);
+  } catch (const std::exception& e) {
+    return {grpc::StatusCode::INTERNAL, e.what()};
+  }
+}
+
+// Computes `request.series()` for every symbol, then the per-date cross-section.
+// A symbol the indicator rejects (typically too few bars) is left out of every date;
+// the request only fails if no symbol could be computed.
+grpc::Status cross_section_request(const tg::v1::CrossSectionRequest& request,
+                                   tg::v1::CrossSectionResult* response) {
+  auto indicator = create_indicator(request.indicator());
+  if (!indicator) {
+    return {grpc::StatusCode::NOT_FOUND, "unknown indicator: " + request.indicator()};
+  }
+  const Params params = decode_params(request.params());
+
+  try {
+    const size_t symbol_count = static_cast<size_t>(request.universe_size());
+    std::vector<SymbolSeries> universe(symbol_count);
+    std::vector<std::string> rejections(symbol_count);
+    parallel_for(symbol_count, default_worker_count(), [&](size_t index) {
+      const auto& symbol = request.universe(static_cast<int>(index));
+      const BarMask valid = decode_mask(symbol.valid(), symbol.bars_size());
+      const std::vector<OHLCV> bars = decode_bars(symbol.bars(), {}, valid);
+      SeriesMap series;
+      try {
+        series = valid.empty() ? indicator->compute(bars, params)
+                               : indicator->compute_masked(bars, valid, params);
+      } catch (const std::invalid_argument& e) {
+        rejections[index] = e.what();
+        return;
+      }
+      const auto it = series.find(request.series());
+      if (it == series.end()) {
+        throw std::invalid_argument(request.indicator() + " has no output series " + request.series());
+      }
+      SymbolSeries& out = universe[index];
+      out.ts_millis.reserve(bars.size());
+      for (const auto& bar : bars) {
+        out.ts_millis.push_back(bar.ts_millis);
+      }
+      out.values.assign(it->second.begin(), it->second.end());
+      if (request.divide_by_close()) {
+        for (size_t i = 0; i < bars.size(); ++i) {
+          out.values[i] /= bars[i].close;
+        }
+      }
+    });
+    if (symbol_count > 0 &&
+        std::all_of(rejections.begin(), rejections.end(), [](const auto& r) { return !r.empty(); })) {
+      throw std::invalid_argument(rejections.front());
+    }
+
+    CrossSectionOptions options;
+    if (request.winsor_lower() != 0.0 || request.winsor_upper() != 0.0) {
+      options.winsor_lower = request.winsor_lower();
+      options.winsor_upper = request.winsor_upper();
+    }
+    const CrossSection result = compute_cross_section(universe, options);
+
+    response->Clear();
+    response->set_indicator(request.indicator());
+    response->mutable_ts_epoch_millis()->Add(result.ts_millis.begin(), result.ts_millis.end());
+    for (const auto& symbol_bars : request.universe()) {
+      response->add_symbols(symbol_bars.symbol());
+    }
+    auto* out_series = response->mutable_series();
+    const std::pair<const char*, const std::vector<double>*> columns[] = {
+        {"value", &result.value},           {"rank", &result.rank},
+        {"percentile", &result.percentile}, {"zscore", &result.zscore},
+        {"winsorized", &result.winsorized},
+    };
+    for (const auto& [name, column] : columns) {
+      (*out_series)[name].mutable_values()->Add(column->begin(), column->end());
+    }
+    return grpc::Status::OK;
+  } catch (const std::invalid_argument& e) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, e.what()};
+  } catch (const ComputeCancelled& e) {
+    return cancelled_status(e);
+  } catch (const std::exception& e) {
+    return {grpc::StatusCode::INTERNAL, e.what()};
   }
+}
 
+// Correlation matrices over the given return columns, plus betas when a benchmark
+// column is supplied. `step` 0 means every bar.
+grpc::Status rolling_correlation_request(const tg::v1::RollingCorrelationRequest& request,
+                                         tg::v1::RollingCorrelationResult* response) {
+  try {
+    RollingCorrelationOptions options;
+    options.window = request.window();
+    // Unset step means back-to-back windows, not a matrix for every bar.
+    options.step = request.step() == 0 ? request.window() : request.step();
+    const auto n = static_cast<size_t>(request.returns_size());
+    const auto length = n == 0 ? size_t{0} : static_cast<size_t>(request.returns(0).values_size());
+    if (options.window > 0 && length >= options.window) {
+      const size_t ends = (length - options.window) / options.step + 1;
+      const size_t values = ends * n * n + (request.benchmark().values_size() > 0 ? n * length : 0);
+      if (values > kMaxCorrelationValues) {
+        throw std::invalid_argument("rolling correlation would return " + std::to_string(values) +
+                                    " values, over the limit of " +
+                                    std::to_string(kMaxCorrelationValues) +
+                                    "; raise step or split the universe");
+      }
+    }
+    std::vector<std::vector<double>> returns;
+    returns.reserve(n);
+    for (const auto& column : request.returns()) {
+      returns.emplace_back(column.values().begin(), column.values().end());
+    }
+    const RollingCorrelation result = rolling_correlation(returns, options);
+
+    response->Clear();
+    response->mutable_symbols()->CopyFrom(request.symbols());
+    for (size_t end : result.end_index) {
+      response->add_end_index(static_cast<uint32_t>(end));
+    }
+    response->mutable_correlation()->mutable_values()->Add(result.correlation.begin(),
+                                                           result.correlation.end());
+    if (request.benchmark().values_size() > 0) {
+      const std::vector<double> benchmark(request.benchmark().values().begin(),
+                                          request.benchmark().values().end());
+      for (const auto& beta : rolling_beta(returns, benchmark, options.window)) {
+        response->add_beta()->mutable_values()->Add(beta.begin(), beta.end());
+      }
+    }
+    return grpc::Status::OK;
+  } catch (const std::invalid_argument& e) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, e.what()};
+  } catch (const ComputeCancelled& e) {
+    return cancelled_status(e);
+  } catch (const std::exception& e) {
+    return {grpc::StatusCode::INTERNAL, e.what()};
+  }
+}
+
+ScreenOperand screen_operand(const tg::v1::ScreenOperand& proto) {
+  ScreenOperand operand;
+  operand.indicator = proto.indicator();
+  operand.params = decode_params(proto.params());
+  operand.series = proto.series();
+  operand.constant = proto.constant();
+  operand.scale = proto.scale() == 0.0 ? 1.0 : proto.scale();
+  operand.average_bars = proto.average_bars();
+  return operand;
+}
+
+Screen build_screen(const tg::v1::ScreenRequest& request) {
+  std::vector<ScreenCondition> conditions;
+  for (const auto& proto : request.conditions()) {
+    CompareOp op{};
+    switch (proto.op()) {
+      case tg::v1::COMPARE_OP_LT:
+        op = CompareOp::kLess;
+        break;
+      case tg::v1::COMPARE_OP_LE:
+        op = CompareOp::kLessEqual;
+        break;
+      case tg::v1::COMPARE_OP_GT:
+        op = CompareOp::kGreater;
+        break;
+      case tg::v1::COMPARE_OP_GE:
+        op = CompareOp::kGreaterEqual;
+        break;
+      default:
+        throw std::invalid_argument("screen condition needs a comparison op");
+    }
+    conditions.push_back({screen_operand(proto.left()), op, screen_operand(proto.right())});
+  }
+  return Screen(conditions);
+}
+
+// Evaluates the conjunction of conditions at every symbol's latest bar, in parallel
+// over symbols, and returns the matches in universe order.
+grpc::Status screen_request(const tg::v1::ScreenRequest& request, const Screen& screen,
+                            tg::v1::ScreenResult* response) {
+  try {
+    const size_t symbol_count = static_cast<size_t>(request.universe_size());
+    std::vector<ScreenOutcome> outcomes(symbol_count);
+    parallel_for(symbol_count, default_worker_count(), [&](size_t index) {
+      const auto& symbol = request.universe(static_cast<int>(index));
+      const BarMask valid = decode_mask(symbol.valid(), symbol.bars_size());
+      if (valid.empty()) {
+        outcomes[index] = screen.evaluate(decode_bars(symbol.bars()));
+        return;
+      }
+      // A symbol halted on its latest bar cannot match; otherwise screen its traded bars.
+      if (!valid.back()) {
+        outcomes[index].values.assign(screen.labels().size(), nan_value());
+        return;
+      }
+      std::vector<OHLCV> bars = decode_bars(symbol.bars(), {}, valid);
+      std::erase_if(bars, [](const OHLCV& bar) { return std::isnan(bar.close); });
+      outcomes[index] = screen.evaluate(bars);
+    });
+
+    response->Clear();
+    response->set_screened(static_cast<uint32_t>(symbol_count));
+    uint64_t computed = 0;
+    for (size_t index = 0; index < symbol_count; ++index) {
+      const ScreenOutcome& outcome = outcomes[index];
+      computed += outcome.indicators_computed;
+      if (!outcome.matched) {
+        continue;
+      }
+      const auto& symbol = request.universe(static_cast<int>(index));
+      auto* match = response->add_matches();
+      match->set_symbol(symbol.symbol());
+      match->set_ts_epoch_millis(symbol.bars(symbol.bars_size() - 1).ts_epoch_millis());
+      auto* values = match->mutable_values();
+      for (size_t i = 0; i < outcome.values.size(); ++i) {
+        (*values)[screen.labels()[i]] = outcome.values[i];
+      }
+    }
+    response->set_indicators_computed(computed);
+    return grpc::Status::OK;
+  } catch (const std::invalid_argument& e) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, e.what()};
+  } catch (const ComputeCancelled& e) {
+    return cancelled_status(e);
+  } catch (const std::exception& e) {
+    return {grpc::StatusCode::INTERNAL, e.what()};
+  }
+}
+
+// Default convergence tolerance for Describe: the seed's influence below 0.01%.
+constexpr double kDefaultWarmupTolerance = 1e-4;
+
+grpc::Status describe_request(const tg::v1::DescribeRequest& request,
+                              tg::v1::DescribeResult* response) {
+  auto indicator = create_indicator(request.indicator());
+  if (!indicator) {
+    return {grpc::StatusCode::NOT_FOUND, "unknown indicator: " + request.indicator()};
+  }
+  try {
+    const double tolerance = request.tolerance() == 0.0 ? kDefaultWarmupTolerance : request.tolerance();
+    if (!(tolerance > 0.0 && tolerance < 1.0)) {
+      throw std::invalid_argument("tolerance must be in (0, 1)");
+    }
+    const Params params = decode_params(request.params());
+    response->Clear();
+    response->set_indicator(request.indicator());
+    response->set_min_bars(static_cast<uint32_t>(indicator->min_bars(params)));
+    response->set_warmup_bars(static_cast<uint32_t>(indicator->warmup_bars(params, tolerance)));
+    for (const char* name : indicator->output_names()) {
+      response->add_outputs(name);
+    }
+    for (const char* name : indicator->state_names()) {
+      response->add_state_keys(name);
+    }
+    response->set_scale_invariant(indicator->scale_invariant());
+    for (const ParamSpec& spec : indicator->param_schema()) {
+      auto* param = response->add_params();
+      param->set_name(spec.name);
+      param->set_default_value(spec.default_value);
+      param->set_min(spec.min);
+      param->set_max(spec.max);
+      param->set_integer(spec.integer);
+      param->set_exclusive_min(spec.exclusive_min);
+    }
+    return grpc::Status::OK;
+  } catch (const std::invalid_argument& e) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, e.what()};
+  } catch (const std::exception& e) {
+    return {grpc::StatusCode::INTERNAL, e.what()};
+  }
+}
+
+grpc::Status stream_update_request(StreamStore& streams, HistoryStore* history,
+                                   const tg::v1::StreamUpdateRequest& request,
+                                   tg::v1::StreamUpdateResult* response) {
+  if (!create_indicator(request.indicator())) {
+    return {grpc::StatusCode::NOT_FOUND, "unknown indicator: " + request.indicator()};
+  }
   try {
     const std::vector<OHLCV> bars = decode_bars(request.bars());
-    const SeriesMap series = indicator->compute(bars, params);
-    fill_result(request, bars, series, response);
+    const std::optional<OHLCV> forming =
+        request.has_forming() ? std::optional<OHLCV>(decode_bar(request.forming())) : std::nullopt;
+    if (request.resample_to() != tg::v1::BAR_PERIOD_UNSPECIFIED) {
+      if (request.bars_size() > 0) {
+        validate_resample(request.bars(0).period(), request.resample_to());
+      }
+      if (request.has_forming()) {
+        validate_resample(request.forming().period(), request.resample_to());
+      }
+    }
+    const StreamUpdate update = streams.update(request.session(), request.indicator(),
+                                               decode_params(request.params()), bars,
+                                               forming ? &*forming : nullptr, request.resample_to());
+    if (history != nullptr) {
+      history->append(request.session(), bars);
+    }
+
+    response->Clear();
+    response->set_session(request.session());
+    response->set_indicator(request.indicator());
+    response->set_watermark_ts_epoch_millis(update.watermark_ts_millis);
+    response->set_bar_count(update.bar_count);
+    response->set_applied_bars(static_cast<uint32_t>(update.applied_bars));
+    auto* latest = response->mutable_latest();
+    for (size_t i = 0; i < update.names.size(); ++i) {
+      (*latest)[update.names[i]] = update.latest[i];
+    }
+    if (!update.provisional.empty()) {
+      auto* provisional = response->mutable_provisional();
+      for (size_t i = 0; i < update.names.size(); ++i) {
+        (*provisional)[update.names[i]] = update.provisional[i];
+      }
+    }
     return grpc::Status::OK;
   } catch (const std::invalid_argument& e) {
     return {grpc::StatusCode::INVALID_ARGUMENT, e.what()};
+  } catch (const ComputeCancelled& e) {
+    return cancelled_status(e);
   } catch (const std::exception& e) {
     return {grpc::StatusCode::INTERNAL, e.what()};
   }
@@ -55,19 +609,125 @@ grpc::Status compute_request(const tg::v1::IndicatorRequest& request,
 
 }  // namespace
 
-grpc::Status IndicatorServiceImpl::Compute(grpc::ServerContext*,
+IndicatorServiceImpl::IndicatorServiceImpl(ServiceOptions options)
+    : admission_(options.admission),
+      coalesce_requests_(options.coalesce_requests),
+      keep_history_(options.keep_history) {
+  if (!options.capture.path.empty()) {
+    capture_ = std::make_unique<CaptureWriter>(std::move(options.capture));
+  }
+}
+
+template <typename Fn>
+grpc::Status IndicatorServiceImpl::run_admitted(grpc::ServerContext* context, double cost_units,
+                                                Fn&& fn) {
+  std::function<bool()> is_cancelled;
+  if (context != nullptr) {
+    is_cancelled = [context] { return context->IsCancelled(); };
+  }
+  return run_admitted(request_deadline(context), request_priority(context), std::move(is_cancelled),
+                      cost_units, std::forward<Fn>(fn));
+}
+
+template <typename Fn>
+grpc::Status IndicatorServiceImpl::run_admitted(CancellationContext::Clock::time_point deadline,
+                                                RequestPriority priority, std::function<bool()> is_cancelled,
+                                                double cost_units, Fn&& fn) {
+  AdmissionController::Ticket ticket;
+  switch (admission_.admit(cost_units, priority, deadline, &ticket)) {
+    case AdmissionController::Decision::kShed:
+      return {grpc::StatusCode::RESOURCE_EXHAUSTED, "indicator service overloaded, request shed"};
+    case AdmissionController::Decision::kDeadlineTooShort:
+      return {grpc::StatusCode::DEADLINE_EXCEEDED,
+              "estimated compute time exceeds the remaining deadline"};
+    case AdmissionController::Decision::kAdmit:
+      break;
+  }
+  const CancellationContext cancellation(deadline, std::move(is_cancelled));
+  const CancellationScope scope(&cancellation);
+  // Kernel scratch and output series come from this thread's arena, released when fn()
+  // has copied what it needs into the response.
+  const ArenaScope arena;
+  const grpc::Status status = fn();
+  if (status.ok()) {
+    ticket.complete();
+  }
+  return status;
+}
+
+grpc::Status IndicatorServiceImpl::compute_one(grpc::ServerContext* context,
+                                               const tg::v1::IndicatorRequest& request,
+                                               tg::v1::IndicatorResult* response) {
+  auto compute = [&](tg::v1::IndicatorResult* out) {
+    const size_t stored =
+        request.history_session().empty() ? 0 : history_.bar_count(request.history_session());
+    return run_admitted(context, indicator_request_cost(request, stored),
+                        [&] { return compute_request(request, history_, out); });
+  };
+  if (!coalesce_requests_) {
+    return compute(response);
+  }
+  // Followers wait under their own deadline; the leader installs its full scope.
+  const CancellationContext waiting(request_deadline(context));
+  const CancellationScope scope(&waiting);
+  return coalescer_.run(coalescing_key(request), response, compute);
+}
+
+grpc::Status IndicatorServiceImpl::Compute(grpc::ServerContext* context,
                                            const tg::v1::IndicatorRequest* request,
                                            tg::v1::IndicatorResult* response) {
-  return compute_request(*request, response);
+  if (capture_) {
+    capture_->record(CapturedMethod::kCompute, request->indicator(), *request, request_deadline(context));
+  }
+  return compute_one(context, *request, response);
+}
+
+grpc::Status IndicatorServiceImpl::compute_bars(const std::string& indicator, const Params& params,
+                                                const std::vector<OHLCV>& bars,
+                                                CancellationContext::Clock::time_point deadline,
+                                                const std::function<void(const SeriesMap&)>& emit) {
+  if (capture_) {
+    tg::v1::IndicatorRequest request;
+    request.set_indicator(indicator);
+    request.mutable_params()->insert(params.begin(), params.end());
+    for (const OHLCV& bar : bars) {
+      encode_bar(bar, request.add_bars());
+    }
+    capture_->record(CapturedMethod::kCompute, indicator, request, deadline);
+  }
+  const auto kernel = create_indicator(indicator);
+  if (!kernel) {
+    return {grpc::StatusCode::NOT_FOUND, "unknown indicator: " + indicator};
+  }
+  const double cost = static_cast<double>(bars.size()) * (kDecodeCostPerBar + kernel->cost_per_bar(params));
+  return run_admitted(deadline, RequestPriority::kNormal, {}, cost, [&]() -> grpc::Status {
+    try {
+      emit(kernel->compute(bars, params));
+      return grpc::Status::OK;
+    } catch (const std::invalid_argument& e) {
+      return {grpc::StatusCode::INVALID_ARGUMENT, e.what()};
+    } catch (const ComputeCancelled& e) {
+      return cancelled_status(e);
+    } catch (const std::exception& e) {
+      return {grpc::StatusCode::INTERNAL, e.what()};
+    }
+  });
 }
 
 grpc::Status IndicatorServiceImpl::BatchCompute(
-    grpc::ServerContext*,
+    grpc::ServerContext* context,
     grpc::ServerReaderWriter<tg::v1::IndicatorResult, tg::v1::IndicatorRequest>* stream) {
   tg::v1::IndicatorRequest request;
   while (stream->Read(&request)) {
+    if (context != nullptr && context->IsCancelled()) {
+      return {grpc::StatusCode::CANCELLED, "client cancelled BatchCompute"};
+    }
+    if (capture_) {
+      capture_->record(CapturedMethod::kBatchCompute, request.indicator(), request,
+                       request_deadline(context));
+    }
     tg::v1::IndicatorResult response;
-    const grpc::Status status = compute_request(request, &response);
+    const grpc::Status status = compute_one(context, request, &response);
     if (!status.ok()) {
       response.Clear();
       response.set_indicator(request.indicator());
@@ -77,6 +737,96 @@ grpc::Status IndicatorServiceImpl::BatchCompute(
   return grpc::Status::OK;
 }
 
+grpc::Status IndicatorServiceImpl::CrossSection(grpc::ServerContext* context,
+                                                const tg::v1::CrossSectionRequest* request,
+                                                tg::v1::CrossSectionResult* response) {
+  if (capture_) {
+    capture_->record(CapturedMethod::kCrossSection, request->indicator(), *request,
+                     request_deadline(context));
+  }
+  const auto indicator = create_indicator(request->indicator());
+  const double per_bar = indicator ? indicator->cost_per_bar(decode_params(request->params())) : 0.0;
+  double bars = 0.0;
+  for (const auto& symbol : request->universe()) {
+    bars += static_cast<double>(symbol.bars_size());
+  }
+  return run_admitted(context, bars * (kDecodeCostPerBar + per_bar),
+                      [&] { return cross_section_request(*request, response); });
+}
+
+grpc::Status IndicatorServiceImpl::RollingCorrelation(
+    grpc::ServerContext* context, const tg::v1::RollingCorrelationRequest* request,
+    tg::v1::RollingCorrelationResult* response) {
+  if (capture_) {
+    capture_->record(CapturedMethod::kRollingCorrelation, "CORRELATION", *request, request_deadline(context));
+  }
+  // One cross-product update per symbol pair per bar, about a quarter of an SMA step.
+  const double symbols = static_cast<double>(request->returns_size());
+  const double length =
+      request->returns_size() == 0 ? 0.0 : static_cast<double>(request->returns(0).values_size());
+  return run_admitted(context, 0.25 * symbols * (symbols + 1.0) / 2.0 * length,
+                      [&] { return rolling_correlation_request(*request, response); });
+}
+
+grpc::Status IndicatorServiceImpl::StreamUpdate(grpc::ServerContext* context,
+                                                const tg::v1::StreamUpdateRequest* request,
+                                                tg::v1::StreamUpdateResult* response) {
+  if (capture_) {
+    capture_->record(CapturedMethod::kStreamUpdate, request->indicator(), *request,
+                     request_deadline(context));
+  }
+  const auto indicator = create_indicator(request->indicator());
+  const double per_bar = indicator ? indicator->cost_per_bar(decode_params(request->params())) : 0.0;
+  HistoryStore* history = keep_history_ ? &history_ : nullptr;
+  return run_admitted(context, static_cast<double>(request->bars_size()) * (kDecodeCostPerBar + per_bar),
+                      [&] { return stream_update_request(streams_, history, *request, response); });
+}
+
+grpc::Status IndicatorServiceImpl::ExtractEvents(grpc::ServerContext* context,
+                                                 const tg::v1::EventsRequest* request,
+                                                 tg::v1::EventsResult* response) {
+  if (capture_) {
+    capture_->record(CapturedMethod::kExtractEvents, request->request().indicator(), *request,
+                     request_deadline(context));
+  }
+  // Each operand is widened first: the int product overflows on large requests.
+  const double scan = static_cast<double>(request->request().bars_size()) *
+                      static_cast<double>(request->predicates_size());
+  return run_admitted(context, indicator_request_cost(request->request()) + scan,
+                      [&] { return events_request(*request, response); });
+}
+
+grpc::Status IndicatorServiceImpl::Screen(grpc::ServerContext* context,
+                                          const tg::v1::ScreenRequest* request,
+                                          tg::v1::ScreenResult* response) {
+  if (capture_) {
+    capture_->record(CapturedMethod::kScreen, "SCREEN", *request, request_deadline(context));
+  }
+  // Built once: it prices the request and then runs it, so bad conditions fail before admission.
+  std::optional<tg_indicators::Screen> screen;
+  try {
+    screen.emplace(build_screen(*request));
+  } catch (const std::invalid_argument& e) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, e.what()};
+  } catch (const std::exception& e) {
+    return {grpc::StatusCode::INTERNAL, e.what()};
+  }
+  // Priced as if no symbol short-circuits.
+  double bars = 0.0;
+  for (const auto& symbol : request->universe()) {
+    bars += static_cast<double>(symbol.bars_size());
+  }
+  return run_admitted(context, bars * (kDecodeCostPerBar + screen->cost_per_bar()),
+                      [&] { return screen_request(*request, *screen, response); });
+}
+
+grpc::Status IndicatorServiceImpl::Describe(grpc::ServerContext*,
+                                            const tg::v1::DescribeRequest* request,
+                                            tg::v1::DescribeResult* response) {
+  // Metadata only: no bars, so neither captured nor admission-controlled.
+  return describe_request(*request, response);
+}
+
 std::unique_ptr<grpc::Server> StartIndicatorServer(const std::string& address,
                                                    IndicatorServiceImpl* service) {
   grpc::ServerBuilder builder;
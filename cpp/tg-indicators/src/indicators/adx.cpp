@@ -4,58 +4,118 @@
 #include <numeric>
 
 #include "tg_indicators/indicators/atr.h"
+#include "tg_indicators/linear_scan.h"
 
 namespace tg_indicators {
 
-SeriesMap AdxIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
-  const int period = period_param(params, "period", 14);
-  require_bars(bars.size(), static_cast<size_t>(period * 2), "ADX");
+namespace {
 
-  const size_t n = bars.size();
+// ADX, +DI and -DI (the `names` slots, in that order) from per-bar true range and
+// directional movement. The inputs only need a common unit: every ratio below cancels it.
+SeriesMap adx_from_moves(std::span<const char* const> names, const Series& tr, const Series& plus_dm,
+                         const Series& minus_dm, int period) {
+  const size_t n = tr.size();
   const size_t p = static_cast<size_t>(period);
-  std::vector<double> tr = true_ranges(bars);
-  std::vector<double> plus_dm(n, 0.0);
-  std::vector<double> minus_dm(n, 0.0);
-  for (size_t i = 1; i < n; ++i) {
-    const double up_move = bars[i].high - bars[i - 1].high;
-    const double down_move = bars[i - 1].low - bars[i].low;
-    plus_dm[i] = (up_move > down_move && up_move > 0.0) ? up_move : 0.0;
-    minus_dm[i] = (down_move > up_move && down_move > 0.0) ? down_move : 0.0;
-  }
-
-  std::vector<double> plus_di(n, nan_value());
-  std::vector<double> minus_di(n, nan_value());
-  std::vector<double> dx(n, nan_value());
+  SeriesMap out(names, n);
+  Series& adx = out[0];
+  Series& plus_di = out[1];
+  Series& minus_di = out[2];
+  Series dx = make_series(n);
 
-  double smooth_tr = std::accumulate(tr.begin() + 1, tr.begin() + static_cast<long>(p + 1), 0.0);
-  double smooth_plus = std::accumulate(plus_dm.begin() + 1, plus_dm.begin() + static_cast<long>(p + 1), 0.0);
-  double smooth_minus = std::accumulate(minus_dm.begin() + 1, minus_dm.begin() + static_cast<long>(p + 1), 0.0);
+  // Wilder running sums: s[p] seeds from bars 1..p, then s[i] = s[i-1] * (1 - 1/p) + x[i].
+  const double decay = 1.0 - 1.0 / static_cast<double>(period);
+  auto wilder_sums = [&](const Series& values) {
+    Series sums = make_series(n, 0.0);
+    sums[p] = std::accumulate(values.begin() + 1, values.begin() + static_cast<long>(p + 1), 0.0);
+    linear_recurrence(values.data() + p + 1, sums.data() + p + 1, n - p - 1, decay, 1.0, sums[p]);
+    return sums;
+  };
+  const Series smooth_tr = wilder_sums(tr);
+  const Series smooth_plus = wilder_sums(plus_dm);
+  const Series smooth_minus = wilder_sums(minus_dm);
 
   for (size_t i = p; i < n; ++i) {
-    if (i > p) {
-      smooth_tr = smooth_tr - (smooth_tr / static_cast<double>(period)) + tr[i];
-      smooth_plus = smooth_plus - (smooth_plus / static_cast<double>(period)) + plus_dm[i];
-      smooth_minus = smooth_minus - (smooth_minus / static_cast<double>(period)) + minus_dm[i];
-    }
-    if (smooth_tr != 0.0) {
-      plus_di[i] = 100.0 * smooth_plus / smooth_tr;
-      minus_di[i] = 100.0 * smooth_minus / smooth_tr;
+    if (smooth_tr[i] != 0.0) {
+      plus_di[i] = 100.0 * smooth_plus[i] / smooth_tr[i];
+      minus_di[i] = 100.0 * smooth_minus[i] / smooth_tr[i];
       const double denominator = plus_di[i] + minus_di[i];
       dx[i] = denominator == 0.0 ? 0.0 : 100.0 * std::abs(plus_di[i] - minus_di[i]) / denominator;
     }
   }
 
-  std::vector<double> adx(n, nan_value());
   double seed = 0.0;
   for (size_t i = p; i < p * 2; ++i) {
     seed += dx[i];
   }
   adx[(p * 2) - 1] = seed / static_cast<double>(period);
-  for (size_t i = p * 2; i < n; ++i) {
-    adx[i] = ((adx[i - 1] * static_cast<double>(period - 1)) + dx[i]) / static_cast<double>(period);
+  const double weight = 1.0 / static_cast<double>(period);
+  linear_recurrence(dx.data() + p * 2, adx.data() + p * 2, n - p * 2, 1.0 - weight, weight,
+                    adx[(p * 2) - 1]);
+
+  return out;
+}
+
+// ADX of bar(0) .. bar(count - 1) given their true ranges; each bar's directional
+// movement is taken against the one before it.
+template <typename Bar>
+SeriesMap adx_over(std::span<const char* const> names, size_t count, Bar bar, const Series& tr,
+                   int period) {
+  Series plus_dm = make_series(count, 0.0);
+  Series minus_dm = make_series(count, 0.0);
+  for (size_t i = 1; i < count; ++i) {
+    const double up_move = bar(i).high - bar(i - 1).high;
+    const double down_move = bar(i - 1).low - bar(i).low;
+    plus_dm[i] = (up_move > down_move && up_move > 0.0) ? up_move : 0.0;
+    minus_dm[i] = (down_move > up_move && down_move > 0.0) ? down_move : 0.0;
   }
+  return adx_from_moves(names, tr, plus_dm, minus_dm, period);
+}
 
-  return {{"adx", adx}, {"plus_di", plus_di}, {"minus_di", minus_di}};
+}  // namespace
+
+SeriesMap AdxIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
+  const int period = kAdxSchema.decode(params).period;
+  require_bars(bars.size(), static_cast<size_t>(period * 2), "ADX");
+  return adx_over(
+      output_names(), bars.size(), [&](size_t i) -> const OHLCV& { return bars[i]; }, true_ranges(bars),
+      period);
+}
+
+SeriesMap AdxIndicator::compute_masked(const std::vector<OHLCV>& bars, const BarMask& valid,
+                                       const Params& params) const {
+  const int period = kAdxSchema.decode(params).period;
+  const Positions positions = valid_positions(valid);
+  require_bars(positions.size(), static_cast<size_t>(period * 2), "ADX");
+  return scatter_valid(adx_over(
+                           output_names(), positions.size(),
+                           [&](size_t j) -> const OHLCV& { return bars[positions[j]]; },
+                           true_ranges(bars, positions), period),
+                       positions, bars.size());
+}
+
+size_t AdxIndicator::warmup_bars(const Params& params, double tolerance) const {
+  // Wilder-smoothed DI sums feed a Wilder-smoothed ADX: two chained recurrences.
+  const int period = kAdxSchema.decode(params).period;
+  return min_bars(params) + 2 * convergence_bars(1.0 / static_cast<double>(period), tolerance);
+}
+
+SeriesMap AdxIndicator::compute_fixed(const FixedBars& bars, const Params& params) const {
+  const int period = kAdxSchema.decode(params).period;
+  require_bars(bars.size(), static_cast<size_t>(period * 2), "ADX");
+
+  // Moves are compared exactly, so ties between up and down moves are real ties.
+  const size_t n = bars.size();
+  const std::pmr::vector<int64_t> exact_tr = true_ranges(bars);
+  Series plus_dm = make_series(n, 0.0);
+  Series minus_dm = make_series(n, 0.0);
+  for (size_t i = 1; i < n; ++i) {
+    const int64_t up_move = bars.high[i] - bars.high[i - 1];
+    const int64_t down_move = bars.low[i - 1] - bars.low[i];
+    plus_dm[i] = (up_move > down_move && up_move > 0) ? static_cast<double>(up_move) : 0.0;
+    minus_dm[i] = (down_move > up_move && down_move > 0) ? static_cast<double>(down_move) : 0.0;
+  }
+  const Series tr(exact_tr.begin(), exact_tr.end(), arena_resource());
+  return adx_from_moves(output_names(), tr, plus_dm, minus_dm, period);
 }
 
 }  // namespace tg_indicators
@@ -3,35 +3,138 @@
 #include <algorithm>
 #include <numeric>
 
+#include "tg_indicators/linear_scan.h"
+
 namespace tg_indicators {
 
-std::vector<double> true_ranges(const std::vector<OHLCV>& bars) {
-  std::vector<double> tr(bars.size(), 0.0);
-  if (bars.empty()) {
+namespace {
+
+// True ranges of bar(0) .. bar(count - 1), each against the close of the one before.
+template <typename Bar>
+Series true_ranges_of(size_t count, Bar bar) {
+  Series tr = make_series(count, 0.0);
+  if (count == 0) {
+    return tr;
+  }
+  tr[0] = bar(0).high - bar(0).low;
+  for (size_t i = 1; i < count; ++i) {
+    const OHLCV& current = bar(i);
+    const double prev_close = bar(i - 1).close;
+    const double high_low = current.high - current.low;
+    const double high_prev_close = std::abs(current.high - prev_close);
+    const double low_prev_close = std::abs(current.low - prev_close);
+    tr[i] = std::max({high_low, high_prev_close, low_prev_close});
+  }
+  return tr;
+}
+
+}  // namespace
+
+Series true_ranges(const std::vector<OHLCV>& bars) {
+  return true_ranges_of(bars.size(), [&](size_t i) -> const OHLCV& { return bars[i]; });
+}
+
+Series true_ranges(const std::vector<OHLCV>& bars, std::span<const uint32_t> positions) {
+  return true_ranges_of(positions.size(), [&](size_t j) -> const OHLCV& { return bars[positions[j]]; });
+}
+
+std::pmr::vector<int64_t> true_ranges(const FixedBars& bars) {
+  std::pmr::vector<int64_t> tr(bars.size(), 0, arena_resource());
+  if (bars.size() == 0) {
     return tr;
   }
-  tr[0] = bars[0].high - bars[0].low;
+  tr[0] = bars.high[0] - bars.low[0];
   for (size_t i = 1; i < bars.size(); ++i) {
-    const double high_low = bars[i].high - bars[i].low;
-    const double high_prev_close = std::abs(bars[i].high - bars[i - 1].close);
-    const double low_prev_close = std::abs(bars[i].low - bars[i - 1].close);
+    const int64_t high_low = bars.high[i] - bars.low[i];
+    const int64_t high_prev_close = std::abs(bars.high[i] - bars.close[i - 1]);
+    const int64_t low_prev_close = std::abs(bars.low[i] - bars.close[i - 1]);
     tr[i] = std::max({high_low, high_prev_close, low_prev_close});
   }
   return tr;
 }
 
+namespace {
+
+// Wilder smoothing of `tr` seeded with the mean of the first `period` values, whose
+// sum the caller provides so the fixed-point path can seed from an exact integer sum.
+Series wilder_average(std::span<const double> tr, double seed_sum, int period) {
+  Series atr = make_series(tr.size());
+  const size_t p = static_cast<size_t>(period);
+  atr[p - 1] = seed_sum / static_cast<double>(period);
+  const double weight = 1.0 / static_cast<double>(period);
+  linear_recurrence(tr.data() + p, atr.data() + p, tr.size() - p, 1.0 - weight, weight, atr[p - 1]);
+  return atr;
+}
+
+}  // namespace
+
 SeriesMap AtrIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
-  const int period = period_param(params, "period", 14);
+  const int period = kAtrSchema.decode(params).period;
   require_bars(bars.size(), static_cast<size_t>(period), "ATR");
-  const std::vector<double> tr = true_ranges(bars);
-  std::vector<double> atr(bars.size(), nan_value());
-  const size_t p = static_cast<size_t>(period);
-  double seed = std::accumulate(tr.begin(), tr.begin() + static_cast<long>(p), 0.0);
-  atr[p - 1] = seed / static_cast<double>(period);
-  for (size_t i = p; i < bars.size(); ++i) {
-    atr[i] = ((atr[i - 1] * static_cast<double>(period - 1)) + tr[i]) / static_cast<double>(period);
+  const Series tr = true_ranges(bars);
+  const double seed = std::accumulate(tr.begin(), tr.begin() + period, 0.0);
+  SeriesMap out;
+  out.emplace(output_names()[0], wilder_average(tr, seed, period));
+  return out;
+}
+
+SeriesMap AtrIndicator::compute_masked(const std::vector<OHLCV>& bars, const BarMask& valid,
+                                       const Params& params) const {
+  const int period = kAtrSchema.decode(params).period;
+  const Positions positions = valid_positions(valid);
+  require_bars(positions.size(), static_cast<size_t>(period), "ATR");
+  const Series tr = true_ranges(bars, positions);
+  const double seed = std::accumulate(tr.begin(), tr.begin() + period, 0.0);
+  SeriesMap compact;
+  compact.emplace(output_names()[0], wilder_average(tr, seed, period));
+  return scatter_valid(compact, positions, bars.size());
+}
+
+size_t AtrIndicator::warmup_bars(const Params& params, double tolerance) const {
+  const size_t period = min_bars(params);
+  return period + convergence_bars(1.0 / static_cast<double>(period), tolerance);
+}
+
+SeriesMap AtrIndicator::compute_seeded(const std::vector<OHLCV>& bars, const Params& params,
+                                       const Params& seed, Params* state) const {
+  SeriesMap series;
+  if (seed.empty()) {
+    series = compute(bars, params);
+  } else {
+    const int period = kAtrSchema.decode(params).period;
+    const double prev_close = seed_value(seed, "prev_close");
+    Series tr = true_ranges(bars);
+    if (!bars.empty()) {
+      tr[0] = std::max({bars[0].high - bars[0].low, std::abs(bars[0].high - prev_close),
+                        std::abs(bars[0].low - prev_close)});
+    }
+    series = SeriesMap(output_names(), bars.size());
+    const double weight = 1.0 / static_cast<double>(period);
+    linear_recurrence(tr.data(), series[0].data(), tr.size(), 1.0 - weight, weight,
+                      seed_value(seed, "atr"));
+  }
+  if (state != nullptr) {
+    const auto& atr = series.at("atr");
+    (*state)["atr"] = atr.empty() ? seed_value(seed, "atr") : atr.back();
+    (*state)["prev_close"] = bars.empty() ? seed_value(seed, "prev_close") : bars.back().close;
+  }
+  return series;
+}
+
+SeriesMap AtrIndicator::compute_fixed(const FixedBars& bars, const Params& params) const {
+  const int period = kAtrSchema.decode(params).period;
+  require_bars(bars.size(), static_cast<size_t>(period), "ATR");
+  const std::pmr::vector<int64_t> exact = true_ranges(bars);
+  const int64_t seed = std::accumulate(exact.begin(), exact.begin() + period, int64_t{0});
+  // Smooth in price units (integers below 2^53 are exact as doubles) and rescale once.
+  const Series units(exact.begin(), exact.end(), arena_resource());
+  SeriesMap out;
+  Series& atr = out.emplace(output_names()[0], wilder_average(units, static_cast<double>(seed), period));
+  const double scale = static_cast<double>(kPriceScale);
+  for (double& value : atr) {
+    value /= scale;
   }
-  return {{"atr", atr}};
+  return out;
 }
 
 }  // namespace tg_indicators
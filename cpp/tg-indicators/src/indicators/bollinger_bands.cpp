@@ -1,33 +1,54 @@
 #include "tg_indicators/indicators/bollinger_bands.h"
 
+#include <algorithm>
 #include <numeric>
 
 #include "tg_indicators/indicators/sma.h"
+#include "tg_indicators/indicators/specialize.h"
 
 namespace tg_indicators {
 
-SeriesMap BollingerBandsIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
-  const int period = period_param(params, "period", 20);
-  const double k = param_or(params, "std_dev", 2.0);
-  if (!std::isfinite(k) || k < 0.0) {
-    throw std::invalid_argument("parameter std_dev must be non-negative");
-  }
-  const std::vector<double> close = close_values(bars);
-  std::vector<double> mid = compute_sma(close, period);
-  std::vector<double> upper(bars.size(), nan_value());
-  std::vector<double> lower(bars.size(), nan_value());
-  const size_t p = static_cast<size_t>(period);
-  for (size_t i = p - 1; i < bars.size(); ++i) {
+namespace {
+
+// Upper and lower bands from `close` and its SMA. `period` is an int or a Const<N>;
+// with a constant the variance loop has a fixed trip count.
+template <typename Period>
+void bands(const Series& close, const Series& mid, Period period, double k, Series& upper,
+           Series& lower) {
+  const size_t p = static_cast<size_t>(static_cast<int>(period));
+  for (size_t i = p - 1; i < close.size(); ++i) {
+    cancellation_point(i);
+    const double* window = close.data() + (i + 1 - p);
     double variance = 0.0;
-    for (size_t j = i + 1 - p; j <= i; ++j) {
-      const double diff = close[j] - mid[i];
+    for (size_t j = 0; j < p; ++j) {
+      const double diff = window[j] - mid[i];
       variance += diff * diff;
     }
-    const double stddev = std::sqrt(variance / static_cast<double>(period));
+    const double stddev = std::sqrt(variance / static_cast<double>(p));
     upper[i] = mid[i] + k * stddev;
     lower[i] = mid[i] - k * stddev;
   }
-  return {{"upper", upper}, {"mid", mid}, {"lower", lower}};
+}
+
+}  // namespace
+
+SeriesMap BollingerBandsIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
+  const auto [period, k] = kBollSchema.decode(params);
+  const Series close = close_values(bars);
+  SeriesMap out(output_names(), bars.size());
+  Series& upper = out[0];
+  Series& mid = out[1];
+  Series& lower = out[2];
+  mid = compute_sma(close, period);
+  const auto specialized = [&](auto fixed) { bands(close, mid, fixed, k, upper, lower); };
+  if (!specialized_kernels() || !with_constant_period<20>(period, specialized)) {
+    bands(close, mid, period, k, upper, lower);
+  }
+  return out;
+}
+
+double BollingerBandsIndicator::cost_per_bar(const Params& params) const {
+  return window_scan_cost(kBollSchema.decode_or_default(params).period);
 }
 
 }  // namespace tg_indicators
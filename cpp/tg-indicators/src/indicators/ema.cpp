@@ -2,30 +2,67 @@
 
 #include <numeric>
 
+#include "tg_indicators/linear_scan.h"
+
 namespace tg_indicators {
 
-std::vector<double> compute_ema(const std::vector<double>& values, int period, double smoothing) {
-  require_bars(values.size(), static_cast<size_t>(period), "EMA");
+namespace {
+
+double ema_alpha(int period, double smoothing) {
   if (!std::isfinite(smoothing) || smoothing <= 0.0) {
     throw std::invalid_argument("parameter smoothing must be positive");
   }
+  return smoothing / (static_cast<double>(period) + 1.0);
+}
 
-  std::vector<double> out(values.size(), nan_value());
+}  // namespace
+
+Series compute_ema(std::span<const double> values, int period, double smoothing) {
+  require_bars(values.size(), static_cast<size_t>(period), "EMA");
+  const double alpha = ema_alpha(period, smoothing);
+
+  Series out = make_series(values.size());
   const size_t p = static_cast<size_t>(period);
   const double seed = std::accumulate(values.begin(), values.begin() + static_cast<long>(p), 0.0) /
                       static_cast<double>(period);
   out[p - 1] = seed;
-  const double alpha = smoothing / (static_cast<double>(period) + 1.0);
-  for (size_t i = p; i < values.size(); ++i) {
-    out[i] = alpha * values[i] + (1.0 - alpha) * out[i - 1];
-  }
+  linear_recurrence(values.data() + p, out.data() + p, values.size() - p, 1.0 - alpha, alpha, seed);
   return out;
 }
 
 SeriesMap EmaIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
-  const int period = period_param(params, "period", 12);
-  const double smoothing = param_or(params, "smoothing", 2.0);
-  return {{"ema", compute_ema(close_values(bars), period, smoothing)}};
+  const EmaParams ema = kEmaSchema.decode(params);
+  SeriesMap out;
+  out.emplace(output_names()[0], compute_ema(close_values(bars), ema.period, ema.smoothing));
+  return out;
+}
+
+size_t EmaIndicator::warmup_bars(const Params& params, double tolerance) const {
+  const EmaParams ema = kEmaSchema.decode(params);
+  const double alpha = ema_alpha(ema.period, ema.smoothing);
+  return min_bars(params) + convergence_bars(alpha, tolerance);
+}
+
+SeriesMap EmaIndicator::compute_seeded(const std::vector<OHLCV>& bars, const Params& params,
+                                       const Params& seed, Params* state) const {
+  if (seed.empty()) {
+    SeriesMap series = compute(bars, params);
+    if (state != nullptr) {
+      (*state)["ema"] = series.at("ema").back();
+    }
+    return series;
+  }
+  const EmaParams ema_params = kEmaSchema.decode(params);
+  const double alpha = ema_alpha(ema_params.period, ema_params.smoothing);
+  const double start = seed_value(seed, "ema");
+  const Series close = close_values(bars);
+  SeriesMap out(output_names(), close.size());
+  Series& ema = out[0];
+  linear_recurrence(close.data(), ema.data(), close.size(), 1.0 - alpha, alpha, start);
+  if (state != nullptr) {
+    (*state)["ema"] = ema.empty() ? start : ema.back();
+  }
+  return out;
 }
 
 }  // namespace tg_indicators
@@ -1,49 +1,158 @@
 #include "tg_indicators/indicators/macd.h"
 
 #include "tg_indicators/indicators/ema.h"
+#include "tg_indicators/indicators/specialize.h"
+#include "tg_indicators/linear_scan.h"
 
 namespace tg_indicators {
+namespace {
 
-SeriesMap MacdIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
-  const int fast = period_param(params, "fast", 12);
-  const int slow = period_param(params, "slow", 26);
-  const int signal = period_param(params, "signal", 9);
-  if (fast >= slow) {
+MacdParams macd_params(const Params& params) {
+  const MacdParams periods = kMacdSchema.decode(params);
+  if (periods.fast >= periods.slow) {
     throw std::invalid_argument("MACD requires fast < slow");
   }
-  require_bars(bars.size(), static_cast<size_t>(slow + signal - 1), "MACD");
+  return periods;
+}
+
+double ema_alpha(int period) {
+  return 2.0 / (static_cast<double>(period) + 1.0);
+}
 
-  const std::vector<double> close = close_values(bars);
-  const std::vector<double> fast_ema = compute_ema(close, fast);
-  const std::vector<double> slow_ema = compute_ema(close, slow);
-  std::vector<double> dif(bars.size(), nan_value());
+// Both EMAs and the signal line in one pass with no scratch series. Performs the same
+// operations in the same order as the sequential multi-pass path, so the output is
+// identical.
+void macd_single_pass(const std::vector<OHLCV>& bars, const MacdParams& periods, Series& dif,
+                      Series& dea, Series& hist) {
+  const auto fast_period = static_cast<size_t>(periods.fast);
+  const auto slow_period = static_cast<size_t>(periods.slow);
+  const auto signal_period = static_cast<size_t>(periods.signal);
+  const double fast_alpha = ema_alpha(periods.fast);
+  const double slow_alpha = ema_alpha(periods.slow);
+  const double signal_alpha = ema_alpha(periods.signal);
+  double fast = 0.0;
+  double slow = 0.0;
+  double signal = 0.0;
   for (size_t i = 0; i < bars.size(); ++i) {
-    if (!std::isnan(fast_ema[i]) && !std::isnan(slow_ema[i])) {
-      dif[i] = fast_ema[i] - slow_ema[i];
+    cancellation_point(i);
+    const double close = bars[i].close;
+    if (i < fast_period) {
+      fast += close;
+      if (i + 1 == fast_period) {
+        fast /= static_cast<double>(fast_period);
+      }
+    } else {
+      fast = (1.0 - fast_alpha) * fast + fast_alpha * close;
+    }
+    if (i < slow_period) {
+      slow += close;
+      if (i + 1 < slow_period) {
+        continue;
+      }
+      slow /= static_cast<double>(slow_period);
+    } else {
+      slow = (1.0 - slow_alpha) * slow + slow_alpha * close;
+    }
+    dif[i] = fast - slow;
+    const size_t signal_index = i + 1 - slow_period;
+    if (signal_index < signal_period) {
+      signal += dif[i];
+      if (signal_index + 1 < signal_period) {
+        continue;
+      }
+      signal /= static_cast<double>(signal_period);
+    } else {
+      signal = (1.0 - signal_alpha) * signal + signal_alpha * dif[i];
     }
+    dea[i] = signal;
+    hist[i] = 2.0 * (dif[i] - dea[i]);
   }
+}
+
+}  // namespace
+
+SeriesMap MacdIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
+  return compute_seeded(bars, params, {}, nullptr);
+}
 
-  std::vector<double> dea(bars.size(), nan_value());
-  const size_t start = static_cast<size_t>(slow - 1);
-  double seed_sum = 0.0;
-  for (size_t i = start; i < start + static_cast<size_t>(signal); ++i) {
-    seed_sum += dif[i];
+size_t MacdIndicator::min_bars(const Params& params) const {
+  const MacdParams periods = macd_params(params);
+  return static_cast<size_t>(periods.slow + periods.signal - 1);
+}
+
+size_t MacdIndicator::warmup_bars(const Params& params, double tolerance) const {
+  // The slow EMA converges last; the signal EMA then smooths its residual error.
+  const MacdParams periods = macd_params(params);
+  return min_bars(params) + convergence_bars(ema_alpha(periods.slow), tolerance) +
+         convergence_bars(ema_alpha(periods.signal), tolerance);
+}
+
+SeriesMap MacdIndicator::compute_seeded(const std::vector<OHLCV>& bars, const Params& params,
+                                        const Params& seed, Params* state) const {
+  const MacdParams periods = macd_params(params);
+  const size_t n = bars.size();
+  if (seed.empty()) {
+    require_bars(n, static_cast<size_t>(periods.slow + periods.signal - 1), "MACD");
   }
-  const size_t seed_idx = start + static_cast<size_t>(signal) - 1;
-  dea[seed_idx] = seed_sum / static_cast<double>(signal);
-  const double alpha = 2.0 / (static_cast<double>(signal) + 1.0);
-  for (size_t i = seed_idx + 1; i < bars.size(); ++i) {
-    dea[i] = alpha * dif[i] + (1.0 - alpha) * dea[i - 1];
+  SeriesMap out(output_names(), n);
+  Series& dif = out[0];
+  Series& dea = out[1];
+  Series& hist = out[2];
+  // Long inputs keep the multi-pass path, whose recurrences can run as a parallel scan.
+  if (seed.empty() && state == nullptr && specialized_kernels() && n < kParallelScanThreshold) {
+    macd_single_pass(bars, periods, dif, dea, hist);
+    return out;
   }
 
-  std::vector<double> hist(bars.size(), nan_value());
-  for (size_t i = 0; i < bars.size(); ++i) {
+  const Series close = close_values(bars);
+  Series fast_ema(arena_resource());
+  Series slow_ema(arena_resource());
+  if (seed.empty()) {
+    fast_ema = compute_ema(close, periods.fast);
+    slow_ema = compute_ema(close, periods.slow);
+    for (size_t i = 0; i < n; ++i) {
+      if (!std::isnan(fast_ema[i]) && !std::isnan(slow_ema[i])) {
+        dif[i] = fast_ema[i] - slow_ema[i];
+      }
+    }
+    const size_t start = static_cast<size_t>(periods.slow - 1);
+    double seed_sum = 0.0;
+    for (size_t i = start; i < start + static_cast<size_t>(periods.signal); ++i) {
+      seed_sum += dif[i];
+    }
+    const size_t seed_idx = start + static_cast<size_t>(periods.signal) - 1;
+    dea[seed_idx] = seed_sum / static_cast<double>(periods.signal);
+    const double alpha = ema_alpha(periods.signal);
+    linear_recurrence(dif.data() + seed_idx + 1, dea.data() + seed_idx + 1, n - seed_idx - 1,
+                      1.0 - alpha, alpha, dea[seed_idx]);
+  } else {
+    fast_ema.resize(n);
+    slow_ema.resize(n);
+    const double fast_alpha = ema_alpha(periods.fast);
+    const double slow_alpha = ema_alpha(periods.slow);
+    const double signal_alpha = ema_alpha(periods.signal);
+    linear_recurrence(close.data(), fast_ema.data(), n, 1.0 - fast_alpha, fast_alpha,
+                      seed_value(seed, "fast_ema"));
+    linear_recurrence(close.data(), slow_ema.data(), n, 1.0 - slow_alpha, slow_alpha,
+                      seed_value(seed, "slow_ema"));
+    for (size_t i = 0; i < n; ++i) {
+      dif[i] = fast_ema[i] - slow_ema[i];
+    }
+    linear_recurrence(dif.data(), dea.data(), n, 1.0 - signal_alpha, signal_alpha,
+                      seed_value(seed, "dea"));
+  }
+
+  for (size_t i = 0; i < n; ++i) {
     if (!std::isnan(dif[i]) && !std::isnan(dea[i])) {
       hist[i] = 2.0 * (dif[i] - dea[i]);
     }
   }
-  return {{"dif", dif}, {"dea", dea}, {"hist", hist}};
+  if (state != nullptr) {
+    (*state)["fast_ema"] = n == 0 ? seed_value(seed, "fast_ema") : fast_ema.back();
+    (*state)["slow_ema"] = n == 0 ? seed_value(seed, "slow_ema") : slow_ema.back();
+    (*state)["dea"] = n == 0 ? seed_value(seed, "dea") : dea.back();
+  }
+  return out;
 }
 
 }  // namespace tg_indicators
-
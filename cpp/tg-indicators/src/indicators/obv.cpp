@@ -1,19 +1,66 @@
 #include "tg_indicators/indicators/obv.h"
 
+#include "tg_indicators/linear_scan.h"
+
 namespace tg_indicators {
 
 SeriesMap ObvIndicator::compute(const std::vector<OHLCV>& bars, const Params&) const {
   require_bars(bars.size(), 1, "OBV");
-  std::vector<double> obv(bars.size(), 0.0);
+  Series signed_volume = make_series(bars.size(), 0.0);
   for (size_t i = 1; i < bars.size(); ++i) {
-    obv[i] = obv[i - 1];
     if (bars[i].close > bars[i - 1].close) {
-      obv[i] += static_cast<double>(bars[i].volume);
+      signed_volume[i] = static_cast<double>(bars[i].volume);
     } else if (bars[i].close < bars[i - 1].close) {
-      obv[i] -= static_cast<double>(bars[i].volume);
+      signed_volume[i] = -static_cast<double>(bars[i].volume);
+    }
+  }
+  SeriesMap out(output_names(), bars.size());
+  Series& obv = out[0];
+  obv[0] = 0.0;
+  linear_recurrence(signed_volume.data() + 1, obv.data() + 1, bars.size() - 1, 1.0, 1.0, 0.0);
+  return out;
+}
+
+SeriesMap ObvIndicator::compute_masked(const std::vector<OHLCV>& bars, const BarMask& valid,
+                                       const Params&) const {
+  // A running total needs no window, so invalid bars are simply stepped over.
+  SeriesMap out(output_names(), bars.size());
+  Series& obv = out[0];
+  const OHLCV* previous = nullptr;
+  double total = 0.0;
+  for (size_t i = 0; i < bars.size(); ++i) {
+    if (!valid[i]) {
+      continue;
+    }
+    if (previous != nullptr) {
+      if (bars[i].close > previous->close) {
+        total += static_cast<double>(bars[i].volume);
+      } else if (bars[i].close < previous->close) {
+        total -= static_cast<double>(bars[i].volume);
+      }
+    }
+    obv[i] = total;
+    previous = &bars[i];
+  }
+  require_bars(previous == nullptr ? 0 : 1, 1, "OBV");
+  return out;
+}
+
+SeriesMap ObvIndicator::compute_fixed(const FixedBars& bars, const Params&) const {
+  require_bars(bars.size(), 1, "OBV");
+  SeriesMap out(output_names(), bars.size());
+  Series& obv = out[0];
+  obv[0] = 0.0;
+  int64_t total = 0;
+  for (size_t i = 1; i < bars.size(); ++i) {
+    if (bars.close[i] > bars.close[i - 1]) {
+      total += bars.volume[i];
+    } else if (bars.close[i] < bars.close[i - 1]) {
+      total -= bars.volume[i];
     }
+    obv[i] = static_cast<double>(total);
   }
-  return {{"obv", obv}};
+  return out;
 }
 
 }  // namespace tg_indicators
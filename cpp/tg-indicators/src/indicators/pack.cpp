@@ -0,0 +1,299 @@
+#include "tg_indicators/indicators/pack.h"
+
+#include <algorithm>
+#include <array>
+
+#include "tg_indicators/indicators/adx.h"
+#include "tg_indicators/indicators/atr.h"
+#include "tg_indicators/indicators/bollinger_bands.h"
+#include "tg_indicators/indicators/cci.h"
+#include "tg_indicators/indicators/ema.h"
+#include "tg_indicators/indicators/macd.h"
+#include "tg_indicators/indicators/obv.h"
+#include "tg_indicators/indicators/rsi.h"
+#include "tg_indicators/indicators/sma.h"
+#include "tg_indicators/indicators/stochastic.h"
+#include "tg_indicators/indicators/williams_r.h"
+
+namespace tg_indicators {
+namespace {
+
+constexpr SmaParams kSma = kSmaSchema.defaults();
+constexpr EmaParams kEma = kEmaSchema.defaults();
+constexpr MacdParams kMacd = kMacdSchema.defaults();
+constexpr RsiParams kRsi = kRsiSchema.defaults();
+constexpr BollParams kBoll = kBollSchema.defaults();
+constexpr AtrParams kAtr = kAtrSchema.defaults();
+constexpr AdxParams kAdx = kAdxSchema.defaults();
+constexpr CciParams kCci = kCciSchema.defaults();
+constexpr KdjParams kKdj = kKdjSchema.defaults();
+constexpr WillrParams kWillr = kWillrSchema.defaults();
+constexpr size_t kBollWindow = static_cast<size_t>(kBoll.period);
+constexpr size_t kCciWindow = static_cast<size_t>(kCci.period);
+constexpr size_t kKdjWindow = static_cast<size_t>(kKdj.k_period);
+constexpr size_t kWillrWindow = static_cast<size_t>(kWillr.period);
+
+// The mean of the first `period` inputs, then y = (1 - alpha) * y + alpha * x: how
+// compute_ema, the Wilder averages of RSI/ATR/ADX and MACD's dea are seeded.
+class SeededAverage {
+ public:
+  SeededAverage(int period, double alpha) : period_(static_cast<size_t>(period)), alpha_(alpha) {}
+
+  // The average after `x`; NaN until `period` inputs have been seen.
+  double push(double x) {
+    if (seen_ < period_) {
+      value_ += x;
+      if (++seen_ < period_) {
+        return nan_value();
+      }
+      value_ /= static_cast<double>(period_);
+      return value_;
+    }
+    value_ = (1.0 - alpha_) * value_ + alpha_ * x;
+    return value_;
+  }
+
+ private:
+  size_t period_;
+  double alpha_;
+  size_t seen_{0};
+  double value_{0.0};
+};
+
+// The sum of the first `period` inputs, then s = (1 - 1/period) * s + x: ADX's
+// smoothed true range and directional movement.
+class WilderSum {
+ public:
+  explicit WilderSum(int period)
+      : period_(static_cast<size_t>(period)), decay_(1.0 - 1.0 / static_cast<double>(period)) {}
+
+  // The sum after `x`; NaN until `period` inputs have been seen.
+  double push(double x) {
+    if (seen_ < period_) {
+      value_ += x;
+      return ++seen_ < period_ ? nan_value() : value_;
+    }
+    value_ = decay_ * value_ + x;
+    return value_;
+  }
+
+ private:
+  size_t period_;
+  double decay_;
+  size_t seen_{0};
+  double value_{0.0};
+};
+
+double to_rsi(double gain, double loss) {
+  if (loss == 0.0) {
+    return 100.0;
+  }
+  return 100.0 - (100.0 / (1.0 + gain / loss));
+}
+
+std::array<const IIndicator*, 11> members() {
+  static const SmaIndicator sma;
+  static const EmaIndicator ema;
+  static const MacdIndicator macd;
+  static const RsiIndicator rsi;
+  static const BollingerBandsIndicator boll;
+  static const AtrIndicator atr;
+  static const AdxIndicator adx;
+  static const CciIndicator cci;
+  static const StochasticIndicator kdj;
+  static const WilliamsRIndicator willr;
+  static const ObvIndicator obv;
+  return {&sma, &ema, &macd, &rsi, &boll, &atr, &adx, &cci, &kdj, &willr, &obv};
+}
+
+}  // namespace
+
+SeriesMap PackIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
+  const size_t n = bars.size();
+  require_bars(n, min_bars(params), "PACK");
+  SeriesMap out(output_names(), n);
+  Series& sma = out[0];
+  Series& ema = out[1];
+  Series& dif = out[2];
+  Series& dea = out[3];
+  Series& hist = out[4];
+  Series& rsi = out[5];
+  Series& upper = out[6];
+  Series& mid = out[7];
+  Series& lower = out[8];
+  Series& atr = out[9];
+  Series& adx = out[10];
+  Series& plus_di = out[11];
+  Series& minus_di = out[12];
+  Series& cci = out[13];
+  Series& k = out[14];
+  Series& d = out[15];
+  Series& j = out[16];
+  Series& willr = out[17];
+  Series& obv = out[18];
+
+  const size_t sma_period = static_cast<size_t>(kSma.period);
+  const double kdj_alpha = 1.0 / static_cast<double>(kKdj.d_period);
+  const double wilder = 1.0 / static_cast<double>(kRsi.period);
+
+  SeededAverage ema_state(kEma.period, kEma.smoothing / (kEma.period + 1.0));
+  SeededAverage fast(kMacd.fast, 2.0 / (kMacd.fast + 1.0));
+  SeededAverage slow(kMacd.slow, 2.0 / (kMacd.slow + 1.0));
+  SeededAverage signal(kMacd.signal, 2.0 / (kMacd.signal + 1.0));
+  SeededAverage gain(kRsi.period, wilder);
+  SeededAverage loss(kRsi.period, wilder);
+  SeededAverage atr_state(kAtr.period, 1.0 / static_cast<double>(kAtr.period));
+  WilderSum smooth_tr(kAdx.period);
+  WilderSum smooth_plus(kAdx.period);
+  WilderSum smooth_minus(kAdx.period);
+  SeededAverage adx_state(kAdx.period, 1.0 / static_cast<double>(kAdx.period));
+  double sma_sum = 0.0;
+  double boll_sum = 0.0;
+  double prev_k = 50.0;
+  double prev_d = 50.0;
+  double volume_total = 0.0;
+  std::array<double, kBollWindow> boll_close{};
+  std::array<double, kCciWindow> cci_typical{};
+  std::array<double, kKdjWindow> kdj_high{};
+  std::array<double, kKdjWindow> kdj_low{};
+  std::array<double, kWillrWindow> willr_high{};
+  std::array<double, kWillrWindow> willr_low{};
+
+  for (size_t i = 0; i < n; ++i) {
+    cancellation_point(i);
+    const OHLCV& bar = bars[i];
+    const OHLCV* prev = i == 0 ? nullptr : &bars[i - 1];
+
+    // Running window sums: SMA, and BOLL's mid.
+    sma_sum += bar.close;
+    if (i >= sma_period) {
+      sma_sum -= bars[i - sma_period].close;
+    }
+    if (i + 1 >= sma_period) {
+      sma[i] = sma_sum / static_cast<double>(sma_period);
+    }
+    boll_sum += bar.close;
+    if (i >= kBollWindow) {
+      boll_sum -= bars[i - kBollWindow].close;
+    }
+
+    // Exponential recurrences over close.
+    ema[i] = ema_state.push(bar.close);
+    const double fast_ema = fast.push(bar.close);
+    const double slow_ema = slow.push(bar.close);
+    if (!std::isnan(fast_ema) && !std::isnan(slow_ema)) {
+      dif[i] = fast_ema - slow_ema;
+      dea[i] = signal.push(dif[i]);
+      if (!std::isnan(dea[i])) {
+        hist[i] = 2.0 * (dif[i] - dea[i]);
+      }
+    }
+
+    // True range, directional movement and close changes, each against the prior bar.
+    if (prev == nullptr) {
+      atr[i] = atr_state.push(bar.high - bar.low);
+    } else {
+      const double change = bar.close - prev->close;
+      const double avg_gain = gain.push(change > 0.0 ? change : 0.0);
+      const double avg_loss = loss.push(change < 0.0 ? -change : 0.0);
+      if (!std::isnan(avg_gain)) {
+        rsi[i] = to_rsi(avg_gain, avg_loss);
+      }
+
+      const double tr = std::max({bar.high - bar.low, std::abs(bar.high - prev->close),
+                                  std::abs(bar.low - prev->close)});
+      atr[i] = atr_state.push(tr);
+
+      const double up_move = bar.high - prev->high;
+      const double down_move = prev->low - bar.low;
+      const double tr_sum = smooth_tr.push(tr);
+      const double plus_sum = smooth_plus.push(up_move > down_move && up_move > 0.0 ? up_move : 0.0);
+      const double minus_sum = smooth_minus.push(down_move > up_move && down_move > 0.0 ? down_move : 0.0);
+      if (!std::isnan(tr_sum)) {
+        double dx = nan_value();
+        if (tr_sum != 0.0) {
+          plus_di[i] = 100.0 * plus_sum / tr_sum;
+          minus_di[i] = 100.0 * minus_sum / tr_sum;
+          const double denominator = plus_di[i] + minus_di[i];
+          dx = denominator == 0.0 ? 0.0 : 100.0 * std::abs(plus_di[i] - minus_di[i]) / denominator;
+        }
+        adx[i] = adx_state.push(dx);
+      }
+
+      if (bar.close > prev->close) {
+        volume_total += static_cast<double>(bar.volume);
+      } else if (bar.close < prev->close) {
+        volume_total -= static_cast<double>(bar.volume);
+      }
+    }
+    obv[i] = volume_total;
+
+    // Window statistics over fixed-size rings of the last few values, refilled once
+    // per bar so the rescans below stay in registers and L1.
+    boll_close[i % kBollWindow] = bar.close;
+    cci_typical[i % kCciWindow] = (bar.high + bar.low + bar.close) / 3.0;
+    kdj_high[i % kKdjWindow] = bar.high;
+    kdj_low[i % kKdjWindow] = bar.low;
+    willr_high[i % kWillrWindow] = bar.high;
+    willr_low[i % kWillrWindow] = bar.low;
+    if (i + 1 >= kBollWindow) {
+      mid[i] = boll_sum / static_cast<double>(kBollWindow);
+      double variance = 0.0;
+      for (const double close : boll_close) {
+        variance += (close - mid[i]) * (close - mid[i]);
+      }
+      const double stddev = std::sqrt(variance / static_cast<double>(kBollWindow));
+      upper[i] = mid[i] + kBoll.std_dev * stddev;
+      lower[i] = mid[i] - kBoll.std_dev * stddev;
+    }
+    if (i + 1 >= kCciWindow) {
+      double tp_sum = 0.0;
+      for (const double tp : cci_typical) {
+        tp_sum += tp;
+      }
+      const double mean = tp_sum / static_cast<double>(kCciWindow);
+      double mad = 0.0;
+      for (const double tp : cci_typical) {
+        mad += std::abs(tp - mean);
+      }
+      mad /= static_cast<double>(kCciWindow);
+      cci[i] = mad == 0.0 ? 0.0 : (cci_typical[i % kCciWindow] - mean) / (kCci.constant * mad);
+    }
+    if (i + 1 >= kKdjWindow) {
+      const double highest_high = *std::max_element(kdj_high.begin(), kdj_high.end());
+      const double lowest_low = *std::min_element(kdj_low.begin(), kdj_low.end());
+      const double range = highest_high - lowest_low;
+      const double rsv = range == 0.0 ? 50.0 : 100.0 * (bar.close - lowest_low) / range;
+      prev_k = (1.0 - kdj_alpha) * prev_k + kdj_alpha * rsv;
+      prev_d = (1.0 - kdj_alpha) * prev_d + kdj_alpha * prev_k;
+      k[i] = prev_k;
+      d[i] = prev_d;
+      j[i] = kKdj.j_smooth * prev_k - (kKdj.j_smooth - 1.0) * prev_d;
+    }
+    if (i + 1 >= kWillrWindow) {
+      const double highest_high = *std::max_element(willr_high.begin(), willr_high.end());
+      const double lowest_low = *std::min_element(willr_low.begin(), willr_low.end());
+      const double range = highest_high - lowest_low;
+      willr[i] = range == 0.0 ? 0.0 : -100.0 * (highest_high - bar.close) / range;
+    }
+  }
+  return out;
+}
+
+size_t PackIndicator::min_bars(const Params&) const {
+  size_t bars = 0;
+  for (const IIndicator* member : members()) {
+    bars = std::max(bars, member->min_bars({}));
+  }
+  return bars;
+}
+
+size_t PackIndicator::warmup_bars(const Params&, double tolerance) const {
+  size_t bars = 0;
+  for (const IIndicator* member : members()) {
+    bars = std::max(bars, member->warmup_bars({}, tolerance));
+  }
+  return bars;
+}
+
+}  // namespace tg_indicators
@@ -10,6 +10,7 @@
 #include "tg_indicators/indicators/ema.h"
 #include "tg_indicators/indicators/macd.h"
 #include "tg_indicators/indicators/obv.h"
+#include "tg_indicators/indicators/pack.h"
 #include "tg_indicators/indicators/rsi.h"
 #include "tg_indicators/indicators/sma.h"
 #include "tg_indicators/indicators/stochastic.h"
@@ -63,6 +64,9 @@ std::unique_ptr<IIndicator> create_indicator(const std::string& name) {
   if (key == "OBV") {
     return std::make_unique<ObvIndicator>();
   }
+  if (key == "PACK") {
+    return std::make_unique<PackIndicator>();
+  }
   return nullptr;
 }
 
@@ -1,15 +1,53 @@
 #include "tg_indicators/indicators/rsi.h"
 
+#include "tg_indicators/indicators/specialize.h"
+#include "tg_indicators/linear_scan.h"
+
 namespace tg_indicators {
+namespace {
 
-SeriesMap RsiIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
-  const int period = period_param(params, "period", 14);
-  require_bars(bars.size(), static_cast<size_t>(period + 1), "RSI");
+double to_rsi(double gain, double loss) {
+  if (loss == 0.0) {
+    return 100.0;
+  }
+  const double rs = gain / loss;
+  return 100.0 - (100.0 / (1.0 + rs));
+}
+
+// Wilder-smooths the close changes of bars[first..] into avg_gain/avg_loss, which
+// hold the averages as of the bar before `first` (whose close is prev_close), and
+// writes rsi[first..]. The averages are left at their values after the last bar.
+void smooth_changes(const std::vector<OHLCV>& bars, size_t first, double prev_close, int period,
+                    double& avg_gain, double& avg_loss, Series& rsi) {
+  const size_t tail = bars.size() - first;
+  Series gains(tail, arena_resource());
+  Series losses(tail, arena_resource());
+  for (size_t i = 0; i < tail; ++i) {
+    const double change = bars[first + i].close - (i == 0 ? prev_close : bars[first + i - 1].close);
+    gains[i] = change > 0.0 ? change : 0.0;
+    losses[i] = change < 0.0 ? -change : 0.0;
+  }
+  const double weight = 1.0 / static_cast<double>(period);
+  linear_recurrence(gains.data(), gains.data(), tail, 1.0 - weight, weight, avg_gain);
+  linear_recurrence(losses.data(), losses.data(), tail, 1.0 - weight, weight, avg_loss);
+  for (size_t i = 0; i < tail; ++i) {
+    rsi[first + i] = to_rsi(gains[i], losses[i]);
+  }
+  if (tail > 0) {
+    avg_gain = gains.back();
+    avg_loss = losses.back();
+  }
+}
 
-  std::vector<double> rsi(bars.size(), nan_value());
+// Seeding, Wilder smoothing and the ratio in one pass with no scratch series. Performs
+// the same operations in the same order as the sequential multi-pass path, so the
+// output is identical.
+void rsi_single_pass(const std::vector<OHLCV>& bars, int period, Series& rsi) {
+  const size_t p = static_cast<size_t>(period);
+  const double weight = 1.0 / static_cast<double>(period);
   double avg_gain = 0.0;
   double avg_loss = 0.0;
-  for (size_t i = 1; i <= static_cast<size_t>(period); ++i) {
+  for (size_t i = 1; i <= p; ++i) {
     const double change = bars[i].close - bars[i - 1].close;
     if (change >= 0.0) {
       avg_gain += change;
@@ -19,26 +57,65 @@ SeriesMap RsiIndicator::compute(const std::vector<OHLCV>& bars, const Params& pa
   }
   avg_gain /= static_cast<double>(period);
   avg_loss /= static_cast<double>(period);
-
-  auto to_rsi = [](double gain, double loss) {
-    if (loss == 0.0) {
-      return 100.0;
-    }
-    const double rs = gain / loss;
-    return 100.0 - (100.0 / (1.0 + rs));
-  };
-
-  rsi[static_cast<size_t>(period)] = to_rsi(avg_gain, avg_loss);
-  for (size_t i = static_cast<size_t>(period) + 1; i < bars.size(); ++i) {
+  rsi[p] = to_rsi(avg_gain, avg_loss);
+  for (size_t i = p + 1; i < bars.size(); ++i) {
+    cancellation_point(i);
     const double change = bars[i].close - bars[i - 1].close;
-    const double gain = change > 0.0 ? change : 0.0;
-    const double loss = change < 0.0 ? -change : 0.0;
-    avg_gain = ((avg_gain * static_cast<double>(period - 1)) + gain) / static_cast<double>(period);
-    avg_loss = ((avg_loss * static_cast<double>(period - 1)) + loss) / static_cast<double>(period);
+    avg_gain = (1.0 - weight) * avg_gain + weight * (change > 0.0 ? change : 0.0);
+    avg_loss = (1.0 - weight) * avg_loss + weight * (change < 0.0 ? -change : 0.0);
     rsi[i] = to_rsi(avg_gain, avg_loss);
   }
-  return {{"rsi", rsi}};
 }
 
-}  // namespace tg_indicators
+}  // namespace
 
+SeriesMap RsiIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
+  return compute_seeded(bars, params, {}, nullptr);
+}
+
+size_t RsiIndicator::warmup_bars(const Params& params, double tolerance) const {
+  const int period = kRsiSchema.decode(params).period;
+  return min_bars(params) + convergence_bars(1.0 / static_cast<double>(period), tolerance);
+}
+
+SeriesMap RsiIndicator::compute_seeded(const std::vector<OHLCV>& bars, const Params& params,
+                                       const Params& seed, Params* state) const {
+  const int period = kRsiSchema.decode(params).period;
+  SeriesMap out(output_names(), bars.size());
+  Series& rsi = out[0];
+  double avg_gain = 0.0;
+  double avg_loss = 0.0;
+  if (seed.empty()) {
+    require_bars(bars.size(), static_cast<size_t>(period + 1), "RSI");
+    // Long inputs keep the multi-pass path, whose recurrences can run as a parallel scan.
+    if (state == nullptr && specialized_kernels() && bars.size() < kParallelScanThreshold) {
+      rsi_single_pass(bars, period, rsi);
+      return out;
+    }
+    for (size_t i = 1; i <= static_cast<size_t>(period); ++i) {
+      const double change = bars[i].close - bars[i - 1].close;
+      if (change >= 0.0) {
+        avg_gain += change;
+      } else {
+        avg_loss -= change;
+      }
+    }
+    avg_gain /= static_cast<double>(period);
+    avg_loss /= static_cast<double>(period);
+    const size_t p = static_cast<size_t>(period);
+    rsi[p] = to_rsi(avg_gain, avg_loss);
+    smooth_changes(bars, p + 1, bars[p].close, period, avg_gain, avg_loss, rsi);
+  } else {
+    avg_gain = seed_value(seed, "avg_gain");
+    avg_loss = seed_value(seed, "avg_loss");
+    smooth_changes(bars, 0, seed_value(seed, "prev_close"), period, avg_gain, avg_loss, rsi);
+  }
+  if (state != nullptr) {
+    (*state)["avg_gain"] = avg_gain;
+    (*state)["avg_loss"] = avg_loss;
+    (*state)["prev_close"] = bars.empty() ? seed_value(seed, "prev_close") : bars.back().close;
+  }
+  return out;
+}
+
+}  // namespace tg_indicators
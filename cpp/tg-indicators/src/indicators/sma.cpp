@@ -2,9 +2,9 @@
 
 namespace tg_indicators {
 
-std::vector<double> compute_sma(const std::vector<double>& values, int period) {
+Series compute_sma(std::span<const double> values, int period) {
   require_bars(values.size(), static_cast<size_t>(period), "SMA");
-  std::vector<double> out(values.size(), nan_value());
+  Series out = make_series(values.size());
   double sum = 0.0;
   for (size_t i = 0; i < values.size(); ++i) {
     sum += values[i];
@@ -19,8 +19,31 @@ std::vector<double> compute_sma(const std::vector<double>& values, int period) {
 }
 
 SeriesMap SmaIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
-  const int period = period_param(params, "period", 20);
-  return {{"sma", compute_sma(close_values(bars), period)}};
+  const int period = kSmaSchema.decode(params).period;
+  SeriesMap out;
+  out.emplace(output_names()[0], compute_sma(close_values(bars), period));
+  return out;
+}
+
+SeriesMap SmaIndicator::compute_fixed(const FixedBars& bars, const Params& params) const {
+  const int period = kSmaSchema.decode(params).period;
+  require_bars(bars.size(), static_cast<size_t>(period), "SMA");
+  const size_t p = static_cast<size_t>(period);
+  SeriesMap out(output_names(), bars.size());
+  Series& sma = out[0];
+  // The running sum is exact, so there is no drift from adding and removing values.
+  const double divisor = static_cast<double>(period) * static_cast<double>(kPriceScale);
+  int64_t sum = 0;
+  for (size_t i = 0; i < bars.size(); ++i) {
+    sum += bars.close[i];
+    if (i >= p) {
+      sum -= bars.close[i - p];
+    }
+    if (i + 1 >= p) {
+      sma[i] = static_cast<double>(sum) / divisor;
+    }
+  }
+  return out;
 }
 
 }  // namespace tg_indicators
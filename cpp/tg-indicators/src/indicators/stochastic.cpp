@@ -4,38 +4,83 @@
 
 namespace tg_indicators {
 
-SeriesMap StochasticIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
-  const int k_period = period_param(params, "k_period", 9);
-  const int d_period = period_param(params, "d_period", 3);
-  const double j_smooth = param_or(params, "j_smooth", 3.0);
-  if (!std::isfinite(j_smooth) || j_smooth <= 0.0) {
-    throw std::invalid_argument("parameter j_smooth must be positive");
-  }
-  require_bars(bars.size(), static_cast<size_t>(k_period), "KDJ");
+namespace {
 
-  std::vector<double> k(bars.size(), nan_value());
-  std::vector<double> d(bars.size(), nan_value());
-  std::vector<double> j(bars.size(), nan_value());
+// Shared by the double and fixed-point paths. `high`, `low` and `close` map a bar index
+// to a price of one type; window extrema and the RSV numerator and range are taken in
+// that type, so fixed-point inputs only meet floating point at the RSV division.
+// `names` are the k, d and j slots, in that order.
+template <typename High, typename Low, typename Close>
+SeriesMap kdj_kernel(std::span<const char* const> names, size_t n, High high, Low low, Close close,
+                     const KdjParams& kdj) {
+  SeriesMap out(names, n);
+  Series& k = out[0];
+  Series& d = out[1];
+  Series& j = out[2];
   double prev_k = 50.0;
   double prev_d = 50.0;
-  const size_t kp = static_cast<size_t>(k_period);
-  const double k_alpha = 1.0 / static_cast<double>(d_period);
-  for (size_t i = kp - 1; i < bars.size(); ++i) {
-    double highest_high = bars[i + 1 - kp].high;
-    double lowest_low = bars[i + 1 - kp].low;
+  const size_t kp = static_cast<size_t>(kdj.k_period);
+  const double k_alpha = 1.0 / static_cast<double>(kdj.d_period);
+  for (size_t i = kp - 1; i < n; ++i) {
+    cancellation_point(i);
+    auto highest_high = high(i + 1 - kp);
+    auto lowest_low = low(i + 1 - kp);
     for (size_t idx = i + 1 - kp; idx <= i; ++idx) {
-      highest_high = std::max(highest_high, bars[idx].high);
-      lowest_low = std::min(lowest_low, bars[idx].low);
+      highest_high = std::max(highest_high, high(idx));
+      lowest_low = std::min(lowest_low, low(idx));
     }
-    const double range = highest_high - lowest_low;
-    const double rsv = range == 0.0 ? 50.0 : 100.0 * (bars[i].close - lowest_low) / range;
+    const auto range = highest_high - lowest_low;
+    const double rsv = range == 0 ? 50.0
+                                  : 100.0 * static_cast<double>(close(i) - lowest_low) /
+                                        static_cast<double>(range);
     prev_k = (1.0 - k_alpha) * prev_k + k_alpha * rsv;
     prev_d = (1.0 - k_alpha) * prev_d + k_alpha * prev_k;
     k[i] = prev_k;
     d[i] = prev_d;
-    j[i] = j_smooth * k[i] - (j_smooth - 1.0) * d[i];
+    j[i] = kdj.j_smooth * k[i] - (kdj.j_smooth - 1.0) * d[i];
   }
-  return {{"k", k}, {"d", d}, {"j", j}};
+  return out;
+}
+
+}  // namespace
+
+SeriesMap StochasticIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
+  const KdjParams kdj = kKdjSchema.decode(params);
+  require_bars(bars.size(), static_cast<size_t>(kdj.k_period), "KDJ");
+  return kdj_kernel(
+      output_names(), bars.size(), [&](size_t i) { return bars[i].high; },
+      [&](size_t i) { return bars[i].low; }, [&](size_t i) { return bars[i].close; }, kdj);
+}
+
+SeriesMap StochasticIndicator::compute_masked(const std::vector<OHLCV>& bars, const BarMask& valid,
+                                              const Params& params) const {
+  const KdjParams kdj = kKdjSchema.decode(params);
+  const Positions positions = valid_positions(valid);
+  require_bars(positions.size(), static_cast<size_t>(kdj.k_period), "KDJ");
+  auto bar = [&](size_t j) -> const OHLCV& { return bars[positions[j]]; };
+  return scatter_valid(
+      kdj_kernel(
+          output_names(), positions.size(), [&](size_t j) { return bar(j).high; },
+          [&](size_t j) { return bar(j).low; }, [&](size_t j) { return bar(j).close; }, kdj),
+      positions, bars.size());
+}
+
+SeriesMap StochasticIndicator::compute_fixed(const FixedBars& bars, const Params& params) const {
+  const KdjParams kdj = kKdjSchema.decode(params);
+  require_bars(bars.size(), static_cast<size_t>(kdj.k_period), "KDJ");
+  return kdj_kernel(
+      output_names(), bars.size(), [&](size_t i) { return bars.high[i]; },
+      [&](size_t i) { return bars.low[i]; }, [&](size_t i) { return bars.close[i]; }, kdj);
+}
+
+size_t StochasticIndicator::warmup_bars(const Params& params, double tolerance) const {
+  // K and D both start at 50 and smooth with 1/d_period, D chained on K.
+  const KdjParams kdj = kKdjSchema.decode(params);
+  return min_bars(params) + 2 * convergence_bars(1.0 / static_cast<double>(kdj.d_period), tolerance);
+}
+
+double StochasticIndicator::cost_per_bar(const Params& params) const {
+  return window_scan_cost(kKdjSchema.decode_or_default(params).k_period);
 }
 
 }  // namespace tg_indicators
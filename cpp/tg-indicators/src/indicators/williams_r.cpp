@@ -4,23 +4,69 @@
 
 namespace tg_indicators {
 
-SeriesMap WilliamsRIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
-  const int period = period_param(params, "period", 14);
-  require_bars(bars.size(), static_cast<size_t>(period), "WILLR");
+namespace {
 
-  std::vector<double> out(bars.size(), nan_value());
+// Shared by the double and fixed-point paths; see kdj_kernel in stochastic.cpp.
+template <typename High, typename Low, typename Close>
+Series willr_kernel(size_t n, High high, Low low, Close close, int period) {
+  Series out = make_series(n);
   const size_t p = static_cast<size_t>(period);
-  for (size_t i = p - 1; i < bars.size(); ++i) {
-    double highest_high = bars[i + 1 - p].high;
-    double lowest_low = bars[i + 1 - p].low;
+  for (size_t i = p - 1; i < n; ++i) {
+    cancellation_point(i);
+    auto highest_high = high(i + 1 - p);
+    auto lowest_low = low(i + 1 - p);
     for (size_t idx = i + 1 - p; idx <= i; ++idx) {
-      highest_high = std::max(highest_high, bars[idx].high);
-      lowest_low = std::min(lowest_low, bars[idx].low);
+      highest_high = std::max(highest_high, high(idx));
+      lowest_low = std::min(lowest_low, low(idx));
     }
-    const double range = highest_high - lowest_low;
-    out[i] = range == 0.0 ? 0.0 : -100.0 * (highest_high - bars[i].close) / range;
+    const auto range = highest_high - lowest_low;
+    out[i] = range == 0 ? 0.0
+                        : -100.0 * static_cast<double>(highest_high - close(i)) /
+                              static_cast<double>(range);
   }
-  return {{"willr", out}};
+  return out;
+}
+
+}  // namespace
+
+SeriesMap WilliamsRIndicator::compute(const std::vector<OHLCV>& bars, const Params& params) const {
+  const int period = kWillrSchema.decode(params).period;
+  require_bars(bars.size(), static_cast<size_t>(period), "WILLR");
+  SeriesMap out;
+  out.emplace(output_names()[0], willr_kernel(
+                                     bars.size(), [&](size_t i) { return bars[i].high; },
+                                     [&](size_t i) { return bars[i].low; },
+                                     [&](size_t i) { return bars[i].close; }, period));
+  return out;
+}
+
+SeriesMap WilliamsRIndicator::compute_masked(const std::vector<OHLCV>& bars, const BarMask& valid,
+                                             const Params& params) const {
+  const int period = kWillrSchema.decode(params).period;
+  const Positions positions = valid_positions(valid);
+  require_bars(positions.size(), static_cast<size_t>(period), "WILLR");
+  auto bar = [&](size_t j) -> const OHLCV& { return bars[positions[j]]; };
+  SeriesMap compact;
+  compact.emplace(output_names()[0], willr_kernel(
+                                         positions.size(), [&](size_t j) { return bar(j).high; },
+                                         [&](size_t j) { return bar(j).low; },
+                                         [&](size_t j) { return bar(j).close; }, period));
+  return scatter_valid(compact, positions, bars.size());
+}
+
+SeriesMap WilliamsRIndicator::compute_fixed(const FixedBars& bars, const Params& params) const {
+  const int period = kWillrSchema.decode(params).period;
+  require_bars(bars.size(), static_cast<size_t>(period), "WILLR");
+  SeriesMap out;
+  out.emplace(output_names()[0], willr_kernel(
+                                     bars.size(), [&](size_t i) { return bars.high[i]; },
+                                     [&](size_t i) { return bars.low[i]; },
+                                     [&](size_t i) { return bars.close[i]; }, period));
+  return out;
+}
+
+double WilliamsRIndicator::cost_per_bar(const Params& params) const {
+  return window_scan_cost(kWillrSchema.decode_or_default(params).period);
 }
 
 }  // namespace tg_indicators
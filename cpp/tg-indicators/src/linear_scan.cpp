@@ -0,0 +1,70 @@
+#include "tg_indicators/linear_scan.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tg_indicators/cancellation.h"
+#include "tg_indicators/parallel.h"
+
+namespace tg_indicators {
+namespace {
+
+void sequential_recurrence(const double* x, double* y, size_t count, double a, double b,
+                           double seed) {
+  double prev = seed;
+  for (size_t i = 0; i < count; ++i) {
+    cancellation_point(i);
+    prev = a * prev + b * x[i];
+    y[i] = prev;
+  }
+}
+
+}  // namespace
+
+void linear_recurrence(const double* x, double* y, size_t count, double a, double b, double seed,
+                       size_t threads) {
+  const size_t workers = threads == 0 ? default_worker_count() : threads;
+  if (count < kParallelScanThreshold || workers <= 1) {
+    sequential_recurrence(x, y, count, a, b, seed);
+    return;
+  }
+
+  // A few blocks per worker so a slow thread does not hold up the fix-up pass.
+  const size_t blocks = std::min(count, workers * 4);
+  const size_t block_size = (count + blocks - 1) / blocks;
+  const size_t block_count = (count + block_size - 1) / block_size;
+
+  parallel_for(block_count, workers, [&](size_t k) {
+    const size_t begin = k * block_size;
+    const size_t end = std::min(begin + block_size, count);
+    sequential_recurrence(x + begin, y + begin, end - begin, a, b, k == 0 ? seed : 0.0);
+  });
+
+  std::vector<double> powers(block_size);
+  double power = 1.0;
+  for (size_t j = 0; j < block_size; ++j) {
+    power *= a;
+    powers[j] = power;
+  }
+
+  // Carry into block k is the true value at the end of block k - 1.
+  std::vector<double> carries(block_count, 0.0);
+  for (size_t k = 1; k < block_count; ++k) {
+    const size_t last = k * block_size - 1;
+    const double previous_carry = k == 1 ? 0.0 : carries[k - 1];
+    carries[k] = y[last] + powers[block_size - 1] * previous_carry;
+  }
+
+  parallel_for(block_count - 1, workers, [&](size_t index) {
+    const size_t k = index + 1;
+    const size_t begin = k * block_size;
+    const size_t end = std::min(begin + block_size, count);
+    const double carry = carries[k];
+    double* block = y + begin;
+    for (size_t j = 0; j < end - begin; ++j) {
+      block[j] += powers[j] * carry;
+    }
+  });
+}
+
+}  // namespace tg_indicators
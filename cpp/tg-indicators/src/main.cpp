@@ -1,12 +1,20 @@
+#include <algorithm>
 #include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
 #include <csignal>
 #include <cstdlib>
+#include <filesystem>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <thread>
 
+#include "tg_indicators/batch_cli.h"
 #include "tg_indicators/indicator_service.h"
+#include "tg_indicators/shm_transport.h"
 
 namespace {
 
@@ -16,9 +24,35 @@ void handle_signal(int) {
   shutdown_requested.store(true);
 }
 
+constexpr std::chrono::seconds kDefaultSnapshotInterval{30};
+// Long enough that a session quiet over a weekend or an exchange holiday keeps its state.
+constexpr std::chrono::seconds kDefaultSessionIdle = std::chrono::hours(24 * 30);
+
+// Reads the environment variable `name` as a positive whole number of seconds. Anything
+// else is logged and replaced by `fallback` rather than aborting startup.
+std::chrono::seconds env_seconds(const char* name, std::chrono::seconds fallback) {
+  const char* env = std::getenv(name);
+  if (env == nullptr) {
+    return fallback;
+  }
+  const std::string_view text(env);
+  int64_t seconds = 0;
+  const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), seconds);
+  if (ec != std::errc() || end != text.data() + text.size() || seconds <= 0) {
+    std::cerr << "ignoring " << name << "=\"" << text << "\": expected a positive integer, using "
+              << fallback.count() << '\n';
+    return fallback;
+  }
+  return std::chrono::seconds(seconds);
+}
+
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+  if (argc > 1 && std::string(argv[1]) == "batch") {
+    return tg_indicators::run_batch_cli(argc - 1, argv + 1);
+  }
+
   const char* port_env = std::getenv("TG_INDICATORS_PORT");
   const std::string port = port_env == nullptr ? "50053" : port_env;
   const std::string address = "0.0.0.0:" + port;
@@ -26,7 +60,46 @@ int main() {
   std::signal(SIGINT, handle_signal);
   std::signal(SIGTERM, handle_signal);
 
-  tg_indicators::IndicatorServiceImpl service;
+  tg_indicators::ServiceOptions options;
+  // Sampled traffic capture for tg_indicators_replay: TG_INDICATORS_CAPTURE=<file>,
+  // TG_INDICATORS_CAPTURE_RATE in [0, 1] (default 1).
+  if (const char* capture = std::getenv("TG_INDICATORS_CAPTURE"); capture != nullptr && *capture) {
+    options.capture.path = capture;
+    if (const char* rate = std::getenv("TG_INDICATORS_CAPTURE_RATE"); rate != nullptr) {
+      options.capture.sample_rate = std::stod(rate);
+    }
+    std::cout << "capturing requests to " << options.capture.path
+              << " sample_rate=" << options.capture.sample_rate << '\n';
+  }
+  // Compressed per-session bar history fed by StreamUpdate: TG_INDICATORS_KEEP_HISTORY=1.
+  if (const char* keep = std::getenv("TG_INDICATORS_KEEP_HISTORY"); keep != nullptr) {
+    options.keep_history = std::string(keep) == "1";
+  }
+  tg_indicators::IndicatorServiceImpl service(std::move(options));
+
+  // Streaming state persistence: TG_INDICATORS_STATE_FILE=<path>, snapshotted every
+  // TG_INDICATORS_SNAPSHOT_SECONDS (default 30) and on shutdown.
+  const char* state_file_env = std::getenv("TG_INDICATORS_STATE_FILE");
+  const std::string state_file = state_file_env == nullptr ? "" : state_file_env;
+  const auto snapshot_interval = env_seconds("TG_INDICATORS_SNAPSHOT_SECONDS", kDefaultSnapshotInterval);
+  // Streaming states and histories untouched for TG_INDICATORS_SESSION_IDLE_SECONDS
+  // (default 30 days) are dropped by the once-a-minute sweep.
+  const auto session_idle = env_seconds("TG_INDICATORS_SESSION_IDLE_SECONDS", kDefaultSessionIdle);
+  if (!state_file.empty() && std::filesystem::exists(state_file)) {
+    try {
+      const size_t restored = service.streams().restore(state_file);
+      std::cout << "restored " << restored << " streaming states from " << state_file << '\n';
+    } catch (const std::exception& e) {
+      std::cerr << "ignoring stream snapshot: " << e.what() << '\n';
+    }
+  }
+  auto write_snapshot = [&] {
+    try {
+      service.streams().snapshot(state_file);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << '\n';
+    }
+  };
   std::unique_ptr<grpc::Server> server = tg_indicators::StartIndicatorServer(address, &service);
   if (!server) {
     std::cerr << "failed to start tg-indicators on " << address << '\n';
@@ -34,10 +107,64 @@ int main() {
   }
 
   std::cout << "tg-indicators listening on " << address << '\n';
+
+  // Optional same-host transport: TG_INDICATORS_SHM=<segment name>.
+  std::unique_ptr<tg_indicators::ShmIndicatorServer> shm_server;
+  if (const char* shm_name = std::getenv("TG_INDICATORS_SHM"); shm_name != nullptr && *shm_name) {
+    const char* slots_env = std::getenv("TG_INDICATORS_SHM_SLOTS");
+    const char* bars_env = std::getenv("TG_INDICATORS_SHM_MAX_BARS");
+    const uint32_t slots = slots_env == nullptr ? 16 : static_cast<uint32_t>(std::stoul(slots_env));
+    const size_t max_bars = bars_env == nullptr ? 65536 : std::stoul(bars_env);
+    // An existing segment of that name is only replaced with TG_INDICATORS_SHM_REPLACE=1,
+    // e.g. one left behind by a crashed server.
+    const char* replace_env = std::getenv("TG_INDICATORS_SHM_REPLACE");
+    const bool replace = replace_env != nullptr && std::string(replace_env) == "1";
+    const size_t workers = std::max(1u, std::thread::hardware_concurrency() / 2);
+    try {
+      shm_server = std::make_unique<tg_indicators::ShmIndicatorServer>(service, shm_name, slots, max_bars,
+                                                                       workers, replace);
+    } catch (const std::exception& e) {
+      std::cerr << "failed to serve shared memory /" << shm_name << ": " << e.what() << '\n';
+      server->Shutdown();
+      return 1;
+    }
+    std::cout << "tg-indicators serving shared memory /" << shm_name << " slots=" << slots
+              << " max_bars=" << max_bars << '\n';
+  }
+  auto next_report = std::chrono::steady_clock::now() + std::chrono::minutes(1);
+  auto next_snapshot = std::chrono::steady_clock::now() + snapshot_interval;
+  uint64_t reported_executions = 0;
   while (!shutdown_requested.load()) {
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (!state_file.empty() && std::chrono::steady_clock::now() >= next_snapshot) {
+      next_snapshot += snapshot_interval;
+      write_snapshot();
+    }
+    if (std::chrono::steady_clock::now() < next_report) {
+      continue;
+    }
+    next_report += std::chrono::minutes(1);
+    const size_t evicted =
+        service.streams().evict_idle(session_idle) + service.history().evict_idle(session_idle);
+    if (evicted > 0) {
+      std::cout << "evicted " << evicted << " idle streaming states and histories\n";
+    }
+    const auto& coalescer = service.coalescer();
+    const auto& admission = service.admission();
+    if (coalescer.executions() != reported_executions) {
+      reported_executions = coalescer.executions();
+      std::cout << "computations=" << coalescer.executions()
+                << " coalesced=" << coalescer.coalesced() << " shed=" << admission.shed()
+                << " deadline_rejected=" << admission.rejected_deadline() << '\n';
+    }
+  }
+  if (shm_server) {
+    shm_server->stop();
   }
   server->Shutdown();
+  if (!state_file.empty()) {
+    write_snapshot();
+  }
   return 0;
 }
 
@@ -0,0 +1,1109 @@
+#include "tg_indicators/parquet_reader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string_view>
+
+#include "tg_indicators/time_util.h"
+
+namespace tg_indicators {
+namespace {
+
+[[noreturn]] void format_error(const std::string& message) {
+  throw std::runtime_error("parquet: " + message);
+}
+
+// Read-only memory map of the whole file. Only the footer and the byte ranges of the
+// projected column chunks are ever touched, so untouched columns are never paged in.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path) {
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+      throw std::runtime_error("open " + path + ": " + std::strerror(errno));
+    }
+    struct stat st {};
+    if (::fstat(fd_, &st) != 0) {
+      const int err = errno;
+      ::close(fd_);
+      throw std::runtime_error("stat " + path + ": " + std::strerror(err));
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+      void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+      if (mapped == MAP_FAILED) {
+        const int err = errno;
+        ::close(fd_);
+        throw std::runtime_error("mmap " + path + ": " + std::strerror(err));
+      }
+      data_ = static_cast<const uint8_t*>(mapped);
+    }
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) {
+      ::munmap(const_cast<uint8_t*>(data_), size_);
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  int fd_{-1};
+  const uint8_t* data_{nullptr};
+  size_t size_{};
+};
+
+// ---------------------------------------------------------------------------------
+// Thrift compact protocol: just enough to walk FileMetaData and PageHeader.
+
+enum ThriftType : uint8_t {
+  kStop = 0,
+  kBoolTrue = 1,
+  kBoolFalse = 2,
+  kByte = 3,
+  kI16 = 4,
+  kI32 = 5,
+  kI64 = 6,
+  kDouble = 7,
+  kBinary = 8,
+  kList = 9,
+  kSet = 10,
+  kMap = 11,
+  kStruct = 12,
+};
+
+class CompactReader {
+ public:
+  CompactReader(const uint8_t* data, size_t size) : pos_(data), end_(data + size) {}
+
+  size_t consumed_from(const uint8_t* start) const { return static_cast<size_t>(pos_ - start); }
+
+  // Returns false at STOP. Tracks the previous field id for delta encoding.
+  bool next_field(int16_t& id, uint8_t& type) {
+    const uint8_t header = byte();
+    type = header & 0x0f;
+    if (type == kStop) {
+      return false;
+    }
+    const uint8_t delta = header >> 4;
+    id = delta == 0 ? static_cast<int16_t>(zigzag(varint())) : static_cast<int16_t>(last_id_ + delta);
+    last_id_ = id;
+    if (type == kBoolTrue || type == kBoolFalse) {
+      bool_value_ = type == kBoolTrue;
+    }
+    return true;
+  }
+
+  template <typename Fn>
+  void read_struct(Fn&& on_field) {
+    const int16_t saved = last_id_;
+    last_id_ = 0;
+    int16_t id = 0;
+    uint8_t type = 0;
+    while (next_field(id, type)) {
+      on_field(id, type);
+    }
+    last_id_ = saved;
+  }
+
+  template <typename Fn>
+  void read_list(Fn&& on_element) {
+    const uint8_t header = byte();
+    uint64_t size = header >> 4;
+    if (size == 15) {
+      size = varint();
+    }
+    const uint8_t elem_type = header & 0x0f;
+    for (uint64_t i = 0; i < size; ++i) {
+      on_element(elem_type);
+    }
+  }
+
+  int64_t i64() { return zigzag(varint()); }
+  int32_t i32() { return static_cast<int32_t>(zigzag(varint())); }
+  bool boolean() const { return bool_value_; }
+
+  std::string_view binary() {
+    const uint64_t len = varint();
+    require(len);
+    std::string_view out(reinterpret_cast<const char*>(pos_), static_cast<size_t>(len));
+    pos_ += len;
+    return out;
+  }
+
+  void skip(uint8_t type) {
+    switch (type) {
+      case kBoolTrue:
+      case kBoolFalse:
+        return;
+      case kByte:
+        byte();
+        return;
+      case kI16:
+      case kI32:
+      case kI64:
+        varint();
+        return;
+      case kDouble:
+        require(8);
+        pos_ += 8;
+        return;
+      case kBinary:
+        binary();
+        return;
+      case kList:
+      case kSet:
+        read_list([this](uint8_t elem) { skip_element(elem); });
+        return;
+      case kMap: {
+        const uint64_t size = varint();
+        if (size == 0) {
+          return;
+        }
+        const uint8_t types = byte();
+        for (uint64_t i = 0; i < size; ++i) {
+          skip_element(types >> 4);
+          skip_element(types & 0x0f);
+        }
+        return;
+      }
+      case kStruct:
+        read_struct([this](int16_t, uint8_t field_type) { skip(field_type); });
+        return;
+      default:
+        format_error("unknown thrift type " + std::to_string(type));
+    }
+  }
+
+ private:
+  // Inside collections booleans occupy a whole byte instead of living in the field header.
+  void skip_element(uint8_t type) {
+    if (type == kBoolTrue || type == kBoolFalse) {
+      byte();
+    } else {
+      skip(type);
+    }
+  }
+
+  void require(uint64_t bytes) const {
+    if (bytes > static_cast<uint64_t>(end_ - pos_)) {
+      format_error("truncated thrift structure");
+    }
+  }
+
+  uint8_t byte() {
+    require(1);
+    return *pos_++;
+  }
+
+  uint64_t varint() {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      const uint8_t b = byte();
+      result |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if ((b & 0x80) == 0) {
+        return result;
+      }
+    }
+    format_error("varint too long");
+  }
+
+  static int64_t zigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  const uint8_t* pos_;
+  const uint8_t* end_;
+  int16_t last_id_{0};
+  bool bool_value_{false};
+};
+
+// ---------------------------------------------------------------------------------
+// Parquet metadata subset.
+
+enum PhysicalType : int32_t {
+  kInt32 = 1,
+  kInt64 = 2,
+  kDoubleType = 5,
+  kFixedLenByteArray = 7,
+};
+
+enum Encoding : int32_t {
+  kPlain = 0,
+  kPlainDictionary = 2,
+  kRleDictionary = 8,
+};
+
+enum Codec : int32_t {
+  kUncompressed = 0,
+  kSnappy = 1,
+};
+
+enum PageType : int32_t {
+  kDataPage = 0,
+  kDictionaryPage = 2,
+  kDataPageV2 = 3,
+};
+
+struct LeafColumn {
+  std::string name;
+  int32_t physical_type{-1};
+  int32_t type_length{};
+  int32_t scale{};
+  bool optional{};
+};
+
+struct ColumnChunkMeta {
+  std::string path;
+  int32_t physical_type{-1};
+  int32_t codec{};
+  int64_t num_values{};
+  int64_t data_page_offset{-1};
+  int64_t dictionary_page_offset{-1};
+  int64_t total_compressed_size{};
+  bool has_min_max{};
+  std::string min_value;
+  std::string max_value;
+};
+
+struct RowGroupMeta {
+  int64_t num_rows{};
+  std::vector<ColumnChunkMeta> columns;
+};
+
+struct FileMeta {
+  int64_t num_rows{};
+  std::vector<LeafColumn> leaves;
+  std::vector<RowGroupMeta> row_groups;
+};
+
+void read_statistics(CompactReader& in, ColumnChunkMeta& column) {
+  std::string legacy_min;
+  std::string legacy_max;
+  bool has_min = false;
+  bool has_max = false;
+  bool has_legacy_min = false;
+  bool has_legacy_max = false;
+  in.read_struct([&](int16_t id, uint8_t type) {
+    switch (id) {
+      case 1:
+        legacy_max = std::string(in.binary());
+        has_legacy_max = true;
+        break;
+      case 2:
+        legacy_min = std::string(in.binary());
+        has_legacy_min = true;
+        break;
+      case 5:
+        column.max_value = std::string(in.binary());
+        has_max = true;
+        break;
+      case 6:
+        column.min_value = std::string(in.binary());
+        has_min = true;
+        break;
+      default:
+        in.skip(type);
+    }
+  });
+  if (!has_min && has_legacy_min) {
+    column.min_value = legacy_min;
+    has_min = true;
+  }
+  if (!has_max && has_legacy_max) {
+    column.max_value = legacy_max;
+    has_max = true;
+  }
+  column.has_min_max = has_min && has_max;
+}
+
+void read_column_meta(CompactReader& in, ColumnChunkMeta& column) {
+  in.read_struct([&](int16_t id, uint8_t type) {
+    switch (id) {
+      case 1:
+        column.physical_type = in.i32();
+        break;
+      case 3: {
+        std::string path;
+        in.read_list([&](uint8_t) {
+          if (!path.empty()) {
+            path.push_back('.');
+          }
+          path.append(in.binary());
+        });
+        column.path = std::move(path);
+        break;
+      }
+      case 4:
+        column.codec = in.i32();
+        break;
+      case 5:
+        column.num_values = in.i64();
+        break;
+      case 7:
+        column.total_compressed_size = in.i64();
+        break;
+      case 9:
+        column.data_page_offset = in.i64();
+        break;
+      case 11:
+        column.dictionary_page_offset = in.i64();
+        break;
+      case 12:
+        read_statistics(in, column);
+        break;
+      default:
+        in.skip(type);
+    }
+  });
+}
+
+RowGroupMeta read_row_group(CompactReader& in) {
+  RowGroupMeta group;
+  in.read_struct([&](int16_t id, uint8_t type) {
+    if (id == 1) {
+      in.read_list([&](uint8_t) {
+        ColumnChunkMeta column;
+        in.read_struct([&](int16_t chunk_id, uint8_t chunk_type) {
+          if (chunk_id == 3) {
+            read_column_meta(in, column);
+          } else {
+            in.skip(chunk_type);
+          }
+        });
+        group.columns.push_back(std::move(column));
+      });
+    } else if (id == 3) {
+      group.num_rows = in.i64();
+    } else {
+      in.skip(type);
+    }
+  });
+  return group;
+}
+
+LeafColumn read_schema_element(CompactReader& in, int32_t& num_children) {
+  LeafColumn element;
+  num_children = 0;
+  in.read_struct([&](int16_t id, uint8_t type) {
+    switch (id) {
+      case 1:
+        element.physical_type = in.i32();
+        break;
+      case 2:
+        element.type_length = in.i32();
+        break;
+      case 3:
+        element.optional = in.i32() == 1;
+        break;
+      case 4:
+        element.name = std::string(in.binary());
+        break;
+      case 5:
+        num_children = in.i32();
+        break;
+      case 7:
+        element.scale = in.i32();
+        break;
+      default:
+        in.skip(type);
+    }
+  });
+  return element;
+}
+
+FileMeta read_file_meta(const MappedFile& file) {
+  constexpr size_t kMagicSize = 4;
+  const uint8_t* data = file.data();
+  const size_t size = file.size();
+  if (size < kMagicSize * 2 + 4 || std::memcmp(data, "PAR1", kMagicSize) != 0 ||
+      std::memcmp(data + size - kMagicSize, "PAR1", kMagicSize) != 0) {
+    format_error("missing PAR1 magic");
+  }
+  uint32_t footer_len = 0;
+  std::memcpy(&footer_len, data + size - kMagicSize - 4, 4);
+  if (footer_len > size - kMagicSize * 2 - 4) {
+    format_error("footer length out of range");
+  }
+  CompactReader in(data + size - kMagicSize - 4 - footer_len, footer_len);
+
+  FileMeta meta;
+  in.read_struct([&](int16_t id, uint8_t type) {
+    if (id == 2) {
+      bool root = true;
+      in.read_list([&](uint8_t) {
+        int32_t num_children = 0;
+        LeafColumn element = read_schema_element(in, num_children);
+        if (root) {
+          root = false;
+          return;
+        }
+        if (num_children > 0) {
+          format_error("nested column " + element.name + " is not a bar column");
+        }
+        meta.leaves.push_back(std::move(element));
+      });
+    } else if (id == 3) {
+      meta.num_rows = in.i64();
+    } else if (id == 4) {
+      in.read_list([&](uint8_t) { meta.row_groups.push_back(read_row_group(in)); });
+    } else {
+      in.skip(type);
+    }
+  });
+  // Row and value counts size the decode buffers, so they must agree with the file's
+  // declared total before anything is allocated from them.
+  if (meta.num_rows < 0) {
+    format_error("negative row count");
+  }
+  int64_t rows_left = meta.num_rows;
+  for (const RowGroupMeta& group : meta.row_groups) {
+    if (group.num_rows < 0 || group.num_rows > rows_left) {
+      format_error("row group row count " + std::to_string(group.num_rows) + " is outside the file's " +
+                   std::to_string(meta.num_rows) + " rows");
+    }
+    rows_left -= group.num_rows;
+    for (const ColumnChunkMeta& column : group.columns) {
+      if (column.num_values != group.num_rows) {
+        format_error("column chunk " + column.path + " declares " + std::to_string(column.num_values) +
+                     " values for " + std::to_string(group.num_rows) + " rows");
+      }
+    }
+  }
+  return meta;
+}
+
+struct PageHeader {
+  int32_t type{-1};
+  int32_t uncompressed_size{};
+  int32_t compressed_size{};
+  int32_t num_values{};
+  int32_t encoding{};
+  int32_t def_levels_byte_length{};
+  int32_t rep_levels_byte_length{};
+  bool v2_compressed{true};
+};
+
+PageHeader read_page_header(CompactReader& in) {
+  PageHeader header;
+  in.read_struct([&](int16_t id, uint8_t type) {
+    switch (id) {
+      case 1:
+        header.type = in.i32();
+        break;
+      case 2:
+        header.uncompressed_size = in.i32();
+        break;
+      case 3:
+        header.compressed_size = in.i32();
+        break;
+      case 5:
+      case 7:
+        // DataPageHeader and DictionaryPageHeader share num_values=1, encoding=2.
+        in.read_struct([&](int16_t sub_id, uint8_t sub_type) {
+          if (sub_id == 1) {
+            header.num_values = in.i32();
+          } else if (sub_id == 2) {
+            header.encoding = in.i32();
+          } else {
+            in.skip(sub_type);
+          }
+        });
+        break;
+      case 8:
+        in.read_struct([&](int16_t sub_id, uint8_t sub_type) {
+          switch (sub_id) {
+            case 1:
+              header.num_values = in.i32();
+              break;
+            case 4:
+              header.encoding = in.i32();
+              break;
+            case 5:
+              header.def_levels_byte_length = in.i32();
+              break;
+            case 6:
+              header.rep_levels_byte_length = in.i32();
+              break;
+            case 7:
+              header.v2_compressed = in.boolean();
+              break;
+            default:
+              in.skip(sub_type);
+          }
+        });
+        break;
+      default:
+        in.skip(type);
+    }
+  });
+  return header;
+}
+
+// ---------------------------------------------------------------------------------
+// Snappy raw block format.
+
+void snappy_decompress(const uint8_t* src, size_t src_len, std::vector<uint8_t>& out) {
+  const uint8_t* pos = src;
+  const uint8_t* end = src + src_len;
+  auto need = [&](size_t n) {
+    if (static_cast<size_t>(end - pos) < n) {
+      format_error("truncated snappy block");
+    }
+  };
+
+  uint64_t expected = 0;
+  for (int shift = 0;; shift += 7) {
+    need(1);
+    const uint8_t b = *pos++;
+    expected |= static_cast<uint64_t>(b & 0x7f) << shift;
+    if ((b & 0x80) == 0) {
+      break;
+    }
+    if (shift > 28) {
+      format_error("snappy length varint too long");
+    }
+  }
+  out.resize(static_cast<size_t>(expected));
+  size_t written = 0;
+
+  while (pos < end) {
+    const uint8_t tag = *pos++;
+    size_t length = 0;
+    size_t offset = 0;
+    switch (tag & 0x03) {
+      case 0: {
+        length = (tag >> 2) + 1;
+        if (length > 60) {
+          const size_t extra = length - 60;
+          need(extra);
+          length = 0;
+          for (size_t i = 0; i < extra; ++i) {
+            length |= static_cast<size_t>(pos[i]) << (8 * i);
+          }
+          length += 1;
+          pos += extra;
+        }
+        need(length);
+        if (written + length > out.size()) {
+          format_error("snappy literal overflows output");
+        }
+        std::memcpy(out.data() + written, pos, length);
+        pos += length;
+        written += length;
+        continue;
+      }
+      case 1:
+        need(1);
+        length = 4 + ((tag >> 2) & 0x07);
+        offset = (static_cast<size_t>(tag >> 5) << 8) | *pos++;
+        break;
+      case 2:
+        need(2);
+        length = (tag >> 2) + 1;
+        offset = static_cast<size_t>(pos[0]) | (static_cast<size_t>(pos[1]) << 8);
+        pos += 2;
+        break;
+      default:
+        need(4);
+        length = (tag >> 2) + 1;
+        offset = static_cast<size_t>(pos[0]) | (static_cast<size_t>(pos[1]) << 8) |
+                 (static_cast<size_t>(pos[2]) << 16) | (static_cast<size_t>(pos[3]) << 24);
+        pos += 4;
+        break;
+    }
+    if (offset == 0 || offset > written || written + length > out.size()) {
+      format_error("snappy copy out of range");
+    }
+    // Copies may overlap their own output (run-length style), so go byte by byte.
+    for (size_t i = 0; i < length; ++i) {
+      out[written + i] = out[written - offset + i];
+    }
+    written += length;
+  }
+  if (written != out.size()) {
+    format_error("snappy block shorter than declared");
+  }
+}
+
+// ---------------------------------------------------------------------------------
+// Value decoding.
+
+// RLE / bit-packed hybrid decoder used for dictionary indices and definition levels.
+class RleBitPackedDecoder {
+ public:
+  RleBitPackedDecoder(const uint8_t* data, size_t size, int bit_width)
+      : pos_(data), end_(data + size), bit_width_(bit_width) {
+    if (bit_width < 0 || bit_width > 32) {
+      format_error("invalid RLE bit width " + std::to_string(bit_width));
+    }
+  }
+
+  void decode(uint32_t* out, size_t count) {
+    size_t produced = 0;
+    while (produced < count) {
+      if (rle_remaining_ > 0) {
+        const size_t n = std::min(rle_remaining_, count - produced);
+        std::fill(out + produced, out + produced + n, rle_value_);
+        rle_remaining_ -= n;
+        produced += n;
+      } else if (packed_remaining_ > 0) {
+        const size_t n = std::min(packed_remaining_, count - produced);
+        for (size_t i = 0; i < n; ++i) {
+          out[produced + i] = unpack_next();
+        }
+        packed_remaining_ -= n;
+        produced += n;
+      } else {
+        next_run();
+      }
+    }
+  }
+
+ private:
+  void next_run() {
+    uint64_t header = 0;
+    for (int shift = 0;; shift += 7) {
+      if (pos_ >= end_) {
+        format_error("truncated RLE run header");
+      }
+      const uint8_t b = *pos_++;
+      header |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if ((b & 0x80) == 0) {
+        break;
+      }
+    }
+    if ((header & 1) != 0) {
+      const size_t groups = static_cast<size_t>(header >> 1);
+      const size_t bytes = groups * static_cast<size_t>(bit_width_);
+      if (static_cast<size_t>(end_ - pos_) < bytes) {
+        // Writers may truncate the final bit-packed run; treat missing bytes as zero
+        // but never read past the buffer.
+        packed_end_ = end_;
+      } else {
+        packed_end_ = pos_ + bytes;
+      }
+      packed_remaining_ = groups * 8;
+      bit_offset_ = 0;
+      packed_start_ = pos_;
+      pos_ = packed_end_;
+    } else {
+      rle_remaining_ = static_cast<size_t>(header >> 1);
+      const size_t width_bytes = static_cast<size_t>((bit_width_ + 7) / 8);
+      if (static_cast<size_t>(end_ - pos_) < width_bytes) {
+        format_error("truncated RLE value");
+      }
+      rle_value_ = 0;
+      for (size_t i = 0; i < width_bytes; ++i) {
+        rle_value_ |= static_cast<uint32_t>(pos_[i]) << (8 * i);
+      }
+      pos_ += width_bytes;
+    }
+  }
+
+  uint32_t unpack_next() {
+    const size_t byte_index = bit_offset_ >> 3;
+    const size_t available = static_cast<size_t>(packed_end_ - packed_start_);
+    uint64_t word = 0;
+    if (byte_index < available) {
+      std::memcpy(&word, packed_start_ + byte_index, std::min<size_t>(8, available - byte_index));
+    }
+    const uint64_t mask = bit_width_ == 32 ? 0xffffffffULL : ((uint64_t{1} << bit_width_) - 1);
+    const uint32_t value = static_cast<uint32_t>((word >> (bit_offset_ & 7)) & mask);
+    bit_offset_ += static_cast<size_t>(bit_width_);
+    return value;
+  }
+
+  const uint8_t* pos_;
+  const uint8_t* end_;
+  int bit_width_;
+  size_t rle_remaining_{};
+  uint32_t rle_value_{};
+  size_t packed_remaining_{};
+  const uint8_t* packed_start_{nullptr};
+  const uint8_t* packed_end_{nullptr};
+  size_t bit_offset_{};
+};
+
+// Every bar column is decoded into int64 first: raw integers for ts/volume, unscaled
+// decimal mantissas for prices, and bit patterns for DOUBLE columns.
+int64_t load_plain_value(const uint8_t* p, const LeafColumn& leaf) {
+  switch (leaf.physical_type) {
+    case kInt32: {
+      int32_t v = 0;
+      std::memcpy(&v, p, 4);
+      return v;
+    }
+    case kInt64:
+    case kDoubleType: {
+      int64_t v = 0;
+      std::memcpy(&v, p, 8);
+      return v;
+    }
+    case kFixedLenByteArray: {
+      // Big-endian two's complement decimal.
+      int64_t v = (p[0] & 0x80) != 0 ? -1 : 0;
+      for (int32_t i = 0; i < leaf.type_length; ++i) {
+        v = static_cast<int64_t>(static_cast<uint64_t>(v) << 8) | p[i];
+      }
+      return v;
+    }
+    default:
+      format_error("column " + leaf.name + " has unsupported physical type " +
+                   std::to_string(leaf.physical_type));
+  }
+}
+
+size_t plain_width(const LeafColumn& leaf) {
+  switch (leaf.physical_type) {
+    case kInt32:
+      return 4;
+    case kInt64:
+    case kDoubleType:
+      return 8;
+    case kFixedLenByteArray:
+      if (leaf.type_length <= 0 || leaf.type_length > 8) {
+        format_error("decimal column " + leaf.name + " wider than 8 bytes");
+      }
+      return static_cast<size_t>(leaf.type_length);
+    default:
+      format_error("column " + leaf.name + " has unsupported physical type " +
+                   std::to_string(leaf.physical_type));
+  }
+}
+
+void decode_plain(const uint8_t* data, size_t size, size_t count, const LeafColumn& leaf, int64_t* out) {
+  const size_t width = plain_width(leaf);
+  if (count > size / width) {
+    format_error("PLAIN page for " + leaf.name + " is truncated");
+  }
+  if (width == 8 && leaf.physical_type != kFixedLenByteArray) {
+    std::memcpy(out, data, count * 8);
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = load_plain_value(data + i * width, leaf);
+  }
+}
+
+// Decodes one projected column chunk into `out` (already sized to the chunk's rows).
+void decode_column_chunk(const MappedFile& file,
+                         const ColumnChunkMeta& chunk,
+                         const LeafColumn& leaf,
+                         int64_t* out,
+                         size_t rows,
+                         ParquetScanStats* stats) {
+  int64_t start = chunk.data_page_offset;
+  if (chunk.dictionary_page_offset > 0 && chunk.dictionary_page_offset < start) {
+    start = chunk.dictionary_page_offset;
+  }
+  if (start < 0 || chunk.total_compressed_size < 0 ||
+      static_cast<uint64_t>(start) + static_cast<uint64_t>(chunk.total_compressed_size) > file.size()) {
+    format_error("column chunk " + leaf.name + " lies outside the file");
+  }
+  if (chunk.codec != kUncompressed && chunk.codec != kSnappy) {
+    format_error("column " + leaf.name + " uses unsupported codec " + std::to_string(chunk.codec));
+  }
+  if (stats != nullptr) {
+    stats->bytes_read += static_cast<size_t>(chunk.total_compressed_size);
+  }
+
+  const uint8_t* pos = file.data() + start;
+  const uint8_t* end = pos + chunk.total_compressed_size;
+  std::vector<int64_t> dictionary;
+  std::vector<uint8_t> scratch;
+  std::vector<uint32_t> indices;
+  size_t produced = 0;
+
+  while (produced < rows && pos < end) {
+    CompactReader header_reader(pos, static_cast<size_t>(end - pos));
+    const PageHeader header = read_page_header(header_reader);
+    pos += header_reader.consumed_from(pos);
+    if (header.compressed_size < 0 || header.compressed_size > end - pos) {
+      format_error("page of " + leaf.name + " overruns its column chunk");
+    }
+    const uint8_t* page = pos;
+    size_t page_size = static_cast<size_t>(header.compressed_size);
+    pos += header.compressed_size;
+
+    if (header.type != kDataPage && header.type != kDataPageV2 && header.type != kDictionaryPage) {
+      continue;
+    }
+
+    // V2 pages keep levels uncompressed ahead of the (possibly compressed) values.
+    if (header.num_values < 0) {
+      format_error("page of " + leaf.name + " declares a negative value count");
+    }
+    size_t levels_size = 0;
+    if (header.type == kDataPageV2) {
+      if (header.def_levels_byte_length < 0 || header.rep_levels_byte_length < 0) {
+        format_error("level section of " + leaf.name + " has a negative length");
+      }
+      levels_size = static_cast<size_t>(header.def_levels_byte_length) +
+                    static_cast<size_t>(header.rep_levels_byte_length);
+      if (levels_size > page_size) {
+        format_error("level section of " + leaf.name + " overruns its page");
+      }
+    }
+    const bool compressed = chunk.codec == kSnappy && (header.type != kDataPageV2 || header.v2_compressed);
+    const uint8_t* values = page + levels_size;
+    size_t values_size = page_size - levels_size;
+    if (compressed) {
+      snappy_decompress(values, values_size, scratch);
+      values = scratch.data();
+      values_size = scratch.size();
+    }
+
+    if (header.type == kDictionaryPage) {
+      if (static_cast<size_t>(header.num_values) > values_size / plain_width(leaf)) {
+        format_error("dictionary page of " + leaf.name + " declares more values than it holds");
+      }
+      dictionary.resize(static_cast<size_t>(header.num_values));
+      decode_plain(values, values_size, dictionary.size(), leaf, dictionary.data());
+      continue;
+    }
+
+    const size_t count = static_cast<size_t>(header.num_values);
+    if (count > rows - produced) {
+      format_error("column " + leaf.name + " has more values than rows");
+    }
+    if (leaf.optional) {
+      // Bars are never null; validate the definition levels and step over them.
+      std::vector<uint32_t> levels(count);
+      if (header.type == kDataPageV2) {
+        RleBitPackedDecoder(page, static_cast<size_t>(header.def_levels_byte_length), 1)
+            .decode(levels.data(), count);
+      } else {
+        if (values_size < 4) {
+          format_error("truncated definition levels in " + leaf.name);
+        }
+        uint32_t levels_len = 0;
+        std::memcpy(&levels_len, values, 4);
+        if (levels_len > values_size - 4) {
+          format_error("definition levels of " + leaf.name + " overrun the page");
+        }
+        RleBitPackedDecoder(values + 4, levels_len, 1).decode(levels.data(), count);
+        values += 4 + levels_len;
+        values_size -= 4 + levels_len;
+      }
+      if (std::any_of(levels.begin(), levels.end(), [](uint32_t level) { return level == 0; })) {
+        format_error("column " + leaf.name + " contains nulls");
+      }
+    }
+
+    if (header.encoding == kPlain) {
+      decode_plain(values, values_size, count, leaf, out + produced);
+    } else if (header.encoding == kPlainDictionary || header.encoding == kRleDictionary) {
+      if (values_size < 1) {
+        format_error("dictionary page of " + leaf.name + " is empty");
+      }
+      indices.resize(count);
+      RleBitPackedDecoder(values + 1, values_size - 1, values[0]).decode(indices.data(), count);
+      for (size_t i = 0; i < count; ++i) {
+        if (indices[i] >= dictionary.size()) {
+          format_error("dictionary index out of range in " + leaf.name);
+        }
+        out[produced + i] = dictionary[indices[i]];
+      }
+    } else {
+      format_error("column " + leaf.name + " uses unsupported encoding " + std::to_string(header.encoding));
+    }
+    produced += count;
+  }
+  if (produced != rows) {
+    format_error("column " + leaf.name + " ended after " + std::to_string(produced) + " of " +
+                 std::to_string(rows) + " rows");
+  }
+}
+
+int64_t stat_as_int64(const std::string& raw, int32_t physical_type) {
+  if (physical_type == kInt64 && raw.size() == 8) {
+    int64_t v = 0;
+    std::memcpy(&v, raw.data(), 8);
+    return v;
+  }
+  if (physical_type == kInt32 && raw.size() == 4) {
+    int32_t v = 0;
+    std::memcpy(&v, raw.data(), 4);
+    return v;
+  }
+  format_error("unexpected ts_ms statistics encoding");
+}
+
+double pow10(int32_t exponent) {
+  double result = 1.0;
+  for (int32_t i = 0; i < exponent; ++i) {
+    result *= 10.0;
+  }
+  return result;
+}
+
+enum BarColumn : size_t { kTs, kOpen, kHigh, kLow, kClose, kVolume, kAmount, kBarColumnCount };
+
+constexpr std::array<std::string_view, kBarColumnCount> kBarColumnNames = {
+    "ts_ms", "open", "high", "low", "close", "volume", "amount"};
+
+}  // namespace
+
+std::vector<OHLCV> read_parquet_bars(const std::string& path,
+                                     int64_t start_millis,
+                                     int64_t end_millis,
+                                     ParquetScanStats* stats) {
+  const MappedFile file(path);
+  const FileMeta meta = read_file_meta(file);
+
+  std::array<size_t, kBarColumnCount> column_index{};
+  for (size_t c = 0; c < kBarColumnCount; ++c) {
+    const auto it = std::find_if(meta.leaves.begin(), meta.leaves.end(),
+                                 [&](const LeafColumn& leaf) { return leaf.name == kBarColumnNames[c]; });
+    if (it == meta.leaves.end()) {
+      format_error(path + " has no column " + std::string(kBarColumnNames[c]));
+    }
+    column_index[c] = static_cast<size_t>(it - meta.leaves.begin());
+  }
+
+  std::array<double, kBarColumnCount> price_divisor{};
+  for (size_t c : {kOpen, kHigh, kLow, kClose, kAmount}) {
+    price_divisor[c] = pow10(meta.leaves[column_index[c]].scale);
+  }
+
+  if (stats != nullptr) {
+    stats->row_groups_total += meta.row_groups.size();
+  }
+
+  std::vector<OHLCV> bars;
+  std::array<std::vector<int64_t>, kBarColumnCount> raw;
+  for (const RowGroupMeta& group : meta.row_groups) {
+    if (group.columns.size() != meta.leaves.size()) {
+      format_error(path + " row group column count does not match schema");
+    }
+    const ColumnChunkMeta& ts_chunk = group.columns[column_index[kTs]];
+    if (ts_chunk.has_min_max) {
+      const int64_t min_ts = stat_as_int64(ts_chunk.min_value, ts_chunk.physical_type);
+      const int64_t max_ts = stat_as_int64(ts_chunk.max_value, ts_chunk.physical_type);
+      if (max_ts < start_millis || min_ts >= end_millis) {
+        continue;
+      }
+    }
+    if (group.num_rows == 0) {
+      continue;
+    }
+
+    const size_t rows = static_cast<size_t>(group.num_rows);
+    for (size_t c = 0; c < kBarColumnCount; ++c) {
+      raw[c].resize(rows);
+      const LeafColumn& leaf = meta.leaves[column_index[c]];
+      decode_column_chunk(file, group.columns[column_index[c]], leaf, raw[c].data(), rows, stats);
+    }
+
+    auto price = [&](size_t column, size_t row) {
+      const int64_t value = raw[column][row];
+      if (meta.leaves[column_index[column]].physical_type == kDoubleType) {
+        double d = 0.0;
+        std::memcpy(&d, &value, 8);
+        return d;
+      }
+      return static_cast<double>(value) / price_divisor[column];
+    };
+
+    bars.reserve(bars.size() + rows);
+    for (size_t row = 0; row < rows; ++row) {
+      const int64_t ts = raw[kTs][row];
+      if (ts < start_millis || ts >= end_millis) {
+        continue;
+      }
+      bars.push_back(OHLCV{
+          ts,
+          price(kOpen, row),
+          price(kHigh, row),
+          price(kLow, row),
+          price(kClose, row),
+          raw[kVolume][row],
+          price(kAmount, row),
+      });
+    }
+    if (stats != nullptr) {
+      ++stats->row_groups_read;
+      stats->rows_decoded += rows;
+    }
+  }
+  return bars;
+}
+
+std::string bar_partition_path(const std::string& root,
+                               const std::string& period,
+                               const std::string& symbol,
+                               int year) {
+  return (std::filesystem::path(root) / "data" / "bars" / period / ("symbol=" + symbol) /
+          ("year=" + std::to_string(year)) / "part.parquet")
+      .string();
+}
+
+std::vector<OHLCV> query_parquet_bars(const std::string& root,
+                                      const std::string& period,
+                                      const std::string& symbol,
+                                      int64_t start_millis,
+                                      int64_t end_millis,
+                                      ParquetScanStats* stats) {
+  std::vector<OHLCV> bars;
+  if (end_millis <= start_millis) {
+    return bars;
+  }
+  // Enumerate the year partitions that exist instead of walking the calendar, so open
+  // ranges (kUnboundedStartMillis/kUnboundedEndMillis) stay cheap.
+  const std::filesystem::path symbol_dir =
+      std::filesystem::path(root) / "data" / "bars" / period / ("symbol=" + symbol);
+  if (!std::filesystem::is_directory(symbol_dir)) {
+    return bars;
+  }
+  const int first_year = start_millis == kUnboundedStartMillis ? std::numeric_limits<int>::min()
+                                                              : utc_year_from_millis(start_millis);
+  const int last_year = end_millis == kUnboundedEndMillis ? std::numeric_limits<int>::max()
+                                                          : utc_year_from_millis(end_millis);
+  std::vector<int> years;
+  for (const auto& entry : std::filesystem::directory_iterator(symbol_dir)) {
+    const std::string name = entry.path().filename().string();
+    if (!entry.is_directory() || name.rfind("year=", 0) != 0) {
+      continue;
+    }
+    int year = 0;
+    const char* first = name.data() + 5;
+    const char* last = name.data() + name.size();
+    const auto parsed = std::from_chars(first, last, year);
+    if (parsed.ec == std::errc() && parsed.ptr == last && year >= first_year && year <= last_year) {
+      years.push_back(year);
+    }
+  }
+  std::sort(years.begin(), years.end());
+  for (int year : years) {
+    const std::string path = bar_partition_path(root, period, symbol, year);
+    if (!std::filesystem::exists(path)) {
+      continue;
+    }
+    std::vector<OHLCV> partition = read_parquet_bars(path, start_millis, end_millis, stats);
+    bars.insert(bars.end(), partition.begin(), partition.end());
+  }
+  std::stable_sort(bars.begin(), bars.end(),
+                   [](const OHLCV& left, const OHLCV& right) { return left.ts_millis < right.ts_millis; });
+  return bars;
+}
+
+}  // namespace tg_indicators
@@ -0,0 +1,211 @@
+#include "tg_indicators/resample.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "tg_indicators/time_util.h"
+
+namespace tg_indicators {
+namespace {
+
+constexpr int64_t kShanghaiOffsetMillis = 8 * 3'600'000;
+constexpr int64_t kMillisPerMinute = 60'000;
+constexpr int kMorningOpen = 9 * 60 + 30;
+constexpr int kMorningClose = 11 * 60 + 30;
+constexpr int kAfternoonOpen = 13 * 60;
+constexpr int kAfternoonClose = 15 * 60;
+constexpr int kMorningMinutes = kMorningClose - kMorningOpen;
+constexpr int kSessionMinutes = kMorningMinutes + (kAfternoonClose - kAfternoonOpen);
+
+struct LocalTime {
+  int64_t day;
+  int minute_of_day;
+};
+
+LocalTime shanghai_time(int64_t ts_millis) {
+  const int64_t local = ts_millis + kShanghaiOffsetMillis;
+  const int64_t day = floor_div(local, kMillisPerDay);
+  return LocalTime{day, static_cast<int>((local - day * kMillisPerDay) / kMillisPerMinute)};
+}
+
+// 1-based trading-minute ordinal of a close-labelled bar, clamped into [1, 240].
+int trading_minute(int minute_of_day) {
+  if (minute_of_day <= kMorningOpen) {
+    return 1;
+  }
+  if (minute_of_day <= kMorningClose) {
+    return minute_of_day - kMorningOpen;
+  }
+  if (minute_of_day <= kAfternoonOpen) {
+    return kMorningMinutes;
+  }
+  if (minute_of_day <= kAfternoonClose) {
+    return kMorningMinutes + (minute_of_day - kAfternoonOpen);
+  }
+  return kSessionMinutes;
+}
+
+int minute_of_day_for_trading_minute(int ordinal) {
+  return ordinal <= kMorningMinutes ? kMorningOpen + ordinal
+                                    : kAfternoonOpen + (ordinal - kMorningMinutes);
+}
+
+int period_rank(tg::v1::BarPeriod period) {
+  switch (period) {
+    case tg::v1::BAR_PERIOD_MIN1:
+      return 1;
+    case tg::v1::BAR_PERIOD_MIN5:
+      return 5;
+    case tg::v1::BAR_PERIOD_MIN15:
+      return 15;
+    case tg::v1::BAR_PERIOD_MIN30:
+      return 30;
+    case tg::v1::BAR_PERIOD_MIN60:
+      return 60;
+    case tg::v1::BAR_PERIOD_DAILY:
+      return kSessionMinutes;
+    case tg::v1::BAR_PERIOD_WEEKLY:
+      return kSessionMinutes * 5;
+    default:
+      return 0;
+  }
+}
+
+// Bucket close label for intraday targets; DAILY/WEEKLY use the last bar's own ts.
+int64_t intraday_bucket_label(int64_t day, int bucket, int minutes) {
+  const int close_ordinal = std::min((bucket + 1) * minutes, kSessionMinutes);
+  return day * kMillisPerDay +
+         static_cast<int64_t>(minute_of_day_for_trading_minute(close_ordinal)) * kMillisPerMinute -
+         kShanghaiOffsetMillis;
+}
+
+void fold(OHLCV& into, const OHLCV& bar) {
+  into.high = std::max(into.high, bar.high);
+  into.low = std::min(into.low, bar.low);
+  into.close = bar.close;
+  into.volume += bar.volume;
+  into.amount += bar.amount;
+}
+
+OHLCV open_bucket(const OHLCV& bar, int64_t key, tg::v1::BarPeriod target) {
+  OHLCV out = bar;
+  const int minutes = intraday_period_minutes(target);
+  if (minutes > 0) {
+    out.ts_millis = intraday_bucket_label(key / 1000, static_cast<int>(key % 1000), minutes);
+  }
+  return out;
+}
+
+}  // namespace
+
+int intraday_period_minutes(tg::v1::BarPeriod period) {
+  const int rank = period_rank(period);
+  return rank > 0 && rank < kSessionMinutes ? rank : 0;
+}
+
+void validate_resample(tg::v1::BarPeriod source, tg::v1::BarPeriod target) {
+  const int from = period_rank(source);
+  const int to = period_rank(target);
+  if (to == 0) {
+    throw std::invalid_argument("unsupported resample target period " + std::to_string(target));
+  }
+  if (from == 0) {
+    throw std::invalid_argument("bars must carry a period to be resampled");
+  }
+  if (to <= from || (to < kSessionMinutes && to % from != 0)) {
+    throw std::invalid_argument("cannot resample " + tg::v1::BarPeriod_Name(source) + " bars to " +
+                                tg::v1::BarPeriod_Name(target));
+  }
+}
+
+int64_t resample_bucket_key(int64_t ts_millis, tg::v1::BarPeriod target) {
+  const LocalTime local = shanghai_time(ts_millis);
+  if (target == tg::v1::BAR_PERIOD_DAILY) {
+    return local.day;
+  }
+  if (target == tg::v1::BAR_PERIOD_WEEKLY) {
+    // 1970-01-01 was a Thursday; shift so weeks start on Monday.
+    return floor_div(local.day + 3, 7);
+  }
+  const int minutes = intraday_period_minutes(target);
+  if (minutes == 0) {
+    throw std::invalid_argument("unsupported resample target period " + std::to_string(target));
+  }
+  return local.day * 1000 + (trading_minute(local.minute_of_day) - 1) / minutes;
+}
+
+std::vector<OHLCV> resample_bars(const std::vector<OHLCV>& bars, tg::v1::BarPeriod target) {
+  std::vector<int64_t> keys(bars.size());
+  for (size_t i = 0; i < bars.size(); ++i) {
+    keys[i] = resample_bucket_key(bars[i].ts_millis, target);
+  }
+
+  std::vector<OHLCV> out;
+  size_t i = 0;
+  while (i < bars.size()) {
+    size_t end = i + 1;
+    while (end < bars.size() && keys[end] == keys[i]) {
+      ++end;
+    }
+    OHLCV bucket = open_bucket(bars[i], keys[i], target);
+    double high = bucket.high;
+    double low = bucket.low;
+    int64_t volume = bucket.volume;
+    double amount = bucket.amount;
+    for (size_t j = i + 1; j < end; ++j) {
+      high = std::max(high, bars[j].high);
+      low = std::min(low, bars[j].low);
+      volume += bars[j].volume;
+      amount += bars[j].amount;
+    }
+    bucket.high = high;
+    bucket.low = low;
+    bucket.volume = volume;
+    bucket.amount = amount;
+    bucket.close = bars[end - 1].close;
+    if (intraday_period_minutes(target) == 0) {
+      bucket.ts_millis = bars[end - 1].ts_millis;
+    }
+    out.push_back(bucket);
+    i = end;
+  }
+  return out;
+}
+
+BarResampler::BarResampler(tg::v1::BarPeriod target) : target_(target) {
+  if (period_rank(target) == 0) {
+    throw std::invalid_argument("unsupported resample target period " + std::to_string(target));
+  }
+}
+
+BarResampler::BarResampler(tg::v1::BarPeriod target, int64_t forming_key, std::optional<OHLCV> forming)
+    : BarResampler(target) {
+  forming_key_ = forming_key;
+  forming_ = std::move(forming);
+}
+
+std::optional<OHLCV> BarResampler::push(const OHLCV& bar) {
+  const int64_t key = resample_bucket_key(bar.ts_millis, target_);
+  if (forming_ && key == forming_key_) {
+    fold(*forming_, bar);
+    if (intraday_period_minutes(target_) == 0) {
+      forming_->ts_millis = bar.ts_millis;
+    }
+    return std::nullopt;
+  }
+  std::optional<OHLCV> closed = std::move(forming_);
+  forming_ = open_bucket(bar, key, target_);
+  forming_key_ = key;
+  return closed;
+}
+
+std::optional<OHLCV> BarResampler::close_before(int64_t ts_millis) {
+  if (!forming_ || resample_bucket_key(ts_millis, target_) == forming_key_) {
+    return std::nullopt;
+  }
+  return std::exchange(forming_, std::nullopt);
+}
+
+}  // namespace tg_indicators
@@ -0,0 +1,201 @@
+#include "tg_indicators/screen.h"
+
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <sstream>
+
+#include "tg_indicators/events.h"
+#include "tg_indicators/indicators/registry.h"
+
+namespace tg_indicators {
+namespace {
+
+std::string source_key(const std::string& indicator, const Params& params) {
+  const std::map<std::string, double> sorted(params.begin(), params.end());
+  std::ostringstream key;
+  key << indicator << '(';
+  const char* separator = "";
+  for (const auto& [name, value] : sorted) {
+    key << separator << name << '=' << value;
+    separator = ",";
+  }
+  key << ')';
+  return key.str();
+}
+
+double bar_field(const OHLCV& bar, size_t field) {
+  const double values[] = {bar.open, bar.high, bar.low, bar.close, static_cast<double>(bar.volume)};
+  return values[field];
+}
+
+bool compare(double left, CompareOp op, double right) {
+  switch (op) {
+    case CompareOp::kLess:
+      return left < right;
+    case CompareOp::kLessEqual:
+      return left <= right;
+    case CompareOp::kGreater:
+      return left > right;
+    case CompareOp::kGreaterEqual:
+      return left >= right;
+  }
+  return false;
+}
+
+}  // namespace
+
+Screen::Screen(const std::vector<ScreenCondition>& conditions) {
+  std::vector<std::string> source_keys;
+  auto add_operand = [&](const ScreenOperand& in) {
+    Operand operand;
+    operand.series = in.series;
+    operand.constant = in.constant;
+    operand.scale = in.scale;
+    operand.average_bars = in.average_bars;
+    std::string label;
+    if (!in.indicator.empty()) {
+      const std::string key = source_key(normalize_indicator_name(in.indicator), in.params);
+      const auto it = std::find(source_keys.begin(), source_keys.end(), key);
+      operand.source = static_cast<size_t>(it - source_keys.begin());
+      if (it == source_keys.end()) {
+        auto indicator = create_indicator(in.indicator);
+        if (!indicator) {
+          throw std::invalid_argument("unknown indicator: " + in.indicator);
+        }
+        // min_bars() validates the params, so a malformed screen fails here rather
+        // than matching nothing.
+        const size_t min_bars = indicator->min_bars(in.params);
+        const double cost = indicator->cost_per_bar(in.params);
+        sources_.push_back({std::move(indicator), in.params, cost, min_bars});
+        source_keys.push_back(key);
+      }
+      const auto names = sources_[operand.source].indicator->output_names();
+      if (std::find(names.begin(), names.end(), in.series) == names.end()) {
+        throw std::invalid_argument(in.indicator + " has no output series " + in.series);
+      }
+      label = key + "." + in.series;
+    } else if (!in.series.empty()) {
+      const auto* field = std::find(std::begin(kBarFields), std::end(kBarFields), in.series);
+      if (field == std::end(kBarFields)) {
+        throw std::invalid_argument("unknown bar field " + in.series);
+      }
+      operand.field = static_cast<size_t>(field - std::begin(kBarFields));
+      label = in.series;
+    } else {
+      std::ostringstream constant;
+      constant << in.constant;
+      label = constant.str();
+    }
+    if (in.average_bars > 0 && operand.source == kNone && operand.field == kNone) {
+      throw std::invalid_argument("average_bars needs a series to average");
+    }
+    if (in.average_bars > 0) {
+      label = "avg" + std::to_string(in.average_bars) + "(" + label + ")";
+    }
+    if (in.scale != 1.0) {
+      std::ostringstream scaled;
+      scaled << in.scale << '*' << label;
+      label = scaled.str();
+    }
+    operands_.push_back(std::move(operand));
+    labels_.push_back(std::move(label));
+    return operands_.size() - 1;
+  };
+
+  for (const auto& in : conditions) {
+    Condition condition;
+    condition.left = add_operand(in.left);
+    condition.right = add_operand(in.right);
+    condition.op = in.op;
+    conditions_.push_back(condition);
+  }
+  // Standalone cost: an indicator shared with an earlier condition is free by the
+  // time a later one runs, which only makes the order conservative.
+  for (auto& condition : conditions_) {
+    for (size_t operand : {condition.left, condition.right}) {
+      if (operands_[operand].source != kNone) {
+        condition.cost += sources_[operands_[operand].source].cost;
+      }
+    }
+  }
+  std::stable_sort(conditions_.begin(), conditions_.end(),
+                   [](const Condition& a, const Condition& b) { return a.cost < b.cost; });
+}
+
+double Screen::cost_per_bar() const {
+  double total = 0.0;
+  for (const auto& source : sources_) {
+    total += source.cost;
+  }
+  return total;
+}
+
+ScreenOutcome Screen::evaluate(const std::vector<OHLCV>& bars) const {
+  ScreenOutcome outcome;
+  outcome.values.assign(operands_.size(), nan_value());
+  if (bars.empty()) {
+    return outcome;
+  }
+  std::vector<std::optional<SeriesMap>> computed(sources_.size());
+  std::vector<bool> rejected(sources_.size(), false);
+
+  auto latest = [&](size_t index) {
+    const Operand& operand = operands_[index];
+    const Series* series = nullptr;
+    if (operand.source != kNone) {
+      auto& slot = computed[operand.source];
+      if (!slot && !rejected[operand.source]) {
+        const Source& source = sources_[operand.source];
+        // Params were validated up front, so the only rejection left is a symbol with
+        // too few (valid) bars.
+        if (bars.size() < source.min_bars) {
+          rejected[operand.source] = true;
+        } else {
+          try {
+            slot = source.indicator->compute(bars, source.params);
+            ++outcome.indicators_computed;
+          } catch (const std::invalid_argument&) {
+            rejected[operand.source] = true;
+          }
+        }
+      }
+      if (!slot) {
+        return nan_value();
+      }
+      series = &slot->at(operand.series);
+    } else if (operand.field == kNone) {
+      return operand.scale * operand.constant;
+    }
+    auto value_at = [&](size_t i) {
+      return series ? (*series)[i] : bar_field(bars[i], operand.field);
+    };
+    const size_t n = bars.size();
+    if (operand.average_bars == 0) {
+      return operand.scale * value_at(n - 1);
+    }
+    if (operand.average_bars > n) {
+      return nan_value();
+    }
+    double sum = 0.0;
+    for (size_t i = n - operand.average_bars; i < n; ++i) {
+      sum += value_at(i);
+    }
+    return operand.scale * sum / static_cast<double>(operand.average_bars);
+  };
+
+  for (const auto& condition : conditions_) {
+    const double left = outcome.values[condition.left] = latest(condition.left);
+    if (std::isnan(left)) {
+      return outcome;
+    }
+    const double right = outcome.values[condition.right] = latest(condition.right);
+    if (!compare(left, condition.op, right)) {
+      return outcome;
+    }
+  }
+  outcome.matched = true;
+  return outcome;
+}
+
+}  // namespace tg_indicators
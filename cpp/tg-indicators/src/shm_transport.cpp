@@ -0,0 +1,523 @@
+#include "tg_indicators/shm_transport.h"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#include "tg_indicators/indicator_service.h"
+#include "tg_indicators/indicators/registry.h"
+
+namespace tg_indicators {
+namespace {
+
+// Spin iterations before falling back to a futex sleep; a round trip for a small
+// request usually completes inside this window.
+constexpr int kSpinIterations = 4000;
+
+// Longest a waiting client sleeps before rechecking whether the server still serves.
+constexpr auto kServingRecheck = std::chrono::milliseconds(50);
+
+// gRPC status codes returned through ShmSlotHeader::status and ShmCall::submit.
+constexpr int kInvalidArgument = 3;
+constexpr int kDeadlineExceeded = 4;
+constexpr int kNotFound = 5;
+constexpr int kInternal = 13;
+constexpr int kUnavailable = 14;
+
+// Sleeps while `word` holds `expected`, for at most `timeout` (relative, FUTEX_WAIT).
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout) {
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  timespec relative{static_cast<time_t>(seconds.count()), static_cast<long>((timeout - seconds).count())};
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &relative, nullptr, 0);
+}
+
+void futex_wake(std::atomic<uint32_t>& word) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+uint32_t to_word(ShmSlotState state) {
+  return static_cast<uint32_t>(state);
+}
+
+// Waits for the server to answer a slot, spinning first. Returns 0 once the slot holds
+// RESPONSE, DEADLINE_EXCEEDED at `deadline`, or UNAVAILABLE if no server is serving.
+int await_response(const ShmSegmentHeader& header, std::atomic<uint32_t>& state,
+                   std::chrono::steady_clock::time_point deadline) {
+  for (int i = 0; i < kSpinIterations; ++i) {
+    if (state.load(std::memory_order_acquire) == to_word(ShmSlotState::kResponse)) {
+      return 0;
+    }
+  }
+  for (;;) {
+    const uint32_t seen = state.load(std::memory_order_acquire);
+    if (seen == to_word(ShmSlotState::kResponse)) {
+      return 0;
+    }
+    if (header.serving.load(std::memory_order_acquire) == 0) {
+      return kUnavailable;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      return kDeadlineExceeded;
+    }
+    futex_wait(state, seen, std::min<std::chrono::nanoseconds>(deadline - now, kServingRecheck));
+  }
+}
+
+size_t slot_bytes_for(size_t max_bars) {
+  const size_t bytes = kShmSlotHeaderBytes + max_bars * kShmColumnsPerBar * sizeof(double);
+  return (bytes + 63) / 64 * 64;
+}
+
+std::string shm_path(const std::string& name) {
+  return name.empty() || name.front() == '/' ? name : "/" + name;
+}
+
+void check_name(size_t capacity, std::string_view value, const char* what) {
+  if (value.size() >= capacity) {
+    throw std::invalid_argument(std::string(what) + " too long for shared-memory transport: " +
+                                std::string(value));
+  }
+}
+
+void copy_name(char* dest, size_t capacity, std::string_view value, const char* what) {
+  check_name(capacity, value, what);
+  std::memset(dest, 0, capacity);
+  std::memcpy(dest, value.data(), value.size());
+}
+
+std::string read_name(const char* source, size_t capacity) {
+  return std::string(source, strnlen(source, capacity));
+}
+
+}  // namespace
+
+ShmSegment ShmSegment::create(const std::string& name, uint32_t slot_count, size_t max_bars_per_slot,
+                              bool replace_existing) {
+  if (slot_count == 0 || max_bars_per_slot == 0) {
+    throw std::invalid_argument("shared-memory segment needs at least one slot and bar");
+  }
+  const std::string path = shm_path(name);
+  const size_t slot_bytes = slot_bytes_for(max_bars_per_slot);
+  const size_t bytes = kShmHeaderBytes + slot_bytes * slot_count;
+  if (replace_existing) {
+    shm_unlink(path.c_str());
+  }
+  const int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "shm_open " + path);
+  }
+  if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+    const int error = errno;
+    close(fd);
+    shm_unlink(path.c_str());
+    throw std::system_error(error, std::generic_category(), "ftruncate " + path);
+  }
+  void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    shm_unlink(path.c_str());
+    throw std::system_error(errno, std::generic_category(), "mmap " + path);
+  }
+  ShmSegment segment(path, base, bytes, true);
+  auto* header = new (base) ShmSegmentHeader{};
+  header->slot_count = slot_count;
+  header->slot_bytes = slot_bytes;
+  for (uint32_t i = 0; i < slot_count; ++i) {
+    new (segment.slot_data(i) - kShmSlotHeaderBytes) ShmSlotHeader{};
+  }
+  header->version = kShmVersion;
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kShmMagic;
+  return segment;
+}
+
+ShmSegment ShmSegment::open(const std::string& name) {
+  const std::string path = shm_path(name);
+  const int fd = shm_open(path.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "shm_open " + path);
+  }
+  struct stat info {};
+  if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < kShmHeaderBytes) {
+    close(fd);
+    throw std::runtime_error("shared-memory segment " + path + " is not initialized");
+  }
+  const size_t bytes = static_cast<size_t>(info.st_size);
+  void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    throw std::system_error(errno, std::generic_category(), "mmap " + path);
+  }
+  ShmSegment segment(path, base, bytes, false);
+  const ShmSegmentHeader& header = segment.header();
+  if (header.magic != kShmMagic || header.version != kShmVersion ||
+      kShmHeaderBytes + header.slot_bytes * header.slot_count > bytes) {
+    throw std::runtime_error("shared-memory segment " + path + " has an incompatible layout");
+  }
+  return segment;
+}
+
+ShmSegment::ShmSegment(ShmSegment&& other) noexcept
+    : name_(std::move(other.name_)),
+      base_(std::exchange(other.base_, nullptr)),
+      bytes_(std::exchange(other.bytes_, 0)),
+      owner_(std::exchange(other.owner_, false)) {}
+
+// Swaps so the moved-from segment releases whatever this one held.
+ShmSegment& ShmSegment::operator=(ShmSegment&& other) noexcept {
+  std::swap(name_, other.name_);
+  std::swap(base_, other.base_);
+  std::swap(bytes_, other.bytes_);
+  std::swap(owner_, other.owner_);
+  return *this;
+}
+
+ShmSegment::~ShmSegment() {
+  if (base_ != nullptr) {
+    munmap(base_, bytes_);
+    base_ = nullptr;
+  }
+  if (owner_) {
+    shm_unlink(name_.c_str());
+    owner_ = false;
+  }
+}
+
+ShmSlotHeader& ShmSegment::slot(uint32_t index) const {
+  return *reinterpret_cast<ShmSlotHeader*>(slot_data(index) - kShmSlotHeaderBytes);
+}
+
+std::byte* ShmSegment::slot_data(uint32_t index) const {
+  return static_cast<std::byte*>(base_) + kShmHeaderBytes + index * header().slot_bytes +
+         kShmSlotHeaderBytes;
+}
+
+size_t ShmSegment::max_bars_per_slot() const {
+  return (header().slot_bytes - kShmSlotHeaderBytes) / (kShmColumnsPerBar * sizeof(double));
+}
+
+ShmIndicatorServer::ShmIndicatorServer(IndicatorServiceImpl& service, const std::string& name,
+                                       uint32_t slot_count, size_t max_bars_per_slot, size_t workers,
+                                       bool replace_existing)
+    : service_(service), segment_(ShmSegment::create(name, slot_count, max_bars_per_slot, replace_existing)) {
+  workers = std::max<size_t>(1, workers);
+  for (size_t i = 0; i < workers; ++i) {
+    threads_.emplace_back([this] { run(); });
+  }
+  segment_.header().serving.store(1, std::memory_order_release);
+}
+
+ShmIndicatorServer::~ShmIndicatorServer() {
+  stop();
+}
+
+void ShmIndicatorServer::stop() {
+  if (stopping_.exchange(true)) {
+    return;
+  }
+  ShmSegmentHeader& header = segment_.header();
+  header.serving.store(0, std::memory_order_release);
+  header.doorbell.fetch_add(1, std::memory_order_release);
+  futex_wake(header.doorbell);
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+  // Clients still waiting on unanswered requests see serving == 0 and give up.
+  for (uint32_t i = 0; i < header.slot_count; ++i) {
+    futex_wake(segment_.slot(i).state);
+  }
+}
+
+void ShmIndicatorServer::run() {
+  ShmSegmentHeader& header = segment_.header();
+  int idle_spins = 0;
+  while (!stopping_.load(std::memory_order_acquire)) {
+    const uint32_t ring = header.doorbell.load(std::memory_order_acquire);
+    bool found = false;
+    for (uint32_t i = 0; i < header.slot_count; ++i) {
+      uint32_t expected = to_word(ShmSlotState::kRequest);
+      if (segment_.slot(i).state.compare_exchange_strong(expected, to_word(ShmSlotState::kProcessing),
+                                                         std::memory_order_acq_rel)) {
+        process(i);
+        found = true;
+      }
+    }
+    if (found) {
+      idle_spins = 0;
+    } else if (++idle_spins > 64) {
+      // Timed so stop() is noticed even if a wake is lost.
+      futex_wait(header.doorbell, ring, std::chrono::milliseconds(100));
+    }
+  }
+}
+
+void ShmIndicatorServer::process(uint32_t index) {
+  ShmSlotHeader& slot = segment_.slot(index);
+  std::byte* data = segment_.slot_data(index);
+  const size_t n = slot.bar_count;
+  const size_t capacity = segment_.header().slot_bytes - kShmSlotHeaderBytes;
+  auto fail = [&](int code, const std::string& message) {
+    const size_t bytes = std::min(message.size(), capacity);
+    std::memcpy(data, message.data(), bytes);
+    slot.status = code;
+    slot.message_bytes = static_cast<uint32_t>(bytes);
+    slot.output_count = 0;
+    slot.output_length = 0;
+  };
+
+  try {
+    const std::string name = read_name(slot.indicator, kShmIndicatorBytes);
+    const auto indicator = create_indicator(name);
+    // The header is client-written: bound it before reading columns from the slot.
+    if (n > segment_.max_bars_per_slot()) {
+      fail(kInvalidArgument, "bar count " + std::to_string(n) +
+                                 " exceeds the shared-memory slot capacity of " +
+                                 std::to_string(segment_.max_bars_per_slot()));
+    } else if (!indicator) {
+      fail(kNotFound, "unknown indicator: " + name);
+    } else if (indicator->output_names().size() * (kShmNameBytes + n * sizeof(double)) > capacity) {
+      fail(kInvalidArgument, "indicator outputs do not fit in the shared-memory slot");
+    } else {
+      Params params;
+      for (uint32_t i = 0; i < std::min<uint32_t>(slot.param_count, kShmMaxParams); ++i) {
+        params.emplace(read_name(slot.params[i].key, kShmNameBytes), slot.params[i].value);
+      }
+      const auto* ts = reinterpret_cast<const int64_t*>(data);
+      const auto* open = reinterpret_cast<const double*>(ts + n);
+      const double* high = open + n;
+      const double* low = high + n;
+      const double* close = low + n;
+      const auto* volume = reinterpret_cast<const int64_t*>(close + n);
+      const auto* amount = reinterpret_cast<const double*>(volume + n);
+      std::vector<OHLCV> bars(n);
+      for (size_t i = 0; i < n; ++i) {
+        bars[i] = OHLCV{ts[i], open[i], high[i], low[i], close[i], volume[i], amount[i]};
+      }
+
+      using Clock = std::chrono::steady_clock;
+      const auto deadline = slot.timeout_millis == 0
+                                ? Clock::time_point::max()
+                                : Clock::now() + std::chrono::milliseconds(slot.timeout_millis);
+      // The outputs are copied into the slot inside the pipeline, before its arena is released.
+      auto emit = [&](const SeriesMap& outputs) {
+        std::vector<std::pair<std::string_view, const Series*>> sorted;
+        for (const auto& [output_name, output] : outputs) {
+          sorted.emplace_back(output_name, &output);
+        }
+        std::sort(sorted.begin(), sorted.end());
+        auto* names = reinterpret_cast<char*>(data);
+        auto* values = reinterpret_cast<double*>(data + sorted.size() * kShmNameBytes);
+        size_t k = 0;
+        for (const auto& [output_name, output] : sorted) {
+          copy_name(names + k * kShmNameBytes, kShmNameBytes, output_name, "output name");
+          std::copy(output->begin(), output->end(), values + k * n);
+          ++k;
+        }
+        slot.output_count = static_cast<uint32_t>(sorted.size());
+        slot.output_length = static_cast<uint32_t>(n);
+      };
+      const grpc::Status status = service_.compute_bars(name, params, bars, deadline, emit);
+      if (status.ok()) {
+        slot.status = 0;
+        slot.message_bytes = 0;
+      } else {
+        fail(static_cast<int>(status.error_code()), status.error_message());
+      }
+    }
+  } catch (const std::invalid_argument& e) {
+    fail(kInvalidArgument, e.what());
+  } catch (const std::exception& e) {
+    fail(kInternal, e.what());
+  }
+  uint32_t expected = to_word(ShmSlotState::kProcessing);
+  if (!slot.state.compare_exchange_strong(expected, to_word(ShmSlotState::kResponse),
+                                          std::memory_order_acq_rel)) {
+    // The client gave up on this request and left the slot for us to free.
+    slot.state.store(to_word(ShmSlotState::kFree), std::memory_order_release);
+  }
+  futex_wake(slot.state);
+}
+
+ShmCall::ShmCall(const ShmSegment* segment, uint32_t index, size_t bar_count)
+    : segment_(segment), index_(index) {
+  std::byte* data = segment->slot_data(index);
+  const size_t n = bar_count;
+  auto* ts = reinterpret_cast<int64_t*>(data);
+  auto* open = reinterpret_cast<double*>(ts + n);
+  double* high = open + n;
+  double* low = high + n;
+  double* close = low + n;
+  auto* volume = reinterpret_cast<int64_t*>(close + n);
+  auto* amount = reinterpret_cast<double*>(volume + n);
+  columns_ = ShmBarColumns{{ts, n},    {open, n},   {high, n},  {low, n},
+                           {close, n}, {volume, n}, {amount, n}};
+}
+
+ShmCall::ShmCall(ShmCall&& other) noexcept
+    : segment_(std::exchange(other.segment_, nullptr)),
+      index_(other.index_),
+      columns_(other.columns_),
+      local_status_(other.local_status_),
+      local_error_(std::move(other.local_error_)),
+      abandoned_(other.abandoned_) {}
+
+// submit() always returns with the slot CLAIMED, RESPONSE or handed to the server, so
+// releasing it never waits.
+ShmCall::~ShmCall() {
+  if (segment_ == nullptr || abandoned_) {
+    return;
+  }
+  ShmSlotHeader& slot = segment_->slot(index_);
+  slot.state.store(to_word(ShmSlotState::kFree), std::memory_order_release);
+  futex_wake(slot.state);
+}
+
+int ShmCall::submit(std::chrono::steady_clock::time_point deadline) {
+  ShmSlotHeader& slot = segment_->slot(index_);
+  ShmSegmentHeader& header = segment_->header();
+  if (header.serving.load(std::memory_order_acquire) == 0) {
+    return give_up(kUnavailable, "no shared-memory server is serving this segment");
+  }
+  slot.timeout_millis = 0;
+  if (deadline != std::chrono::steady_clock::time_point::max()) {
+    const auto remaining =
+        std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) {
+      return give_up(kDeadlineExceeded, "deadline passed before the request was sent");
+    }
+    slot.timeout_millis = static_cast<uint32_t>(std::min<int64_t>(remaining.count(), UINT32_MAX));
+  }
+  slot.state.store(to_word(ShmSlotState::kRequest), std::memory_order_release);
+  header.doorbell.fetch_add(1, std::memory_order_release);
+  futex_wake(header.doorbell);
+  const int waited = await_response(header, slot.state, deadline);
+  if (waited != 0) {
+    return give_up(waited, waited == kDeadlineExceeded
+                               ? "deadline exceeded waiting for the shared-memory server"
+                               : "shared-memory server stopped");
+  }
+  return slot.status;
+}
+
+int ShmCall::give_up(int code, std::string message) {
+  std::atomic<uint32_t>& state = segment_->slot(index_).state;
+  uint32_t expected = to_word(ShmSlotState::kRequest);
+  const auto withdrawn = to_word(ShmSlotState::kClaimed);
+  const auto abandoned = to_word(ShmSlotState::kAbandoned);
+  if (!state.compare_exchange_strong(expected, withdrawn, std::memory_order_acq_rel) &&
+      expected == to_word(ShmSlotState::kProcessing)) {
+    abandoned_ = state.compare_exchange_strong(expected, abandoned, std::memory_order_acq_rel);
+  }
+  // The server may have answered in the meantime; its response wins.
+  if (expected == to_word(ShmSlotState::kResponse)) {
+    return segment_->slot(index_).status;
+  }
+  local_status_ = code;
+  local_error_ = std::move(message);
+  return code;
+}
+
+std::string ShmCall::error_message() const {
+  if (local_status_ != 0) {
+    return local_error_;
+  }
+  const ShmSlotHeader& slot = segment_->slot(index_);
+  return std::string(reinterpret_cast<const char*>(segment_->slot_data(index_)), slot.message_bytes);
+}
+
+std::vector<std::string> ShmCall::series_names() const {
+  if (local_status_ != 0) {
+    return {};
+  }
+  const ShmSlotHeader& slot = segment_->slot(index_);
+  const auto* names = reinterpret_cast<const char*>(segment_->slot_data(index_));
+  std::vector<std::string> out;
+  for (uint32_t k = 0; k < slot.output_count; ++k) {
+    out.push_back(read_name(names + k * kShmNameBytes, kShmNameBytes));
+  }
+  return out;
+}
+
+std::span<const double> ShmCall::series(std::string_view name) const {
+  if (local_status_ != 0) {
+    return {};
+  }
+  const ShmSlotHeader& slot = segment_->slot(index_);
+  const std::byte* data = segment_->slot_data(index_);
+  const auto* names = reinterpret_cast<const char*>(data);
+  const auto* values = reinterpret_cast<const double*>(data + slot.output_count * kShmNameBytes);
+  for (uint32_t k = 0; k < slot.output_count; ++k) {
+    if (read_name(names + k * kShmNameBytes, kShmNameBytes) == name) {
+      return {values + static_cast<size_t>(k) * slot.output_length, slot.output_length};
+    }
+  }
+  return {};
+}
+
+ShmIndicatorClient::ShmIndicatorClient(const std::string& name)
+    : segment_(ShmSegment::open(name)) {}
+
+ShmCall ShmIndicatorClient::begin(const std::string& indicator, const Params& params,
+                                  size_t bar_count) {
+  if (bar_count > segment_.max_bars_per_slot()) {
+    throw std::invalid_argument("request of " + std::to_string(bar_count) +
+                                " bars exceeds the shared-memory slot capacity of " +
+                                std::to_string(segment_.max_bars_per_slot()));
+  }
+  if (params.size() > kShmMaxParams) {
+    throw std::invalid_argument("shared-memory transport supports at most 8 params");
+  }
+  // Checked before claiming a slot, so a rejected name cannot leave one stuck in kClaimed.
+  check_name(kShmIndicatorBytes, indicator, "indicator name");
+  for (const auto& [key, value] : params) {
+    check_name(kShmNameBytes, key, "param name");
+  }
+  ShmSegmentHeader& header = segment_.header();
+  const uint32_t slots = header.slot_count;
+  for (uint32_t attempt = 0;; ++attempt) {
+    const uint32_t start = header.next_slot.fetch_add(1, std::memory_order_relaxed);
+    for (uint32_t offset = 0; offset < slots; ++offset) {
+      const uint32_t index = (start + offset) % slots;
+      ShmSlotHeader& slot = segment_.slot(index);
+      uint32_t expected = to_word(ShmSlotState::kFree);
+      if (!slot.state.compare_exchange_strong(expected, to_word(ShmSlotState::kClaimed),
+                                              std::memory_order_acquire)) {
+        continue;
+      }
+      copy_name(slot.indicator, kShmIndicatorBytes, indicator, "indicator name");
+      slot.param_count = static_cast<uint32_t>(params.size());
+      uint32_t i = 0;
+      for (const auto& [key, value] : params) {
+        copy_name(slot.params[i].key, kShmNameBytes, key, "param name");
+        slot.params[i].value = value;
+        ++i;
+      }
+      slot.bar_count = static_cast<uint32_t>(bar_count);
+      slot.status = 0;
+      slot.output_count = 0;
+      slot.output_length = 0;
+      slot.message_bytes = 0;
+      return ShmCall(&segment_, index, bar_count);
+    }
+    // Every slot is busy: sleep on one until it changes state.
+    ShmSlotHeader& slot = segment_.slot(start % slots);
+    const uint32_t seen = slot.state.load(std::memory_order_acquire);
+    if (seen != to_word(ShmSlotState::kFree) && attempt > 16) {
+      futex_wait(slot.state, seen, std::chrono::milliseconds(1));
+    }
+  }
+}
+
+}  // namespace tg_indicators
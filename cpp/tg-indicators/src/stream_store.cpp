@@ -0,0 +1,393 @@
+#include "tg_indicators/stream_store.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "tg_indicators/indicators/registry.h"
+
+namespace tg_indicators {
+namespace {
+
+constexpr char kSnapshotMagic[4] = {'T', 'G', 'S', 'T'};
+constexpr uint32_t kSnapshotVersion = 2;
+
+uint64_t fnv1a(std::string_view bytes) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : bytes) {
+    hash = (hash ^ c) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Every parameter in the indicator's schema, sorted by name: the given value once
+// validated, else the default. Keys the schema does not name are dropped, so requests
+// that spell one configuration differently ({} and {"period": 14} for RSI) share a
+// state. Throws std::invalid_argument for an unknown indicator or an invalid value.
+std::vector<std::pair<std::string, double>> normalized_params(const std::string& indicator,
+                                                              const Params& params) {
+  const std::unique_ptr<IIndicator> schema_source = create_indicator(indicator);
+  if (!schema_source) {
+    throw std::invalid_argument("unknown indicator: " + indicator);
+  }
+  std::vector<std::pair<std::string, double>> out;
+  for (const ParamSpec& spec : schema_source->param_schema()) {
+    const auto it = params.find(spec.name);
+    out.emplace_back(spec.name, it == params.end() ? spec.default_value : checked_param(spec, it->second));
+  }
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+Params to_params(const std::vector<std::pair<std::string, double>>& ordered) {
+  return Params(ordered.begin(), ordered.end());
+}
+
+std::string entry_key(const std::string& session, const std::string& indicator,
+                      const std::vector<std::pair<std::string, double>>& params,
+                      tg::v1::BarPeriod resample_to) {
+  std::string key = session;
+  key.push_back('\0');
+  key += indicator;
+  for (const auto& [name, value] : params) {
+    key.push_back('\0');
+    key += name;
+    key.push_back('=');
+    key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+  if (resample_to != tg::v1::BAR_PERIOD_UNSPECIFIED) {
+    key.push_back('\0');
+    key.push_back('@');
+    key += std::to_string(resample_to);
+  }
+  return key;
+}
+
+template <typename T>
+void put(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void put_string(std::string& out, std::string_view value) {
+  put(out, static_cast<uint32_t>(value.size()));
+  out.append(value);
+}
+
+void put_bar(std::string& out, const OHLCV& bar) {
+  put(out, bar.ts_millis);
+  put(out, bar.open);
+  put(out, bar.high);
+  put(out, bar.low);
+  put(out, bar.close);
+  put(out, bar.volume);
+  put(out, bar.amount);
+}
+
+class SnapshotReader {
+ public:
+  explicit SnapshotReader(std::string_view in) : in_(in) {}
+
+  template <typename T>
+  T get() {
+    T value;
+    std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+    return value;
+  }
+
+  std::string_view get_string() { return take(get<uint32_t>()); }
+
+  OHLCV get_bar() {
+    OHLCV bar;
+    bar.ts_millis = get<int64_t>();
+    bar.open = get<double>();
+    bar.high = get<double>();
+    bar.low = get<double>();
+    bar.close = get<double>();
+    bar.volume = get<int64_t>();
+    bar.amount = get<double>();
+    return bar;
+  }
+
+  std::string_view take(size_t bytes) {
+    if (in_.size() < bytes) {
+      throw std::runtime_error("stream snapshot is truncated");
+    }
+    const std::string_view out = in_.substr(0, bytes);
+    in_.remove_prefix(bytes);
+    return out;
+  }
+
+  bool done() const { return in_.empty(); }
+
+ private:
+  std::string_view in_;
+};
+
+}  // namespace
+
+StreamStore::Shard& StreamStore::shard_for(const std::string& key) {
+  return shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+StreamUpdate StreamStore::update(const std::string& session, const std::string& indicator,
+                                 const Params& params, std::span<const OHLCV> bars,
+                                 const OHLCV* forming, tg::v1::BarPeriod resample_to) {
+  const std::string name = normalize_indicator_name(indicator);
+  auto ordered = normalized_params(name, params);
+  const std::string key = entry_key(session, name, ordered, resample_to);
+
+  std::shared_ptr<Entry> entry;
+  {
+    Shard& shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto& slot = shard.entries[key];
+    if (!slot) {
+      std::unique_ptr<StreamingIndicator> state;
+      std::optional<BarResampler> resampler;
+      try {
+        state = create_streaming_indicator(name, to_params(ordered));
+        if (resample_to != tg::v1::BAR_PERIOD_UNSPECIFIED) {
+          resampler.emplace(resample_to);
+        }
+      } catch (...) {
+        shard.entries.erase(key);
+        throw;
+      }
+      if (!state) {
+        shard.entries.erase(key);
+        throw std::invalid_argument("unknown indicator: " + indicator);
+      }
+      slot = std::make_shared<Entry>();
+      slot->session = session;
+      slot->indicator = name;
+      slot->params = std::move(ordered);
+      slot->latest.assign(state->output_names().size(), nan_value());
+      slot->state = std::move(state);
+      slot->resampler = std::move(resampler);
+    }
+    entry = slot;
+  }
+
+  std::lock_guard<std::mutex> lock(entry->mutex);
+  entry->last_used = std::chrono::steady_clock::now();
+  StreamUpdate result;
+  auto& resampler = entry->resampler;
+  auto is_new = [&](const OHLCV& bar) {
+    const bool started = entry->state->bar_count() > 0 || (resampler && resampler->forming());
+    return !started || bar.ts_millis > entry->watermark_ts_millis;
+  };
+  for (const OHLCV& bar : bars) {
+    if (!is_new(bar)) {
+      continue;
+    }
+    if (!resampler) {
+      entry->state->update(bar, entry->latest);
+    } else if (const auto closed = resampler->push(bar)) {
+      entry->state->update(*closed, entry->latest);
+    }
+    entry->watermark_ts_millis = bar.ts_millis;
+    ++result.applied_bars;
+  }
+  if (forming != nullptr && is_new(*forming)) {
+    result.provisional.assign(entry->latest.size(), nan_value());
+    if (!resampler) {
+      entry->state->preview(*forming, result.provisional);
+    } else {
+      // A forming bar in a later bucket proves the current one complete: commit it,
+      // then preview the new bucket as the forming bar has it so far.
+      if (const auto closed = resampler->close_before(forming->ts_millis)) {
+        entry->state->update(*closed, entry->latest);
+      }
+      BarResampler bucket = *resampler;
+      bucket.push(*forming);
+      entry->state->preview(*bucket.forming(), result.provisional);
+    }
+  } else if (resampler && resampler->forming()) {
+    result.provisional.assign(entry->latest.size(), nan_value());
+    entry->state->preview(*resampler->forming(), result.provisional);
+  }
+  result.watermark_ts_millis = entry->watermark_ts_millis;
+  result.bar_count = entry->state->bar_count();
+  result.names = entry->state->output_names();
+  result.latest = entry->latest;
+  return result;
+}
+
+size_t StreamStore::size() const {
+  size_t total = 0;
+  for (const Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    total += shard.entries.size();
+  }
+  return total;
+}
+
+size_t StreamStore::evict_idle(std::chrono::steady_clock::duration max_idle) {
+  const auto cutoff = std::chrono::steady_clock::now() - max_idle;
+  size_t evicted = 0;
+  for (Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    std::erase_if(shard.entries, [&](const auto& item) {
+      // Entries are only handed out under the shard lock, so one nobody else holds
+      // now stays unreachable until it is erased.
+      if (item.second.use_count() != 1) {
+        return false;
+      }
+      std::lock_guard<std::mutex> entry_lock(item.second->mutex);
+      const bool idle = item.second->last_used < cutoff;
+      evicted += idle;
+      return idle;
+    });
+  }
+  return evicted;
+}
+
+size_t StreamStore::snapshot(const std::string& path) const {
+  std::string body;
+  size_t count = 0;
+  for (const Shard& shard : shards_) {
+    std::vector<std::shared_ptr<Entry>> entries;
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      entries.reserve(shard.entries.size());
+      for (const auto& [key, entry] : shard.entries) {
+        entries.push_back(entry);
+      }
+    }
+    for (const auto& entry : entries) {
+      std::lock_guard<std::mutex> lock(entry->mutex);
+      put_string(body, entry->session);
+      put_string(body, entry->indicator);
+      put(body, static_cast<uint32_t>(entry->params.size()));
+      for (const auto& [name, value] : entry->params) {
+        put_string(body, name);
+        put(body, value);
+      }
+      const auto& resampler = entry->resampler;
+      put(body, static_cast<int32_t>(resampler ? resampler->target() : tg::v1::BAR_PERIOD_UNSPECIFIED));
+      if (resampler) {
+        put(body, static_cast<uint8_t>(resampler->forming().has_value()));
+        put(body, resampler->forming_key());
+        if (resampler->forming()) {
+          put_bar(body, *resampler->forming());
+        }
+      }
+      put(body, entry->watermark_ts_millis);
+      put(body, static_cast<uint32_t>(entry->latest.size()));
+      for (double value : entry->latest) {
+        put(body, value);
+      }
+      std::string state;
+      entry->state->save(state);
+      put_string(body, state);
+      ++count;
+    }
+  }
+
+  std::string file(kSnapshotMagic, sizeof(kSnapshotMagic));
+  put(file, kSnapshotVersion);
+  put(file, static_cast<uint64_t>(count));
+  file += body;
+  put(file, fnv1a(file));
+
+  const std::string temp = path + ".tmp";
+  FILE* out = std::fopen(temp.c_str(), "wb");
+  if (out == nullptr) {
+    throw std::runtime_error("cannot open " + temp + " for writing");
+  }
+  const bool written = std::fwrite(file.data(), 1, file.size(), out) == file.size() &&
+                       std::fflush(out) == 0 && fsync(fileno(out)) == 0;
+  std::fclose(out);
+  if (!written || std::rename(temp.c_str(), path.c_str()) != 0) {
+    std::remove(temp.c_str());
+    throw std::runtime_error("failed to write stream snapshot " + path);
+  }
+  return count;
+}
+
+size_t StreamStore::restore(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("cannot open stream snapshot " + path);
+  }
+  const std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  if (file.size() < sizeof(kSnapshotMagic) + sizeof(uint32_t) + 2 * sizeof(uint64_t) ||
+      std::memcmp(file.data(), kSnapshotMagic, sizeof(kSnapshotMagic)) != 0) {
+    throw std::runtime_error(path + " is not a stream snapshot");
+  }
+  const std::string_view content(file.data(), file.size() - sizeof(uint64_t));
+  uint64_t checksum = 0;
+  std::memcpy(&checksum, file.data() + content.size(), sizeof(checksum));
+  if (checksum != fnv1a(content)) {
+    throw std::runtime_error("stream snapshot " + path + " failed its checksum");
+  }
+
+  SnapshotReader reader(content.substr(sizeof(kSnapshotMagic)));
+  const uint32_t version = reader.get<uint32_t>();
+  if (version != kSnapshotVersion) {
+    throw std::runtime_error("stream snapshot " + path + " has an unsupported version");
+  }
+  const uint64_t count = reader.get<uint64_t>();
+  std::vector<std::pair<std::string, std::shared_ptr<Entry>>> loaded;
+  for (uint64_t i = 0; i < count; ++i) {
+    auto entry = std::make_shared<Entry>();
+    entry->session = reader.get_string();
+    entry->indicator = reader.get_string();
+    const uint32_t param_count = reader.get<uint32_t>();
+    Params params;
+    for (uint32_t p = 0; p < param_count; ++p) {
+      std::string name(reader.get_string());
+      params[std::move(name)] = reader.get<double>();
+    }
+    const auto resample_to = static_cast<tg::v1::BarPeriod>(reader.get<int32_t>());
+    if (resample_to != tg::v1::BAR_PERIOD_UNSPECIFIED) {
+      const bool has_forming = reader.get<uint8_t>() != 0;
+      const int64_t forming_key = reader.get<int64_t>();
+      std::optional<OHLCV> forming;
+      if (has_forming) {
+        forming = reader.get_bar();
+      }
+      try {
+        entry->resampler.emplace(resample_to, forming_key, forming);
+      } catch (const std::invalid_argument& e) {
+        throw std::runtime_error("stream snapshot entry for " + entry->session + ": " + e.what());
+      }
+    }
+    entry->watermark_ts_millis = reader.get<int64_t>();
+    entry->latest.resize(reader.get<uint32_t>());
+    for (double& value : entry->latest) {
+      value = reader.get<double>();
+    }
+    try {
+      entry->params = normalized_params(entry->indicator, params);
+      entry->state = create_streaming_indicator(entry->indicator, to_params(entry->params));
+    } catch (const std::invalid_argument& e) {
+      throw std::runtime_error("stream snapshot entry for " + entry->session + ": " + e.what());
+    }
+    if (!entry->state || entry->state->output_names().size() != entry->latest.size()) {
+      throw std::runtime_error("stream snapshot has an unusable entry for " + entry->session);
+    }
+    entry->state->load(reader.get_string());
+    entry->last_used = std::chrono::steady_clock::now();
+    std::string key = entry_key(entry->session, entry->indicator, entry->params, resample_to);
+    loaded.emplace_back(std::move(key), std::move(entry));
+  }
+  if (!reader.done()) {
+    throw std::runtime_error("stream snapshot " + path + " has trailing bytes");
+  }
+
+  // Only publish once the whole file has parsed, so a bad snapshot changes nothing.
+  for (auto& [key, entry] : loaded) {
+    Shard& shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.entries[key] = std::move(entry);
+  }
+  return loaded.size();
+}
+
+}  // namespace tg_indicators
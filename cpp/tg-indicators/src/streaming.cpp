@@ -0,0 +1,894 @@
+#include "tg_indicators/streaming.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "tg_indicators/indicators/adx.h"
+#include "tg_indicators/indicators/atr.h"
+#include "tg_indicators/indicators/bollinger_bands.h"
+#include "tg_indicators/indicators/cci.h"
+#include "tg_indicators/indicators/ema.h"
+#include "tg_indicators/indicators/macd.h"
+#include "tg_indicators/indicators/registry.h"
+#include "tg_indicators/indicators/rsi.h"
+#include "tg_indicators/indicators/sma.h"
+#include "tg_indicators/indicators/stochastic.h"
+#include "tg_indicators/indicators/williams_r.h"
+
+namespace tg_indicators {
+namespace {
+
+// Last `capacity` values in arrival order.
+class Window {
+ public:
+  explicit Window(size_t capacity) : values_(capacity) {}
+
+  bool full() const { return size_ == values_.size(); }
+  bool full_after_push() const { return size_ + 1 >= values_.size(); }
+  double oldest() const { return values_[full() ? head_ : 0]; }
+
+  void push(double value) {
+    values_[head_] = value;
+    head_ = (head_ + 1) % values_.size();
+    size_ = std::min(size_ + 1, values_.size());
+    invalidate();
+  }
+
+  // Oldest to newest, matching the index order of the batch kernels.
+  template <typename Fn>
+  void for_each(Fn&& fn) const {
+    const size_t start = full() ? head_ : 0;
+    for (size_t i = 0; i < size_; ++i) {
+      fn(values_[(start + i) % values_.size()]);
+    }
+  }
+
+  double max() const {
+    double out = oldest();
+    for_each([&](double v) { out = std::max(out, v); });
+    return out;
+  }
+
+  double min() const {
+    double out = oldest();
+    for_each([&](double v) { out = std::min(out, v); });
+    return out;
+  }
+
+  // The values that stay when the next one is pushed: all of them until the window is
+  // full, then all but the oldest. A forming bar is previewed against this summary,
+  // which is built on first use after each push and reused while the bar is revised.
+  struct Retained {
+    size_t count{0};
+    double sum{0.0};  // oldest to newest, as the batch kernels add
+    double max{0.0};
+    double min{0.0};
+    double m2{0.0};  // sum of squared deviations from sum / count
+  };
+
+  const Retained& retained() const {
+    if (!retained_valid_) {
+      retained_ = {};
+      const size_t skip = full() ? 1 : 0;
+      retained_.count = size_ - skip;
+      size_t index = 0;
+      for_each([&](double v) {
+        if (index++ < skip) {
+          return;
+        }
+        if (index == skip + 1) {
+          retained_.max = retained_.min = v;
+        }
+        retained_.max = std::max(retained_.max, v);
+        retained_.min = std::min(retained_.min, v);
+        retained_.sum += v;
+      });
+      if (retained_.count > 0) {
+        const double mean = retained_.sum / static_cast<double>(retained_.count);
+        index = 0;
+        for_each([&](double v) {
+          if (index++ >= skip) {
+            retained_.m2 += (v - mean) * (v - mean);
+          }
+        });
+      }
+      retained_valid_ = true;
+    }
+    return retained_;
+  }
+
+  // Sum of |v - center| over the retained values, in O(log capacity) from a sorted copy
+  // with prefix sums.
+  double retained_deviation(double center) const {
+    if (!sorted_valid_) {
+      sorted_.clear();
+      const size_t skip = full() ? 1 : 0;
+      size_t index = 0;
+      for_each([&](double v) {
+        if (index++ >= skip) {
+          sorted_.push_back(v);
+        }
+      });
+      std::sort(sorted_.begin(), sorted_.end());
+      prefix_.assign(1, 0.0);
+      for (const double v : sorted_) {
+        prefix_.push_back(prefix_.back() + v);
+      }
+      sorted_valid_ = true;
+    }
+    const size_t below = static_cast<size_t>(
+        std::lower_bound(sorted_.begin(), sorted_.end(), center) - sorted_.begin());
+    const size_t above = sorted_.size() - below;
+    return (center * static_cast<double>(below) - prefix_[below]) +
+           ((prefix_.back() - prefix_[below]) - center * static_cast<double>(above));
+  }
+
+  // Lists the persisted fields to v; Self is Window when loading, const Window when saving.
+  template <typename Self, typename Visitor>
+  static void visit(Self& self, Visitor& v) {
+    v.fixed(self.values_.size());
+    v(self.head_);
+    v(self.size_);
+    for (auto& value : self.values_) {
+      v(value);
+    }
+    if constexpr (!std::is_const_v<Self>) {
+      self.invalidate();
+    }
+  }
+
+ private:
+  void invalidate() {
+    retained_valid_ = false;
+    sorted_valid_ = false;
+  }
+
+  std::vector<double> values_;
+  size_t head_{0};
+  size_t size_{0};
+  mutable Retained retained_;
+  mutable bool retained_valid_{false};
+  mutable std::vector<double> sorted_;
+  mutable std::vector<double> prefix_;
+  mutable bool sorted_valid_{false};
+};
+
+class StateWriter {
+ public:
+  explicit StateWriter(std::string& out) : out_(out) {}
+
+  void operator()(double value) { append(&value, sizeof(value)); }
+  void operator()(size_t value) {
+    const uint64_t wide = value;
+    append(&wide, sizeof(wide));
+  }
+  void fixed(size_t value) { (*this)(value); }
+  void operator()(const Window& window) { Window::visit(window, *this); }
+
+ private:
+  void append(const void* data, size_t bytes) {
+    out_.append(static_cast<const char*>(data), bytes);
+  }
+  std::string& out_;
+};
+
+class StateReader {
+ public:
+  explicit StateReader(std::string_view in) : in_(in) {}
+
+  void operator()(double& value) { take(&value, sizeof(value)); }
+  void operator()(size_t& value) {
+    uint64_t wide = 0;
+    take(&wide, sizeof(wide));
+    value = static_cast<size_t>(wide);
+  }
+  // A value fixed by the params (e.g. window capacity) that must round-trip unchanged.
+  void fixed(size_t expected) {
+    size_t stored = 0;
+    (*this)(stored);
+    if (stored != expected) {
+      throw std::runtime_error("streaming state was saved with different params");
+    }
+  }
+  void operator()(Window& window) { Window::visit(window, *this); }
+
+  void finish() const {
+    if (!in_.empty()) {
+      throw std::runtime_error("streaming state has trailing bytes");
+    }
+  }
+
+ private:
+  void take(void* data, size_t bytes) {
+    if (in_.size() < bytes) {
+      throw std::runtime_error("streaming state is truncated");
+    }
+    std::memcpy(data, in_.data(), bytes);
+    in_.remove_prefix(bytes);
+  }
+  std::string_view in_;
+};
+
+// save/load via the derived class's static visit(self, v), which lists every mutable
+// field once for both directions.
+template <typename Derived>
+class StreamingBase : public StreamingIndicator {
+ public:
+  uint64_t bar_count() const override { return count_; }
+
+  // The recursive indicators carry O(1) state, so a forming bar is folded into a copy.
+  // Windowed streams override this to avoid copying their window.
+  void preview(const OHLCV& bar, std::span<double> out) const override {
+    Derived scratch = static_cast<const Derived&>(*this);
+    scratch.update(bar, out);
+  }
+
+  void save(std::string& out) const override {
+    StateWriter writer(out);
+    writer(count_);
+    Derived::visit(static_cast<const Derived&>(*this), writer);
+  }
+
+  void load(std::string_view bytes) override {
+    StateReader reader(bytes);
+    reader(count_);
+    Derived::visit(static_cast<Derived&>(*this), reader);
+    reader.finish();
+  }
+
+ protected:
+  size_t count_{0};
+};
+
+// EMA seeded with the SMA of its first `period` inputs, as in compute_ema.
+struct EmaState {
+  EmaState(int period, double smoothing)
+      : period(static_cast<size_t>(period)), alpha(smoothing / (static_cast<double>(period) + 1.0)) {}
+
+  // Returns the EMA after `value`, NaN until seeded.
+  double push(double value) {
+    if (seen < period) {
+      seed_sum += value;
+      if (++seen < period) {
+        return nan_value();
+      }
+      ema = seed_sum / static_cast<double>(period);
+      return ema;
+    }
+    ema = (1.0 - alpha) * ema + alpha * value;
+    return ema;
+  }
+
+  template <typename Self, typename Visitor>
+  static void visit(Self& self, Visitor& v) {
+    v(self.seen);
+    v(self.seed_sum);
+    v(self.ema);
+  }
+
+  size_t period;
+  double alpha;
+  size_t seen{0};
+  double seed_sum{0.0};
+  double ema{0.0};
+};
+
+// Window extrema once `value` is pushed, from the retained summary in O(1).
+double extreme_high(const Window& window, double value) {
+  const Window::Retained& retained = window.retained();
+  return retained.count == 0 ? value : std::max(retained.max, value);
+}
+
+double extreme_low(const Window& window, double value) {
+  const Window::Retained& retained = window.retained();
+  return retained.count == 0 ? value : std::min(retained.min, value);
+}
+
+class SmaStream final : public StreamingBase<SmaStream> {
+ public:
+  explicit SmaStream(const SmaParams& params) : period_(static_cast<size_t>(params.period)), window_(period_) {}
+
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"sma"};
+    return kNames;
+  }
+
+  void update(const OHLCV& bar, std::span<double> out) override {
+    sum_ += bar.close;
+    if (window_.full()) {
+      sum_ -= window_.oldest();
+    }
+    window_.push(bar.close);
+    ++count_;
+    out[0] = window_.full() ? sum_ / static_cast<double>(period_) : nan_value();
+  }
+
+  void preview(const OHLCV& bar, std::span<double> out) const override {
+    if (!window_.full_after_push()) {
+      out[0] = nan_value();
+      return;
+    }
+    const double sum = window_.full() ? (sum_ + bar.close) - window_.oldest() : sum_ + bar.close;
+    out[0] = sum / static_cast<double>(period_);
+  }
+
+  template <typename Self, typename Visitor>
+  static void visit(Self& self, Visitor& v) {
+    v(self.sum_);
+    v(self.window_);
+  }
+
+ private:
+  size_t period_;
+  Window window_;
+  double sum_{0.0};
+};
+
+class EmaStream final : public StreamingBase<EmaStream> {
+ public:
+  explicit EmaStream(const EmaParams& params) : ema_(params.period, params.smoothing) {}
+
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"ema"};
+    return kNames;
+  }
+
+  void update(const OHLCV& bar, std::span<double> out) override {
+    ++count_;
+    out[0] = ema_.push(bar.close);
+  }
+
+  template <typename Self, typename Visitor>
+  static void visit(Self& self, Visitor& v) {
+    EmaState::visit(self.ema_, v);
+  }
+
+ private:
+  EmaState ema_;
+};
+
+class MacdStream final : public StreamingBase<MacdStream> {
+ public:
+  explicit MacdStream(const MacdParams& params)
+      : fast_(params.fast, 2.0),
+        slow_(params.slow, 2.0),
+        signal_(static_cast<size_t>(params.signal)),
+        alpha_(2.0 / (static_cast<double>(signal_) + 1.0)) {
+    if (fast_.period >= slow_.period) {
+      throw std::invalid_argument("MACD requires fast < slow");
+    }
+  }
+
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"dif", "dea", "hist"};
+    return kNames;
+  }
+
+  void update(const OHLCV& bar, std::span<double> out) override {
+    ++count_;
+    const double fast = fast_.push(bar.close);
+    const double slow = slow_.push(bar.close);
+    const double dif = std::isnan(fast) || std::isnan(slow) ? nan_value() : fast - slow;
+    double dea = nan_value();
+    if (!std::isnan(dif)) {
+      if (dea_seen_ < signal_) {
+        dea_seed_sum_ += dif;
+        if (++dea_seen_ == signal_) {
+          dea_ = dea_seed_sum_ / static_cast<double>(signal_);
+          dea = dea_;
+        }
+      } else {
+        dea_ = (1.0 - alpha_) * dea_ + alpha_ * dif;
+        dea = dea_;
+      }
+    }
+    out[0] = dif;
+    out[1] = dea;
+    out[2] = std::isnan(dif) || std::isnan(dea) ? nan_value() : 2.0 * (dif - dea);
+  }
+
+  template <typename Self, typename Visitor>
+  static void visit(Self& self, Visitor& v) {
+    EmaState::visit(self.fast_, v);
+    EmaState::visit(self.slow_, v);
+    v(self.dea_seen_);
+    v(self.dea_seed_sum_);
+    v(self.dea_);
+  }
+
+ private:
+  EmaState fast_;
+  EmaState slow_;
+  size_t signal_;
+  double alpha_;
+  size_t dea_seen_{0};
+  double dea_seed_sum_{0.0};
+  double dea_{0.0};
+};
+
+class RsiStream final : public StreamingBase<RsiStream> {
+ public:
+  explicit RsiStream(const RsiParams& params) : period_(static_cast<size_t>(params.period)) {}
+
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"rsi"};
+    return kNames;
+  }
+
+  void update(const OHLCV& bar, std::span<double> out) override {
+    out[0] = nan_value();
+    if (count_++ == 0) {
+      prev_close_ = bar.close;
+      return;
+    }
+    const double change = bar.close - prev_close_;
+    prev_close_ = bar.close;
+    if (count_ <= period_ + 1) {
+      if (change >= 0.0) {
+        avg_gain_ += change;
+      } else {
+        avg_loss_ -= change;
+      }
+      if (count_ < period_ + 1) {
+        return;
+      }
+      avg_gain_ /= static_cast<double>(period_);
+      avg_loss_ /= static_cast<double>(period_);
+    } else {
+      const double weight = 1.0 / static_cast<double>(period_);
+      avg_gain_ = (1.0 - weight) * avg_gain_ + weight * (change > 0.0 ? change : 0.0);
+      avg_loss_ = (1.0 - weight) * avg_loss_ + weight * (change < 0.0 ? -change : 0.0);
+    }
+    out[0] = avg_loss_ == 0.0 ? 100.0 : 100.0 - (100.0 / (1.0 + avg_gain_ / avg_loss_));
+  }
+
+  template <typename Self, typename Visitor>
+  static void visit(Self& self, Visitor& v) {
+    v(self.prev_close_);
+    v(self.avg_gain_);
+    v(self.avg_loss_);
+  }
+
+ private:
+  size_t period_;
+  double prev_close_{0.0};
+  double avg_gain_{0.0};  // seed sums until period_ changes have been seen
+  double avg_loss_{0.0};
+};
+
+double true_range(const OHLCV& bar, double prev_close, bool first) {
+  const double high_low = bar.high - bar.low;
+  if (first) {
+    return high_low;
+  }
+  return std::max({high_low, std::abs(bar.high - prev_close), std::abs(bar.low - prev_close)});
+}
+
+class AtrStream final : public StreamingBase<AtrStream> {
+ public:
+  explicit AtrStream(const AtrParams& params) : period_(static_cast<size_t>(params.period)) {}
+
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"atr"};
+    return kNames;
+  }
+
+  void update(const OHLCV& bar, std::span<double> out) override {
+    const double tr = true_range(bar, prev_close_, count_ == 0);
+    prev_close_ = bar.close;
+    ++count_;
+    if (count_ < period_) {
+      atr_ += tr;
+      out[0] = nan_value();
+      return;
+    }
+    if (count_ == period_) {
+      atr_ = (atr_ + tr) / static_cast<double>(period_);
+    } else {
+      const double weight = 1.0 / static_cast<double>(period_);
+      atr_ = (1.0 - weight) * atr_ + weight * tr;
+    }
+    out[0] = atr_;
+  }
+
+  template <typename Self, typename Visitor>
+  static void visit(Self& self, Visitor& v) {
+    v(self.prev_close_);
+    v(self.atr_);
+  }
+
+ private:
+  size_t period_;
+  double prev_close_{0.0};
+  double atr_{0.0};  // seed sum until period_ bars have been seen
+};
+
+class AdxStream final : public StreamingBase<AdxStream> {
+ public:
+  explicit AdxStream(const AdxParams& params) : period_(static_cast<size_t>(params.period)) {}
+
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"adx", "plus_di", "minus_di"};
+    return kNames;
+  }
+
+  void update(const OHLCV& bar, std::span<double> out) override {
+    const size_t i = count_++;
+    out[0] = out[1] = out[2] = nan_value();
+    if (i == 0) {
+      remember(bar);
+      return;
+    }
+    const double tr = true_range(bar, prev_close_, false);
+    const double up_move = bar.high - prev_high_;
+    const double down_move = prev_low_ - bar.low;
+    const double plus_dm = (up_move > down_move && up_move > 0.0) ? up_move : 0.0;
+    const double minus_dm = (down_move > up_move && down_move > 0.0) ? down_move : 0.0;
+    remember(bar);
+    if (i <= period_) {
+      // Wilder sums seed from bars 1..period.
+      smooth_tr_ += tr;
+      smooth_plus_ += plus_dm;
+      smooth_minus_ += minus_dm;
+      if (i < period_) {
+        return;
+      }
+    } else {
+      const double decay = 1.0 - 1.0 / static_cast<double>(period_);
+      smooth_tr_ = decay * smooth_tr_ + tr;
+      smooth_plus_ = decay * smooth_plus_ + plus_dm;
+      smooth_minus_ = decay * smooth_minus_ + minus_dm;
+    }
+
+    double dx = nan_value();
+    if (smooth_tr_ != 0.0) {
+      out[1] = 100.0 * smooth_plus_ / smooth_tr_;
+      out[2] = 100.0 * smooth_minus_ / smooth_tr_;
+      const double denominator = out[1] + out[2];
+      dx = denominator == 0.0 ? 0.0 : 100.0 * std::abs(out[1] - out[2]) / denominator;
+    }
+    if (i < period_ * 2) {
+      adx_ += dx;
+      if (i == period_ * 2 - 1) {
+        adx_ /= static_cast<double>(period_);
+        out[0] = adx_;
+      }
+      return;
+    }
+    const double weight = 1.0 / static_cast<double>(period_);
+    adx_ = (1.0 - weight) * adx_ + weight * dx;
+    out[0] = adx_;
+  }
+
+  template <typename Self, typename Visitor>
+  static void visit(Self& self, Visitor& v) {
+    v(self.prev_high_);
+    v(self.prev_low_);
+    v(self.prev_close_);
+    v(self.smooth_tr_);
+    v(self.smooth_plus_);
+    v(self.smooth_minus_);
+    v(self.adx_);
+  }
+
+ private:
+  void remember(const OHLCV& bar) {
+    prev_high_ = bar.high;
+    prev_low_ = bar.low;
+    prev_close_ = bar.close;
+  }
+
+  size_t period_;
+  double prev_high_{0.0};
+  double prev_low_{0.0};
+  double prev_close_{0.0};
+  double smooth_tr_{0.0};
+  double smooth_plus_{0.0};
+  double smooth_minus_{0.0};
+  double adx_{0.0};  // seed sum of dx until bar 2 * period - 1
+};
+
+class CciStream final : public StreamingBase<CciStream> {
+ public:
+  explicit CciStream(const CciParams& params)
+      : period_(static_cast<size_t>(params.period)), constant_(params.constant), typical_(period_) {}
+
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"cci"};
+    return kNames;
+  }
+
+  void update(const OHLCV& bar, std::span<double> out) override {
+    const double tp = (bar.high + bar.low + bar.close) / 3.0;
+    typical_.push(tp);
+    ++count_;
+    if (!typical_.full()) {
+      out[0] = nan_value();
+      return;
+    }
+    double sum = 0.0;
+    typical_.for_each([&](double v) { sum += v; });
+    const double mean = sum / static_cast<double>(period_);
+    double mad = 0.0;
+    typical_.for_each([&](double v) { mad += std::abs(v - mean); });
+    mad /= static_cast<double>(period_);
+    out[0] = mad == 0.0 ? 0.0 : (tp - mean) / (constant_ * mad);
+  }
+
+  // The mean is bit-identical to update(); the mean absolute deviation comes from the
+  // sorted retained values, so it can differ from update() in the last bits.
+  void preview(const OHLCV& bar, std::span<double> out) const override {
+    if (!typical_.full_after_push()) {
+      out[0] = nan_value();
+      return;
+    }
+    const double tp = (bar.high + bar.low + bar.close) / 3.0;
+    const double mean = (typical_.retained().sum + tp) / static_cast<double>(period_);
+    const double mad =
+        (typical_.retained_deviation(mean) + std::abs(tp - mean)) / static_cast<double>(period_);
+    out[0] = mad == 0.0 ? 0.0 : (tp - mean) / (constant_ * mad);
+  }
+
+  template <typename Self, typename Visitor>
+  static void visit(Self& self, Visitor& v) {
+    v(self.typical_);
+  }
+
+ private:
+  size_t period_;
+  double constant_;
+  Window typical_;
+};
+
+class BollStream final : public StreamingBase<BollStream> {
+ public:
+  explicit BollStream(const BollParams& params)
+      : period_(static_cast<size_t>(params.period)), k_(params.std_dev), close_(period_) {}
+
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"upper", "mid", "lower"};
+    return kNames;
+  }
+
+  void update(const OHLCV& bar, std::span<double> out) override {
+    sum_ += bar.close;
+    if (close_.full()) {
+      sum_ -= close_.oldest();
+    }
+    close_.push(bar.close);
+    ++count_;
+    if (!close_.full()) {
+      out[0] = out[1] = out[2] = nan_value();
+      return;
+    }
+    const double mid = sum_ / static_cast<double>(period_);
+    double variance = 0.0;
+    close_.for_each([&](double v) { variance += (v - mid) * (v - mid); });
+    const double stddev = std::sqrt(variance / static_cast<double>(period_));
+    out[0] = mid + k_ * stddev;
+    out[1] = mid;
+    out[2] = mid - k_ * stddev;
+  }
+
+  // The mid is bit-identical to update(); the variance merges the retained values'
+  // squared deviations with the forming close, so the bands can differ in the last bits.
+  void preview(const OHLCV& bar, std::span<double> out) const override {
+    if (!close_.full_after_push()) {
+      out[0] = out[1] = out[2] = nan_value();
+      return;
+    }
+    const double sum = close_.full() ? (sum_ + bar.close) - close_.oldest() : sum_ + bar.close;
+    const double mid = sum / static_cast<double>(period_);
+    const Window::Retained& retained = close_.retained();
+    double variance = (bar.close - mid) * (bar.close - mid);
+    if (retained.count > 0) {
+      const double shift = retained.sum / static_cast<double>(retained.count) - mid;
+      variance += retained.m2 + static_cast<double>(retained.count) * shift * shift;
+    }
+    const double stddev = std::sqrt(variance / static_cast<double>(period_));
+    out[0] = mid + k_ * stddev;
+    out[1] = mid;
+    out[2] = mid - k_ * stddev;
+  }
+
+  template <typename Self, typename Visitor>
+  static void visit(Self& self, Visitor& v) {
+    v(self.sum_);
+    v(self.close_);
+  }
+
+ private:
+  size_t period_;
+  double k_;
+  Window close_;
+  double sum_{0.0};
+};
+
+class KdjStream final : public StreamingBase<KdjStream> {
+ public:
+  explicit KdjStream(const KdjParams& params)
+      : high_(static_cast<size_t>(params.k_period)),
+        low_(static_cast<size_t>(params.k_period)),
+        alpha_(1.0 / static_cast<double>(params.d_period)),
+        j_smooth_(params.j_smooth) {}
+
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"k", "d", "j"};
+    return kNames;
+  }
+
+  void update(const OHLCV& bar, std::span<double> out) override {
+    high_.push(bar.high);
+    low_.push(bar.low);
+    ++count_;
+    if (!high_.full()) {
+      out[0] = out[1] = out[2] = nan_value();
+      return;
+    }
+    const double highest_high = high_.max();
+    const double lowest_low = low_.min();
+    const double range = highest_high - lowest_low;
+    const double rsv = range == 0.0 ? 50.0 : 100.0 * (bar.close - lowest_low) / range;
+    k_ = (1.0 - alpha_) * k_ + alpha_ * rsv;
+    d_ = (1.0 - alpha_) * d_ + alpha_ * k_;
+    out[0] = k_;
+    out[1] = d_;
+    out[2] = j_smooth_ * k_ - (j_smooth_ - 1.0) * d_;
+  }
+
+  void preview(const OHLCV& bar, std::span<double> out) const override {
+    if (!high_.full_after_push()) {
+      out[0] = out[1] = out[2] = nan_value();
+      return;
+    }
+    const double highest_high = extreme_high(high_, bar.high);
+    const double lowest_low = extreme_low(low_, bar.low);
+    const double range = highest_high - lowest_low;
+    const double rsv = range == 0.0 ? 50.0 : 100.0 * (bar.close - lowest_low) / range;
+    const double k = (1.0 - alpha_) * k_ + alpha_ * rsv;
+    const double d = (1.0 - alpha_) * d_ + alpha_ * k;
+    out[0] = k;
+    out[1] = d;
+    out[2] = j_smooth_ * k - (j_smooth_ - 1.0) * d;
+  }
+
+  template <typename Self, typename Visitor>
+  static void visit(Self& self, Visitor& v) {
+    v(self.high_);
+    v(self.low_);
+    v(self.k_);
+    v(self.d_);
+  }
+
+ private:
+  Window high_;
+  Window low_;
+  double alpha_;
+  double j_smooth_;
+  double k_{50.0};
+  double d_{50.0};
+};
+
+class WillrStream final : public StreamingBase<WillrStream> {
+ public:
+  explicit WillrStream(const WillrParams& params)
+      : high_(static_cast<size_t>(params.period)), low_(static_cast<size_t>(params.period)) {}
+
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"willr"};
+    return kNames;
+  }
+
+  void update(const OHLCV& bar, std::span<double> out) override {
+    high_.push(bar.high);
+    low_.push(bar.low);
+    ++count_;
+    if (!high_.full()) {
+      out[0] = nan_value();
+      return;
+    }
+    const double highest_high = high_.max();
+    const double range = highest_high - low_.min();
+    out[0] = range == 0.0 ? 0.0 : -100.0 * (highest_high - bar.close) / range;
+  }
+
+  void preview(const OHLCV& bar, std::span<double> out) const override {
+    if (!high_.full_after_push()) {
+      out[0] = nan_value();
+      return;
+    }
+    const double highest_high = extreme_high(high_, bar.high);
+    const double range = highest_high - extreme_low(low_, bar.low);
+    out[0] = range == 0.0 ? 0.0 : -100.0 * (highest_high - bar.close) / range;
+  }
+
+  template <typename Self, typename Visitor>
+  static void visit(Self& self, Visitor& v) {
+    v(self.high_);
+    v(self.low_);
+  }
+
+ private:
+  Window high_;
+  Window low_;
+};
+
+class ObvStream final : public StreamingBase<ObvStream> {
+ public:
+  ObvStream() = default;
+
+  std::span<const char* const> output_names() const override {
+    static constexpr const char* kNames[] = {"obv"};
+    return kNames;
+  }
+
+  void update(const OHLCV& bar, std::span<double> out) override {
+    if (count_++ > 0) {
+      double signed_volume = 0.0;
+      if (bar.close > prev_close_) {
+        signed_volume = static_cast<double>(bar.volume);
+      } else if (bar.close < prev_close_) {
+        signed_volume = -static_cast<double>(bar.volume);
+      }
+      obv_ += signed_volume;
+    }
+    prev_close_ = bar.close;
+    out[0] = obv_;
+  }
+
+  template <typename Self, typename Visitor>
+  static void visit(Self& self, Visitor& v) {
+    v(self.prev_close_);
+    v(self.obv_);
+  }
+
+ private:
+  double prev_close_{0.0};
+  double obv_{0.0};
+};
+
+}  // namespace
+
+std::unique_ptr<StreamingIndicator> create_streaming_indicator(const std::string& name,
+                                                               const Params& params) {
+  const std::string key = normalize_indicator_name(name);
+  if (key == "SMA") {
+    return std::make_unique<SmaStream>(kSmaSchema.decode(params));
+  }
+  if (key == "EMA") {
+    return std::make_unique<EmaStream>(kEmaSchema.decode(params));
+  }
+  if (key == "MACD") {
+    return std::make_unique<MacdStream>(kMacdSchema.decode(params));
+  }
+  if (key == "RSI") {
+    return std::make_unique<RsiStream>(kRsiSchema.decode(params));
+  }
+  if (key == "BOLL" || key == "BOLLINGER" || key == "BOLLINGERBANDS") {
+    return std::make_unique<BollStream>(kBollSchema.decode(params));
+  }
+  if (key == "ATR") {
+    return std::make_unique<AtrStream>(kAtrSchema.decode(params));
+  }
+  if (key == "ADX") {
+    return std::make_unique<AdxStream>(kAdxSchema.decode(params));
+  }
+  if (key == "CCI") {
+    return std::make_unique<CciStream>(kCciSchema.decode(params));
+  }
+  if (key == "KDJ" || key == "STOCHASTIC") {
+    return std::make_unique<KdjStream>(kKdjSchema.decode(params));
+  }
+  if (key == "WILLR" || key == "WILLIAMSR" || key == "WILLIAMS%R") {
+    return std::make_unique<WillrStream>(kWillrSchema.decode(params));
+  }
+  if (key == "OBV") {
+    return std::make_unique<ObvStream>();
+  }
+  return nullptr;
+}
+
+}  // namespace tg_indicators
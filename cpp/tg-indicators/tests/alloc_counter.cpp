@@ -0,0 +1,25 @@
+#include "alloc_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+thread_local bool count_allocations = false;
+thread_local std::size_t counted_allocations = 0;
+
+void* operator new(std::size_t size) {
+  if (count_allocations) {
+    ++counted_allocations;
+  }
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+
+// Counts global-heap allocations made on the current thread while enabled. The
+// replacement operator new/delete are defined in alloc_counter.cpp, out of sight of
+// the tests, so optimized builds do not trip -Wmismatched-new-delete.
+extern thread_local bool count_allocations;
+extern thread_local std::size_t counted_allocations;
@@ -1,9 +1,35 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <span>
+#include <sstream>
+#include <thread>
 #include <string>
+#include <system_error>
+#include <unistd.h>
 #include <vector>
 
 #include <gtest/gtest.h>
 
+#include "tg_indicators/adjustment.h"
+#include "tg_indicators/admission.h"
+#include "tg_indicators/arena.h"
+#include "tg_indicators/bar_history.h"
+#include "tg_indicators/batch_cli.h"
+#include "tg_indicators/c_api.h"
+#include "tg_indicators/capture.h"
+#include "tg_indicators/cancellation.h"
+#include "tg_indicators/correlation.h"
+#include "tg_indicators/cross_section.h"
+#include "tg_indicators/events.h"
+#include "tg_indicators/fixed_point.h"
 #include "tg_indicators/indicator_service.h"
 #include "tg_indicators/indicators/adx.h"
 #include "tg_indicators/indicators/atr.h"
@@ -12,10 +38,24 @@
 #include "tg_indicators/indicators/ema.h"
 #include "tg_indicators/indicators/macd.h"
 #include "tg_indicators/indicators/obv.h"
+#include "tg_indicators/indicators/registry.h"
 #include "tg_indicators/indicators/rsi.h"
 #include "tg_indicators/indicators/sma.h"
+#include "tg_indicators/indicators/specialize.h"
 #include "tg_indicators/indicators/stochastic.h"
 #include "tg_indicators/indicators/williams_r.h"
+#include "tg_indicators/linear_scan.h"
+#include "tg_indicators/parallel.h"
+#include "tg_indicators/parquet_reader.h"
+#include "tg_indicators/resample.h"
+#include "tg_indicators/screen.h"
+#include "tg_indicators/shm_transport.h"
+#include "tg_indicators/singleflight.h"
+#include "tg_indicators/stream_store.h"
+#include "tg_indicators/streaming.h"
+#include "tg_indicators/time_util.h"
+
+#include "alloc_counter.h"
 
 namespace {
 
@@ -60,6 +100,375 @@ void expect_nan(double value) {
   EXPECT_TRUE(std::isnan(value));
 }
 
+// Expects `actual` to match `expected` element for element, NaN where it is NaN:
+// exactly, or within `relative` of max(1, |expected|). Reports the first mismatch only.
+void expect_same_series(std::span<const double> actual, std::span<const double> expected,
+                        const std::string& label, double relative = 0.0) {
+  ASSERT_EQ(actual.size(), expected.size()) << label;
+  for (size_t i = 0; i < expected.size(); ++i) {
+    const bool same =
+        std::isnan(expected[i])
+            ? std::isnan(actual[i])
+            : std::abs(actual[i] - expected[i]) <= relative * std::max(1.0, std::abs(expected[i]));
+    if (!same) {
+      ADD_FAILURE() << label << "[" << i << "]: " << actual[i] << " vs " << expected[i];
+      return;
+    }
+  }
+}
+
+// The streaming kernels, at the parameters the streaming tests run them with.
+const std::vector<std::pair<std::string, Params>> kStreamingCases = {
+    {"SMA", {{"period", 5.0}}},    {"EMA", {{"period", 6.0}}}, {"MACD", {}},
+    {"RSI", {{"period", 6.0}}},    {"BOLL", {}},              {"ATR", {{"period", 5.0}}},
+    {"ADX", {{"period", 5.0}}},    {"CCI", {}},               {"KDJ", {}},
+    {"WILLR", {{"period", 10.0}}}, {"OBV", {}},
+};
+
+// One 2026-01-05 (Monday) session of close-labelled 1-minute bars in Asia/Shanghai,
+// led by a 09:25 opening-auction bar: 1 + 120 + 120 bars.
+std::vector<OHLCV> minute_session_bars() {
+  const int64_t midnight_utc8 = tg_indicators::parse_date_millis("2026-01-05") - 8 * 3'600'000;
+  std::vector<int> minutes{9 * 60 + 25};
+  for (int m = 9 * 60 + 31; m <= 11 * 60 + 30; ++m) {
+    minutes.push_back(m);
+  }
+  for (int m = 13 * 60 + 1; m <= 15 * 60; ++m) {
+    minutes.push_back(m);
+  }
+  std::vector<OHLCV> bars;
+  for (size_t i = 0; i < minutes.size(); ++i) {
+    const double close = 20.0 + static_cast<double>(i % 17) * 0.01 + static_cast<double>(i) * 0.001;
+    bars.push_back(OHLCV{midnight_utc8 + minutes[i] * 60'000LL, close - 0.005, close + 0.02,
+                         close - 0.02, close, 100 + static_cast<int64_t>(i), close * 100.0});
+  }
+  return bars;
+}
+
+std::filesystem::path make_temp_dir(const std::string& name) {
+  static int counter = 0;
+  const auto dir = std::filesystem::temp_directory_path() /
+                   ("tg_indicators_" + name + "_" + std::to_string(::getpid()) + "_" +
+                    std::to_string(counter++));
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  return dir;
+}
+
+// Minimal Parquet writer for fixtures: same schema as tg-persistence bar partitions,
+// PLAIN pages (optionally dictionary-encoded close), optional literal-only Snappy.
+class ParquetFixtureWriter {
+ public:
+  struct Options {
+    size_t rows_per_group{10};
+    bool dictionary_close{false};
+    bool snappy{false};
+  };
+  // Counts written in place of the true ones, for the validation tests.
+  struct Corruption {
+    std::optional<int64_t> group_rows;   // every row group's num_rows
+    std::optional<int64_t> page_values;  // every data page's num_values
+  };
+
+  static void write(const std::filesystem::path& path, const std::vector<OHLCV>& bars, Options options,
+                    Corruption corruption = {}) {
+    ParquetFixtureWriter writer(options);
+    writer.corruption_ = corruption;
+    writer.file_ = "PAR1";
+    for (size_t start = 0; start < bars.size(); start += options.rows_per_group) {
+      const size_t end = std::min(bars.size(), start + options.rows_per_group);
+      writer.write_row_group(std::vector<OHLCV>(bars.begin() + static_cast<long>(start),
+                                                bars.begin() + static_cast<long>(end)));
+    }
+    const std::string footer = writer.footer(bars.size());
+    writer.file_ += footer;
+    const uint32_t len = static_cast<uint32_t>(footer.size());
+    writer.file_.append(reinterpret_cast<const char*>(&len), 4);
+    writer.file_ += "PAR1";
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary) << writer.file_;
+  }
+
+ private:
+  enum Kind { kString, kInt64, kDecimal };
+  struct Column {
+    std::string name;
+    Kind kind;
+  };
+  struct Chunk {
+    int32_t type;
+    std::string name;
+    int64_t data_offset;
+    int64_t dict_offset;
+    int64_t size;
+    int64_t min;
+    int64_t max;
+    int32_t encoding;
+  };
+
+  explicit ParquetFixtureWriter(Options options) : options_(options) {}
+
+  static const std::vector<Column>& columns() {
+    static const std::vector<Column> cols = {
+        {"symbol", kString}, {"exchange", kString}, {"period", kString}, {"ts_ms", kInt64},
+        {"trading_date", kString}, {"open", kDecimal}, {"high", kDecimal}, {"low", kDecimal},
+        {"close", kDecimal}, {"volume", kInt64}, {"amount", kDecimal}};
+    return cols;
+  }
+
+  // Thrift compact encoding helpers.
+  struct Thrift {
+    std::string out;
+    std::vector<int16_t> stack;
+    int16_t last{0};
+    void byte(uint8_t b) { out.push_back(static_cast<char>(b)); }
+    void varint(uint64_t v) {
+      while (v >= 0x80) {
+        byte(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+      }
+      byte(static_cast<uint8_t>(v));
+    }
+    static uint64_t zz(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+    void field(int16_t id, uint8_t type) {
+      const int delta = id - last;
+      if (delta > 0 && delta <= 15) {
+        byte(static_cast<uint8_t>((delta << 4) | type));
+      } else {
+        byte(type);
+        varint(zz(id));
+      }
+      last = id;
+    }
+    void i32(int16_t id, int64_t v) {
+      field(id, 5);
+      varint(zz(v));
+    }
+    void i64(int16_t id, int64_t v) {
+      field(id, 6);
+      varint(zz(v));
+    }
+    void binary(int16_t id, const std::string& v) {
+      field(id, 8);
+      varint(v.size());
+      out += v;
+    }
+    void list(int16_t id, uint8_t elem, size_t size) {
+      field(id, 9);
+      if (size < 15) {
+        byte(static_cast<uint8_t>((size << 4) | elem));
+      } else {
+        byte(static_cast<uint8_t>(0xf0 | elem));
+        varint(size);
+      }
+    }
+    void begin(int16_t id) {
+      if (id != 0) {
+        field(id, 12);
+      }
+      stack.push_back(last);
+      last = 0;
+    }
+    void end() {
+      byte(0);
+      last = stack.back();
+      stack.pop_back();
+    }
+  };
+
+  std::string compress(const std::string& raw) const {
+    if (!options_.snappy) {
+      return raw;
+    }
+    Thrift t;
+    t.varint(raw.size());
+    for (size_t pos = 0; pos < raw.size(); pos += 60) {
+      const size_t len = std::min<size_t>(60, raw.size() - pos);
+      t.byte(static_cast<uint8_t>((len - 1) << 2));
+      t.out += raw.substr(pos, len);
+    }
+    return t.out;
+  }
+
+  void write_page(int32_t type, int32_t encoding, size_t num_values, const std::string& raw) {
+    const std::string body = compress(raw);
+    Thrift h;
+    h.begin(0);
+    h.i32(1, type);
+    h.i32(2, static_cast<int64_t>(raw.size()));
+    h.i32(3, static_cast<int64_t>(body.size()));
+    h.begin(type == 2 ? 7 : 5);
+    h.i32(1, type == 0 ? corruption_.page_values.value_or(static_cast<int64_t>(num_values))
+                       : static_cast<int64_t>(num_values));
+    h.i32(2, encoding);
+    if (type == 0) {
+      h.i32(3, 3);
+      h.i32(4, 3);
+    }
+    h.end();
+    h.end();
+    file_ += h.out;
+    file_ += body;
+  }
+
+  static std::string le64(int64_t v) {
+    return std::string(reinterpret_cast<const char*>(&v), 8);
+  }
+
+  void write_row_group(const std::vector<OHLCV>& rows) {
+    std::vector<Chunk> chunks;
+    for (const auto& column : columns()) {
+      std::vector<int64_t> ints;
+      std::string plain;
+      for (const auto& bar : rows) {
+        if (column.kind == kString) {
+          const std::string value = column.name == "symbol" ? "600519" : column.name == "exchange" ? "SH" : column.name == "period" ? "daily" : "2026-01-01";
+          const uint32_t len = static_cast<uint32_t>(value.size());
+          plain.append(reinterpret_cast<const char*>(&len), 4);
+          plain += value;
+          continue;
+        }
+        int64_t v = 0;
+        if (column.name == "ts_ms") {
+          v = bar.ts_millis;
+        } else if (column.name == "volume") {
+          v = bar.volume;
+        } else if (column.name == "open") {
+          v = std::llround(bar.open * 10000.0);
+        } else if (column.name == "high") {
+          v = std::llround(bar.high * 10000.0);
+        } else if (column.name == "low") {
+          v = std::llround(bar.low * 10000.0);
+        } else if (column.name == "close") {
+          v = std::llround(bar.close * 10000.0);
+        } else if (column.name == "amount") {
+          v = std::llround(bar.amount * 10000.0);
+        }
+        ints.push_back(v);
+        plain += le64(v);
+      }
+      Chunk chunk{column.kind == kString ? 6 : 2, column.name, 0, -1, 0, 0, 0, 0};
+      const int64_t start = static_cast<int64_t>(file_.size());
+      if (column.name == "close" && options_.dictionary_close) {
+        std::vector<int64_t> dict;
+        std::vector<uint32_t> indices;
+        for (int64_t v : ints) {
+          auto it = std::find(dict.begin(), dict.end(), v);
+          if (it == dict.end()) {
+            dict.push_back(v);
+            it = dict.end() - 1;
+          }
+          indices.push_back(static_cast<uint32_t>(it - dict.begin()));
+        }
+        std::string dict_plain;
+        for (int64_t v : dict) {
+          dict_plain += le64(v);
+        }
+        chunk.dict_offset = start;
+        write_page(2, 0, dict.size(), dict_plain);
+        int width = 1;
+        while ((size_t{1} << width) < dict.size()) {
+          ++width;
+        }
+        const size_t groups = (indices.size() + 7) / 8;
+        std::string data(1, static_cast<char>(width));
+        Thrift run;
+        run.varint((groups << 1) | 1);
+        data += run.out;
+        std::string packed(groups * static_cast<size_t>(width), '\0');
+        for (size_t i = 0; i < indices.size(); ++i) {
+          for (int b = 0; b < width; ++b) {
+            if ((indices[i] >> b) & 1U) {
+              const size_t bit = i * static_cast<size_t>(width) + static_cast<size_t>(b);
+              packed[bit / 8] = static_cast<char>(packed[bit / 8] | (1 << (bit % 8)));
+            }
+          }
+        }
+        data += packed;
+        chunk.data_offset = static_cast<int64_t>(file_.size());
+        chunk.encoding = 8;
+        write_page(0, 8, indices.size(), data);
+      } else {
+        chunk.data_offset = start;
+        write_page(0, 0, rows.size(), plain);
+      }
+      chunk.size = static_cast<int64_t>(file_.size()) - start;
+      if (!ints.empty()) {
+        chunk.min = *std::min_element(ints.begin(), ints.end());
+        chunk.max = *std::max_element(ints.begin(), ints.end());
+      }
+      chunks.push_back(chunk);
+    }
+    groups_.push_back({static_cast<int64_t>(rows.size()), chunks});
+  }
+
+  std::string footer(size_t total_rows) const {
+    Thrift t;
+    t.begin(0);
+    t.i32(1, 1);
+    t.list(2, 12, columns().size() + 1);
+    t.begin(0);
+    t.binary(4, "arrow_schema");
+    t.i32(5, static_cast<int64_t>(columns().size()));
+    t.end();
+    for (const auto& column : columns()) {
+      t.begin(0);
+      t.i32(1, column.kind == kString ? 6 : 2);
+      t.i32(3, 0);
+      t.binary(4, column.name);
+      if (column.kind == kDecimal) {
+        t.i32(6, 5);
+        t.i32(7, 4);
+        t.i32(8, 18);
+      }
+      t.end();
+    }
+    t.i64(3, static_cast<int64_t>(total_rows));
+    t.list(4, 12, groups_.size());
+    for (const auto& group : groups_) {
+      t.begin(0);
+      t.list(1, 12, group.second.size());
+      for (const auto& chunk : group.second) {
+        t.begin(0);
+        t.i64(2, chunk.data_offset);
+        t.begin(3);
+        t.i32(1, chunk.type);
+        t.list(2, 5, 1);
+        t.varint(Thrift::zz(chunk.encoding));
+        t.list(3, 8, 1);
+        t.varint(chunk.name.size());
+        t.out += chunk.name;
+        t.i32(4, options_.snappy ? 1 : 0);
+        t.i64(5, group.first);
+        t.i64(6, chunk.size);
+        t.i64(7, chunk.size);
+        t.i64(9, chunk.data_offset);
+        if (chunk.dict_offset >= 0) {
+          t.i64(11, chunk.dict_offset);
+        }
+        if (chunk.type == 2) {
+          t.begin(12);
+          t.binary(5, le64(chunk.max));
+          t.binary(6, le64(chunk.min));
+          t.end();
+        }
+        t.end();
+        t.end();
+      }
+      t.i64(2, 0);
+      t.i64(3, corruption_.group_rows.value_or(group.first));
+      t.end();
+    }
+    t.end();
+    return t.out;
+  }
+
+  Options options_;
+  Corruption corruption_;
+  std::string file_;
+  std::vector<std::pair<int64_t, std::vector<Chunk>>> groups_;
+};
+
 }  // namespace
 
 TEST(SmaIndicatorTest, ComputesAlignedSeries) {
@@ -158,6 +567,953 @@ TEST(ObvIndicatorTest, AccumulatesSignedVolume) {
   EXPECT_NEAR(obv[3], 306.0, 1e-12);
 }
 
+TEST(PackIndicatorTest, MatchesEachMemberInOnePass) {
+  auto bars = increasing_bars(400);
+  for (size_t i = 0; i < bars.size(); ++i) {
+    const double wave = 5.0 * std::sin(static_cast<double>(i) * 0.2);
+    bars[i].close += wave;
+    bars[i].high += wave + static_cast<double>(i % 3);
+    bars[i].low += wave - static_cast<double>(i % 5);
+  }
+  const auto pack = tg_indicators::create_indicator("PACK");
+  const auto result = pack->compute(bars, {});
+  ASSERT_EQ(result.size(), pack->output_names().size());
+  size_t compared = 0;
+  for (const char* name : {"SMA", "EMA", "MACD", "RSI", "BOLL", "ATR", "ADX", "CCI", "KDJ", "WILLR", "OBV"}) {
+    const auto member = tg_indicators::create_indicator(name)->compute(bars, {});
+    for (const auto& [output, expected] : member) {
+      expect_same_series(result.at(output), expected, std::string(output), 1e-9);
+      ++compared;
+    }
+  }
+  EXPECT_EQ(compared, result.size());
+  EXPECT_EQ(pack->min_bars({}), 34u);
+  bars.resize(33);
+  EXPECT_THROW(pack->compute(bars, {}), std::invalid_argument);
+}
+
+TEST(SpecializedKernelTest, HotParameterSetsMatchGenericKernelsExactly) {
+  auto bars = increasing_bars(300);
+  for (size_t i = 0; i < bars.size(); ++i) {
+    const double wave = 4.0 * std::sin(static_cast<double>(i) * 0.37);
+    bars[i].close += wave;
+    bars[i].high += wave + static_cast<double>(i % 4);
+    bars[i].low += wave - static_cast<double>(i % 3);
+  }
+  const std::vector<std::pair<const char*, Params>> hot{
+      {"RSI", {{"period", 6.0}}}, {"RSI", {{"period", 9.0}}}, {"RSI", {}}, {"RSI", {{"period", 24.0}}},
+      {"MACD", {}},               {"MACD", {{"fast", 5.0}, {"slow", 35.0}, {"signal", 5.0}}},
+      {"BOLL", {}}};
+  for (const auto& [name, params] : hot) {
+    const auto indicator = tg_indicators::create_indicator(name);
+    const auto specialized = indicator->compute(bars, params);
+    tg_indicators::set_specialized_kernels(false);
+    const auto generic = indicator->compute(bars, params);
+    tg_indicators::set_specialized_kernels(true);
+    for (const auto& [output, expected] : generic) {
+      expect_same_series(specialized.at(output), expected, std::string(name) + "." + std::string(output));
+    }
+  }
+}
+
+TEST(FixedPointTest, ParsesDecimalStringsExactly) {
+  using tg_indicators::parse_fixed_price;
+  EXPECT_EQ(parse_fixed_price("12.34", "close"), 123'400);
+  EXPECT_EQ(parse_fixed_price("0.1", "close"), 1'000);
+  EXPECT_EQ(parse_fixed_price("7", "close"), 70'000);
+  EXPECT_EQ(parse_fixed_price("-0.0005", "close"), -5);
+  EXPECT_EQ(parse_fixed_price("+3.", "close"), 30'000);
+  EXPECT_EQ(parse_fixed_price(".25", "close"), 2'500);
+  EXPECT_EQ(parse_fixed_price("10.123450", "close"), 101'235);
+  EXPECT_EQ(parse_fixed_price("10.123449", "close"), 101'234);
+  // 0.1 + 0.2 is exact in fixed point.
+  EXPECT_EQ(parse_fixed_price("0.1", "a") + parse_fixed_price("0.2", "b"), parse_fixed_price("0.3", "c"));
+  for (const char* bad : {"", "-", ".", "1e3", "1.2.3", "abc", " 1", "99999999999999999"}) {
+    EXPECT_THROW(parse_fixed_price(bad, "close"), std::invalid_argument) << bad;
+  }
+}
+
+TEST(FixedPointTest, IntegerKernelsMatchDoubleKernels) {
+  google::protobuf::RepeatedPtrField<tg::v1::Bar> proto_bars;
+  for (const auto& bar : minute_session_bars()) {
+    *proto_bars.Add() = make_proto_bar(bar);
+  }
+  const auto fixed = tg_indicators::decode_fixed_bars(proto_bars);
+  const auto bars = tg_indicators::decode_bars(proto_bars);
+  ASSERT_EQ(fixed.size(), bars.size());
+  size_t checked = 0;
+  for (const char* name : {"SMA", "ATR", "ADX", "OBV", "KDJ", "WILLR", "EMA"}) {
+    const auto indicator = tg_indicators::create_indicator(name);
+    if (!indicator->has_fixed_point_kernel()) {
+      EXPECT_THROW(indicator->compute_fixed(fixed, {}), std::logic_error) << name;
+      continue;
+    }
+    const auto expected = indicator->compute(bars, {});
+    const auto actual = indicator->compute_fixed(fixed, {});
+    ASSERT_EQ(actual.size(), expected.size()) << name;
+    for (const auto& [series, values] : expected) {
+      const auto& fixed_values = actual.at(series);
+      ASSERT_EQ(fixed_values.size(), values.size()) << name << "." << series;
+      for (size_t i = 0; i < values.size(); ++i) {
+        if (std::isnan(values[i])) {
+          expect_nan(fixed_values[i]);
+        } else {
+          EXPECT_NEAR(fixed_values[i], values[i], 1e-8 * std::max(1.0, std::abs(values[i])))
+              << name << "." << series << "[" << i << "]";
+        }
+      }
+    }
+    ++checked;
+  }
+  EXPECT_EQ(checked, 6u);
+}
+
+TEST(EventsTest, FindsCrossingsRangeTransitionsAndNewExtremes) {
+  using tg_indicators::PredicateKind;
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const tg_indicators::SeriesMap series{
+      {"fast", {nan, 1.0, 3.0, 2.0, 2.0, 4.0, 1.0}},
+      {"slow", {nan, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0}},
+  };
+  std::vector<tg_indicators::SeriesPredicate> predicates(5);
+  predicates[0] = {"golden", PredicateKind::kCrossAbove, "fast", "slow"};
+  predicates[1] = {"dead", PredicateKind::kCrossBelow, "fast", "", 1.5};
+  predicates[2] = {"enter", PredicateKind::kEnterRange, "fast", "", 0.0, 1.5, 2.5};
+  predicates[3] = {"exit", PredicateKind::kExitRange, "fast", "", 0.0, 1.5, 2.5};
+  predicates[4] = {"high", PredicateKind::kNewHigh, "fast", "", 0.0, 0.0, 0.0, 2};
+
+  const auto events = tg_indicators::extract_events(predicates, series);
+  std::vector<std::pair<std::string, size_t>> fired;
+  for (const auto& event : events) {
+    fired.emplace_back(predicates[event.predicate].id, event.bar);
+  }
+  // Bar 1 follows a NaN, so nothing fires there; 1.0 -> 3.0 jumps over the range and
+  // 2.0 -> 2.0 does not cross 2.0.
+  const std::vector<std::pair<std::string, size_t>> expected{
+      {"golden", 2}, {"enter", 3}, {"golden", 5}, {"exit", 5}, {"high", 5}, {"dead", 6},
+  };
+  EXPECT_EQ(fired, expected);
+  EXPECT_EQ(events[3].reference, 2.5);  // upper bound left through
+  EXPECT_EQ(events[4].reference, 2.0);  // previous 2-bar high
+
+  // first_bar keeps earlier bars as context only.
+  const auto live = tg_indicators::extract_events(predicates, series, 6);
+  ASSERT_EQ(live.size(), 1u);
+  EXPECT_EQ(live[0].bar, 6u);
+  EXPECT_EQ(live[0].value, 1.0);
+
+  predicates[0].reference = "missing";
+  EXPECT_THROW(tg_indicators::extract_events(predicates, series), std::invalid_argument);
+}
+
+TEST(SeededStateTest, ContinuesRecurrencesWithoutWarmupBars) {
+  const auto bars = minute_session_bars();
+  const size_t split = 150;
+  const std::vector<OHLCV> head(bars.begin(), bars.begin() + split);
+  const std::vector<OHLCV> tail(bars.begin() + split, bars.end());
+  for (const char* name : {"EMA", "RSI", "MACD", "ATR"}) {
+    const auto indicator = tg_indicators::create_indicator(name);
+    const auto full = indicator->compute(bars, {});
+    Params state;
+    const auto first = indicator->compute_seeded(head, {}, {}, &state);
+    EXPECT_EQ(state.size(), indicator->state_names().size()) << name;
+    const auto rest = indicator->compute_seeded(tail, {}, state, nullptr);
+    for (const auto& [series, values] : full) {
+      for (size_t i = 0; i < tail.size(); ++i) {
+        EXPECT_NEAR(rest.at(series)[i], values[split + i], 1e-9)
+            << name << "." << series << "[" << i << "]";
+      }
+      for (size_t i = 0; i < split; ++i) {
+        if (!std::isnan(values[i])) {
+          EXPECT_EQ(first.at(series)[i], values[i]) << name << "." << series;
+        }
+      }
+    }
+  }
+  const auto rsi = tg_indicators::create_indicator("RSI");
+  EXPECT_THROW(rsi->compute_seeded(tail, {}, {{"avg_gain", 1.0}}, nullptr), std::invalid_argument);
+  EXPECT_THROW(tg_indicators::create_indicator("KDJ")->compute_seeded(tail, {}, {}, nullptr),
+               std::invalid_argument);
+}
+
+TEST(MaskedComputeTest, SkipsInvalidBarsInPlace) {
+  auto bars = minute_session_bars();
+  tg_indicators::BarMask valid(bars.size(), 1);
+  std::vector<OHLCV> traded;
+  for (size_t i = 0; i < bars.size(); ++i) {
+    // A halt from bar 60 to 89 plus scattered gaps; their prices are garbage.
+    if ((i >= 60 && i < 90) || i % 23 == 7) {
+      valid[i] = 0;
+      bars[i].high = bars[i].low = bars[i].close = -1.0;
+    } else {
+      traded.push_back(bars[i]);
+    }
+  }
+  for (const char* name : {"SMA", "EMA", "MACD", "RSI", "BOLL", "ATR", "ADX", "CCI", "KDJ", "WILLR", "OBV"}) {
+    const auto indicator = tg_indicators::create_indicator(name);
+    const auto compact = indicator->compute(traded, {});
+    const auto masked = indicator->compute_masked(bars, valid, {});
+    for (const auto& [series, values] : compact) {
+      const auto& aligned = masked.at(series);
+      ASSERT_EQ(aligned.size(), bars.size()) << name;
+      size_t j = 0;
+      for (size_t i = 0; i < bars.size(); ++i) {
+        if (!valid[i]) {
+          expect_nan(aligned[i]);
+        } else if (std::isnan(values[j])) {
+          expect_nan(aligned[i]);
+          ++j;
+        } else {
+          EXPECT_EQ(aligned[i], values[j++]) << name << "." << series << "[" << i << "]";
+        }
+      }
+    }
+  }
+}
+
+TEST(ArenaTest, SteadyStateComputeMakesNoHeapAllocations) {
+  auto bars = increasing_bars(3000);
+  for (size_t i = 0; i < bars.size(); ++i) {
+    bars[i].close += std::sin(static_cast<double>(i) * 0.3);
+  }
+  const Params params;
+  for (const char* name : {"SMA", "EMA", "MACD", "RSI", "BOLL", "ATR", "ADX", "CCI", "KDJ", "WILLR", "OBV",
+                           "PACK"}) {
+    const auto indicator = tg_indicators::create_indicator(name);
+    {
+      // The first request sizes this thread's arena.
+      const tg_indicators::ArenaScope scope;
+      indicator->compute(bars, params);
+    }
+    const tg_indicators::ArenaScope scope;
+    counted_allocations = 0;
+    count_allocations = true;
+    const auto series = indicator->compute(bars, params);
+    count_allocations = false;
+    EXPECT_EQ(counted_allocations, 0U) << name;
+    EXPECT_EQ(series.size(), indicator->output_names().size()) << name;
+    EXPECT_EQ(series.begin()->second.size(), bars.size()) << name;
+  }
+  EXPECT_GT(tg_indicators::arena_capacity(), 0U);
+
+  // Outside a scope kernels use the heap, so results can outlive the call.
+  counted_allocations = 0;
+  count_allocations = true;
+  const auto series = tg_indicators::create_indicator("MACD")->compute(bars, params);
+  count_allocations = false;
+  EXPECT_GT(counted_allocations, 0U);
+  EXPECT_EQ(series.at("dif").get_allocator().resource(), std::pmr::get_default_resource());
+}
+
+TEST(LinearScanTest, ParallelScanMatchesSequentialRecurrence) {
+  const size_t count = tg_indicators::kParallelScanThreshold + 12'345;
+  std::vector<double> x(count);
+  for (size_t i = 0; i < count; ++i) {
+    x[i] = 50.0 + 10.0 * std::sin(static_cast<double>(i) * 0.001) + static_cast<double>(i % 7);
+  }
+  const std::pair<double, double> coefficients[] = {
+      {1.0 - 2.0 / 13.0, 2.0 / 13.0},  // EMA(12)
+      {13.0 / 14.0, 1.0 / 14.0},       // Wilder(14)
+      {1.0, 1.0},                      // running sum (OBV)
+  };
+  for (const auto& [a, b] : coefficients) {
+    std::vector<double> sequential(count);
+    std::vector<double> parallel(count);
+    tg_indicators::linear_recurrence(x.data(), sequential.data(), count, a, b, 42.0, 1);
+    tg_indicators::linear_recurrence(x.data(), parallel.data(), count, a, b, 42.0, 4);
+    const double scale = std::abs(sequential.back()) + 1.0;
+    for (size_t i = 0; i < count; i += 997) {
+      ASSERT_NEAR(parallel[i], sequential[i], scale * 1e-10) << a << " " << i;
+    }
+    EXPECT_NEAR(parallel.back(), sequential.back(), scale * 1e-10);
+  }
+}
+
+TEST(CancellationTest, ExpiredDeadlineStopsKernelsAndParallelWorkers) {
+  const tg_indicators::CancellationContext expired(tg_indicators::CancellationContext::Clock::now() -
+                                                   std::chrono::milliseconds(1));
+  const tg_indicators::CancellationScope scope(&expired);
+  std::vector<double> values(10'000, 1.0);
+  EXPECT_THROW(tg_indicators::compute_ema(values, 5), tg_indicators::ComputeCancelled);
+
+  bool client_gone = false;
+  const tg_indicators::CancellationContext disconnect(
+      tg_indicators::CancellationContext::Clock::time_point::max(), [&] { return client_gone; });
+  const tg_indicators::CancellationScope inner(&disconnect);
+  std::atomic<size_t> ran{0};
+  tg_indicators::parallel_for(4, 2, [&](size_t) { ++ran; });
+  EXPECT_EQ(ran.load(), 4U);
+  client_gone = true;
+  try {
+    tg_indicators::parallel_for(4, 2, [&](size_t) { ++ran; });
+    FAIL() << "expected cancellation";
+  } catch (const tg_indicators::ComputeCancelled& e) {
+    EXPECT_FALSE(e.deadline_exceeded());
+  }
+  EXPECT_EQ(ran.load(), 4U);
+}
+
+TEST(AdmissionTest, ShedsLowPriorityFirstAndRejectsHopelessDeadlines) {
+  using tg_indicators::AdmissionController;
+  tg_indicators::AdmissionOptions options;
+  options.shed_low_priority_above = 1;
+  options.max_in_flight = 2;
+  options.initial_ns_per_unit = 1000.0;
+  AdmissionController admission(options);
+  const auto none = AdmissionController::Clock::time_point::max();
+
+  AdmissionController::Ticket first;
+  EXPECT_EQ(admission.admit(10, tg_indicators::RequestPriority::kLow, none, &first),
+            AdmissionController::Decision::kAdmit);
+  AdmissionController::Ticket rejected;
+  EXPECT_EQ(admission.admit(10, tg_indicators::RequestPriority::kLow, none, &rejected),
+            AdmissionController::Decision::kShed);
+  AdmissionController::Ticket second;
+  EXPECT_EQ(admission.admit(10, tg_indicators::RequestPriority::kNormal, none, &second),
+            AdmissionController::Decision::kAdmit);
+  EXPECT_EQ(admission.admit(10, tg_indicators::RequestPriority::kNormal, none, &rejected),
+            AdmissionController::Decision::kShed);
+  EXPECT_EQ(admission.in_flight(), 2U);
+  first = AdmissionController::Ticket();
+  EXPECT_EQ(admission.in_flight(), 1U);
+
+  // 1M units at 1us each cannot fit a 10ms budget.
+  const auto soon = AdmissionController::Clock::now() + std::chrono::milliseconds(10);
+  AdmissionController::Ticket slow;
+  EXPECT_EQ(admission.admit(1'000'000, tg_indicators::RequestPriority::kNormal, soon, &slow),
+            AdmissionController::Decision::kDeadlineTooShort);
+  EXPECT_EQ(admission.shed(), 2U);
+  EXPECT_EQ(admission.rejected_deadline(), 1U);
+
+  // Completed requests pull the estimate toward observed cost.
+  second.complete();
+  EXPECT_LT(admission.ns_per_unit(), 1000.0 + 1e-9);
+  AdmissionController::Ticket large;
+  ASSERT_EQ(admission.admit(1'000'000, tg_indicators::RequestPriority::kNormal, none, &large),
+            AdmissionController::Decision::kAdmit);
+  large.complete();
+  EXPECT_LT(admission.ns_per_unit(), 1000.0);
+}
+
+TEST(SingleflightTest, ConcurrentIdenticalCallsShareOneComputation) {
+  tg_indicators::Singleflight<tg::v1::IndicatorResult> flight;
+  std::atomic<bool> release{false};
+  std::atomic<int> runs{0};
+  auto compute = [&](tg::v1::IndicatorResult* out) {
+    ++runs;
+    while (!release.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    out->set_indicator("SMA");
+    out->add_ts_epoch_millis(7);
+    return grpc::Status::OK;
+  };
+
+  std::vector<tg::v1::IndicatorResult> results(4);
+  std::vector<std::thread> callers;
+  callers.emplace_back([&] { EXPECT_TRUE(flight.run("k", &results[0], compute).ok()); });
+  while (runs.load() == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  for (size_t i = 1; i < results.size(); ++i) {
+    callers.emplace_back([&, i] { EXPECT_TRUE(flight.run("k", &results[i], compute).ok()); });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  release.store(true);
+  for (auto& caller : callers) {
+    caller.join();
+  }
+  EXPECT_EQ(runs.load(), 1);
+  EXPECT_EQ(flight.executions(), 1U);
+  EXPECT_EQ(flight.coalesced(), 3U);
+  for (const auto& result : results) {
+    EXPECT_EQ(result.indicator(), "SMA");
+    ASSERT_EQ(result.ts_epoch_millis_size(), 1);
+  }
+
+  // Finished calls are not cached.
+  tg::v1::IndicatorResult again;
+  EXPECT_TRUE(flight.run("k", &again, compute).ok());
+  EXPECT_EQ(flight.executions(), 2U);
+}
+
+TEST(SingleflightTest, FollowersRetryWhenLeaderIsCancelled) {
+  tg_indicators::Singleflight<tg::v1::IndicatorResult> flight;
+  std::atomic<bool> release{false};
+  std::atomic<int> runs{0};
+  tg::v1::IndicatorResult leader_result;
+  std::thread leader([&] {
+    const auto status = flight.run("k", &leader_result, [&](tg::v1::IndicatorResult*) {
+      ++runs;
+      while (!release.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      return grpc::Status(grpc::StatusCode::CANCELLED, "client went away");
+    });
+    EXPECT_EQ(status.error_code(), grpc::StatusCode::CANCELLED);
+  });
+  while (runs.load() == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  tg::v1::IndicatorResult follower_result;
+  std::thread follower([&] {
+    const auto status = flight.run("k", &follower_result, [&](tg::v1::IndicatorResult* out) {
+      ++runs;
+      out->set_indicator("RSI");
+      return grpc::Status::OK;
+    });
+    EXPECT_TRUE(status.ok());
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  release.store(true);
+  leader.join();
+  follower.join();
+  EXPECT_EQ(runs.load(), 2);
+  EXPECT_EQ(follower_result.indicator(), "RSI");
+}
+
+TEST(CApiTest, ComputesIntoCallerBuffersAndReportsErrors) {
+  EXPECT_EQ(tg_abi_version(), static_cast<uint32_t>(TG_ABI_VERSION));
+  const auto bars = increasing_bars(12);
+  std::vector<double> close;
+  for (const auto& bar : bars) {
+    close.push_back(bar.close);
+  }
+  const auto expected = tg_indicators::create_indicator("RSI")->compute(bars, {{"period", 6.0}});
+
+  tg_bars columns{};
+  columns.close = close.data();
+  columns.length = close.size();
+  const tg_param params[] = {{"period", 6.0}};
+  std::vector<double> rsi(close.size(), -1.0);
+  tg_output output{"rsi", rsi.data(), rsi.size()};
+  ASSERT_EQ(tg_compute("rsi", &columns, params, 1, &output, 1), TG_OK) << tg_last_error();
+  EXPECT_STREQ(tg_last_error(), "");
+  for (size_t i = 0; i < rsi.size(); ++i) {
+    const double want = expected.at("rsi")[i];
+    EXPECT_TRUE(std::isnan(want) ? std::isnan(rsi[i]) : rsi[i] == want) << i;
+  }
+
+  const char* names[4] = {};
+  size_t count = 0;
+  ASSERT_EQ(tg_output_names("KDJ", names, 4, &count), TG_OK);
+  ASSERT_EQ(count, 3U);
+  EXPECT_STREQ(names[2], "j");
+
+  tg_output missing{"upper", rsi.data(), rsi.size()};
+  EXPECT_EQ(tg_compute("RSI", &columns, params, 1, &missing, 1), TG_NOT_FOUND);
+  tg_output short_buffer{"rsi", rsi.data(), 3};
+  EXPECT_EQ(tg_compute("RSI", &columns, params, 1, &short_buffer, 1), TG_OUT_OF_RANGE);
+  const tg_param bad_period[] = {{"period", 0.0}};
+  EXPECT_EQ(tg_compute("RSI", &columns, bad_period, 1, &output, 1), TG_INVALID_ARGUMENT);
+  EXPECT_NE(std::string(tg_last_error()), "");
+  EXPECT_EQ(tg_compute("NOPE", &columns, nullptr, 0, nullptr, 0), TG_NOT_FOUND);
+}
+
+TEST(ShmTransportTest, RoundTripsIndicatorThroughSharedMemory) {
+  const std::string name = "tg_indicators_test_" + std::to_string(getpid());
+  tg_indicators::IndicatorServiceImpl service;
+  tg_indicators::ShmIndicatorServer server(service, name, 2, 64, 2);
+  tg_indicators::ShmIndicatorClient client(name);
+  const auto bars = increasing_bars(40);
+  const auto expected = tg_indicators::create_indicator("MACD")->compute(bars, {});
+
+  for (int round = 0; round < 3; ++round) {
+    auto call = client.begin("MACD", {}, bars.size());
+    auto& columns = call.columns();
+    for (size_t i = 0; i < bars.size(); ++i) {
+      columns.ts_millis[i] = bars[i].ts_millis;
+      columns.open[i] = bars[i].open;
+      columns.high[i] = bars[i].high;
+      columns.low[i] = bars[i].low;
+      columns.close[i] = bars[i].close;
+      columns.volume[i] = bars[i].volume;
+      columns.amount[i] = bars[i].amount;
+    }
+    ASSERT_EQ(call.submit(), 0) << call.error_message();
+    EXPECT_EQ(call.series_names(), (std::vector<std::string>{"dea", "dif", "hist"}));
+    for (const auto& [series_name, values] : expected) {
+      const auto got = call.series(series_name);
+      ASSERT_EQ(got.size(), values.size());
+      for (size_t i = 0; i < values.size(); ++i) {
+        if (std::isnan(values[i])) {
+          EXPECT_TRUE(std::isnan(got[i]));
+        } else {
+          EXPECT_DOUBLE_EQ(got[i], values[i]);
+        }
+      }
+    }
+  }
+
+  // Each call went through the service's admission control.
+  EXPECT_EQ(service.admission().admitted(), 3U);
+
+  auto unknown = client.begin("NOPE", {{"period", 3.0}}, 1);
+  EXPECT_EQ(unknown.submit(), 5);
+  EXPECT_NE(unknown.error_message().find("NOPE"), std::string::npos);
+  EXPECT_THROW(client.begin("SMA", {}, 65), std::invalid_argument);
+}
+
+TEST(ShmTransportTest, RejectsMalformedRequestsWithoutLosingSlots) {
+  const std::string name = "tg_indicators_test_bad_" + std::to_string(getpid());
+  tg_indicators::IndicatorServiceImpl service;
+  tg_indicators::ShmIndicatorServer server(service, name, 2, 64, 1);
+  tg_indicators::ShmIndicatorClient client(name);
+
+  // Over-long names are rejected before a slot is claimed, so both slots stay usable.
+  const std::string long_name(tg_indicators::kShmIndicatorBytes, 'X');
+  const std::string long_key(tg_indicators::kShmNameBytes, 'k');
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_THROW(client.begin(long_name, {}, 1), std::invalid_argument);
+    EXPECT_THROW(client.begin("SMA", {{long_key, 3.0}}, 1), std::invalid_argument);
+  }
+
+  // A header claiming more bars than the slot holds is refused, not read past the slot.
+  auto call = client.begin("SMA", {{"period", 3.0}}, 8);
+  const auto raw = tg_indicators::ShmSegment::open(name);
+  for (uint32_t i = 0; i < raw.header().slot_count; ++i) {
+    auto& slot = raw.slot(i);
+    if (slot.state.load() == static_cast<uint32_t>(tg_indicators::ShmSlotState::kClaimed)) {
+      slot.bar_count = 1'000'000;
+    }
+  }
+  EXPECT_EQ(call.submit(), 3);
+  EXPECT_NE(call.error_message().find("1000000"), std::string::npos) << call.error_message();
+
+  // An indicator whose outputs cannot fit in the slot is refused up front.
+  auto pack = client.begin("PACK", {}, 64);
+  EXPECT_EQ(pack.submit(), 3);
+  EXPECT_EQ(pack.series_names(), std::vector<std::string>{});
+}
+
+TEST(ShmTransportTest, GivesUpAtDeadlinesWithoutLeakingSlots) {
+  using tg_indicators::ShmSlotState;
+  const std::string name = "tg_indicators_test_idle_" + std::to_string(getpid());
+  // A bare segment: no server answers, so every call has to give up on its own.
+  auto segment = tg_indicators::ShmSegment::create(name, 1, 8);
+  try {
+    tg_indicators::ShmSegment::create(name, 1, 8);
+    ADD_FAILURE() << "an existing segment was replaced";
+  } catch (const std::system_error& e) {
+    EXPECT_EQ(e.code().value(), EEXIST);
+  }
+  tg_indicators::ShmIndicatorClient client(name);
+  auto& state = segment.slot(0).state;
+  const Params params{{"period", 3.0}};
+
+  {
+    auto call = client.begin("SMA", params, 4);
+    EXPECT_EQ(call.submit(), 14);  // UNAVAILABLE: nothing is serving
+  }
+  EXPECT_EQ(state.load(), static_cast<uint32_t>(ShmSlotState::kFree));
+
+  segment.header().serving.store(1);
+  {
+    auto call = client.begin("SMA", params, 4);
+    EXPECT_EQ(call.submit(std::chrono::steady_clock::now() + std::chrono::milliseconds(20)), 4);
+    EXPECT_NE(call.error_message().find("deadline"), std::string::npos) << call.error_message();
+    EXPECT_TRUE(call.series_names().empty());
+  }
+  EXPECT_EQ(state.load(), static_cast<uint32_t>(ShmSlotState::kFree));
+
+  // Once a server has picked the request up, the slot is left for it to free.
+  bool picked_up = false;
+  {
+    auto call = client.begin("SMA", params, 4);
+    std::thread fake_server([&] {
+      const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+      while (!picked_up && std::chrono::steady_clock::now() < give_up) {
+        uint32_t expected = static_cast<uint32_t>(ShmSlotState::kRequest);
+        picked_up = state.compare_exchange_strong(expected, static_cast<uint32_t>(ShmSlotState::kProcessing));
+        std::this_thread::yield();
+      }
+    });
+    EXPECT_EQ(call.submit(std::chrono::steady_clock::now() + std::chrono::milliseconds(200)), 4);
+    fake_server.join();
+  }
+  ASSERT_TRUE(picked_up);
+  EXPECT_EQ(state.load(), static_cast<uint32_t>(ShmSlotState::kAbandoned));
+
+  auto replaced = tg_indicators::ShmSegment::create(name, 1, 8, true);
+  EXPECT_EQ(replaced.header().serving.load(), 0U);
+}
+
+TEST(StreamingTest, MatchesBatchComputeBarForBar) {
+  const auto bars = minute_session_bars();
+  for (const auto& [name, params] : kStreamingCases) {
+    const auto expected = tg_indicators::create_indicator(name)->compute(bars, params);
+    auto stream = tg_indicators::create_streaming_indicator(name, params);
+    ASSERT_TRUE(stream) << name;
+    const auto names = stream->output_names();
+    std::vector<double> latest(names.size());
+    std::vector<std::vector<double>> streamed(names.size(), std::vector<double>(bars.size()));
+    for (size_t i = 0; i < bars.size(); ++i) {
+      if (i == bars.size() / 2) {
+        // Round-trip through save/load mid-stream.
+        std::string bytes;
+        stream->save(bytes);
+        stream = tg_indicators::create_streaming_indicator(name, params);
+        stream->load(bytes);
+      }
+      stream->update(bars[i], latest);
+      for (size_t k = 0; k < names.size(); ++k) {
+        streamed[k][i] = latest[k];
+      }
+    }
+    for (size_t k = 0; k < names.size(); ++k) {
+      expect_same_series(streamed[k], expected.at(names[k]), name + "." + names[k]);
+    }
+    EXPECT_EQ(stream->bar_count(), bars.size());
+  }
+  std::string bytes;
+  tg_indicators::create_streaming_indicator("SMA", {{"period", 5.0}})->save(bytes);
+  EXPECT_THROW(tg_indicators::create_streaming_indicator("SMA", {{"period", 6.0}})->load(bytes),
+               std::runtime_error);
+}
+
+TEST(StreamingTest, PreviewsRevisedFormingBarWithoutFoldingIt) {
+  const auto bars = minute_session_bars();
+  for (const auto& [name, params] : kStreamingCases) {
+    // BOLL's bands and CCI's deviation are merged from a summary rather than rescanned.
+    const bool exact = name != "BOLL" && name != "CCI";
+    auto stream = tg_indicators::create_streaming_indicator(name, params);
+    auto scratch = tg_indicators::create_streaming_indicator(name, params);
+    const size_t width = stream->output_names().size();
+    std::vector<double> previewed(width);
+    std::vector<double> folded(width);
+    for (size_t i = 0; i < bars.size(); ++i) {
+      std::string checkpoint;
+      stream->save(checkpoint);
+      // Ticks revise the forming bar; the last revision is the bar as it closes.
+      for (const double shift : {0.35, -0.2, 0.0}) {
+        OHLCV forming = bars[i];
+        forming.close += shift;
+        forming.high = std::max(forming.high, forming.close);
+        forming.low = std::min(forming.low, forming.close);
+        forming.volume += 100;
+        if (shift == 0.0) {
+          forming = bars[i];
+        }
+        stream->preview(forming, previewed);
+        scratch->load(checkpoint);
+        scratch->update(forming, folded);
+        expect_same_series(previewed, folded, name + " @" + std::to_string(i), exact ? 0.0 : 1e-9);
+      }
+      EXPECT_EQ(stream->bar_count(), i);
+      stream->update(bars[i], folded);
+    }
+  }
+
+  tg_indicators::StreamStore store;
+  const std::span<const OHLCV> all(bars);
+  const auto update = store.update("SZ.000001", "SMA", {{"period", 5.0}}, all.first(10), &bars[10]);
+  EXPECT_EQ(update.bar_count, 10U);
+  ASSERT_EQ(update.provisional.size(), 1U);
+  const auto committed = store.update("SZ.000001", "SMA", {{"period", 5.0}}, all.subspan(10, 1));
+  EXPECT_EQ(update.provisional[0], committed.latest[0]);
+  EXPECT_TRUE(committed.provisional.empty());
+  EXPECT_TRUE(store.update("SZ.000001", "SMA", {{"period", 5.0}}, {}, &bars[10]).provisional.empty());
+}
+
+TEST(StreamStoreTest, SnapshotRestoresStateAndWatermark) {
+  const auto bars = minute_session_bars();
+  const std::span<const OHLCV> all(bars);
+  const size_t half = bars.size() / 2;
+  const auto path = (make_temp_dir("streams") / "state.bin").string();
+  const auto expected = tg_indicators::create_indicator("RSI")->compute(bars, {{"period", 6.0}});
+
+  {
+    tg_indicators::StreamStore store;
+    store.update("SZ.000001", "rsi", {{"period", 6.0}}, all.first(half));
+    store.update("SH.600000", "MACD", {}, all.first(half));
+    EXPECT_EQ(store.snapshot(path), 2U);
+  }
+
+  tg_indicators::IndicatorServiceImpl service;
+  EXPECT_EQ(service.streams().restore(path), 2U);
+  tg::v1::StreamUpdateRequest request;
+  request.set_session("SZ.000001");
+  request.set_indicator("RSI");
+  (*request.mutable_params())["period"] = 6.0;
+  tg::v1::StreamUpdateResult response;
+  // Resending everything is safe: bars at or before the watermark are skipped.
+  for (const auto& bar : bars) {
+    *request.add_bars() = make_proto_bar(bar);
+  }
+  ASSERT_TRUE(service.StreamUpdate(nullptr, &request, &response).ok());
+  EXPECT_EQ(response.applied_bars(), bars.size() - half);
+  EXPECT_EQ(response.bar_count(), bars.size());
+  EXPECT_EQ(response.watermark_ts_epoch_millis(), bars.back().ts_millis);
+  EXPECT_NEAR(response.latest().at("rsi"), expected.at("rsi").back(), 1e-9);
+
+  request.set_indicator("NOPE");
+  EXPECT_EQ(service.StreamUpdate(nullptr, &request, &response).error_code(),
+            grpc::StatusCode::NOT_FOUND);
+
+  std::string contents;
+  {
+    std::ifstream in(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  contents[contents.size() / 2] ^= 0x5a;
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+  tg_indicators::StreamStore corrupt;
+  EXPECT_THROW(corrupt.restore(path), std::runtime_error);
+  EXPECT_EQ(corrupt.size(), 0U);
+}
+
+TEST(StreamStoreTest, FoldsResampledBucketsAndPreviewsTheFormingOne) {
+  const auto bars = minute_session_bars();
+  const std::span<const OHLCV> all(bars);
+  const auto target = tg::v1::BAR_PERIOD_MIN15;
+  const Params params{{"period", 3.0}};
+  const auto sma = tg_indicators::create_indicator("SMA");
+  // Bucket-by-bucket SMA over bars[0, end): the last bucket is the forming one.
+  auto expected_last = [&](size_t end) {
+    const std::vector<OHLCV> prefix(bars.begin(), bars.begin() + static_cast<std::ptrdiff_t>(end));
+    return sma->compute(tg_indicators::resample_bars(prefix, target), params).at("sma").back();
+  };
+  // First bar of the 5th bucket, so bars before it close exactly four buckets.
+  size_t boundary = 0;
+  for (int64_t buckets = 1; buckets < 5; ++boundary) {
+    buckets += tg_indicators::resample_bucket_key(bars[boundary + 1].ts_millis, target) !=
+               tg_indicators::resample_bucket_key(bars[boundary].ts_millis, target);
+  }
+
+  const auto path = (make_temp_dir("resampled_streams") / "state.bin").string();
+  {
+    tg_indicators::StreamStore store;
+    const auto update = store.update("SZ.000001", "SMA", params, all.first(boundary), nullptr, target);
+    EXPECT_EQ(update.applied_bars, boundary);
+    EXPECT_EQ(update.bar_count, 3U);  // the 4th bucket is still forming
+    ASSERT_EQ(update.provisional.size(), 1U);
+    EXPECT_NEAR(update.provisional[0], expected_last(boundary), 1e-9);
+
+    // A forming bar in the 5th bucket closes the 4th and previews the 5th.
+    const auto moved = store.update("SZ.000001", "SMA", params, {}, &bars[boundary], target);
+    EXPECT_EQ(moved.bar_count, 4U);
+    EXPECT_NEAR(moved.latest[0], expected_last(boundary), 1e-9);
+    EXPECT_NEAR(moved.provisional[0], expected_last(boundary + 1), 1e-9);
+    // The unresampled feed of the same session is its own state.
+    EXPECT_EQ(store.update("SZ.000001", "SMA", params, all.first(5)).bar_count, 5U);
+    EXPECT_EQ(store.snapshot(path), 2U);
+  }
+
+  tg_indicators::IndicatorServiceImpl service;
+  EXPECT_EQ(service.streams().restore(path), 2U);
+  tg::v1::StreamUpdateRequest request;
+  request.set_session("SZ.000001");
+  request.set_indicator("SMA");
+  (*request.mutable_params())["period"] = 3.0;
+  request.set_resample_to(target);
+  for (const auto& bar : bars) {
+    auto* proto = request.add_bars();
+    *proto = make_proto_bar(bar);
+    proto->set_period(tg::v1::BAR_PERIOD_MIN1);
+  }
+  tg::v1::StreamUpdateResult response;
+  const grpc::Status status = service.StreamUpdate(nullptr, &request, &response);
+  ASSERT_TRUE(status.ok()) << status.error_message();
+  EXPECT_EQ(response.applied_bars(), bars.size() - boundary);
+  EXPECT_EQ(response.bar_count(), 15U);
+  EXPECT_NEAR(response.provisional().at("sma"), expected_last(bars.size()), 1e-9);
+
+  request.set_resample_to(tg::v1::BAR_PERIOD_MIN1);
+  EXPECT_EQ(service.StreamUpdate(nullptr, &request, &response).error_code(),
+            grpc::StatusCode::INVALID_ARGUMENT);
+}
+
+TEST(StreamStoreTest, KeysSchemaNormalizedParamsAndEvictsIdleSessions) {
+  const auto bars = minute_session_bars();
+  const std::span<const OHLCV> all(bars);
+  tg_indicators::StreamStore store;
+  store.update("SZ.000001", "RSI", {}, all.first(20));
+  // The default spelled out, plus a key RSI does not read, is the same state.
+  const auto update = store.update("SZ.000001", "rsi", {{"period", 14.0}, {"unused", 1.0}}, all.first(30));
+  EXPECT_EQ(update.applied_bars, 10U);
+  EXPECT_EQ(update.bar_count, 30U);
+  EXPECT_EQ(store.size(), 1U);
+  EXPECT_THROW(store.update("SZ.000001", "RSI", {{"period", 0.0}}, all.first(1)), std::invalid_argument);
+  EXPECT_EQ(store.size(), 1U);
+
+  tg_indicators::HistoryStore history;
+  history.append("SZ.000001", all.first(30));
+  EXPECT_EQ(store.evict_idle(std::chrono::hours(1)), 0U);
+  EXPECT_EQ(history.evict_idle(std::chrono::hours(1)), 0U);
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  EXPECT_EQ(store.evict_idle(std::chrono::milliseconds(1)), 1U);
+  EXPECT_EQ(history.evict_idle(std::chrono::milliseconds(1)), 1U);
+  EXPECT_EQ(store.size(), 0U);
+  EXPECT_EQ(history.size(), 0U);
+  // An evicted session starts over.
+  EXPECT_EQ(store.update("SZ.000001", "RSI", {}, all.first(30)).applied_bars, 30U);
+}
+
+TEST(BarHistoryTest, CompressesMinuteBarsLosslessly) {
+  // 60 sessions of A-share minute bars: 0.01 ticks, 100-share lots, amount to the fen.
+  std::mt19937_64 rng(7);
+  std::uniform_int_distribution<int> step(-3, 3);
+  std::uniform_int_distribution<int> wick(0, 4);
+  std::uniform_int_distribution<int64_t> lots(10, 3000);
+  const auto session = minute_session_bars();
+  std::vector<OHLCV> bars;
+  int64_t close = 1523;
+  for (int64_t day = 0; day < 60; ++day) {
+    for (const OHLCV& slot : session) {
+      const int64_t open = close + (step(rng) == 0 ? 1 : 0);
+      close = open + step(rng);
+      const int64_t high = std::max(open, close) + wick(rng);
+      const int64_t low = std::min(open, close) - wick(rng);
+      const int64_t volume = lots(rng) * 100;
+      const int64_t vwap_fen = low + (high - low) / 2;
+      bars.push_back(OHLCV{slot.ts_millis + day * 86'400'000, open / 100.0, high / 100.0,
+                           low / 100.0, close / 100.0, volume,
+                           static_cast<double>(volume * vwap_fen) / 100.0});
+    }
+  }
+  auto same = [](const OHLCV& a, const OHLCV& b) { return std::memcmp(&a, &b, sizeof(OHLCV)) == 0; };
+
+  tg_indicators::BarHistory history;
+  const std::span<const OHLCV> all(bars);
+  EXPECT_EQ(history.append(all.first(1000)), 1000U);
+  EXPECT_EQ(history.append(all.first(1200)), 200U);  // bars at or before the newest are skipped
+  EXPECT_EQ(history.append(all.subspan(1200)), bars.size() - 1200);
+  EXPECT_EQ(history.last_ts_millis(), bars.back().ts_millis);
+  std::vector<OHLCV> decoded;
+  history.read(decoded);
+  ASSERT_EQ(decoded.size(), bars.size());
+  EXPECT_TRUE(std::equal(decoded.begin(), decoded.end(), bars.begin(), same));
+  std::vector<OHLCV> tail{bars.front()};
+  history.read(tail, bars.size() - 300);  // starts inside a sealed chunk, ends in the hot one
+  ASSERT_EQ(tail.size(), 301U);
+  EXPECT_TRUE(std::equal(tail.begin() + 1, tail.end(), bars.end() - 300, same));
+  EXPECT_LT(history.memory_bytes() * 5, bars.size() * sizeof(OHLCV)) << history.memory_bytes();
+
+  // Prices that are not exact 1e-4 multiples take the XOR path, still bit-identical.
+  std::vector<OHLCV> inexact = session;
+  inexact[3].close = -0.0;
+  inexact[5].amount = std::nan("");
+  inexact.resize(tg_indicators::BarHistory::kChunkBars + 1, session.back());
+  for (size_t i = session.size(); i < inexact.size(); ++i) {
+    inexact[i].ts_millis = inexact[i - 1].ts_millis + 60'000 + static_cast<int64_t>(i % 3) * 7;
+    inexact[i].volume = -static_cast<int64_t>(i);
+  }
+  inexact.back().ts_millis += int64_t{1} << 40;  // widest timestamp and varint encodings
+  inexact.back().volume = INT64_MIN;
+  tg_indicators::BarHistory fallback;
+  fallback.append(inexact);
+  decoded.clear();
+  fallback.read(decoded);
+  ASSERT_EQ(decoded.size(), inexact.size());
+  EXPECT_TRUE(std::equal(decoded.begin(), decoded.end(), inexact.begin(), same));
+
+  tg_indicators::ServiceOptions options;
+  options.keep_history = true;
+  tg_indicators::IndicatorServiceImpl service(std::move(options));
+  tg::v1::StreamUpdateRequest update;
+  update.set_session("SZ.000001");
+  update.set_indicator("SMA");
+  for (const auto& bar : session) {
+    *update.add_bars() = make_proto_bar(bar);
+  }
+  tg::v1::StreamUpdateResult streamed;
+  ASSERT_TRUE(service.StreamUpdate(nullptr, &update, &streamed).ok());
+  EXPECT_EQ(service.history().bar_count("SZ.000001"), session.size());
+  tg::v1::IndicatorRequest request;
+  request.set_indicator("RSI");
+  request.set_history_session("SZ.000001");
+  tg::v1::IndicatorResult result;
+  ASSERT_TRUE(service.Compute(nullptr, &request, &result).ok());
+  const auto expected =
+      tg_indicators::create_indicator("RSI")->compute(tg_indicators::decode_bars(update.bars()), {});
+  ASSERT_EQ(result.ts_epoch_millis_size(), static_cast<int>(session.size()));
+  EXPECT_EQ(result.series().at("rsi").values(static_cast<int>(session.size()) - 1), expected.at("rsi").back());
+  request.set_history_session("SH.600000");
+  EXPECT_EQ(service.Compute(nullptr, &request, &result).error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+}
+
+TEST(CaptureTest, RecordsSampledRequestsForReplay) {
+  const auto path = (make_temp_dir("capture") / "traffic.cap").string();
+  tg::v1::IndicatorRequest request;
+  request.set_indicator("SMA");
+  (*request.mutable_params())["period"] = 3.0;
+  for (const auto& bar : increasing_bars(5)) {
+    *request.add_bars() = make_proto_bar(bar);
+  }
+  {
+    tg_indicators::ServiceOptions options;
+    options.capture.path = path;
+    tg_indicators::IndicatorServiceImpl service(options);
+    tg::v1::IndicatorResult response;
+    ASSERT_TRUE(service.Compute(nullptr, &request, &response).ok());
+    request.set_indicator("EMA");
+    ASSERT_TRUE(service.Compute(nullptr, &request, &response).ok());
+  }
+
+  tg_indicators::CaptureReader reader(path);
+  tg_indicators::CapturedRequest captured;
+  std::vector<std::string> labels;
+  int64_t last_offset = 0;
+  while (reader.next(&captured)) {
+    EXPECT_EQ(captured.method, tg_indicators::CapturedMethod::kCompute);
+    EXPECT_GE(captured.offset_micros, last_offset);
+    last_offset = captured.offset_micros;
+    tg::v1::IndicatorRequest decoded;
+    ASSERT_TRUE(decoded.ParseFromString(captured.payload));
+    EXPECT_EQ(decoded.bars_size(), 5);
+    labels.push_back(captured.label);
+  }
+  EXPECT_EQ(labels, (std::vector<std::string>{"SMA", "EMA"}));
+
+  tg_indicators::CaptureOptions none;
+  none.path = path + ".unsampled";
+  none.sample_rate = 0.0;
+  {
+    tg_indicators::CaptureWriter writer(none);
+    writer.record(tg_indicators::CapturedMethod::kCompute, "SMA", request);
+  }
+  tg_indicators::CaptureReader empty(none.path);
+  EXPECT_FALSE(empty.next(&captured));
+}
+
+TEST(CaptureTest, KeepsDeadlinesAndRejectsOversizedRecords) {
+  const auto dir = make_temp_dir("capture_bounds");
+  tg_indicators::CaptureOptions options;
+  options.path = (dir / "deadline.cap").string();
+  tg::v1::IndicatorRequest request;
+  request.set_indicator("SMA");
+  {
+    tg_indicators::CaptureWriter writer(options);
+    writer.record(tg_indicators::CapturedMethod::kCompute, "SMA", request,
+                  std::chrono::steady_clock::now() + std::chrono::seconds(5));
+    writer.record(tg_indicators::CapturedMethod::kCompute, "SMA", request);
+  }
+  tg_indicators::CaptureReader reader(options.path);
+  tg_indicators::CapturedRequest captured;
+  ASSERT_TRUE(reader.next(&captured));
+  EXPECT_GT(captured.deadline_micros, 4'000'000);
+  EXPECT_LE(captured.deadline_micros, 5'000'000);
+  ASSERT_TRUE(reader.next(&captured));
+  EXPECT_EQ(captured.deadline_micros, 0);
+
+  // Record lengths come from the file, so neither a huge one nor one longer than the
+  // rest of the file may size an allocation.
+  auto write_record_length = [&](const std::string& name, uint64_t length) {
+    std::ofstream out(dir / name, std::ios::binary);
+    out << "TGCAP02\n";
+    for (; length >= 0x80; length >>= 7) {
+      out.put(static_cast<char>((length & 0x7f) | 0x80));
+    }
+    out.put(static_cast<char>(length));
+    out << "short";
+    return (dir / name).string();
+  };
+  tg_indicators::CaptureReader huge(write_record_length("huge.cap", 0xffffffffULL));
+  EXPECT_THROW(huge.next(&captured), std::runtime_error);
+  tg_indicators::CaptureReader past_end(write_record_length("past_end.cap", 1000));
+  EXPECT_THROW(past_end.next(&captured), std::runtime_error);
+}
+
 TEST(IndicatorServiceTest, ComputesRequestInProcess) {
   tg_indicators::IndicatorServiceImpl service;
   tg::v1::IndicatorRequest request;
@@ -175,6 +1531,245 @@ TEST(IndicatorServiceTest, ComputesRequestInProcess) {
   EXPECT_NEAR(response.series().at("sma").values(4), 13.0, 1e-12);
 }
 
+TEST(IndicatorServiceTest, ComputesFixedPointRequests) {
+  tg_indicators::IndicatorServiceImpl service;
+  tg::v1::IndicatorRequest request;
+  (*request.mutable_params())["period"] = 3.0;
+  request.set_fixed_point(true);
+  for (const auto& bar : increasing_bars(5)) {
+    *request.add_bars() = make_proto_bar(bar);
+  }
+  tg::v1::IndicatorResult response;
+  // SMA has an integer kernel; EMA falls back to double decoding.
+  for (const char* name : {"SMA", "EMA"}) {
+    request.set_indicator(name);
+    const grpc::Status status = service.Compute(nullptr, &request, &response);
+    ASSERT_TRUE(status.ok()) << status.error_message();
+    ASSERT_EQ(response.ts_epoch_millis_size(), 5);
+    EXPECT_EQ(response.ts_epoch_millis(4), increasing_bars(5)[4].ts_millis);
+  }
+  request.set_indicator("SMA");
+  ASSERT_TRUE(service.Compute(nullptr, &request, &response).ok());
+  EXPECT_EQ(response.series().at("sma").values(4), 13.0);
+
+  request.mutable_bars(2)->set_close("1.5e1");
+  EXPECT_EQ(service.Compute(nullptr, &request, &response).error_code(),
+            grpc::StatusCode::INVALID_ARGUMENT);
+}
+
+TEST(IndicatorServiceTest, ExtractsEventsInsteadOfSeries) {
+  tg_indicators::IndicatorServiceImpl service;
+  tg::v1::EventsRequest request;
+  auto* inner = request.mutable_request();
+  inner->set_indicator("SMA");
+  (*inner->mutable_params())["period"] = 3.0;
+  auto bars = increasing_bars(8);
+  bars[6].close = bars[7].close = 5.0;  // a sharp drop through the average
+  for (const auto& bar : bars) {
+    *inner->add_bars() = make_proto_bar(bar);
+  }
+  auto* cross = request.add_predicates();
+  cross->set_id("close_below_sma");
+  cross->set_kind(tg::v1::PREDICATE_KIND_CROSS_BELOW);
+  cross->set_series("close");
+  cross->set_reference("sma");
+  auto* high = request.add_predicates();
+  high->set_id("new_high");
+  high->set_kind(tg::v1::PREDICATE_KIND_NEW_HIGH);
+  high->set_series("sma");
+  high->set_lookback(2);
+
+  tg::v1::EventsResult response;
+  const grpc::Status status = service.ExtractEvents(nullptr, &request, &response);
+  ASSERT_TRUE(status.ok()) << status.error_message();
+  // SMA(3) makes new 2-bar highs at bars 4 and 5; close drops below it at bar 6.
+  ASSERT_EQ(response.events_size(), 3);
+  EXPECT_EQ(response.events(0).predicate_id(), "new_high");
+  EXPECT_EQ(response.events(0).ts_epoch_millis(), bars[4].ts_millis);
+  EXPECT_EQ(response.events(2).predicate_id(), "close_below_sma");
+  EXPECT_EQ(response.events(2).ts_epoch_millis(), bars[6].ts_millis);
+  EXPECT_NEAR(response.events(2).value(), 5.0, 1e-12);
+
+  request.set_since_ts_epoch_millis(bars[6].ts_millis);
+  ASSERT_TRUE(service.ExtractEvents(nullptr, &request, &response).ok());
+  EXPECT_EQ(response.events_size(), 0);
+
+  cross->set_kind(tg::v1::PREDICATE_KIND_UNSPECIFIED);
+  EXPECT_EQ(service.ExtractEvents(nullptr, &request, &response).error_code(),
+            grpc::StatusCode::INVALID_ARGUMENT);
+}
+
+TEST(IndicatorServiceTest, ScreensUniverseWithCheapConditionsFirst) {
+  tg_indicators::IndicatorServiceImpl service;
+  tg::v1::ScreenRequest request;
+  // RSI(6) < 20 and volume > 2x its 5-bar average, listed expensive-first.
+  auto* rsi = request.add_conditions();
+  rsi->mutable_left()->set_indicator("RSI");
+  (*rsi->mutable_left()->mutable_params())["period"] = 6.0;
+  rsi->mutable_left()->set_series("rsi");
+  rsi->set_op(tg::v1::COMPARE_OP_LT);
+  rsi->mutable_right()->set_constant(20.0);
+  auto* volume = request.add_conditions();
+  volume->mutable_left()->set_series("volume");
+  volume->set_op(tg::v1::COMPARE_OP_GT);
+  volume->mutable_right()->set_series("volume");
+  volume->mutable_right()->set_average_bars(5);
+  volume->mutable_right()->set_scale(2.0);
+
+  auto add_symbol = [&](const std::string& name, bool falling, bool spike) {
+    auto bars = increasing_bars(30);
+    if (falling) {
+      std::reverse(bars.begin(), bars.end());
+    }
+    bars.back().volume = spike ? 10'000 : 100;
+    auto* symbol = request.add_universe();
+    symbol->set_symbol(name);
+    for (size_t i = 0; i < bars.size(); ++i) {
+      bars[i].ts_millis = 1'700'000'000'000 + static_cast<int64_t>(i) * 86'400'000;
+      *symbol->add_bars() = make_proto_bar(bars[i]);
+    }
+  };
+  add_symbol("600000", true, true);    // oversold with a volume spike
+  add_symbol("600001", false, true);   // spike but rising
+  add_symbol("600002", true, false);   // oversold without a spike
+  add_symbol("600003", false, false);
+  request.add_universe()->set_symbol("600004");  // no bars
+
+  tg::v1::ScreenResult response;
+  const grpc::Status status = service.Screen(nullptr, &request, &response);
+  ASSERT_TRUE(status.ok()) << status.error_message();
+  EXPECT_EQ(response.screened(), 5u);
+  ASSERT_EQ(response.matches_size(), 1);
+  EXPECT_EQ(response.matches(0).symbol(), "600000");
+  EXPECT_LT(response.matches(0).values().at("RSI(period=6).rsi"), 20.0);
+  EXPECT_EQ(response.matches(0).values().at("volume"), 10'000.0);
+  EXPECT_TRUE(response.matches(0).values().contains("2*avg5(volume)"));
+  // Only the two symbols with a volume spike reach the RSI condition.
+  EXPECT_EQ(response.indicators_computed(), 2u);
+
+  rsi->mutable_left()->set_series("nope");
+  EXPECT_EQ(service.Screen(nullptr, &request, &response).error_code(),
+            grpc::StatusCode::INVALID_ARGUMENT);
+  // Invalid params fail the whole screen instead of quietly matching nothing.
+  rsi->mutable_left()->set_series("rsi");
+  (*rsi->mutable_left()->mutable_params())["period"] = 0.0;
+  EXPECT_EQ(service.Screen(nullptr, &request, &response).error_code(),
+            grpc::StatusCode::INVALID_ARGUMENT);
+}
+
+TEST(IndicatorServiceTest, DescribesWarmupAndAcceptsSeededState) {
+  tg_indicators::IndicatorServiceImpl service;
+  tg::v1::DescribeRequest describe;
+  describe.set_indicator("RSI");
+  (*describe.mutable_params())["period"] = 14.0;
+  tg::v1::DescribeResult description;
+  ASSERT_TRUE(service.Describe(nullptr, &describe, &description).ok());
+  EXPECT_EQ(description.min_bars(), 15u);
+  // (13/14)^k < 1e-4 needs k = 125.
+  EXPECT_EQ(description.warmup_bars(), 15u + 125u);
+  ASSERT_EQ(description.outputs_size(), 1);
+  EXPECT_EQ(description.outputs(0), "rsi");
+  EXPECT_EQ(description.state_keys_size(), 3);
+  describe.set_indicator("SMA");
+  ASSERT_TRUE(service.Describe(nullptr, &describe, &description).ok());
+  EXPECT_EQ(description.warmup_bars(), description.min_bars());
+  describe.set_tolerance(2.0);
+  EXPECT_EQ(service.Describe(nullptr, &describe, &description).error_code(),
+            grpc::StatusCode::INVALID_ARGUMENT);
+
+  const auto bars = increasing_bars(40);
+  tg::v1::IndicatorRequest request;
+  request.set_indicator("MACD");
+  request.set_return_state(true);
+  for (size_t i = 0; i < 35; ++i) {
+    *request.add_bars() = make_proto_bar(bars[i]);
+  }
+  tg::v1::IndicatorResult response;
+  ASSERT_TRUE(service.Compute(nullptr, &request, &response).ok());
+  ASSERT_EQ(response.state_size(), 3);
+
+  tg::v1::IndicatorRequest next;
+  next.set_indicator("MACD");
+  next.mutable_seed()->insert(response.state().begin(), response.state().end());
+  for (size_t i = 35; i < bars.size(); ++i) {
+    *next.add_bars() = make_proto_bar(bars[i]);
+  }
+  tg::v1::IndicatorResult continued;
+  ASSERT_TRUE(service.Compute(nullptr, &next, &continued).ok());
+  ASSERT_EQ(continued.series().at("dif").values_size(), 5);
+
+  request.clear_bars();
+  for (const auto& bar : bars) {
+    *request.add_bars() = make_proto_bar(bar);
+  }
+  ASSERT_TRUE(service.Compute(nullptr, &request, &response).ok());
+  EXPECT_NEAR(continued.series().at("hist").values(4), response.series().at("hist").values(39), 1e-9);
+}
+
+TEST(ParamSchemaTest, DecodesTypedParamsAndDescribesThem) {
+  using tg_indicators::kKdjSchema;
+  static_assert(kKdjSchema.defaults().k_period == 9 && kKdjSchema.defaults().j_smooth == 3.0);
+  const auto kdj = kKdjSchema.decode({{"d_period", 5.0}, {"unknown", -1.0}});
+  EXPECT_EQ(kdj.k_period, 9);
+  EXPECT_EQ(kdj.d_period, 5);
+  EXPECT_EQ(kdj.j_smooth, 3.0);
+  EXPECT_THROW(kKdjSchema.decode({{"k_period", 2.5}}), std::invalid_argument);
+  EXPECT_THROW(kKdjSchema.decode({{"k_period", 1e9}}), std::invalid_argument);
+  EXPECT_THROW(kKdjSchema.decode({{"j_smooth", 0.0}}), std::invalid_argument);
+  EXPECT_NO_THROW(tg_indicators::kBollSchema.decode({{"std_dev", 0.0}}));
+  EXPECT_THROW(tg_indicators::kBollSchema.decode({{"std_dev", NAN}}), std::invalid_argument);
+  // Cost estimates read the same defaults and never throw on a bad value.
+  EXPECT_EQ(kKdjSchema.decode_or_default({{"k_period", 2.5}, {"d_period", 5.0}}).k_period, 9);
+  const auto kdj_indicator = tg_indicators::create_indicator("KDJ");
+  EXPECT_EQ(kdj_indicator->cost_per_bar({}), kdj_indicator->cost_per_bar({{"k_period", 9.0}}));
+  EXPECT_EQ(kdj_indicator->cost_per_bar({{"k_period", -4.0}}), kdj_indicator->cost_per_bar({}));
+
+  tg_indicators::IndicatorServiceImpl service;
+  tg::v1::DescribeRequest describe;
+  describe.set_indicator("BOLL");
+  tg::v1::DescribeResult description;
+  ASSERT_TRUE(service.Describe(nullptr, &describe, &description).ok());
+  ASSERT_EQ(description.params_size(), 2);
+  EXPECT_EQ(description.params(0).name(), "period");
+  EXPECT_TRUE(description.params(0).integer());
+  EXPECT_EQ(description.params(0).default_value(), 20.0);
+  EXPECT_EQ(description.params(1).name(), "std_dev");
+  EXPECT_FALSE(description.params(1).exclusive_min());
+  describe.set_indicator("OBV");
+  ASSERT_TRUE(service.Describe(nullptr, &describe, &description).ok());
+  EXPECT_EQ(description.params_size(), 0);
+}
+
+TEST(IndicatorServiceTest, ComputesMaskedRequestsAlignedToAllBars) {
+  tg_indicators::IndicatorServiceImpl service;
+  tg::v1::IndicatorRequest request;
+  request.set_indicator("ATR");
+  (*request.mutable_params())["period"] = 3.0;
+  for (const auto& bar : increasing_bars(8)) {
+    *request.add_bars() = make_proto_bar(bar);
+    request.add_valid(true);
+  }
+  // Bar 4 is a suspension: no prices at all.
+  request.set_valid(4, false);
+  for (auto* field : {request.mutable_bars(4)->mutable_open(), request.mutable_bars(4)->mutable_high(),
+                      request.mutable_bars(4)->mutable_low(), request.mutable_bars(4)->mutable_close(),
+                      request.mutable_bars(4)->mutable_amount()}) {
+    field->clear();
+  }
+  tg::v1::IndicatorResult response;
+  const grpc::Status status = service.Compute(nullptr, &request, &response);
+  ASSERT_TRUE(status.ok()) << status.error_message();
+  ASSERT_EQ(response.ts_epoch_millis_size(), 8);
+  const auto& atr = response.series().at("atr");
+  ASSERT_EQ(atr.values_size(), 8);
+  expect_nan(atr.values(4));
+  EXPECT_FALSE(std::isnan(atr.values(5)));
+
+  request.add_valid(true);
+  EXPECT_EQ(service.Compute(nullptr, &request, &response).error_code(),
+            grpc::StatusCode::INVALID_ARGUMENT);
+}
+
 TEST(IndicatorServiceTest, RejectsUnknownIndicator) {
   tg_indicators::IndicatorServiceImpl service;
   tg::v1::IndicatorRequest request;
@@ -184,6 +1779,488 @@ TEST(IndicatorServiceTest, RejectsUnknownIndicator) {
   EXPECT_EQ(status.error_code(), grpc::StatusCode::NOT_FOUND);
 }
 
+TEST(IndicatorServiceTest, AppliesAdjustmentFactorsDuringDecode) {
+  tg_indicators::IndicatorServiceImpl service;
+  tg::v1::IndicatorRequest request;
+  request.set_indicator("SMA");
+  (*request.mutable_params())["period"] = 2.0;
+  request.set_adjustment(tg::v1::ADJUSTMENT_PRE_ADJUST);
+  const auto bars = increasing_bars(4);
+  for (size_t i = 0; i < bars.size(); ++i) {
+    auto* proto = request.add_bars();
+    *proto = make_proto_bar(bars[i]);
+    proto->set_trading_date("2026-01-0" + std::to_string(i + 1));
+  }
+  auto* before = request.add_adjustment_factors();
+  before->set_ex_date("2025-06-01");
+  before->set_factor("1.0");
+  auto* split = request.add_adjustment_factors();
+  split->set_ex_date("2026-01-03");
+  split->set_factor("2.0");
+
+  tg::v1::IndicatorResult response;
+  grpc::Status status = service.Compute(nullptr, &request, &response);
+  ASSERT_TRUE(status.ok()) << status.error_message();
+  // Closes 10, 11 are halved ahead of the 2026-01-03 ex-date; 12, 13 stay raw.
+  EXPECT_NEAR(response.series().at("sma").values(1), 5.25, 1e-9);
+  EXPECT_NEAR(response.series().at("sma").values(2), 8.75, 1e-9);
+  EXPECT_NEAR(response.series().at("sma").values(3), 12.5, 1e-9);
+
+  const auto ratios = tg_indicators::adjustment_ratios(request.bars(), request.adjustment_factors(),
+                                                       tg::v1::ADJUSTMENT_POST_ADJUST);
+  ASSERT_EQ(ratios.size(), 4U);
+  EXPECT_EQ(ratios[0], 1.0);
+  EXPECT_EQ(ratios[3], 2.0);
+  EXPECT_FALSE(tg_indicators::uniform_ratios(ratios));
+
+  split->set_factor("0");
+  status = service.Compute(nullptr, &request, &response);
+  EXPECT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+}
+
+TEST(IndicatorServiceTest, SkipsUniformAdjustmentForScaleInvariantIndicators) {
+  tg_indicators::IndicatorServiceImpl service;
+  tg::v1::IndicatorRequest request;
+  request.set_indicator("RSI");
+  (*request.mutable_params())["period"] = 3.0;
+  request.set_adjustment(tg::v1::ADJUSTMENT_POST_ADJUST);
+  for (const auto& bar : increasing_bars(8)) {
+    *request.add_bars() = make_proto_bar(bar);
+  }
+  auto* first = request.add_adjustment_factors();
+  first->set_ex_date("2025-01-01");
+  first->set_factor("1.0");
+  auto* second = request.add_adjustment_factors();
+  second->set_ex_date("2025-06-01");
+  second->set_factor("3.0");
+  const auto ratios = tg_indicators::adjustment_ratios(request.bars(), request.adjustment_factors(),
+                                                       request.adjustment());
+  EXPECT_TRUE(tg_indicators::uniform_ratios(ratios));
+  EXPECT_TRUE(tg_indicators::create_indicator("RSI")->scale_invariant());
+  EXPECT_FALSE(tg_indicators::create_indicator("OBV")->scale_invariant());
+
+  tg::v1::IndicatorResult adjusted;
+  ASSERT_TRUE(service.Compute(nullptr, &request, &adjusted).ok());
+  const auto factors = request.adjustment_factors();
+  request.clear_adjustment_factors();
+  tg::v1::IndicatorResult raw;
+  ASSERT_TRUE(service.Compute(nullptr, &request, &raw).ok());
+  EXPECT_EQ(adjusted.SerializeAsString(), raw.SerializeAsString());
+
+  request.set_indicator("SMA");
+  *request.mutable_adjustment_factors() = factors;
+  ASSERT_TRUE(service.Compute(nullptr, &request, &adjusted).ok());
+  EXPECT_NEAR(adjusted.series().at("sma").values(7), 3.0 * 16.0, 1e-9);
+}
+
+TEST(CrossSectionTest, RanksPerDateAndSkipsHaltedSymbols) {
+  const double nan = tg_indicators::nan_value();
+  std::vector<tg_indicators::SymbolSeries> universe{
+      {{1, 2, 3}, {1.0, 5.0, nan}},
+      {{1, 3}, {3.0, 2.0}},  // halted on ts 2
+      {{1, 2, 3}, {3.0, 4.0, 8.0}},
+      {{2, 3}, {6.0, 4.0}},  // listed on ts 2
+  };
+  tg_indicators::CrossSectionOptions options;
+  options.winsor_lower = 0.25;
+  options.winsor_upper = 0.75;
+  options.threads = 2;
+  const auto result = tg_indicators::compute_cross_section(universe, options);
+  ASSERT_EQ(result.ts_millis, (std::vector<int64_t>{1, 2, 3}));
+  ASSERT_EQ(result.symbol_count, 4U);
+  const auto at = [&](const std::vector<double>& column, size_t d, size_t s) {
+    return column[d * result.symbol_count + s];
+  };
+
+  // ts 1: {1, 3, 3}; the tie shares rank 2.5.
+  EXPECT_EQ(at(result.rank, 0, 0), 1.0);
+  EXPECT_EQ(at(result.rank, 0, 1), 2.5);
+  EXPECT_EQ(at(result.rank, 0, 2), 2.5);
+  expect_nan(at(result.rank, 0, 3));
+  EXPECT_NEAR(at(result.percentile, 0, 0), 1.0 / 3.0, 1e-12);
+  // ts 2: {5, 4, 6}, symbol 1 halted.
+  expect_nan(at(result.value, 1, 1));
+  expect_nan(at(result.zscore, 1, 1));
+  EXPECT_NEAR(at(result.zscore, 1, 0), 0.0, 1e-12);
+  EXPECT_NEAR(at(result.zscore, 1, 3), 1.0, 1e-12);
+  EXPECT_EQ(at(result.percentile, 1, 3), 1.0);
+  // ts 3: {2, 8, 4}, symbol 0 still in warm-up; quantiles 2.5 and 6.
+  EXPECT_EQ(at(result.rank, 2, 2), 3.0);
+  EXPECT_NEAR(at(result.winsorized, 2, 1), 3.0, 1e-12);
+  EXPECT_NEAR(at(result.winsorized, 2, 2), 6.0, 1e-12);
+  EXPECT_NEAR(at(result.winsorized, 2, 3), 4.0, 1e-12);
+}
+
+TEST(IndicatorServiceTest, ComputesCrossSectionOverUniverse) {
+  tg_indicators::IndicatorServiceImpl service;
+  tg::v1::CrossSectionRequest request;
+  request.set_indicator("SMA");
+  (*request.mutable_params())["period"] = 2.0;
+  request.set_series("sma");
+  request.set_divide_by_close(true);
+  for (int s = 0; s < 3; ++s) {
+    auto* symbol = request.add_universe();
+    symbol->set_symbol("60000" + std::to_string(s));
+    auto bars = increasing_bars(static_cast<size_t>(4 + s));
+    for (auto& bar : bars) {
+      bar.close *= static_cast<double>(s + 1);
+      *symbol->add_bars() = make_proto_bar(bar);
+    }
+  }
+  auto* short_history = request.add_universe();
+  short_history->set_symbol("688001");
+  *short_history->add_bars() = make_proto_bar(increasing_bars(1)[0]);
+
+  tg::v1::CrossSectionResult response;
+  const grpc::Status status = service.CrossSection(nullptr, &request, &response);
+  ASSERT_TRUE(status.ok()) << status.error_message();
+  ASSERT_EQ(response.symbols_size(), 4);
+  ASSERT_EQ(response.ts_epoch_millis_size(), 6);
+  const auto& rank = response.series().at("rank");
+  ASSERT_EQ(rank.values_size(), 6 * 4);
+  // sma/close is scale-free, so every symbol ties on ts index 1.
+  EXPECT_EQ(rank.values(1 * 4 + 0), 2.0);
+  EXPECT_EQ(rank.values(1 * 4 + 2), 2.0);
+  expect_nan(rank.values(1 * 4 + 3));
+  expect_nan(rank.values(5 * 4 + 0));
+  EXPECT_EQ(response.series().at("percentile").values(5 * 4 + 2), 1.0);
+
+  request.set_series("nope");
+  EXPECT_EQ(service.CrossSection(nullptr, &request, &response).error_code(),
+            grpc::StatusCode::INVALID_ARGUMENT);
+}
+
+TEST(CorrelationTest, RollingMatricesMatchTwoPassComputation) {
+  const size_t symbols = 70;  // spans two tiles
+  const size_t length = 40;
+  const size_t window = 10;
+  std::vector<std::vector<double>> returns(symbols, std::vector<double>(length));
+  uint64_t state = 42;
+  for (auto& column : returns) {
+    for (double& value : column) {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      value = static_cast<double>(state >> 40) / static_cast<double>(1ULL << 24) - 0.5;
+    }
+  }
+  returns[3][25] = tg_indicators::nan_value();
+
+  tg_indicators::RollingCorrelationOptions options;
+  options.window = window;
+  options.step = 7;
+  options.threads = 3;
+  const auto result = tg_indicators::rolling_correlation(returns, options);
+  ASSERT_EQ(result.end_index, (std::vector<size_t>{9, 16, 23, 30, 37}));
+
+  auto two_pass = [&](size_t a, size_t b, size_t end) {
+    double ma = 0.0, mb = 0.0;
+    for (size_t t = end + 1 - window; t <= end; ++t) {
+      ma += returns[a][t] / static_cast<double>(window);
+      mb += returns[b][t] / static_cast<double>(window);
+    }
+    double cov = 0.0, va = 0.0, vb = 0.0;
+    for (size_t t = end + 1 - window; t <= end; ++t) {
+      cov += (returns[a][t] - ma) * (returns[b][t] - mb);
+      va += (returns[a][t] - ma) * (returns[a][t] - ma);
+      vb += (returns[b][t] - mb) * (returns[b][t] - mb);
+    }
+    return cov / std::sqrt(va * vb);
+  };
+  for (size_t k = 0; k < result.end_index.size(); ++k) {
+    const double* matrix = &result.correlation[k * symbols * symbols];
+    for (size_t i = 0; i < symbols; i += 5) {
+      for (size_t j = 0; j < symbols; j += 3) {
+        const double actual = matrix[i * symbols + j];
+        const bool halted = (i == 3 || j == 3) && result.end_index[k] >= 25 &&
+                            result.end_index[k] < 25 + window;
+        if (halted) {
+          expect_nan(actual);
+        } else {
+          EXPECT_NEAR(actual, i == j ? 1.0 : two_pass(i, j, result.end_index[k]), 1e-9)
+              << k << " " << i << " " << j;
+        }
+      }
+    }
+  }
+
+  std::vector<double> benchmark = returns[0];
+  std::vector<std::vector<double>> levered{returns[0], returns[1]};
+  for (double& value : levered[0]) {
+    value = 2.0 * value + 0.001;
+  }
+  const auto betas = tg_indicators::rolling_beta(levered, benchmark, window);
+  expect_nan(betas[0][window - 2]);
+  EXPECT_NEAR(betas[0][window - 1], 2.0, 1e-9);
+  EXPECT_NEAR(betas[0][length - 1], 2.0, 1e-9);
+  EXPECT_TRUE(std::isfinite(betas[1][length - 1]));
+}
+
+TEST(CorrelationTest, FlatWindowsGiveNanAfterRunningUpdates) {
+  // Symbol 0 trades, then locks limit-up: its returns go to exactly zero mid-stream,
+  // off the rebuild boundary, so the running sums must cancel to a true zero.
+  const size_t length = 61;
+  const size_t window = 20;
+  std::vector<std::vector<double>> returns(2, std::vector<double>(length));
+  for (size_t t = 0; t < length; ++t) {
+    returns[0][t] = t < 27 ? 0.0137 * std::sin(0.9 * static_cast<double>(t)) + 0.003 : 0.0;
+    returns[1][t] = 0.011 * std::cos(1.3 * static_cast<double>(t));
+  }
+  tg_indicators::RollingCorrelationOptions options;
+  options.window = window;
+  const auto result = tg_indicators::rolling_correlation(returns, options);
+  const auto beta = tg_indicators::rolling_beta({returns[1]}, returns[0], window);
+  for (size_t k = 0; k < result.end_index.size(); ++k) {
+    const size_t end = result.end_index[k];
+    const double corr = result.correlation[k * 4 + 1];
+    if (end >= 27 + window - 1) {
+      EXPECT_TRUE(std::isnan(corr)) << "end " << end << ": " << corr;
+      EXPECT_TRUE(std::isnan(beta[0][end])) << "end " << end << ": " << beta[0][end];
+    } else {
+      EXPECT_FALSE(std::isnan(corr)) << "end " << end;
+    }
+  }
+}
+
+TEST(IndicatorServiceTest, BoundsRollingCorrelationReplies) {
+  tg_indicators::IndicatorServiceImpl service;
+  tg::v1::RollingCorrelationRequest request;
+  request.set_window(10);
+  for (int i = 0; i < 3; ++i) {
+    request.add_symbols(std::string(1, static_cast<char>('A' + i)));
+    auto* column = request.add_returns();
+    for (int t = 0; t < 40; ++t) {
+      column->add_values(std::sin(0.3 * t + i));
+    }
+  }
+  tg::v1::RollingCorrelationResult response;
+  ASSERT_TRUE(service.RollingCorrelation(nullptr, &request, &response).ok());
+  // Without a step the windows tile the series: ends at bars 9, 19, 29 and 39.
+  EXPECT_EQ(response.end_index_size(), 4);
+  EXPECT_EQ(response.correlation().values_size(), 4 * 3 * 3);
+
+  // 300 symbols over 250 bars, a matrix per bar, would be ~21M values.
+  request.Clear();
+  request.set_window(20);
+  request.set_step(1);
+  for (int i = 0; i < 300; ++i) {
+    request.add_returns()->mutable_values()->Resize(250, 0.0);
+  }
+  EXPECT_EQ(service.RollingCorrelation(nullptr, &request, &response).error_code(),
+            grpc::StatusCode::INVALID_ARGUMENT);
+}
+
+TEST(ParquetReaderTest, ReadsBarColumnsAndPrunesRowGroupsByTimestamp) {
+  const auto dir = make_temp_dir("parquet_prune");
+  const auto path = dir / "part.parquet";
+  auto bars = increasing_bars(30);
+  bars[13].close = 11.25;
+  ParquetFixtureWriter::write(path, bars, {10, true, false});
+
+  tg_indicators::ParquetScanStats stats;
+  const auto read = tg_indicators::read_parquet_bars(path.string(), bars[12].ts_millis,
+                                                     bars[18].ts_millis, &stats);
+  ASSERT_EQ(read.size(), 6U);
+  EXPECT_EQ(stats.row_groups_total, 3U);
+  EXPECT_EQ(stats.row_groups_read, 1U);
+  EXPECT_EQ(read[0].ts_millis, bars[12].ts_millis);
+  EXPECT_NEAR(read[1].close, 11.25, 1e-12);
+  EXPECT_NEAR(read[0].open, bars[12].open, 1e-12);
+  EXPECT_NEAR(read[0].high, bars[12].high, 1e-12);
+  EXPECT_NEAR(read[0].low, bars[12].low, 1e-12);
+  EXPECT_EQ(read[0].volume, bars[12].volume);
+  EXPECT_NEAR(read[5].amount, bars[17].amount, 1e-9);
+
+  const auto all = tg_indicators::read_parquet_bars(path.string());
+  ASSERT_EQ(all.size(), 30U);
+  EXPECT_NEAR(all.back().close, bars.back().close, 1e-12);
+  std::filesystem::remove_all(dir);
+}
+
+TEST(ParquetReaderTest, RejectsCountsOutsideTheDeclaredSizes) {
+  const auto dir = make_temp_dir("parquet_counts");
+  const auto path = dir / "part.parquet";
+  const auto bars = increasing_bars(20);
+  // Negative, beyond the file's 20 rows, and disagreeing with the chunks' 10 values.
+  for (const int64_t rows : {int64_t{-1}, int64_t{1} << 40, int64_t{11}}) {
+    ParquetFixtureWriter::Corruption corruption;
+    corruption.group_rows = rows;
+    ParquetFixtureWriter::write(path, bars, {}, corruption);
+    EXPECT_THROW(tg_indicators::read_parquet_bars(path.string()), std::runtime_error) << rows;
+  }
+  for (const int64_t values : {int64_t{-1}, int64_t{11}}) {
+    ParquetFixtureWriter::Corruption corruption;
+    corruption.page_values = values;
+    ParquetFixtureWriter::write(path, bars, {}, corruption);
+    EXPECT_THROW(tg_indicators::read_parquet_bars(path.string()), std::runtime_error) << values;
+  }
+  std::filesystem::remove_all(dir);
+}
+
+TEST(ParquetReaderTest, BatchModeQueriesYearPartitionsAndComputes) {
+  const auto dir = make_temp_dir("parquet_batch");
+  auto bars = increasing_bars(10);
+  const int64_t year_2025 = tg_indicators::parse_date_millis("2025-12-27");
+  for (size_t i = 0; i < bars.size(); ++i) {
+    bars[i].ts_millis = year_2025 + static_cast<int64_t>(i) * tg_indicators::kMillisPerDay;
+  }
+  const std::vector<OHLCV> first(bars.begin(), bars.begin() + 5);
+  const std::vector<OHLCV> second(bars.begin() + 5, bars.end());
+  ParquetFixtureWriter::write(tg_indicators::bar_partition_path(dir.string(), "daily", "600519", 2026),
+                              second, {4, false, true});
+  ParquetFixtureWriter::write(tg_indicators::bar_partition_path(dir.string(), "daily", "600519", 2025),
+                              first, {4, false, true});
+
+  const auto read = tg_indicators::query_parquet_bars(dir.string(), "daily", "600519", year_2025,
+                                                      tg_indicators::parse_date_millis("2026-02-01"));
+  ASSERT_EQ(read.size(), 10U);
+  EXPECT_EQ(read[4].ts_millis, bars[4].ts_millis);
+  EXPECT_EQ(read[5].ts_millis, bars[5].ts_millis);
+
+  const auto options = tg_indicators::parse_batch_args(
+      {"--root", dir.string(), "--indicator", "SMA", "--param", "period=3", "--threads", "2"});
+  std::ostringstream out;
+  std::ostringstream log;
+  tg_indicators::run_batch(options, out, log);
+  std::istringstream lines(out.str());
+  std::string line;
+  std::vector<std::string> rows;
+  while (std::getline(lines, line)) {
+    rows.push_back(line);
+  }
+  ASSERT_EQ(rows.size(), 11U);
+  EXPECT_EQ(rows[0], "symbol,ts_epoch_millis,sma");
+  EXPECT_EQ(rows[1], "600519," + std::to_string(bars[0].ts_millis) + ",");
+  EXPECT_EQ(rows[3], "600519," + std::to_string(bars[2].ts_millis) + ",11");
+  EXPECT_TRUE(log.str().empty());
+  std::filesystem::remove_all(dir);
+}
+
+TEST(ParquetReaderTest, BatchModeStreamsSpecsToChunkedArrowFile) {
+  const auto dir = make_temp_dir("parquet_arrow");
+  auto bars = increasing_bars(10);
+  const int64_t start = tg_indicators::parse_date_millis("2025-03-03");
+  for (size_t i = 0; i < bars.size(); ++i) {
+    bars[i].ts_millis = start + static_cast<int64_t>(i) * tg_indicators::kMillisPerDay;
+  }
+  for (const char* symbol : {"000001", "600519"}) {
+    ParquetFixtureWriter::write(tg_indicators::bar_partition_path(dir.string(), "daily", symbol, 2025),
+                                bars, {4, false, true});
+  }
+
+  const auto options = tg_indicators::parse_batch_args(
+      {"--root", dir.string(), "--spec", "SMA:period=3", "--spec", "SMA:period=12", "--chunk-rows", "4",
+       "--out", "panel.arrow"});
+  EXPECT_EQ(options.format, tg_indicators::BatchFormat::kArrow);
+  std::ostringstream out;
+  std::ostringstream log;
+  tg_indicators::run_batch(options, out, log);
+  EXPECT_NE(log.str().find("empty 000001 SMA(period=12)"), std::string::npos) << log.str();
+
+  const std::string file = out.str();
+  ASSERT_GT(file.size(), 16U);
+  EXPECT_EQ(file.compare(0, 8, std::string("ARROW1\0\0", 8)), 0);
+  EXPECT_EQ(file.substr(file.size() - 6), "ARROW1");
+  int32_t footer = 0;
+  std::memcpy(&footer, file.data() + file.size() - 10, sizeof(footer));
+  EXPECT_GT(footer, 0);
+  EXPECT_LT(static_cast<size_t>(footer), file.size());
+  // Schema, 20 rows in batches of 4, end-of-stream; messages start 8-byte aligned.
+  size_t messages = 0;
+  for (size_t at = 8; at + 4 <= file.size() - 10 - static_cast<size_t>(footer); at += 8) {
+    messages += file.compare(at, 4, std::string(4, '\xff')) == 0;
+  }
+  EXPECT_EQ(messages, 7U);
+  // Columnar: the second batch holds SMA(3) of bars 4..7 as contiguous doubles.
+  const double sma[] = {13.0, 14.0, 15.0, 16.0};
+  EXPECT_NE(file.find(std::string(reinterpret_cast<const char*>(sma), sizeof(sma))), std::string::npos);
+
+  EXPECT_THROW(tg_indicators::parse_batch_args(
+                   {"--root", dir.string(), "--spec", "SMA:period=3", "--indicator", "SMA", "--param", "period=3"}),
+               std::invalid_argument);
+  std::filesystem::remove_all(dir);
+}
+
+TEST(ResampleTest, BuildsSessionAwareThirtyMinuteBars) {
+  const auto bars = minute_session_bars();
+  const auto out = tg_indicators::resample_bars(bars, tg::v1::BAR_PERIOD_MIN30);
+  ASSERT_EQ(out.size(), 8U);
+  const int64_t midnight_utc8 = tg_indicators::parse_date_millis("2026-01-05") - 8 * 3'600'000;
+  const int closes[] = {600, 630, 660, 690, 810, 840, 870, 900};
+  for (size_t i = 0; i < out.size(); ++i) {
+    EXPECT_EQ(out[i].ts_millis, midnight_utc8 + closes[i] * 60'000LL) << i;
+  }
+  // First bucket absorbs the auction bar plus 09:31-10:00.
+  EXPECT_EQ(out[0].open, bars[0].open);
+  EXPECT_EQ(out[0].close, bars[30].close);
+  int64_t volume = 0;
+  double high = bars[0].high;
+  for (size_t i = 0; i <= 30; ++i) {
+    volume += bars[i].volume;
+    high = std::max(high, bars[i].high);
+  }
+  EXPECT_EQ(out[0].volume, volume);
+  EXPECT_EQ(out[0].high, high);
+  // 11:30 and 13:30 buckets never straddle the lunch break.
+  EXPECT_EQ(out[3].close, bars[120].close);
+  EXPECT_EQ(out[4].open, bars[121].open);
+
+  const auto hourly = tg_indicators::resample_bars(bars, tg::v1::BAR_PERIOD_MIN60);
+  ASSERT_EQ(hourly.size(), 4U);
+  EXPECT_EQ(hourly[1].ts_millis, midnight_utc8 + (11 * 60 + 30) * 60'000LL);
+  EXPECT_EQ(hourly[2].ts_millis, midnight_utc8 + 14 * 60 * 60'000LL);
+  const auto daily = tg_indicators::resample_bars(bars, tg::v1::BAR_PERIOD_DAILY);
+  ASSERT_EQ(daily.size(), 1U);
+  EXPECT_EQ(daily[0].ts_millis, bars.back().ts_millis);
+
+  EXPECT_THROW(tg_indicators::validate_resample(tg::v1::BAR_PERIOD_DAILY, tg::v1::BAR_PERIOD_MIN30),
+               std::invalid_argument);
+  EXPECT_NO_THROW(tg_indicators::validate_resample(tg::v1::BAR_PERIOD_MIN5, tg::v1::BAR_PERIOD_MIN15));
+}
+
+TEST(ResampleTest, StreamingResamplerMatchesBatch) {
+  const auto bars = minute_session_bars();
+  const auto batch = tg_indicators::resample_bars(bars, tg::v1::BAR_PERIOD_MIN15);
+  tg_indicators::BarResampler resampler(tg::v1::BAR_PERIOD_MIN15);
+  std::vector<OHLCV> streamed;
+  for (const auto& bar : bars) {
+    if (auto closed = resampler.push(bar)) {
+      streamed.push_back(*closed);
+    }
+  }
+  ASSERT_TRUE(resampler.forming().has_value());
+  streamed.push_back(*resampler.forming());
+  ASSERT_EQ(streamed.size(), batch.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    EXPECT_EQ(streamed[i].ts_millis, batch[i].ts_millis);
+    EXPECT_EQ(streamed[i].open, batch[i].open);
+    EXPECT_EQ(streamed[i].high, batch[i].high);
+    EXPECT_EQ(streamed[i].low, batch[i].low);
+    EXPECT_EQ(streamed[i].close, batch[i].close);
+    EXPECT_EQ(streamed[i].volume, batch[i].volume);
+  }
+}
+
+TEST(IndicatorServiceTest, ComputesOnResampledBars) {
+  tg_indicators::IndicatorServiceImpl service;
+  tg::v1::IndicatorRequest request;
+  request.set_indicator("SMA");
+  (*request.mutable_params())["period"] = 2.0;
+  request.set_resample_to(tg::v1::BAR_PERIOD_MIN30);
+  for (const auto& bar : minute_session_bars()) {
+    auto* proto = request.add_bars();
+    *proto = make_proto_bar(bar);
+    proto->set_period(tg::v1::BAR_PERIOD_MIN1);
+  }
+  tg::v1::IndicatorResult response;
+  grpc::Status status = service.Compute(nullptr, &request, &response);
+  ASSERT_TRUE(status.ok()) << status.error_message();
+  ASSERT_EQ(response.ts_epoch_millis_size(), 8);
+  ASSERT_EQ(response.series().at("sma").values_size(), 8);
+
+  request.set_resample_to(tg::v1::BAR_PERIOD_MIN1);
+  status = service.Compute(nullptr, &request, &response);
+  EXPECT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
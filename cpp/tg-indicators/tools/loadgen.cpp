@@ -0,0 +1,501 @@
+// Closed-loop synthetic load for a running tg-indicators server, for capacity
+// planning. Each worker sends its next request as soon as the previous one answers.
+//
+//   tg_indicators_loadgen --target HOST:PORT [--rpc compute|batch|cross_section|stream|correlation]
+//                         [--mix RSI:4,MACD:2,KDJ:1] [--bars 240 | --bars 60-5000]
+//                         [--concurrency 16] [--channels 4] [--duration 30]
+//                         [--batch-size 16] [--universe 500] [--limit 0.10]
+//                         [--pool 256] [--server-pid PID] [--seed 1]
+//
+// Bars are a random walk on a 0.01 tick, clamped to the A-share daily price limit
+// (--limit, 0.10 main board, 0.20 ChiNext/STAR, 0.05 ST) around the previous day's
+// close, 240 bars per session. `--bars A-B` draws log-uniform bar counts. Requests
+// come from a pre-generated pool of distinct series so the generator itself stays
+// cheap and server-side request coalescing rarely triggers.
+//
+// The report has a log-bucketed latency histogram, p50/p90/p99/p999, achieved QPS,
+// client CPU per request, and with --server-pid the server's CPU per request, cores
+// used and peak RSS (read from /proc).
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+
+#include "tg/v1/contracts.grpc.pb.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct LoadOptions {
+  std::string target;
+  std::string rpc{"compute"};
+  std::vector<std::pair<std::string, double>> mix{{"RSI", 4}, {"MACD", 2}, {"KDJ", 1}, {"BOLL", 1}};
+  size_t min_bars{240};
+  size_t max_bars{240};
+  size_t concurrency{16};
+  size_t channels{4};
+  double duration_s{30.0};
+  size_t batch_size{16};
+  size_t universe{500};
+  double limit{0.10};
+  size_t pool{256};
+  long server_pid{0};
+  uint64_t seed{1};
+};
+
+// Log-bucketed latency histogram: four buckets per power of two of microseconds.
+class Histogram {
+ public:
+  static constexpr size_t kBuckets = 4 * 40;
+
+  void record(double micros) {
+    ++counts_[bucket(micros)];
+    ++total_;
+  }
+
+  void merge(const Histogram& other) {
+    for (size_t i = 0; i < kBuckets; ++i) {
+      counts_[i] += other.counts_[i];
+    }
+    total_ += other.total_;
+  }
+
+  uint64_t total() const { return total_; }
+
+  // Upper bound of the bucket holding quantile q, in microseconds.
+  double quantile(double q) const {
+    const uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total_)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      seen += counts_[i];
+      if (seen >= rank && seen > 0) {
+        return upper(i);
+      }
+    }
+    return upper(kBuckets - 1);
+  }
+
+  void print(std::ostream& out) const {
+    out << "latency_upper_ms\tcount\tcumulative\n";
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      if (counts_[i] == 0) {
+        continue;
+      }
+      seen += counts_[i];
+      out << upper(i) / 1000.0 << '\t' << counts_[i] << '\t'
+          << static_cast<double>(seen) / static_cast<double>(total_) << '\n';
+    }
+  }
+
+ private:
+  static size_t bucket(double micros) {
+    if (micros <= 1.0) {
+      return 0;
+    }
+    return std::min(kBuckets - 1, static_cast<size_t>(std::ceil(4.0 * std::log2(micros))));
+  }
+  static double upper(size_t index) { return std::exp2(static_cast<double>(index) / 4.0); }
+
+  std::array<uint64_t, kBuckets> counts_{};
+  uint64_t total_{0};
+};
+
+std::string price(double value) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.2f", value);
+  return buffer;
+}
+
+// Built in place rather than with operator+, which GCC 12 flags under -Werror=restrict at -O2.
+std::string symbol_name(size_t i) {
+  std::string s = "S";
+  s += std::to_string(i);
+  return s;
+}
+
+// One symbol's minute bars: a tick-rounded random walk clamped to the daily limit.
+std::vector<tg::v1::Bar> random_walk_bars(size_t count, double limit, std::mt19937_64& rng) {
+  constexpr int64_t kStart = 1'767'225'600'000;  // 2026-01-01T00:00:00Z
+  constexpr size_t kBarsPerDay = 240;
+  std::normal_distribution<double> step(0.0, 0.0015);
+  std::lognormal_distribution<double> volume(9.0, 0.8);
+  double close = std::uniform_real_distribution<double>(3.0, 80.0)(rng);
+  double reference = close;
+  std::vector<tg::v1::Bar> bars(count);
+  for (size_t i = 0; i < count; ++i) {
+    if (i % kBarsPerDay == 0) {
+      reference = close;
+    }
+    const double upper = std::floor(reference * (1.0 + limit) * 100.0 + 1e-6) / 100.0;
+    const double lower = std::ceil(reference * (1.0 - limit) * 100.0 - 1e-6) / 100.0;
+    const double open = close;
+    close = std::clamp(std::round(close * (1.0 + step(rng)) * 100.0) / 100.0, lower, upper);
+    const double wiggle = std::abs(step(rng)) * close;
+    const double high = std::min(upper, std::max(open, close) + std::round(wiggle * 100.0) / 100.0);
+    const double low = std::max(lower, std::min(open, close) - std::round(wiggle * 100.0) / 100.0);
+    const auto shares = static_cast<int64_t>(volume(rng)) * 100;
+
+    tg::v1::Bar& bar = bars[i];
+    bar.set_symbol("LOAD");
+    bar.set_period(tg::v1::BAR_PERIOD_MIN1);
+    bar.set_ts_epoch_millis(kStart + static_cast<int64_t>(i / kBarsPerDay) * 86'400'000 +
+                            static_cast<int64_t>(i % kBarsPerDay) * 60'000);
+    bar.set_open(price(open));
+    bar.set_high(price(high));
+    bar.set_low(price(low));
+    bar.set_close(price(close));
+    bar.set_volume(shares);
+    bar.set_amount(price(static_cast<double>(shares) * close));
+  }
+  return bars;
+}
+
+class RequestFactory {
+ public:
+  RequestFactory(const LoadOptions& options, uint64_t seed) : options_(options), rng_(seed) {
+    std::vector<double> weights;
+    for (const auto& [name, weight] : options.mix) {
+      weights.push_back(weight);
+    }
+    pick_indicator_ = std::discrete_distribution<size_t>(weights.begin(), weights.end());
+    for (size_t i = 0; i < options.pool; ++i) {
+      series_.push_back(random_walk_bars(bar_count(), options.limit, rng_));
+    }
+  }
+
+  tg::v1::IndicatorRequest indicator_request() {
+    tg::v1::IndicatorRequest request;
+    request.set_indicator(indicator());
+    const auto& bars = series_[pick_series()];
+    request.mutable_bars()->Add(bars.begin(), bars.end());
+    return request;
+  }
+
+  tg::v1::CrossSectionRequest cross_section_request() {
+    tg::v1::CrossSectionRequest request;
+    request.set_indicator(indicator());
+    request.set_series(series_name(request.indicator()));
+    for (size_t i = 0; i < options_.universe; ++i) {
+      auto* symbol = request.add_universe();
+      symbol->set_symbol(symbol_name(i));
+      const auto& bars = series_[pick_series()];
+      symbol->mutable_bars()->Add(bars.begin(), bars.end());
+    }
+    return request;
+  }
+
+  tg::v1::RollingCorrelationRequest correlation_request() {
+    tg::v1::RollingCorrelationRequest request;
+    request.set_window(60);
+    request.set_step(30);
+    std::normal_distribution<double> ret(0.0, 0.02);
+    const size_t length = bar_count();
+    for (size_t i = 0; i < std::min<size_t>(options_.universe, 200); ++i) {
+      request.add_symbols(symbol_name(i));
+      auto* column = request.add_returns();
+      for (size_t j = 0; j < length; ++j) {
+        column->add_values(ret(rng_));
+      }
+    }
+    return request;
+  }
+
+  // Next bar of one of this worker's live sessions (one bar per StreamUpdate,
+  // sessions visited round-robin, each session's timestamps strictly increasing).
+  tg::v1::StreamUpdateRequest stream_request(size_t worker, uint64_t sequence) {
+    tg::v1::StreamUpdateRequest request;
+    const size_t session = sequence % series_.size();
+    const uint64_t round = sequence / series_.size();
+    request.set_session("LOAD." + std::to_string(worker) + "." + std::to_string(session));
+    request.set_indicator(options_.mix[session % options_.mix.size()].first);
+    const auto& bars = series_[session];
+    tg::v1::Bar bar = bars[round % bars.size()];
+    bar.set_ts_epoch_millis(bars.front().ts_epoch_millis() + static_cast<int64_t>(round) * 60'000);
+    *request.add_bars() = std::move(bar);
+    return request;
+  }
+
+ private:
+  size_t bar_count() {
+    if (options_.min_bars >= options_.max_bars) {
+      return options_.min_bars;
+    }
+    std::uniform_real_distribution<double> log_count(std::log(static_cast<double>(options_.min_bars)),
+                                                     std::log(static_cast<double>(options_.max_bars)));
+    return static_cast<size_t>(std::exp(log_count(rng_)));
+  }
+
+  size_t pick_series() { return std::uniform_int_distribution<size_t>(0, series_.size() - 1)(rng_); }
+
+  std::string indicator() { return options_.mix[pick_indicator_(rng_)].first; }
+
+  static std::string series_name(const std::string& indicator) {
+    if (indicator == "MACD") {
+      return "dif";
+    }
+    if (indicator == "KDJ") {
+      return "k";
+    }
+    if (indicator == "BOLL") {
+      return "mid";
+    }
+    if (indicator == "ADX") {
+      return "adx";
+    }
+    std::string lower = indicator;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    return lower;
+  }
+
+  const LoadOptions& options_;
+  std::mt19937_64 rng_;
+  std::discrete_distribution<size_t> pick_indicator_;
+  std::vector<std::vector<tg::v1::Bar>> series_;
+};
+
+struct ProcessSample {
+  double cpu_seconds{};
+  double rss_mb{};
+  double peak_rss_mb{};
+};
+
+// utime + stime and VmRSS/VmHWM of another process, from /proc.
+ProcessSample sample_process(long pid) {
+  ProcessSample sample;
+  std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+  std::string line;
+  if (std::getline(stat, line)) {
+    std::istringstream fields(line.substr(line.rfind(')') + 2));
+    std::string field;
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    for (int index = 3; fields >> field; ++index) {
+      if (index == 14) {
+        utime = std::stoull(field);
+      } else if (index == 15) {
+        stime = std::stoull(field);
+        break;
+      }
+    }
+    sample.cpu_seconds = static_cast<double>(utime + stime) / static_cast<double>(sysconf(_SC_CLK_TCK));
+  }
+  std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+  while (std::getline(status, line)) {
+    if (line.rfind("VmRSS:", 0) == 0) {
+      sample.rss_mb = std::stod(line.substr(6)) / 1024.0;
+    } else if (line.rfind("VmHWM:", 0) == 0) {
+      sample.peak_rss_mb = std::stod(line.substr(6)) / 1024.0;
+    }
+  }
+  return sample;
+}
+
+double own_cpu_seconds() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  auto seconds = [](const timeval& tv) { return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1e6; };
+  return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+LoadOptions parse_args(int argc, char** argv) {
+  LoadOptions options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw std::invalid_argument("missing value for " + arg);
+      }
+      return argv[++i];
+    };
+    if (arg == "--target") {
+      options.target = value();
+    } else if (arg == "--rpc") {
+      options.rpc = value();
+    } else if (arg == "--mix") {
+      options.mix.clear();
+      std::istringstream items(value());
+      std::string item;
+      while (std::getline(items, item, ',')) {
+        const size_t colon = item.find(':');
+        options.mix.emplace_back(item.substr(0, colon),
+                                 colon == std::string::npos ? 1.0 : std::stod(item.substr(colon + 1)));
+      }
+    } else if (arg == "--bars") {
+      const std::string bars = value();
+      const size_t dash = bars.find('-');
+      options.min_bars = std::stoul(bars.substr(0, dash));
+      options.max_bars = dash == std::string::npos ? options.min_bars : std::stoul(bars.substr(dash + 1));
+    } else if (arg == "--concurrency") {
+      options.concurrency = std::stoul(value());
+    } else if (arg == "--channels") {
+      options.channels = std::stoul(value());
+    } else if (arg == "--duration") {
+      options.duration_s = std::stod(value());
+    } else if (arg == "--batch-size") {
+      options.batch_size = std::stoul(value());
+    } else if (arg == "--universe") {
+      options.universe = std::stoul(value());
+    } else if (arg == "--limit") {
+      options.limit = std::stod(value());
+    } else if (arg == "--pool") {
+      options.pool = std::stoul(value());
+    } else if (arg == "--server-pid") {
+      options.server_pid = std::stol(value());
+    } else if (arg == "--seed") {
+      options.seed = std::stoull(value());
+    } else {
+      throw std::invalid_argument("unknown argument " + arg);
+    }
+  }
+  const bool known_rpc = options.rpc == "compute" || options.rpc == "batch" || options.rpc == "cross_section" ||
+                         options.rpc == "stream" || options.rpc == "correlation";
+  if (options.target.empty() || !known_rpc || options.mix.empty() || options.min_bars == 0 ||
+      options.concurrency == 0 || options.channels == 0 || options.pool == 0 || options.batch_size == 0) {
+    throw std::invalid_argument(
+        "usage: tg_indicators_loadgen --target HOST:PORT [--rpc compute|batch|cross_section|stream|correlation]\n"
+        "       [--mix RSI:4,MACD:2] [--bars N|MIN-MAX] [--concurrency N] [--channels N] [--duration S]\n"
+        "       [--batch-size N] [--universe N] [--limit 0.10] [--pool N] [--server-pid PID] [--seed N]");
+  }
+  return options;
+}
+
+// One closed-loop call; returns the number of indicator computations it carried.
+size_t call_once(tg::v1::IndicatorService::Stub& stub, RequestFactory& factory, const LoadOptions& options,
+                 size_t worker, uint64_t sequence, bool* ok) {
+  grpc::ClientContext context;
+  if (options.rpc == "compute") {
+    const auto request = factory.indicator_request();
+    tg::v1::IndicatorResult response;
+    *ok = stub.Compute(&context, request, &response).ok();
+    return 1;
+  }
+  if (options.rpc == "batch") {
+    auto stream = stub.BatchCompute(&context);
+    for (size_t i = 0; i < options.batch_size; ++i) {
+      stream->Write(factory.indicator_request());
+    }
+    stream->WritesDone();
+    tg::v1::IndicatorResult response;
+    while (stream->Read(&response)) {
+    }
+    *ok = stream->Finish().ok();
+    return options.batch_size;
+  }
+  if (options.rpc == "cross_section") {
+    const auto request = factory.cross_section_request();
+    tg::v1::CrossSectionResult response;
+    *ok = stub.CrossSection(&context, request, &response).ok();
+    return options.universe;
+  }
+  if (options.rpc == "correlation") {
+    const auto request = factory.correlation_request();
+    tg::v1::RollingCorrelationResult response;
+    *ok = stub.RollingCorrelation(&context, request, &response).ok();
+    return 1;
+  }
+  const auto request = factory.stream_request(worker, sequence);
+  tg::v1::StreamUpdateResult response;
+  *ok = stub.StreamUpdate(&context, request, &response).ok();
+  return 1;
+}
+
+int run(const LoadOptions& options) {
+  std::vector<std::unique_ptr<tg::v1::IndicatorService::Stub>> stubs;
+  for (size_t c = 0; c < options.channels; ++c) {
+    // A distinct channel argument keeps gRPC from sharing one subchannel.
+    grpc::ChannelArguments args;
+    args.SetInt("tg.loadgen.channel", static_cast<int>(c));
+    stubs.push_back(tg::v1::IndicatorService::NewStub(
+        grpc::CreateCustomChannel(options.target, grpc::InsecureChannelCredentials(), args)));
+  }
+
+  std::cerr << "generating " << options.pool << " series per worker...\n";
+  std::vector<std::unique_ptr<RequestFactory>> factories;
+  for (size_t w = 0; w < options.concurrency; ++w) {
+    factories.push_back(std::make_unique<RequestFactory>(options, options.seed * 1'000'003 + w));
+  }
+
+  std::vector<Histogram> histograms(options.concurrency);
+  std::vector<uint64_t> errors(options.concurrency);
+  std::vector<uint64_t> computations(options.concurrency);
+  std::atomic<bool> stop{false};
+
+  const ProcessSample server_before = options.server_pid > 0 ? sample_process(options.server_pid) : ProcessSample{};
+  const double client_cpu_before = own_cpu_seconds();
+  const auto started = Clock::now();
+  std::vector<std::thread> workers;
+  for (size_t w = 0; w < options.concurrency; ++w) {
+    workers.emplace_back([&, w] {
+      auto& stub = *stubs[w % stubs.size()];
+      for (uint64_t sequence = 0; !stop.load(std::memory_order_relaxed); ++sequence) {
+        const auto sent = Clock::now();
+        bool ok = false;
+        computations[w] += call_once(stub, *factories[w], options, w, sequence, &ok);
+        histograms[w].record(std::chrono::duration<double, std::micro>(Clock::now() - sent).count());
+        errors[w] += ok ? 0 : 1;
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.duration_s));
+  stop.store(true);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  const double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+  const double client_cpu = own_cpu_seconds() - client_cpu_before;
+
+  Histogram total;
+  uint64_t error_count = 0;
+  uint64_t computation_count = 0;
+  for (size_t w = 0; w < options.concurrency; ++w) {
+    total.merge(histograms[w]);
+    error_count += errors[w];
+    computation_count += computations[w];
+  }
+  const double requests = static_cast<double>(std::max<uint64_t>(total.total(), 1));
+
+  std::cout << "rpc=" << options.rpc << " concurrency=" << options.concurrency << " channels=" << options.channels
+            << " bars=" << options.min_bars << "-" << options.max_bars << " duration_s=" << elapsed << '\n';
+  std::cout << "requests=" << total.total() << " errors=" << error_count << " qps=" << requests / elapsed
+            << " computations_per_s=" << static_cast<double>(computation_count) / elapsed << '\n';
+  std::cout << "p50_ms=" << total.quantile(0.50) / 1000.0 << " p90_ms=" << total.quantile(0.90) / 1000.0
+            << " p99_ms=" << total.quantile(0.99) / 1000.0 << " p999_ms=" << total.quantile(0.999) / 1000.0 << '\n';
+  std::cout << "client_cpu_ms_per_request=" << client_cpu * 1000.0 / requests << '\n';
+  if (options.server_pid > 0) {
+    const ProcessSample server_after = sample_process(options.server_pid);
+    const double server_cpu = server_after.cpu_seconds - server_before.cpu_seconds;
+    std::cout << "server_cpu_ms_per_request=" << server_cpu * 1000.0 / requests
+              << " server_cores_used=" << server_cpu / elapsed << " server_rss_mb=" << server_after.rss_mb
+              << " server_peak_rss_mb=" << server_after.peak_rss_mb << '\n';
+  }
+  total.print(std::cout);
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  try {
+    return run(parse_args(argc, argv));
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+}
@@ -0,0 +1,313 @@
+// Replays a capture file (ServiceOptions::capture, TG_INDICATORS_CAPTURE) against a
+// running tg-indicators server and reports per-indicator throughput and latency.
+//
+//   tg_indicators_replay --target HOST:PORT --capture FILE [--speed original|FACTOR|max]
+//                        [--concurrency N] [--report OUT.tsv]
+//                        [--baseline PREVIOUS.tsv [--tolerance 0.2]]
+//
+// Requests are released on the captured schedule divided by the speed factor (or as
+// fast as the workers allow with `max`). Latency is measured from each request's
+// scheduled release, so a server that falls behind shows the queueing it causes, and
+// each call carries the deadline it was captured with, counted from that release.
+// With --baseline, the run fails (exit 2) when any indicator's p99 or error rate
+// exceeds the baseline's by more than the tolerance, which turns a captured day into
+// a performance regression test. Failed calls are kept out of the latency
+// percentiles, where a fast error would flatter them, and counted in the error rate.
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+
+#include "tg/v1/contracts.grpc.pb.h"
+#include "tg_indicators/capture.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ReplayOptions {
+  std::string target;
+  std::string capture;
+  double speed{1.0};  // 0 = max
+  size_t concurrency{32};
+  std::string report;
+  std::string baseline;
+  double tolerance{0.2};
+};
+
+struct Job {
+  tg_indicators::CapturedRequest request;
+  Clock::time_point scheduled;
+};
+
+struct LabelStats {
+  uint64_t count{};
+  std::vector<double> latency_ms;  // successful calls only
+  uint64_t errors{};
+};
+
+struct Summary {
+  uint64_t count{};
+  uint64_t errors{};
+  double qps{};
+  double p50{};
+  double p99{};
+  double p999{};
+};
+
+double percentile(std::vector<double>& sorted, double q) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(q * static_cast<double>(sorted.size())));
+  return sorted[index];
+}
+
+ReplayOptions parse_args(int argc, char** argv) {
+  ReplayOptions options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw std::invalid_argument("missing value for " + arg);
+      }
+      return argv[++i];
+    };
+    if (arg == "--target") {
+      options.target = value();
+    } else if (arg == "--capture") {
+      options.capture = value();
+    } else if (arg == "--speed") {
+      const std::string speed = value();
+      options.speed = speed == "max" ? 0.0 : speed == "original" ? 1.0 : std::stod(speed);
+    } else if (arg == "--concurrency") {
+      options.concurrency = std::max<size_t>(1, std::stoul(value()));
+    } else if (arg == "--report") {
+      options.report = value();
+    } else if (arg == "--baseline") {
+      options.baseline = value();
+    } else if (arg == "--tolerance") {
+      options.tolerance = std::stod(value());
+    } else {
+      throw std::invalid_argument("unknown argument " + arg);
+    }
+  }
+  if (options.target.empty() || options.capture.empty() || options.speed < 0.0) {
+    throw std::invalid_argument(
+        "usage: tg_indicators_replay --target HOST:PORT --capture FILE [--speed original|FACTOR|max]\n"
+        "       [--concurrency N] [--report OUT.tsv] [--baseline PREVIOUS.tsv [--tolerance 0.2]]");
+  }
+  return options;
+}
+
+grpc::Status issue(tg::v1::IndicatorService::Stub& stub, const tg_indicators::CapturedRequest& captured,
+                   Clock::time_point scheduled) {
+  grpc::ClientContext context;
+  if (captured.deadline_micros > 0) {
+    const auto left = scheduled + std::chrono::microseconds(captured.deadline_micros) - Clock::now();
+    context.set_deadline(std::chrono::system_clock::now() +
+                         std::chrono::duration_cast<std::chrono::system_clock::duration>(left));
+  }
+  using tg_indicators::CapturedMethod;
+  switch (captured.method) {
+    case CapturedMethod::kCompute:
+    case CapturedMethod::kBatchCompute: {
+      // Streamed items replay as unary Compute: same server work, no stream pairing.
+      tg::v1::IndicatorRequest request;
+      tg::v1::IndicatorResult response;
+      request.ParseFromString(captured.payload);
+      return stub.Compute(&context, request, &response);
+    }
+    case CapturedMethod::kCrossSection: {
+      tg::v1::CrossSectionRequest request;
+      tg::v1::CrossSectionResult response;
+      request.ParseFromString(captured.payload);
+      return stub.CrossSection(&context, request, &response);
+    }
+    case CapturedMethod::kRollingCorrelation: {
+      tg::v1::RollingCorrelationRequest request;
+      tg::v1::RollingCorrelationResult response;
+      request.ParseFromString(captured.payload);
+      return stub.RollingCorrelation(&context, request, &response);
+    }
+    case CapturedMethod::kStreamUpdate: {
+      tg::v1::StreamUpdateRequest request;
+      tg::v1::StreamUpdateResult response;
+      request.ParseFromString(captured.payload);
+      return stub.StreamUpdate(&context, request, &response);
+    }
+    case CapturedMethod::kExtractEvents: {
+      tg::v1::EventsRequest request;
+      tg::v1::EventsResult response;
+      request.ParseFromString(captured.payload);
+      return stub.ExtractEvents(&context, request, &response);
+    }
+    case CapturedMethod::kScreen: {
+      tg::v1::ScreenRequest request;
+      tg::v1::ScreenResult response;
+      request.ParseFromString(captured.payload);
+      return stub.Screen(&context, request, &response);
+    }
+  }
+  return {grpc::StatusCode::UNIMPLEMENTED, "unknown captured method"};
+}
+
+std::map<std::string, Summary> read_report(const std::string& path) {
+  std::map<std::string, Summary> out;
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("cannot read baseline " + path);
+  }
+  std::string line;
+  std::getline(in, line);  // header
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string label;
+    Summary summary;
+    if (fields >> label >> summary.count >> summary.errors >> summary.qps >> summary.p50 >>
+        summary.p99 >> summary.p999) {
+      out[label] = summary;
+    }
+  }
+  return out;
+}
+
+int run(const ReplayOptions& options) {
+  auto stub = tg::v1::IndicatorService::NewStub(
+      grpc::CreateChannel(options.target, grpc::InsecureChannelCredentials()));
+
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::condition_variable space;
+  std::deque<Job> queue;
+  bool exhausted = false;
+  std::map<std::string, LabelStats> stats;
+
+  std::vector<std::thread> workers;
+  for (size_t w = 0; w < options.concurrency; ++w) {
+    workers.emplace_back([&] {
+      for (;;) {
+        Job job;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          ready.wait(lock, [&] { return exhausted || !queue.empty(); });
+          if (queue.empty()) {
+            return;
+          }
+          job = std::move(queue.front());
+          queue.pop_front();
+        }
+        space.notify_one();
+        const grpc::Status status = issue(*stub, job.request, job.scheduled);
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - job.scheduled).count();
+        std::lock_guard<std::mutex> lock(mutex);
+        LabelStats& label = stats[job.request.label.empty() ? "-" : job.request.label];
+        ++label.count;
+        if (status.ok()) {
+          label.latency_ms.push_back(ms);
+        } else {
+          ++label.errors;
+        }
+      }
+    });
+  }
+
+  tg_indicators::CaptureReader reader(options.capture);
+  const auto started = Clock::now();
+  tg_indicators::CapturedRequest captured;
+  while (reader.next(&captured)) {
+    Job job{std::move(captured), Clock::now()};
+    if (options.speed > 0.0) {
+      job.scheduled = started + std::chrono::microseconds(static_cast<int64_t>(
+                                    static_cast<double>(job.request.offset_micros) / options.speed));
+      std::this_thread::sleep_until(job.scheduled);
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    space.wait(lock, [&] { return queue.size() < options.concurrency * 4; });
+    if (options.speed == 0.0) {
+      job.scheduled = Clock::now();
+    }
+    queue.push_back(std::move(job));
+    ready.notify_one();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    exhausted = true;
+  }
+  ready.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  const double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+
+  std::ostringstream report;
+  report << "label\tcount\terrors\tqps\tp50_ms\tp99_ms\tp999_ms\n";
+  std::map<std::string, Summary> current;
+  for (auto& [label, entry] : stats) {
+    std::sort(entry.latency_ms.begin(), entry.latency_ms.end());
+    Summary& summary = current[label];
+    summary.count = entry.count;
+    summary.errors = entry.errors;
+    summary.qps = static_cast<double>(summary.count) / std::max(seconds, 1e-9);
+    summary.p50 = percentile(entry.latency_ms, 0.50);
+    summary.p99 = percentile(entry.latency_ms, 0.99);
+    summary.p999 = percentile(entry.latency_ms, 0.999);
+    report << label << '\t' << summary.count << '\t' << summary.errors << '\t' << summary.qps << '\t'
+           << summary.p50 << '\t' << summary.p99 << '\t' << summary.p999 << '\n';
+  }
+  std::cout << report.str();
+  if (!options.report.empty()) {
+    std::ofstream(options.report) << report.str();
+  }
+
+  if (options.baseline.empty()) {
+    return 0;
+  }
+  auto error_rate = [](const Summary& summary) {
+    return summary.count == 0 ? 0.0
+                              : static_cast<double>(summary.errors) / static_cast<double>(summary.count);
+  };
+  int regressions = 0;
+  for (const auto& [label, before] : read_report(options.baseline)) {
+    const auto it = current.find(label);
+    if (it == current.end()) {
+      continue;
+    }
+    const Summary& now = it->second;
+    if (now.p99 > before.p99 * (1.0 + options.tolerance)) {
+      std::cerr << "regression: " << label << " p99 " << now.p99 << " ms vs baseline " << before.p99
+                << " ms\n";
+      ++regressions;
+    }
+    if (error_rate(now) > error_rate(before) * (1.0 + options.tolerance)) {
+      std::cerr << "regression: " << label << " " << now.errors << " of " << now.count
+                << " calls failed vs " << before.errors << " of " << before.count << " in the baseline\n";
+      ++regressions;
+    }
+  }
+  return regressions == 0 ? 0 : 2;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  try {
+    return run(parse_args(argc, argv));
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+}
@@ -154,6 +154,7 @@ impl IndicatorSource for GrpcIndicatorSource {
             indicator: request.indicator,
             params: request.params,
             bars: request.bars.iter().map(bar_to_proto).collect(),
+            ..Default::default()
         };
         let response = self
             .client